@@ -0,0 +1,59 @@
+#include "ActivityGovernor.h"
+
+int ActivityGovernor::Register(const std::string& name, ActivityState hiddenState, StateCallback apply)
+{
+    Subsystem subsystem;
+    subsystem.name = name;
+    subsystem.hiddenState = hiddenState;
+    subsystem.state = ActivityState::Active;
+    subsystem.resumeCount = 0;
+    subsystem.apply = std::move(apply);
+    m_subsystems.push_back(std::move(subsystem));
+    return static_cast<int>(m_subsystems.size()) - 1;
+}
+
+void ActivityGovernor::SetHiddenState(int index, ActivityState hiddenState)
+{
+    Subsystem& subsystem = m_subsystems[index];
+    subsystem.hiddenState = hiddenState;
+    if (!m_visible)
+        Transition(subsystem, hiddenState);
+}
+
+void ActivityGovernor::OnOverlayShown()
+{
+    m_visible = true;
+    for (auto& subsystem : m_subsystems) {
+        if (subsystem.state != ActivityState::Active)
+            subsystem.resumeCount++;
+        Transition(subsystem, ActivityState::Active);
+    }
+}
+
+void ActivityGovernor::OnOverlayHidden()
+{
+    m_visible = false;
+    for (auto& subsystem : m_subsystems) {
+        Transition(subsystem, subsystem.hiddenState);
+    }
+}
+
+void ActivityGovernor::Transition(Subsystem& subsystem, ActivityState state)
+{
+    if (subsystem.state == state)
+        return;
+
+    subsystem.state = state;
+    if (subsystem.apply)
+        subsystem.apply(state);
+}
+
+const char* ActivityGovernor::StateName(ActivityState state)
+{
+    switch (state) {
+    case ActivityState::Active: return "Active";
+    case ActivityState::Downshifted: return "Downshifted";
+    case ActivityState::Suspended: return "Suspended";
+    }
+    return "Unknown";
+}
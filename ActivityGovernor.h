@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+
+// What a subsystem is currently allowed to do
+enum class ActivityState {
+    Active,       // Running at full rate
+    Downshifted,  // Running at a reduced rate
+    Suspended     // Not running at all
+};
+
+// Central switch for background work that only matters while the overlay is visible.
+// Subsystems register a callback; on hide the governor moves each one to its hidden state,
+// on show it moves them back to Active so they can prewarm before the first frame.
+class ActivityGovernor {
+public:
+    using StateCallback = std::function<void(ActivityState)>;
+
+    struct Subsystem {
+        std::string name;
+        ActivityState hiddenState;   // State to use while the overlay is hidden
+        ActivityState state;
+        int resumeCount;
+        StateCallback apply;
+    };
+
+    ActivityGovernor() = default;
+
+    // Returns the subsystem index. Subsystems start out Active; the callback is invoked on every state change.
+    int Register(const std::string& name, ActivityState hiddenState, StateCallback apply);
+
+    // Change what a subsystem does while hidden (e.g. because something still needs it).
+    // Takes effect immediately if the overlay is hidden.
+    void SetHiddenState(int index, ActivityState hiddenState);
+
+    void OnOverlayShown();
+    void OnOverlayHidden();
+    bool IsOverlayVisible() const { return m_visible; }
+
+    const std::vector<Subsystem>& GetSubsystems() const { return m_subsystems; }
+    ActivityState GetState(int index) const { return m_subsystems[index].state; }
+    static const char* StateName(ActivityState state);
+
+private:
+    void Transition(Subsystem& subsystem, ActivityState state);
+
+    std::vector<Subsystem> m_subsystems;
+    bool m_visible = false;
+};
@@ -0,0 +1,110 @@
+#include "AdaptiveSampler.h"
+#include <algorithm>
+#include <cmath>
+
+AdaptiveSampler::AdaptiveSampler(size_t metricCount)
+{
+    Resize(metricCount);
+}
+
+void AdaptiveSampler::Resize(size_t metricCount)
+{
+    m_metrics.resize(metricCount);
+    for (auto& metric : m_metrics)
+        metric.intervalMs = metric.config.minIntervalMs;
+    UpdateBudgetScale();
+}
+
+void AdaptiveSampler::Configure(int metric, const AdaptiveSamplingConfig& config)
+{
+    MetricState& state = m_metrics[metric];
+    state.config = config;
+    state.intervalMs = config.minIntervalMs;
+    UpdateBudgetScale();
+}
+
+void AdaptiveSampler::SetMinInterval(int metric, uint32_t minIntervalMs)
+{
+    MetricState& state = m_metrics[metric];
+    if (state.config.minIntervalMs == minIntervalMs)
+        return;
+
+    // The configured maximum stays as it is; a minimum above it only caps the back-off
+    // while it lasts (see MaxInterval), so lowering the minimum again restores the old range
+    state.config.minIntervalMs = minIntervalMs;
+    state.intervalMs = std::max(state.intervalMs, static_cast<double>(minIntervalMs));
+    state.intervalMs = std::min(state.intervalMs, MaxInterval(state));
+    UpdateBudgetScale();
+}
+
+void AdaptiveSampler::SetActive(int metric, bool active)
+{
+    if (m_metrics[metric].active == active)
+        return;
+    m_metrics[metric].active = active;
+    if (!active)
+        Reset(metric);
+    UpdateBudgetScale();
+}
+
+bool AdaptiveSampler::IsDue(int metric, uint64_t nowMs) const
+{
+    const MetricState& state = m_metrics[metric];
+    return !state.hasSample || nowMs - state.lastSample >= GetInterval(metric);
+}
+
+void AdaptiveSampler::OnSample(int metric, double value, uint64_t nowMs)
+{
+    MetricState& state = m_metrics[metric];
+    const AdaptiveSamplingConfig& config = state.config;
+
+    if (state.hasSample) {
+        if (std::fabs(value - state.lastValue) >= config.changeThreshold) {
+            // Moving: go back to full rate straight away so transients aren't missed
+            state.intervalMs = config.minIntervalMs;
+        } else {
+            // Flat: back off exponentially
+            state.intervalMs = std::min(state.intervalMs * config.backoffFactor, MaxInterval(state));
+        }
+    }
+
+    state.lastValue = value;
+    state.lastSample = nowMs;
+    state.hasSample = true;
+    state.samples++;
+    UpdateBudgetScale();
+}
+
+uint32_t AdaptiveSampler::GetInterval(int metric) const
+{
+    const MetricState& state = m_metrics[metric];
+    // The budget may stretch past maxIntervalMs: the maximum bounds the back-off, the
+    // budget bounds the total rate, and clamping here would let the total exceed it
+    double interval = state.intervalMs * m_budgetScale;
+    interval = std::max(interval, static_cast<double>(state.config.minIntervalMs));
+    return static_cast<uint32_t>(interval);
+}
+
+double AdaptiveSampler::MaxInterval(const MetricState& state)
+{
+    return static_cast<double>(std::max(state.config.maxIntervalMs, state.config.minIntervalMs));
+}
+
+void AdaptiveSampler::Reset(int metric)
+{
+    MetricState& state = m_metrics[metric];
+    state.intervalMs = state.config.minIntervalMs;
+    state.hasSample = false;
+}
+
+// Stretch every interval by the same factor when the combined rate exceeds the budget
+void AdaptiveSampler::UpdateBudgetScale()
+{
+    double rate = 0.0;
+    for (const auto& state : m_metrics) {
+        if (state.active && state.intervalMs > 0.0)
+            rate += 1000.0 / state.intervalMs;
+    }
+
+    m_budgetScale = (m_budget > 0.0 && rate > m_budget) ? rate / m_budget : 1.0;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Per-metric tuning for the adaptive sampler
+struct AdaptiveSamplingConfig {
+    uint32_t minIntervalMs = 250;     // Fastest we'll ever sample
+    uint32_t maxIntervalMs = 8000;    // Slowest we'll back off to
+    double changeThreshold = 1.0;     // Change between samples that counts as "moving"
+    double backoffFactor = 2.0;       // Interval multiplier per flat sample
+};
+
+// Adaptive per-metric sampling rate controller.
+// A metric that moves by at least its threshold snaps back to its minimum interval,
+// a flat one backs off exponentially towards its maximum. On top of that a global
+// budget (samples per second across all metrics) stretches every interval evenly.
+class AdaptiveSampler {
+public:
+    explicit AdaptiveSampler(size_t metricCount = 0);
+
+    void Resize(size_t metricCount);
+    void Configure(int metric, const AdaptiveSamplingConfig& config);
+
+    // Tighten/loosen the minimum at runtime (e.g. from the fastest subscriber)
+    void SetMinInterval(int metric, uint32_t minIntervalMs);
+
+    // Total samples per second allowed across all active metrics, 0 = unlimited
+    void SetBudget(double samplesPerSecond) { m_budget = samplesPerSecond; UpdateBudgetScale(); }
+
+    // Metrics that nobody needs don't count against the budget
+    void SetActive(int metric, bool active);
+
+    bool IsDue(int metric, uint64_t nowMs) const;
+    void OnSample(int metric, double value, uint64_t nowMs);
+
+    // Interval after the budget has been applied
+    uint32_t GetInterval(int metric) const;
+    uint64_t GetSampleCount(int metric) const { return m_metrics[metric].samples; }
+    void Reset(int metric);
+
+private:
+    struct MetricState {
+        AdaptiveSamplingConfig config;
+        double intervalMs = 0.0;
+        double lastValue = 0.0;
+        uint64_t lastSample = 0;
+        uint64_t samples = 0;
+        bool hasSample = false;
+        bool active = false;
+    };
+
+    // Back-off ceiling: the configured maximum, or the minimum if that's been raised above it
+    static double MaxInterval(const MetricState& state);
+    void UpdateBudgetScale();
+
+    std::vector<MetricState> m_metrics;
+    double m_budget = 0.0;
+    double m_budgetScale = 1.0;
+};
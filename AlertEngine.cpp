@@ -0,0 +1,129 @@
+#include "AlertEngine.h"
+
+AlertEngine::AlertEngine()
+{
+    for (int i = 0; i < ALERT_SIGNAL_COUNT; i++)
+        m_signals[i] = 0.0f;
+}
+
+void AlertEngine::Compile(const AlertRule* rules, int count)
+{
+    m_program.clear();
+    m_rules.clear();
+    m_signalMask = 0;
+
+    for (int i = 0; i < count; i++) {
+        const AlertRule& rule = rules[i];
+        if (!rule.enabled)
+            continue;
+
+        RuleState state = {};
+        state.firstInstruction = static_cast<uint16_t>(m_program.size());
+        state.holdMs = rule.holdMs;
+        state.cooldownMs = rule.cooldownMs;
+        state.sourceIndex = i;
+
+        for (const AlertCondition& condition : rule.conditions) {
+            if (!condition.used || condition.signal >= ALERT_SIGNAL_COUNT)
+                continue;
+
+            Instruction instruction;
+            instruction.signal = condition.signal;
+            instruction.comparison = condition.comparison;
+            instruction.threshold = condition.threshold;
+            instruction.clearThreshold = condition.comparison == ALERT_ABOVE
+                ? condition.threshold - condition.hysteresis
+                : condition.threshold + condition.hysteresis;
+            m_program.push_back(instruction);
+            state.signalMask |= 1u << condition.signal;
+        }
+
+        state.instructionCount = static_cast<uint16_t>(m_program.size() - state.firstInstruction);
+        if (state.instructionCount == 0)
+            continue;
+
+        m_signalMask |= state.signalMask;
+        m_rules.push_back(state);
+    }
+
+    // Every rule gets a first look at whatever values are already known
+    m_changedSignals = m_validSignals;
+}
+
+void AlertEngine::SetSignal(int signal, float value)
+{
+    uint32_t bit = 1u << signal;
+    if (!(m_validSignals & bit) || m_signals[signal] != value)
+        m_changedSignals |= bit;
+    m_signals[signal] = value;
+    m_validSignals |= bit;
+}
+
+void AlertEngine::ClearSignal(int signal)
+{
+    uint32_t bit = 1u << signal;
+    if (m_validSignals & bit)
+        m_changedSignals |= bit;
+    m_validSignals &= ~bit;
+}
+
+bool AlertEngine::ConditionsHold(const RuleState& rule) const
+{
+    if ((rule.signalMask & m_validSignals) != rule.signalMask)
+        return false;
+
+    const Instruction* instruction = &m_program[rule.firstInstruction];
+    const Instruction* end = instruction + rule.instructionCount;
+    for (; instruction != end; ++instruction) {
+        float threshold = rule.firing ? instruction->clearThreshold : instruction->threshold;
+        float value = m_signals[instruction->signal];
+        bool holds = instruction->comparison == ALERT_ABOVE ? value > threshold : value < threshold;
+        if (!holds)
+            return false;
+    }
+    return true;
+}
+
+void AlertEngine::Evaluate(uint64_t nowMs, std::vector<AlertEvent>& events)
+{
+    uint32_t changed = m_changedSignals;
+    m_changedSignals = 0;
+
+    for (RuleState& rule : m_rules) {
+        // Nothing it looks at changed: only a rule waiting to fire (hold time, cooldown) can move
+        bool waiting = rule.holding && !rule.firing;
+        if (!(rule.signalMask & changed) && !waiting)
+            continue;
+
+        if (!ConditionsHold(rule)) {
+            rule.holding = false;
+            if (rule.firing) {
+                rule.firing = false;
+                events.push_back(AlertEvent{ rule.sourceIndex, false, nowMs });
+            }
+            continue;
+        }
+
+        if (!rule.holding) {
+            rule.holding = true;
+            rule.holdingSinceMs = nowMs;
+        }
+
+        if (!rule.firing && nowMs - rule.holdingSinceMs >= rule.holdMs &&
+            (!rule.hasFired || nowMs - rule.lastFiredMs >= rule.cooldownMs)) {
+            rule.firing = true;
+            rule.hasFired = true;
+            rule.lastFiredMs = nowMs;
+            events.push_back(AlertEvent{ rule.sourceIndex, true, nowMs });
+        }
+    }
+}
+
+bool AlertEngine::IsFiring(int rule) const
+{
+    for (const RuleState& state : m_rules) {
+        if (state.sourceIndex == rule)
+            return state.firing;
+    }
+    return false;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Values the rules can look at
+enum AlertSignal : uint8_t {
+    ALERT_SIGNAL_CPU_USAGE,          // percent
+    ALERT_SIGNAL_CPU_TEMPERATURE,    // degrees C
+    ALERT_SIGNAL_MEMORY_LOAD,        // percent
+    ALERT_SIGNAL_BATTERY_PERCENT,
+    ALERT_SIGNAL_BATTERY_CHARGING,   // 0 or 1
+    ALERT_SIGNAL_DOWNLOAD_SPEED,     // MB/s
+    ALERT_SIGNAL_UPLOAD_SPEED,       // MB/s
+    ALERT_SIGNAL_NETWORK_CONNECTED,  // 0 or 1
+    ALERT_SIGNAL_COUNT
+};
+
+enum AlertComparison : uint8_t {
+    ALERT_ABOVE,
+    ALERT_BELOW
+};
+
+#define MAX_ALERT_RULES 8
+#define MAX_ALERT_CONDITIONS 2
+#define ALERT_NAME_LENGTH 40
+
+// One comparison. While its rule is firing, the value has to move 'hysteresis' back past
+// the threshold before the condition stops holding, so a value hovering around the
+// threshold doesn't flap.
+struct AlertCondition {
+    uint8_t used;          // 0 = unused slot
+    uint8_t signal;        // AlertSignal
+    uint8_t comparison;    // AlertComparison
+    float threshold;
+    float hysteresis;
+};
+
+// A rule fires once all of its conditions have held for holdMs, and not again within
+// cooldownMs of the previous firing. Plain data so it can live in the settings file.
+struct AlertRule {
+    char name[ALERT_NAME_LENGTH];
+    uint8_t enabled;
+    AlertCondition conditions[MAX_ALERT_CONDITIONS];
+    uint32_t holdMs;
+    uint32_t cooldownMs;
+};
+
+struct AlertSettings {
+    bool enabled = true;
+    AlertRule rules[MAX_ALERT_RULES] = {
+        { "CPU above 90% for 30 s", 1,
+          { { 1, ALERT_SIGNAL_CPU_USAGE, ALERT_ABOVE, 90.0f, 10.0f } }, 30000, 300000 },
+        { "CPU temperature above 85 C", 1,
+          { { 1, ALERT_SIGNAL_CPU_TEMPERATURE, ALERT_ABOVE, 85.0f, 5.0f } }, 5000, 300000 },
+        { "Battery below 15% and discharging", 1,
+          { { 1, ALERT_SIGNAL_BATTERY_PERCENT, ALERT_BELOW, 15.0f, 2.0f },
+            { 1, ALERT_SIGNAL_BATTERY_CHARGING, ALERT_BELOW, 0.5f, 0.0f } }, 0, 600000 },
+        { "Download below 0.1 MB/s while connected", 0,
+          { { 1, ALERT_SIGNAL_DOWNLOAD_SPEED, ALERT_BELOW, 0.1f, 0.05f },
+            { 1, ALERT_SIGNAL_NETWORK_CONNECTED, ALERT_ABOVE, 0.5f, 0.0f } }, 60000, 600000 },
+    };
+};
+
+struct AlertEvent {
+    int rule;          // Index into the rule table passed to Compile
+    bool fired;        // false = the rule cleared
+    uint64_t timeMs;
+};
+
+// Streaming rule evaluator.
+// The rule table is compiled into one flat array of comparisons (grouped per rule) plus a
+// few words of state per rule, so a tick is a linear pass with no allocation. Rules whose
+// signals haven't changed since the last tick are skipped unless they're waiting out a
+// hold time or cooldown.
+class AlertEngine {
+public:
+    AlertEngine();
+
+    // Build the program from a rule table (disabled rules and unused conditions are skipped).
+    // Resets every rule's state.
+    void Compile(const AlertRule* rules, int count);
+
+    // Record a new value; rules only look at signals that have been set at least once
+    void SetSignal(int signal, float value);
+    void ClearSignal(int signal);
+
+    // Evaluate the rules affected since the last call. Fired/cleared transitions are appended to 'events'.
+    void Evaluate(uint64_t nowMs, std::vector<AlertEvent>& events);
+
+    bool IsFiring(int rule) const;
+    size_t GetRuleCount() const { return m_rules.size(); }
+
+    // Bit (1 << AlertSignal) for every signal some compiled rule uses
+    uint32_t GetSignalMask() const { return m_signalMask; }
+
+private:
+    struct Instruction {
+        uint8_t signal;
+        uint8_t comparison;
+        float threshold;
+        float clearThreshold;    // Threshold used while the rule is firing
+    };
+
+    struct RuleState {
+        uint16_t firstInstruction;
+        uint16_t instructionCount;
+        uint32_t signalMask;
+        uint32_t holdMs;
+        uint32_t cooldownMs;
+        uint64_t holdingSinceMs;
+        uint64_t lastFiredMs;
+        int sourceIndex;
+        bool holding;
+        bool firing;
+        bool hasFired;
+    };
+
+    bool ConditionsHold(const RuleState& rule) const;
+
+    std::vector<Instruction> m_program;
+    std::vector<RuleState> m_rules;
+    float m_signals[ALERT_SIGNAL_COUNT];
+    uint32_t m_validSignals = 0;
+    uint32_t m_changedSignals = 0;
+    uint32_t m_signalMask = 0;
+};
@@ -6,11 +6,13 @@
 #include <algorithm>
 #define _USE_MATH_DEFINES
 #include <math.h>
+#include "LatencyHistogram.h"
 
 #pragma comment(lib, "Ole32.lib")
 
 // Make sure there's only one constructor definition
-AudioManager::AudioManager() : 
+AudioManager::AudioManager(const Clock& clock) : 
+    m_clock(clock),
     m_pEnumerator(nullptr),
     m_pDevice(nullptr),
     m_pEndpointVolume(nullptr),
@@ -22,8 +24,11 @@ AudioManager::AudioManager() :
 {
     // Initialize visualizer data
     m_visualizerData.resize(VISUALIZER_BANDS, 0.0f);
-    m_visualizerPeaks.resize(VISUALIZER_BANDS, 0.0f);
-    m_visualizerPeakFalloff.resize(VISUALIZER_BANDS, 0.0f);
+    m_visualizerPrevious.resize(VISUALIZER_BANDS, 0.0f);
+    m_renderCurrent.resize(VISUALIZER_BANDS, 0.0f);
+    m_renderPrevious.resize(VISUALIZER_BANDS, 0.0f);
+    m_renderTarget.resize(VISUALIZER_BANDS, 0.0f);
+    m_smoother.Resize(VISUALIZER_BANDS);
     
     // Initialize audio system
     Initialize();
@@ -68,7 +73,9 @@ void AudioManager::StopVisualizerCapture()
     // Clear visualization data
     std::lock_guard<std::mutex> lock(m_visualizerMutex);
     std::fill(m_visualizerData.begin(), m_visualizerData.end(), 0.0f);
-    std::fill(m_visualizerPeaks.begin(), m_visualizerPeaks.end(), 0.0f);
+    std::fill(m_visualizerPrevious.begin(), m_visualizerPrevious.end(), 0.0f);
+    m_hasPreviousSnapshot = false;
+    m_smoother.Reset();
 }
 
 // Update settings for visualizer
@@ -78,9 +85,39 @@ void AudioManager::UpdateVisualizerSettings(float sensitivity, int style)
     m_visualizerStyle = style;
 }
 
+// Produce band and peak levels for the current render time.
+// Only the two raw snapshots are copied under the lock; interpolation and smoothing
+// run afterwards, and all of it is driven by timestamps so skipped frames cost nothing.
+// The destination vectors keep their capacity, so this doesn't allocate once warmed up
+void AudioManager::GetVisualizerSnapshot(std::vector<float>& data, std::vector<float>& peaks)
+{
+    double currentTime, previousTime;
+    bool hasPrevious;
+    {
+        std::lock_guard<std::mutex> lock(m_visualizerMutex);
+        m_renderCurrent.assign(m_visualizerData.begin(), m_visualizerData.end());
+        m_renderPrevious.assign(m_visualizerPrevious.begin(), m_visualizerPrevious.end());
+        currentTime = m_visualizerDataTime;
+        previousTime = m_visualizerPreviousTime;
+        hasPrevious = m_hasPreviousSnapshot;
+    }
+    
+    double now = m_clock.NowSeconds();
+    VisualizerSmoother::InterpolateSnapshots(
+        hasPrevious ? m_renderPrevious.data() : nullptr, previousTime,
+        m_renderCurrent.data(), currentTime,
+        now, VISUALIZER_BANDS, m_renderTarget.data());
+    m_smoother.Update(m_renderTarget.data(), now);
+    
+    data.assign(m_smoother.GetLevels().begin(), m_smoother.GetLevels().end());
+    peaks.assign(m_smoother.GetPeaks().begin(), m_smoother.GetPeaks().end());
+}
+
 // The main audio capture thread function
 void AudioManager::VisualizerCaptureThread()
 {
+    TraceRecorder::Instance().SetThreadName("Visualizer capture");
+    
     // Initialize COM for this thread
     HRESULT hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
     if (FAILED(hr)) {
@@ -226,11 +263,14 @@ void AudioManager::VisualizerCaptureThread()
         
         // Process all available packets
         while (packetLength > 0) {
+            TraceScope packetTrace("Audio packet");
+            
             // Get the data
             BYTE* pData = nullptr;
             UINT32 numFramesAvailable = 0;
             DWORD flags = 0;
             
+            uint64_t packetStartNs = m_clock.NowNs();
             hr = pCaptureClient->GetBuffer(
                 &pData,
                 &numFramesAvailable,
@@ -238,19 +278,24 @@ void AudioManager::VisualizerCaptureThread()
                 NULL,
                 NULL
             );
+            LatencyHistogram::For(LATENCY_COM_AUDIO_CAPTURE).Record(m_clock.NowNs() - packetStartNs);
             
             if (FAILED(hr)) {
                 break;
             }
             
-            // Skip silent packets
             if (!(flags & AUDCLNT_BUFFERFLAGS_SILENT)) {
                 // Process the captured audio data
                 ProcessAudioData(reinterpret_cast<float*>(pData), numFramesAvailable, channelCount);
+            } else {
+                // Silent packets still advance time so the bars fall back to zero
+                static const float silence[VISUALIZER_BANDS] = {};
+                PushBandSnapshot(silence);
             }
             
             // Release the buffer
             hr = pCaptureClient->ReleaseBuffer(numFramesAvailable);
+            LatencyHistogram::For(LATENCY_AUDIO_PACKET).Record(m_clock.NowNs() - packetStartNs);
             if (FAILED(hr)) {
                 break;
             }
@@ -313,33 +358,21 @@ void AudioManager::ProcessAudioData(const float* data, size_t frameCount, size_t
         normalizedBands[i] = value;
     }
     
-    // Update the visualizer data with mutex protection
-    {
-        std::lock_guard<std::mutex> lock(m_visualizerMutex);
-        
-        for (size_t i = 0; i < VISUALIZER_BANDS; i++) {
-            // Smooth transition to new value (30% new, 70% old)
-            m_visualizerData[i] = m_visualizerData[i] * 0.7f + normalizedBands[i] * 0.3f;
-            
-            // Update peaks
-            if (m_visualizerData[i] > m_visualizerPeaks[i]) {
-                m_visualizerPeaks[i] = m_visualizerData[i];
-                m_visualizerPeakFalloff[i] = 0.002f; // Reset falloff speed
-            } else {
-                // Gradually reduce peak markers
-                m_visualizerPeaks[i] -= m_visualizerPeakFalloff[i];
-                m_visualizerPeakFalloff[i] *= 1.02f; // Accelerate falloff
-                
-                // Make sure peaks don't go below the current level
-                if (m_visualizerPeaks[i] < m_visualizerData[i])
-                    m_visualizerPeaks[i] = m_visualizerData[i];
-                
-                // Ensure it doesn't go negative
-                if (m_visualizerPeaks[i] < 0.0f)
-                    m_visualizerPeaks[i] = 0.0f;
-            }
-        }
-    }
+    PushBandSnapshot(normalizedBands.data());
+}
+
+// Publish a new raw band snapshot. Smoothing happens at render time from the timestamps.
+void AudioManager::PushBandSnapshot(const float* bands)
+{
+    double now = m_clock.NowSeconds();
+    
+    std::lock_guard<std::mutex> lock(m_visualizerMutex);
+    m_visualizerPrevious.swap(m_visualizerData);
+    m_visualizerPreviousTime = m_visualizerDataTime;
+    m_hasPreviousSnapshot = m_visualizerDataTime > 0.0;
+    
+    std::copy(bands, bands + VISUALIZER_BANDS, m_visualizerData.begin());
+    m_visualizerDataTime = now;
 }
 
 // Simple FFT implementation (simplified for visualization purposes)
@@ -612,7 +645,10 @@ float AudioManager::GetMasterVolume()
     
     if (m_pEndpointVolume)
     {
-        hr = m_pEndpointVolume->GetMasterVolumeLevelScalar(&level);
+        {
+            LatencyScope scope(LATENCY_COM_ENDPOINT_VOLUME);
+            hr = m_pEndpointVolume->GetMasterVolumeLevelScalar(&level);
+        }
         if (FAILED(hr))
         {
             // If getting volume fails, try refreshing the audio device
@@ -643,7 +679,10 @@ void AudioManager::SetMasterVolume(float volume)
         // Make sure volume is in the valid range
         volume = (volume < 0.0f) ? 0.0f : (volume > 1.0f) ? 1.0f : volume;
         
-        hr = m_pEndpointVolume->SetMasterVolumeLevelScalar(volume, nullptr);
+        {
+            LatencyScope scope(LATENCY_COM_ENDPOINT_VOLUME);
+            hr = m_pEndpointVolume->SetMasterVolumeLevelScalar(volume, nullptr);
+        }
         if (FAILED(hr))
         {
             // If setting volume fails, try refreshing the audio device
@@ -671,7 +710,10 @@ bool AudioManager::IsMasterMuted()
     
     if (m_pEndpointVolume)
     {
-        hr = m_pEndpointVolume->GetMute(&muted);
+        {
+            LatencyScope scope(LATENCY_COM_ENDPOINT_VOLUME);
+            hr = m_pEndpointVolume->GetMute(&muted);
+        }
         if (FAILED(hr))
         {
             // If getting mute state fails, try refreshing the audio device
@@ -699,7 +741,10 @@ void AudioManager::SetMasterMuted(bool muted)
     
     if (m_pEndpointVolume)
     {
-        hr = m_pEndpointVolume->SetMute(muted, nullptr);
+        {
+            LatencyScope scope(LATENCY_COM_ENDPOINT_VOLUME);
+            hr = m_pEndpointVolume->SetMute(muted, nullptr);
+        }
         if (FAILED(hr))
         {
             // If setting mute fails, try refreshing the audio device
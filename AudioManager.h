@@ -7,6 +7,8 @@
 #include <string>
 #include <thread>
 #include <mutex>
+#include "Clock.h"
+#include "VisualizerSmoother.h"
 
 // Define the property key manually for MinGW compatibility
 const static PROPERTYKEY PKEY_Device_FriendlyName_Custom = 
@@ -28,7 +30,8 @@ const int VISUALIZER_BANDS = 32;
 
 class AudioManager {
 public:
-    AudioManager();
+    // The clock timestamps capture snapshots and drives render-time smoothing
+    explicit AudioManager(const Clock& clock = Clock::System());
     ~AudioManager();
 
     // Initialization and cleanup
@@ -52,9 +55,13 @@ public:
     void StopVisualizerCapture();
     bool IsVisualizerActive() const { return m_visualizerActive; }
     const std::vector<float>& GetVisualizerData() const { return m_visualizerData; }
+    // Render-thread call: interpolates capture snapshots and applies time-based smoothing
+    void GetVisualizerSnapshot(std::vector<float>& data, std::vector<float>& peaks);
     void UpdateVisualizerSettings(float sensitivity, int style);
 
 private:
+    const Clock& m_clock;
+
     // COM interfaces for audio
     IMMDeviceEnumerator* m_pEnumerator = nullptr;
     IMMDevice* m_pDevice = nullptr;
@@ -66,9 +73,15 @@ private:
 
     // Visualizer components
     bool m_visualizerActive = false;
-    std::vector<float> m_visualizerData;
-    std::vector<float> m_visualizerPeaks;
-    std::vector<float> m_visualizerPeakFalloff;
+    std::vector<float> m_visualizerData;       // Newest captured band levels
+    std::vector<float> m_visualizerPrevious;   // Band levels from the capture before that
+    double m_visualizerDataTime = 0.0;
+    double m_visualizerPreviousTime = 0.0;
+    bool m_hasPreviousSnapshot = false;
+    VisualizerSmoother m_smoother;             // Only touched from the render thread
+    std::vector<float> m_renderCurrent;
+    std::vector<float> m_renderPrevious;
+    std::vector<float> m_renderTarget;
     std::thread m_captureThread;
     std::mutex m_visualizerMutex;
     bool m_stopCapture = false;
@@ -78,5 +91,6 @@ private:
     // Audio capture for visualizer
     void VisualizerCaptureThread();
     void ProcessAudioData(const float* data, size_t frameCount, size_t channels);
+    void PushBandSnapshot(const float* bands);
     void CalculateFFT(const std::vector<float>& input, std::vector<float>& output);
 };
\ No newline at end of file
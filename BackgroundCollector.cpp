@@ -0,0 +1,116 @@
+#include "BackgroundCollector.h"
+#include "TraceRecorder.h"
+
+BackgroundCollector::BackgroundCollector(const Clock& clock) : m_clock(clock)
+{
+}
+
+BackgroundCollector::~BackgroundCollector()
+{
+    Stop();
+}
+
+int BackgroundCollector::Add(std::function<void()> job)
+{
+    m_jobs.push_back(std::make_unique<Job>());
+    m_jobs.back()->run = std::move(job);
+    return static_cast<int>(m_jobs.size() - 1);
+}
+
+void BackgroundCollector::SetThreadHooks(std::function<void()> onStart, std::function<void()> onStop)
+{
+    m_onStart = std::move(onStart);
+    m_onStop = std::move(onStop);
+}
+
+bool BackgroundCollector::Start()
+{
+    if (m_running)
+        return true;
+
+    m_stop = false;
+    m_queue.clear();
+    for (auto& job : m_jobs)
+        job->state.store(JOB_IDLE, std::memory_order_relaxed);
+
+    m_thread = std::thread(&BackgroundCollector::WorkerLoop, this);
+    m_running = true;
+    return true;
+}
+
+void BackgroundCollector::Stop()
+{
+    if (!m_running)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+    m_running = false;
+}
+
+bool BackgroundCollector::Request(int job)
+{
+    if (!m_running)
+        return false;
+
+    // Only the owner moves a job out of IDLE, so this can't race with another request
+    if (m_jobs[job]->state.load(std::memory_order_acquire) != JOB_IDLE)
+        return false;
+    m_jobs[job]->state.store(JOB_QUEUED, std::memory_order_relaxed);
+
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_queue.push_back(job);
+    }
+    m_wake.notify_one();
+    return true;
+}
+
+bool BackgroundCollector::TakeResult(int job)
+{
+    if (m_jobs[job]->state.load(std::memory_order_acquire) != JOB_DONE)
+        return false;
+    m_jobs[job]->state.store(JOB_IDLE, std::memory_order_relaxed);
+    return true;
+}
+
+bool BackgroundCollector::IsBusy(int job) const
+{
+    int state = m_jobs[job]->state.load(std::memory_order_relaxed);
+    return state == JOB_QUEUED || state == JOB_RUNNING;
+}
+
+void BackgroundCollector::WorkerLoop()
+{
+    TraceRecorder::Instance().SetThreadName("Collector");
+    if (m_onStart)
+        m_onStart();
+
+    for (;;) {
+        int id;
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_wake.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+            if (m_stop)
+                break;
+            id = m_queue.front();
+            m_queue.pop_front();
+        }
+
+        Job& job = *m_jobs[id];
+        job.state.store(JOB_RUNNING, std::memory_order_relaxed);
+        uint64_t startNs = m_clock.NowNs();
+        job.run();
+        job.durationNs.store(m_clock.NowNs() - startNs, std::memory_order_relaxed);
+
+        // Publishes everything the job wrote to the owner's acquire in TakeResult
+        job.state.store(JOB_DONE, std::memory_order_release);
+    }
+
+    if (m_onStop)
+        m_onStop();
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Clock.h"
+
+// Runs slow metric providers (WMI, WLAN, power status) on a worker thread so the render
+// thread never waits on them. The owner requests a job when its metric is due and picks
+// the result up on a later frame. A job is never queued twice, and its completion is
+// published with a release store, so a job's output needs no lock: the worker only writes
+// it between Request and completion, the owner only reads it after TakeResult.
+class BackgroundCollector {
+public:
+    explicit BackgroundCollector(const Clock& clock = Clock::System());
+    ~BackgroundCollector();
+
+    BackgroundCollector(const BackgroundCollector&) = delete;
+    BackgroundCollector& operator=(const BackgroundCollector&) = delete;
+
+    // Jobs and hooks are registered while stopped; returns the job id
+    int Add(std::function<void()> job);
+
+    // Run on the worker thread around its lifetime (e.g. per-thread COM setup)
+    void SetThreadHooks(std::function<void()> onStart, std::function<void()> onStop);
+
+    bool Start();
+    void Stop();    // Waits for the job in progress; queued ones are dropped
+    bool IsRunning() const { return m_running; }
+
+    // Queue a job. Returns false if it's already queued, running, or its result hasn't
+    // been taken yet.
+    bool Request(int job);
+
+    // True once per finished request; the job's output may be read after this
+    bool TakeResult(int job);
+
+    bool IsBusy(int job) const;
+    uint64_t GetLastDurationNs(int job) const { return m_jobs[job]->durationNs.load(std::memory_order_relaxed); }
+
+private:
+    enum JobState {
+        JOB_IDLE,
+        JOB_QUEUED,
+        JOB_RUNNING,
+        JOB_DONE
+    };
+
+    struct Job {
+        std::function<void()> run;
+        std::atomic<int> state{ JOB_IDLE };
+        std::atomic<uint64_t> durationNs{ 0 };
+    };
+
+    void WorkerLoop();
+
+    const Clock& m_clock;
+    std::vector<std::unique_ptr<Job>> m_jobs;
+    std::function<void()> m_onStart;
+    std::function<void()> m_onStop;
+    bool m_running = false;
+
+    std::thread m_thread;
+    std::mutex m_queueMutex;
+    std::condition_variable m_wake;
+    std::deque<int> m_queue;
+    bool m_stop = false;
+};
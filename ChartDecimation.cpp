@@ -0,0 +1,207 @@
+#include "ChartDecimation.h"
+#include <algorithm>
+#include <cmath>
+
+void ChartDecimator::SetMode(DecimationMode mode)
+{
+    if (mode != m_mode) {
+        m_mode = mode;
+        m_valid = false;
+    }
+}
+
+void ChartDecimator::SetWidth(int pixels)
+{
+    pixels = std::max(pixels, 2);
+    if (pixels != m_width) {
+        m_width = pixels;
+        m_valid = false;
+    }
+}
+
+const std::vector<ChartPoint>& ChartDecimator::Update(const HistoryRing& ring)
+{
+    uint64_t begin = ring.Begin();
+    uint64_t end = ring.End();
+
+    if (m_valid && begin == m_begin && end == m_processedEnd)
+        return m_points;
+
+    // Cleared, resized, or more than a whole ring arrived since the last look: start over
+    if (!m_valid || ring.Capacity() != m_capacity || end < m_processedEnd || begin > m_processedEnd) {
+        Rebuild(ring);
+        return m_points;
+    }
+
+    // Drop buckets that fell off the front; the new oldest one may have lost some samples
+    uint64_t firstBucket = begin / m_bucketSize;
+    bool headChanged = begin != m_begin;
+    m_firstBucket = std::max(m_firstBucket, firstBucket);
+    m_endBucket = std::max(m_endBucket, m_firstBucket);
+    if (headChanged && m_firstBucket < m_endBucket)
+        RecomputeBucket(ring, m_firstBucket, begin, std::min(m_processedEnd, (m_firstBucket + 1) * m_bucketSize));
+
+    // Fold in what's new; only the tail buckets change
+    uint64_t tailBucket = m_processedEnd / m_bucketSize;
+    for (uint64_t i = m_processedEnd; i < end; i++)
+        Fold(i, ring.At(i));
+
+    m_begin = begin;
+    m_processedEnd = end;
+
+    if (m_mode == DECIMATE_LTTB) {
+        // A pick depends on its left neighbour's pick and its right neighbour's average
+        if (headChanged) {
+            for (uint64_t b = m_firstBucket; b < std::min(m_firstBucket + 2, m_endBucket); b++)
+                Select(ring, b);
+        }
+        uint64_t from = std::max(m_firstBucket, tailBucket > 0 ? tailBucket - 1 : 0);
+        for (uint64_t b = from; b < m_endBucket; b++)
+            Select(ring, b);
+    }
+
+    BuildPoints();
+    return m_points;
+}
+
+void ChartDecimator::Rebuild(const HistoryRing& ring)
+{
+    m_capacity = ring.Capacity();
+    m_bucketSize = std::max<uint64_t>(1, (m_capacity + m_width - 1) / m_width);
+
+    // The retained range can straddle one extra bucket at each end
+    m_buckets.assign(static_cast<size_t>(m_capacity / m_bucketSize + 2), Bucket());
+
+    m_begin = ring.Begin();
+    m_processedEnd = ring.End();
+    m_firstBucket = m_begin / m_bucketSize;
+    m_endBucket = m_firstBucket;
+    for (uint64_t i = m_begin; i < m_processedEnd; i++)
+        Fold(i, ring.At(i));
+
+    if (m_mode == DECIMATE_LTTB) {
+        for (uint64_t b = m_firstBucket; b < m_endBucket; b++)
+            Select(ring, b);
+    }
+
+    m_valid = true;
+    BuildPoints();
+}
+
+void ChartDecimator::Fold(uint64_t index, float value)
+{
+    uint64_t bucket = index / m_bucketSize;
+    while (m_endBucket <= bucket) {
+        Bucket& fresh = Slot(m_endBucket);
+        fresh = Bucket();
+        fresh.first = m_endBucket * m_bucketSize;
+        m_endBucket++;
+    }
+
+    Bucket& slot = Slot(bucket);
+    if (slot.count == 0) {
+        slot.first = index;
+        slot.min = slot.max = value;
+        slot.minIndex = slot.maxIndex = index;
+        slot.sum = 0.0;
+    }
+    else if (value < slot.min) {
+        slot.min = value;
+        slot.minIndex = index;
+    }
+    else if (value > slot.max) {
+        slot.max = value;
+        slot.maxIndex = index;
+    }
+    slot.sum += value;
+    slot.count++;
+}
+
+void ChartDecimator::RecomputeBucket(const HistoryRing& ring, uint64_t bucket, uint64_t begin, uint64_t end)
+{
+    Bucket& slot = Slot(bucket);
+    slot = Bucket();
+    slot.first = begin;
+    for (uint64_t i = begin; i < end; i++) {
+        float value = ring.At(i);
+        if (slot.count == 0 || value < slot.min) {
+            slot.min = value;
+            slot.minIndex = i;
+        }
+        if (slot.count == 0 || value > slot.max) {
+            slot.max = value;
+            slot.maxIndex = i;
+        }
+        slot.sum += value;
+        slot.count++;
+    }
+}
+
+// Keep the point of this bucket that spans the largest triangle with the previous pick
+// and the average of the next bucket. The first and last buckets keep their end samples.
+void ChartDecimator::Select(const HistoryRing& ring, uint64_t bucket)
+{
+    Bucket& slot = Slot(bucket);
+    if (slot.count == 0)
+        return;
+    if (bucket == m_firstBucket || bucket + 1 >= m_endBucket) {
+        slot.selected = bucket == m_firstBucket ? slot.first : slot.first + slot.count - 1;
+        slot.selectedValue = ring.At(slot.selected);
+        return;
+    }
+
+    const Bucket& previous = Slot(bucket - 1);
+    const Bucket& next = Slot(bucket + 1);
+    double ax = static_cast<double>(previous.selected);
+    double ay = ring.At(previous.selected);
+    double cx = next.first + (next.count - 1) * 0.5;
+    double cy = next.count ? next.sum / next.count : ay;
+
+    double bestArea = -1.0;
+    for (uint64_t i = slot.first; i < slot.first + slot.count; i++) {
+        float value = ring.At(i);
+        double area = std::fabs((ax - cx) * (value - ay) - (ax - static_cast<double>(i)) * (cy - ay));
+        if (area > bestArea) {
+            bestArea = area;
+            slot.selected = i;
+            slot.selectedValue = value;
+        }
+    }
+}
+
+void ChartDecimator::BuildPoints()
+{
+    m_points.clear();
+    bool first = true;
+
+    for (uint64_t b = m_firstBucket; b < m_endBucket; b++) {
+        const Bucket& slot = Slot(b);
+        if (slot.count == 0)
+            continue;
+
+        m_min = first ? slot.min : std::min(m_min, slot.min);
+        m_max = first ? slot.max : std::max(m_max, slot.max);
+        first = false;
+
+        if (m_mode == DECIMATE_LTTB) {
+            m_points.push_back(ChartPoint{ slot.selected, slot.selectedValue });
+            continue;
+        }
+
+        // Both extremes, in time order
+        if (slot.minIndex == slot.maxIndex) {
+            m_points.push_back(ChartPoint{ slot.minIndex, slot.min });
+        }
+        else if (slot.minIndex < slot.maxIndex) {
+            m_points.push_back(ChartPoint{ slot.minIndex, slot.min });
+            m_points.push_back(ChartPoint{ slot.maxIndex, slot.max });
+        }
+        else {
+            m_points.push_back(ChartPoint{ slot.maxIndex, slot.max });
+            m_points.push_back(ChartPoint{ slot.minIndex, slot.min });
+        }
+    }
+
+    if (first)
+        m_min = m_max = 0.0f;
+}
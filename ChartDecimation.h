@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Fixed-capacity history of samples. Samples are addressed by absolute index (the number
+// of samples pushed before them), so consumers can tell exactly what's new since they last
+// looked without copying anything.
+class HistoryRing {
+public:
+    explicit HistoryRing(size_t capacity) : m_values(capacity > 0 ? capacity : 1) {}
+
+    void Push(float value)
+    {
+        m_values[m_total % m_values.size()] = value;
+        m_total++;
+    }
+
+    void Clear() { m_total = 0; }
+
+    size_t Capacity() const { return m_values.size(); }
+    size_t Size() const { return m_total < m_values.size() ? static_cast<size_t>(m_total) : m_values.size(); }
+    bool Empty() const { return m_total == 0; }
+
+    // Absolute index range [Begin, End) of the retained samples
+    uint64_t Begin() const { return m_total - Size(); }
+    uint64_t End() const { return m_total; }
+
+    float At(uint64_t index) const { return m_values[index % m_values.size()]; }
+
+private:
+    std::vector<float> m_values;
+    uint64_t m_total = 0;
+};
+
+enum DecimationMode {
+    DECIMATE_MINMAX,    // Min and max of every bucket: keeps spikes, up to 2 points per pixel
+    DECIMATE_LTTB       // Largest-Triangle-Three-Buckets: 1 point per pixel, keeps the shape
+};
+
+struct ChartPoint {
+    uint64_t index;     // Absolute sample index in the ring
+    float value;
+};
+
+// Reduces a HistoryRing to a point set bounded by the chart's pixel width.
+// Buckets are aligned to absolute sample indices, so as samples arrive only the newest
+// bucket changes and as old ones fall off only the oldest bucket changes; everything in
+// between stays cached. An update with nothing new returns the cached points untouched.
+// For LTTB the buckets next to a changed one are re-selected too; the (tiny) knock-on
+// effect further along the chain is ignored until the next full rebuild.
+class ChartDecimator {
+public:
+    explicit ChartDecimator(DecimationMode mode = DECIMATE_MINMAX) : m_mode(mode) {}
+
+    // Both invalidate the cache when they change anything
+    void SetMode(DecimationMode mode);
+    void SetWidth(int pixels);
+
+    // Bring the point set up to date with the ring and return it (oldest first)
+    const std::vector<ChartPoint>& Update(const HistoryRing& ring);
+
+    const std::vector<ChartPoint>& GetPoints() const { return m_points; }
+    float GetMin() const { return m_min; }
+    float GetMax() const { return m_max; }
+    void Invalidate() { m_valid = false; }
+
+private:
+    struct Bucket {
+        uint64_t first;       // First retained sample in the bucket
+        uint32_t count;
+        float min;
+        float max;
+        uint64_t minIndex;
+        uint64_t maxIndex;
+        double sum;
+        uint64_t selected;    // LTTB pick
+        float selectedValue;
+    };
+
+    void Rebuild(const HistoryRing& ring);
+    Bucket& Slot(uint64_t bucket) { return m_buckets[bucket % m_buckets.size()]; }
+    void Fold(uint64_t index, float value);
+    void RecomputeBucket(const HistoryRing& ring, uint64_t bucket, uint64_t begin, uint64_t end);
+    void Select(const HistoryRing& ring, uint64_t bucket);
+    void BuildPoints();
+
+    DecimationMode m_mode;
+    int m_width = 100;
+    bool m_valid = false;
+
+    size_t m_capacity = 0;
+    uint64_t m_bucketSize = 1;
+    std::vector<Bucket> m_buckets;    // Ring of buckets, indexed by absolute bucket number
+    uint64_t m_firstBucket = 0;
+    uint64_t m_endBucket = 0;
+    uint64_t m_begin = 0;             // Ring state at the last update
+    uint64_t m_processedEnd = 0;
+
+    std::vector<ChartPoint> m_points;
+    float m_min = 0.0f;
+    float m_max = 0.0f;
+};
@@ -0,0 +1,40 @@
+#include "Clock.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+const Clock& Clock::System()
+{
+    static MonotonicClock clock;
+    return clock;
+}
+
+MonotonicClock::MonotonicClock()
+{
+#ifdef _WIN32
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    m_frequency = static_cast<uint64_t>(frequency.QuadPart);
+#endif
+}
+
+uint64_t MonotonicClock::NowNs() const
+{
+#ifdef _WIN32
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    uint64_t ticks = static_cast<uint64_t>(counter.QuadPart);
+
+    // Split into whole seconds and remainder so the multiply can't overflow
+    uint64_t seconds = ticks / m_frequency;
+    uint64_t remainder = ticks % m_frequency;
+    return seconds * 1000000000ull + remainder * 1000000000ull / m_frequency;
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+#endif
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+// Monotonic time source. Everything that computes rates or intervals takes
+// its time from a Clock so tests can substitute a FakeClock.
+class Clock {
+public:
+    virtual ~Clock() = default;
+
+    // Nanoseconds since an arbitrary fixed point; never goes backwards
+    virtual uint64_t NowNs() const = 0;
+
+    uint64_t NowMs() const { return NowNs() / 1000000; }
+    double NowSeconds() const { return NowNs() * 1e-9; }
+
+    // Process-wide high-resolution clock (QueryPerformanceCounter on Windows, CLOCK_MONOTONIC elsewhere)
+    static const Clock& System();
+};
+
+class MonotonicClock : public Clock {
+public:
+    MonotonicClock();
+    uint64_t NowNs() const override;
+
+private:
+    uint64_t m_frequency = 0;   // QPC ticks per second (Windows only)
+};
+
+// Manually advanced clock for tests
+class FakeClock : public Clock {
+public:
+    explicit FakeClock(uint64_t startNs = 0) : m_now(startNs) {}
+
+    uint64_t NowNs() const override { return m_now; }
+    void Set(uint64_t ns) { m_now = ns; }
+    void Advance(uint64_t ns) { m_now += ns; }
+    void AdvanceMs(uint64_t ms) { m_now += ms * 1000000; }
+
+private:
+    uint64_t m_now;
+};
+
+// A value together with the time it was acquired
+template <typename T>
+struct Timestamped {
+    T value{};
+    uint64_t timestampNs = 0;
+};
@@ -0,0 +1,267 @@
+#include "ConnectionMonitor.h"
+#include <algorithm>
+#include <cstring>
+
+void FingerprintSet::Reserve(size_t count)
+{
+    // Keep the load factor at or below one half
+    size_t capacity = 16;
+    while (capacity < count * 2)
+        capacity <<= 1;
+    if (capacity <= m_slots.size())
+        return;
+
+    m_slots.assign(capacity, 0);
+    m_mask = capacity - 1;
+    m_size = 0;
+}
+
+void FingerprintSet::Clear()
+{
+    std::fill(m_slots.begin(), m_slots.end(), 0);
+    m_size = 0;
+}
+
+bool FingerprintSet::Insert(uint64_t fingerprint)
+{
+    size_t slot = static_cast<size_t>(fingerprint) & m_mask;
+    while (m_slots[slot] != 0) {
+        if (m_slots[slot] == fingerprint)
+            return false;
+        slot = (slot + 1) & m_mask;
+    }
+    m_slots[slot] = fingerprint;
+    m_size++;
+    return true;
+}
+
+bool FingerprintSet::Contains(uint64_t fingerprint) const
+{
+    if (m_slots.empty())
+        return false;
+
+    size_t slot = static_cast<size_t>(fingerprint) & m_mask;
+    while (m_slots[slot] != 0) {
+        if (m_slots[slot] == fingerprint)
+            return true;
+        slot = (slot + 1) & m_mask;
+    }
+    return false;
+}
+
+ConnectionMonitor::ConnectionMonitor(std::unique_ptr<IConnectionBackend> backend, const Clock& clock)
+    : m_backend(std::move(backend)), m_clock(clock)
+{
+}
+
+void ConnectionMonitor::Reset()
+{
+    m_hasBaseline = false;
+    m_openedPerSec = 0.0;
+    m_closedPerSec = 0.0;
+}
+
+// 64-bit mix of protocol, addresses and ports; never returns 0 (the empty-slot marker)
+uint64_t ConnectionMonitor::Fingerprint(const ConnectionRecord& record)
+{
+    uint64_t words[4];
+    memcpy(&words[0], record.localAddress, 16);
+    memcpy(&words[2], record.remoteAddress, 16);
+
+    uint64_t h = (static_cast<uint64_t>(record.localPort) << 32) ^
+                 (static_cast<uint64_t>(record.remotePort) << 16) ^
+                 (static_cast<uint64_t>(record.protocol) << 8) ^ record.family;
+    for (uint64_t word : words) {
+        h ^= word;
+        h *= 0x9E3779B97F4A7C15ull;
+        h ^= h >> 29;
+    }
+    h *= 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 32;
+    return h ? h : 1;
+}
+
+static bool SameConnection(const ConnectionRecord& a, const ConnectionRecord& b)
+{
+    return a.localPort == b.localPort && a.remotePort == b.remotePort &&
+           a.protocol == b.protocol && a.family == b.family &&
+           memcmp(a.localAddress, b.localAddress, sizeof(a.localAddress)) == 0 &&
+           memcmp(a.remoteAddress, b.remoteAddress, sizeof(a.remoteAddress)) == 0;
+}
+
+// How far 'record' sits within the CONNECTION_RESYNC_WINDOW rows after rows[start], 0 if it doesn't
+static size_t FindAhead(const std::vector<ConnectionRecord>& rows, size_t start, const ConnectionRecord& record)
+{
+    size_t end = std::min(rows.size(), start + 1 + CONNECTION_RESYNC_WINDOW);
+    for (size_t k = start + 1; k < end; k++) {
+        if (SameConnection(rows[k], record))
+            return k - start;
+    }
+    return 0;
+}
+
+void ConnectionMonitor::Diff(size_t& opened, size_t& closed)
+{
+    const std::vector<ConnectionRecord>& current = m_records;
+    const std::vector<ConnectionRecord>& previous = m_previousRecords;
+    m_currentUnmatched.clear();
+    m_previousUnmatched.clear();
+
+    // A run of insertions or removals shows up as the other side's row a few places ahead.
+    // After a long streak of misses (a block replaced in place, or a reordered table) the
+    // walk stops searching ahead on every row and just waits for the rows to line up again.
+    size_t i = 0;
+    size_t j = 0;
+    size_t misses = 0;
+    while (i < current.size() && j < previous.size()) {
+        bool searching = misses < CONNECTION_RESYNC_WINDOW * 4;
+        if (SameConnection(current[i], previous[j])) {
+            i++;
+            j++;
+            misses = 0;
+        } else if (size_t removed = searching ? FindAhead(previous, j, current[i]) : 0) {
+            for (size_t end = j + removed; j < end; j++)
+                m_previousUnmatched.push_back(Fingerprint(previous[j]));
+        } else if (size_t added = searching ? FindAhead(current, i, previous[j]) : 0) {
+            for (size_t end = i + added; i < end; i++)
+                m_currentUnmatched.push_back(Fingerprint(current[i]));
+        } else {
+            m_currentUnmatched.push_back(Fingerprint(current[i++]));
+            m_previousUnmatched.push_back(Fingerprint(previous[j++]));
+            misses++;
+        }
+    }
+    for (; i < current.size(); i++)
+        m_currentUnmatched.push_back(Fingerprint(current[i]));
+    for (; j < previous.size(); j++)
+        m_previousUnmatched.push_back(Fingerprint(previous[j]));
+
+    // A leftover on both sides only moved in the table; the rest opened or closed
+    m_currentLeftovers.Reserve(m_currentUnmatched.size());
+    m_currentLeftovers.Clear();
+    for (uint64_t fingerprint : m_currentUnmatched)
+        m_currentLeftovers.Insert(fingerprint);
+    m_previousLeftovers.Reserve(m_previousUnmatched.size());
+    m_previousLeftovers.Clear();
+    for (uint64_t fingerprint : m_previousUnmatched)
+        m_previousLeftovers.Insert(fingerprint);
+
+    opened = 0;
+    for (uint64_t fingerprint : m_currentUnmatched)
+        opened += !m_previousLeftovers.Contains(fingerprint);
+    closed = 0;
+    for (uint64_t fingerprint : m_previousUnmatched)
+        closed += !m_currentLeftovers.Contains(fingerprint);
+}
+
+bool ConnectionMonitor::Sample()
+{
+    uint64_t startNs = m_clock.NowNs();
+    if (!m_backend->Snapshot(m_records))
+        return false;
+
+    if (m_pidSlots.empty())
+        m_pidSlots.assign(1024, PidSlot{ 0, 0 });
+    else
+        std::fill(m_pidSlots.begin(), m_pidSlots.end(), PidSlot{ 0, 0 });
+    m_pidCount = 0;
+    m_tcpCount = 0;
+    m_udpCount = 0;
+    std::fill(std::begin(m_stateCounts), std::end(m_stateCounts), 0);
+
+    for (const ConnectionRecord& record : m_records) {
+        if (record.protocol == CONNECTION_TCP) {
+            m_tcpCount++;
+            if (record.state < TCP_STATE_COUNT)
+                m_stateCounts[record.state]++;
+        } else {
+            m_udpCount++;
+        }
+        CountProcess(record.pid);
+    }
+
+    uint64_t nowNs = m_clock.NowNs();
+    if (m_hasBaseline && nowNs > m_lastSampleNs) {
+        size_t opened;
+        size_t closed;
+        Diff(opened, closed);
+        double seconds = (nowNs - m_lastSampleNs) * 1e-9;
+        m_openedPerSec = opened / seconds;
+        m_closedPerSec = closed / seconds;
+    }
+
+    // The backend refills the old buffer next time, so neither vector reallocates
+    std::swap(m_previousRecords, m_records);
+    m_lastSampleNs = nowNs;
+    m_hasBaseline = true;
+
+    UpdateTopProcesses();
+    m_lastCostNs = m_clock.NowNs() - startNs;
+    return true;
+}
+
+void ConnectionMonitor::CountProcess(uint32_t pid)
+{
+    uint32_t key = pid + 1;
+    size_t mask = m_pidSlots.size() - 1;
+    size_t slot = (key * 0x9E3779B1u) & mask;
+    while (m_pidSlots[slot].key != 0 && m_pidSlots[slot].key != key)
+        slot = (slot + 1) & mask;
+
+    if (m_pidSlots[slot].key == 0) {
+        m_pidSlots[slot].key = key;
+        if (++m_pidCount * 2 > m_pidSlots.size()) {
+            m_pidSlots[slot].connections = 1;
+            GrowPidTable();
+            return;
+        }
+    }
+    m_pidSlots[slot].connections++;
+}
+
+void ConnectionMonitor::GrowPidTable()
+{
+    std::vector<PidSlot> old;
+    old.swap(m_pidSlots);
+    m_pidSlots.assign(old.size() * 2, PidSlot{ 0, 0 });
+
+    size_t mask = m_pidSlots.size() - 1;
+    for (const PidSlot& entry : old) {
+        if (entry.key == 0)
+            continue;
+        size_t slot = (entry.key * 0x9E3779B1u) & mask;
+        while (m_pidSlots[slot].key != 0)
+            slot = (slot + 1) & mask;
+        m_pidSlots[slot] = entry;
+    }
+}
+
+void ConnectionMonitor::UpdateTopProcesses()
+{
+    m_processOrder.clear();
+    for (const PidSlot& entry : m_pidSlots) {
+        if (entry.key != 0)
+            m_processOrder.push_back(ProcessCount{ entry.key - 1, entry.connections, "" });
+    }
+
+    auto more = [](const ProcessCount& a, const ProcessCount& b) { return a.connections > b.connections; };
+    size_t count = std::min(m_topCount, m_processOrder.size());
+    if (count < m_processOrder.size())
+        std::nth_element(m_processOrder.begin(), m_processOrder.begin() + count, m_processOrder.end(), more);
+    std::sort(m_processOrder.begin(), m_processOrder.begin() + count, more);
+
+    m_topProcesses.assign(m_processOrder.begin(), m_processOrder.begin() + count);
+    for (auto& process : m_topProcesses) {
+        if (!m_backend->GetProcessName(process.pid, process.name, sizeof(process.name)))
+            process.name[0] = '\0';
+    }
+}
+
+const char* ConnectionMonitor::StateName(int state)
+{
+    static const char* names[TCP_STATE_COUNT] = {
+        "Unknown", "Closed", "Listen", "SYN sent", "SYN received", "Established", "FIN wait 1",
+        "FIN wait 2", "Close wait", "Closing", "Last ACK", "Time wait", "Delete TCB"
+    };
+    return state >= 0 && state < TCP_STATE_COUNT ? names[state] : "Unknown";
+}
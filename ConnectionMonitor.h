@@ -0,0 +1,148 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "Clock.h"
+
+#define MAX_TOP_CONNECTION_PROCESSES 8
+#define CONNECTION_PROCESS_NAME_LENGTH 64
+#define CONNECTION_RESYNC_WINDOW 8    // Rows the diff looks ahead to get back in step
+
+enum ConnectionProtocol {
+    CONNECTION_TCP,
+    CONNECTION_UDP
+};
+
+// TCP states, numbered like MIB_TCP_STATE so the Windows backend can pass them straight through
+enum TcpState {
+    TCP_STATE_UNKNOWN = 0,
+    TCP_STATE_CLOSED = 1,
+    TCP_STATE_LISTEN,
+    TCP_STATE_SYN_SENT,
+    TCP_STATE_SYN_RCVD,
+    TCP_STATE_ESTABLISHED,
+    TCP_STATE_FIN_WAIT1,
+    TCP_STATE_FIN_WAIT2,
+    TCP_STATE_CLOSE_WAIT,
+    TCP_STATE_CLOSING,
+    TCP_STATE_LAST_ACK,
+    TCP_STATE_TIME_WAIT,
+    TCP_STATE_DELETE_TCB,
+    TCP_STATE_COUNT
+};
+
+// One row of the TCP or UDP table. IPv4 addresses use the first 4 bytes.
+struct ConnectionRecord {
+    uint8_t localAddress[16];
+    uint8_t remoteAddress[16];
+    uint16_t localPort;
+    uint16_t remotePort;
+    uint32_t pid;
+    uint8_t protocol;    // ConnectionProtocol
+    uint8_t family;      // 4 or 6
+    uint8_t state;       // TcpState, TCP_STATE_UNKNOWN for UDP
+};
+
+// Platform side of the monitor
+class IConnectionBackend {
+public:
+    virtual ~IConnectionBackend() = default;
+
+    // Replace 'records' with every TCP and UDP endpoint. Returns false on failure.
+    virtual bool Snapshot(std::vector<ConnectionRecord>& records) = 0;
+
+    // Only called for the handful of processes shown in the UI
+    virtual bool GetProcessName(uint32_t pid, char* name, size_t length) = 0;
+};
+
+// Open-addressing set of 64-bit connection fingerprints. Zero marks an empty slot.
+class FingerprintSet {
+public:
+    void Reserve(size_t count);
+    void Clear();
+
+    // Returns false if the fingerprint was already present
+    bool Insert(uint64_t fingerprint);
+    bool Contains(uint64_t fingerprint) const;
+    size_t Size() const { return m_size; }
+
+private:
+    std::vector<uint64_t> m_slots;
+    size_t m_mask = 0;
+    size_t m_size = 0;
+};
+
+// Connection counts per state, opened/closed rates and per-process counts.
+// Backends return their tables in a stable order, so each snapshot is first walked in
+// step with the previous one: rows with the same 4-tuple stayed open, and a short
+// lookahead gets back in step after a run of insertions or removals. Only the rows
+// left over are diffed through flat sets of 4-tuple fingerprints (a 64-bit hash of
+// protocol, addresses and ports), which tells connections that merely moved from
+// ones that opened or closed. A tick is a couple of linear passes with no
+// per-connection allocation, and in the steady state almost no hashing.
+class ConnectionMonitor {
+public:
+    struct ProcessCount {
+        uint32_t pid;
+        int connections;
+        char name[CONNECTION_PROCESS_NAME_LENGTH];
+    };
+
+    explicit ConnectionMonitor(std::unique_ptr<IConnectionBackend> backend, const Clock& clock = Clock::System());
+
+    bool Sample();
+
+    // Next sample only takes a baseline (no opened/closed counts across a pause)
+    void Reset();
+
+    void SetTopCount(size_t count) { m_topCount = count < MAX_TOP_CONNECTION_PROCESSES ? count : MAX_TOP_CONNECTION_PROCESSES; }
+
+    int GetTcpCount() const { return m_tcpCount; }
+    int GetUdpCount() const { return m_udpCount; }
+    int GetStateCount(int state) const { return m_stateCounts[state]; }
+    double GetOpenedPerSec() const { return m_openedPerSec; }
+    double GetClosedPerSec() const { return m_closedPerSec; }
+    const std::vector<ProcessCount>& GetTopProcesses() const { return m_topProcesses; }
+    uint64_t GetLastSampleCostNs() const { return m_lastCostNs; }
+
+    static const char* StateName(int state);
+    static uint64_t Fingerprint(const ConnectionRecord& record);
+
+private:
+    struct PidSlot {
+        uint32_t key;        // pid + 1, 0 = empty
+        int connections;
+    };
+
+    // Opened and closed connections between m_previousRecords and m_records
+    void Diff(size_t& opened, size_t& closed);
+
+    // Small open-addressing pid -> count table; a few hundred PIDs fit in cache
+    void CountProcess(uint32_t pid);
+    void GrowPidTable();
+    void UpdateTopProcesses();
+
+    std::unique_ptr<IConnectionBackend> m_backend;
+    const Clock& m_clock;
+    std::vector<ConnectionRecord> m_records;
+    std::vector<ConnectionRecord> m_previousRecords;
+    std::vector<uint64_t> m_currentUnmatched;     // Fingerprints of rows the in-step walk couldn't pair
+    std::vector<uint64_t> m_previousUnmatched;
+    FingerprintSet m_currentLeftovers;
+    FingerprintSet m_previousLeftovers;
+    std::vector<PidSlot> m_pidSlots;
+    size_t m_pidCount = 0;
+    std::vector<ProcessCount> m_processOrder;
+    std::vector<ProcessCount> m_topProcesses;
+    size_t m_topCount = 5;
+    int m_tcpCount = 0;
+    int m_udpCount = 0;
+    int m_stateCounts[TCP_STATE_COUNT] = {};
+    double m_openedPerSec = 0.0;
+    double m_closedPerSec = 0.0;
+    uint64_t m_lastSampleNs = 0;
+    uint64_t m_lastCostNs = 0;
+    bool m_hasBaseline = false;
+};
@@ -0,0 +1,63 @@
+#include "CounterRegistry.h"
+#include <algorithm>
+
+CounterRegistry::CounterRegistry(std::unique_ptr<ICounterBackend> backend) :
+    m_backend(std::move(backend))
+{
+}
+
+CounterRegistry::~CounterRegistry()
+{
+    Close();
+}
+
+int CounterRegistry::Declare(CounterCategory category, const std::string& path, const std::string& label)
+{
+    m_counters.push_back({ category, path, label, false });
+    m_values.push_back(0.0);
+    return static_cast<int>(m_counters.size()) - 1;
+}
+
+bool CounterRegistry::Open()
+{
+    if (m_open)
+        return true;
+    if (!m_backend || !m_backend->Open())
+        return false;
+
+    // One query for everything; counters that don't exist on this machine just read as 0
+    for (size_t i = 0; i < m_counters.size(); i++)
+        m_counters[i].available = m_backend->AddCounter(m_counters[i].path, static_cast<int>(i));
+
+    if (!m_backend->Prime()) {
+        m_backend->Close();
+        return false;
+    }
+
+    std::fill(m_values.begin(), m_values.end(), 0.0);
+    ResetSchedule();
+    m_open = true;
+    return true;
+}
+
+void CounterRegistry::Close()
+{
+    if (!m_open)
+        return;
+    m_backend->Close();
+    for (auto& counter : m_counters)
+        counter.available = false;
+    m_open = false;
+}
+
+bool CounterRegistry::Tick(uint64_t nowMs)
+{
+    if (!m_open)
+        return false;
+    if (m_hasCollected && nowMs - m_lastCollect < m_intervalMs)
+        return false;
+
+    m_lastCollect = nowMs;
+    m_hasCollected = true;
+    return m_backend->Collect(m_values.data(), m_values.size());
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+// Which provider a counter belongs to (for grouping in the UI)
+enum CounterCategory {
+    COUNTER_PROCESSOR,
+    COUNTER_MEMORY,
+    COUNTER_DISK,
+    COUNTER_PAGING,
+    COUNTER_SYSTEM
+};
+
+// Platform side of the registry: one query that holds every counter and is collected in one go
+class ICounterBackend {
+public:
+    virtual ~ICounterBackend() = default;
+
+    virtual bool Open() = 0;
+    virtual void Close() = 0;
+
+    // Add a counter to the query. Returns false if this counter isn't available.
+    virtual bool AddCounter(const std::string& path, int index) = 0;
+
+    // Take the baseline sample rate counters need
+    virtual bool Prime() = 0;
+
+    // Collect the whole query once and write every counter's value into values[index]
+    virtual bool Collect(double* values, size_t count) = 0;
+};
+
+// Registry of performance counters.
+// Providers declare counters up front; they all go into a single backend query that
+// is collected once per sampling tick, and values land in a flat index-addressed array.
+class CounterRegistry {
+public:
+    struct Counter {
+        CounterCategory category;
+        std::string path;
+        std::string label;
+        bool available;
+    };
+
+    explicit CounterRegistry(std::unique_ptr<ICounterBackend> backend);
+    ~CounterRegistry();
+
+    // Declare a counter (before Open). Returns its index into the value array.
+    int Declare(CounterCategory category, const std::string& path, const std::string& label);
+
+    bool Open();
+    void Close();
+    bool IsOpen() const { return m_open; }
+
+    // Tick scheduler: collects at most once per interval. Returns true if values were refreshed.
+    void SetInterval(uint32_t intervalMs) { m_intervalMs = intervalMs; }
+    void ResetSchedule() { m_lastCollect = 0; m_hasCollected = false; }
+    bool Tick(uint64_t nowMs);
+
+    double GetValue(int index) const { return m_values[index]; }
+    bool IsAvailable(int index) const { return m_open && m_counters[index].available; }
+    const std::vector<double>& GetValues() const { return m_values; }
+    const std::vector<Counter>& GetCounters() const { return m_counters; }
+
+private:
+    std::unique_ptr<ICounterBackend> m_backend;
+    std::vector<Counter> m_counters;
+    std::vector<double> m_values;
+    bool m_open = false;
+    uint32_t m_intervalMs = 1000;
+    uint64_t m_lastCollect = 0;
+    bool m_hasCollected = false;
+};
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Streaming estimators shared by the samplers. Header-only, no allocation,
+// and every Update is O(1).
+
+// Turns successive readings of a monotonically increasing counter into a per-second rate.
+// Counter must be unsigned: a reading below the previous one is treated as a single
+// wrap at the counter's width, which unsigned subtraction handles for free.
+template <typename Counter, typename Rate = double>
+class CounterRate {
+    static_assert(std::is_unsigned<Counter>::value, "CounterRate needs an unsigned counter type");
+
+public:
+    // Feed a reading acquired at timestampNs. Returns true when a new rate is available.
+    bool Update(Counter value, uint64_t timestampNs)
+    {
+        bool updated = false;
+        if (m_hasLast && timestampNs > m_lastNs) {
+            Counter delta = static_cast<Counter>(value - m_last);
+            m_rate = static_cast<Rate>(delta / ((timestampNs - m_lastNs) * 1e-9));
+            m_hasRate = true;
+            updated = true;
+        }
+        m_last = value;
+        m_lastNs = timestampNs;
+        m_hasLast = true;
+        return updated;
+    }
+
+    void Reset() { m_hasLast = false; m_hasRate = false; m_rate = Rate(); }
+
+    Rate Get() const { return m_rate; }
+    bool HasRate() const { return m_hasRate; }
+
+private:
+    Counter m_last = 0;
+    uint64_t m_lastNs = 0;
+    Rate m_rate = Rate();
+    bool m_hasLast = false;
+    bool m_hasRate = false;
+};
+
+// Exponentially weighted moving average. The first sample seeds the average.
+template <typename T>
+class Ewma {
+public:
+    explicit Ewma(T alpha = T(0.5)) : m_alpha(alpha) {}
+
+    T Update(T sample) { return Update(sample, m_alpha); }
+
+    T Update(T sample, T alpha)
+    {
+        m_value = m_hasValue ? Step(m_value, sample, alpha) : sample;
+        m_hasValue = true;
+        return m_value;
+    }
+
+    // Frame-rate-independent update: decays with the given time constant over dt seconds
+    T Update(T sample, double dt, double timeConstant) { return Update(sample, TimeConstantAlpha(dt, timeConstant)); }
+
+    void Reset() { m_hasValue = false; m_value = T(); }
+    void SetAlpha(T alpha) { m_alpha = alpha; }
+
+    T Get() const { return m_value; }
+    bool HasValue() const { return m_hasValue; }
+
+    // Building blocks for callers that keep their own state (e.g. per-band arrays)
+    static T Step(T previous, T sample, T alpha) { return previous + (sample - previous) * alpha; }
+    static T TimeConstantAlpha(double dt, double timeConstant)
+    {
+        return timeConstant > 0.0 ? static_cast<T>(1.0 - std::exp(-dt / timeConstant)) : T(1);
+    }
+
+private:
+    T m_alpha;
+    T m_value = T();
+    bool m_hasValue = false;
+};
+
+// Mean of the last N samples, kept as a running sum over a ring buffer.
+// Accumulator can be widened (e.g. int64_t for int samples, double for float).
+template <typename T, size_t N, typename Accumulator = T>
+class MovingAverage {
+    static_assert(N > 0, "MovingAverage needs a non-empty window");
+
+public:
+    T Update(T sample)
+    {
+        if (m_count == N)
+            m_sum -= m_samples[m_next];
+        else
+            m_count++;
+
+        m_samples[m_next] = sample;
+        m_sum += sample;
+        m_next = (m_next + 1) % N;
+        return Get();
+    }
+
+    void Reset() { m_count = 0; m_next = 0; m_sum = Accumulator(); }
+
+    T Get() const { return m_count ? static_cast<T>(m_sum / static_cast<Accumulator>(m_count)) : T(); }
+    size_t GetCount() const { return m_count; }
+    bool IsFull() const { return m_count == N; }
+
+private:
+    std::array<T, N> m_samples{};
+    Accumulator m_sum = Accumulator();
+    size_t m_count = 0;
+    size_t m_next = 0;
+};
+
+// Minimum and maximum of the last N samples. Each bound is a monotonic deque of
+// candidates (held in a fixed ring), so updates are amortised O(1) and queries O(1).
+template <typename T, size_t N>
+class SlidingMinMax {
+    static_assert(N > 0, "SlidingMinMax needs a non-empty window");
+
+public:
+    void Update(T sample)
+    {
+        uint64_t index = m_index++;
+
+        // Drop candidates that leave the window first, so the ring never overflows
+        if (index >= N) {
+            m_min.Expire(index - N);
+            m_max.Expire(index - N);
+        }
+
+        m_min.Push(sample, index, [](T a, T b) { return a <= b; });
+        m_max.Push(sample, index, [](T a, T b) { return a >= b; });
+    }
+
+    void Reset() { m_index = 0; m_min.Clear(); m_max.Clear(); }
+
+    T GetMin() const { return m_min.Front(); }
+    T GetMax() const { return m_max.Front(); }
+    bool HasValue() const { return m_index > 0; }
+
+private:
+    // Ring-backed deque; never holds more than N entries because older ones expire
+    class MonotonicDeque {
+    public:
+        template <typename Dominates>
+        void Push(T value, uint64_t index, Dominates dominates)
+        {
+            // Anything the new sample dominates can never be the answer again
+            while (m_size > 0 && dominates(value, m_entries[Back()].value))
+                m_size--;
+            m_entries[(m_head + m_size) % N] = { value, index };
+            m_size++;
+        }
+
+        void Expire(uint64_t lastExpired)
+        {
+            while (m_size > 0 && m_entries[m_head].index <= lastExpired) {
+                m_head = (m_head + 1) % N;
+                m_size--;
+            }
+        }
+
+        void Clear() { m_head = 0; m_size = 0; }
+        T Front() const { return m_size ? m_entries[m_head].value : T(); }
+
+    private:
+        struct Entry {
+            T value;
+            uint64_t index;
+        };
+
+        size_t Back() const { return (m_head + m_size - 1) % N; }
+
+        std::array<Entry, N> m_entries{};
+        size_t m_head = 0;
+        size_t m_size = 0;
+    };
+
+    MonotonicDeque m_min;
+    MonotonicDeque m_max;
+    uint64_t m_index = 0;
+};
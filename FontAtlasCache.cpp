@@ -0,0 +1,435 @@
+#include "FontAtlasCache.h"
+#include "Clock.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static const char FONT_CACHE_MAGIC[4] = { 'O', 'F', 'A', 'C' };
+
+// Fixed-size records; every variable-length table follows its record in the file. The file is
+// only ever read back by the build that wrote it (checked through the header), so native
+// layout and endianness are fine.
+struct CacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint64_t fileSize;
+    uint32_t imguiVersion;
+    uint32_t glyphSize;
+    uint32_t wcharSize;
+    uint32_t useColors;
+    int32_t texWidth;
+    int32_t texHeight;
+    int32_t fontCount;
+    int32_t customRectCount;
+    int32_t packIdMouseCursors;
+    int32_t packIdLines;
+    ImVec2 texUvScale;
+    ImVec2 texUvWhitePixel;
+    ImVec4 texUvLines[IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1];
+};
+
+struct CacheFontRecord {
+    float fontSize;
+    float ascent;
+    float descent;
+    float scale;
+    float fallbackAdvanceX;
+    float ellipsisWidth;
+    float ellipsisCharStep;
+    uint32_t ellipsisChar;
+    uint32_t fallbackChar;
+    int32_t ellipsisCharCount;
+    int32_t metricsTotalSurface;
+    int32_t fallbackGlyph;      // Index into the glyphs, -1 = none
+    int32_t glyphCount;
+    int32_t indexCount;         // Entries in each of IndexAdvanceX and IndexLookup
+    char name[40];
+    ImU8 usedPages[sizeof(ImFont::Used8kPagesMap)];
+};
+
+struct CacheCustomRect {
+    uint16_t x, y, width, height;
+    uint32_t glyphId;
+    uint32_t glyphColored;
+    float glyphAdvanceX;
+    ImVec2 glyphOffset;
+    int32_t font;               // Index into the atlas fonts, -1 = not a glyph
+};
+
+// Read-only view of the whole cache file
+class MappedFile {
+public:
+    ~MappedFile()
+    {
+#ifdef _WIN32
+        if (m_data)
+            UnmapViewOfFile(m_data);
+#else
+        if (m_data)
+            munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+    }
+
+    bool Open(const std::string& path)
+    {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER size;
+        HANDLE mapping = NULL;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+            mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        CloseHandle(file);
+        if (!mapping)
+            return false;
+        m_data = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        CloseHandle(mapping);
+        m_size = static_cast<size_t>(size.QuadPart);
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                m_data = static_cast<const unsigned char*>(data);
+                m_size = static_cast<size_t>(info.st_size);
+            }
+        }
+        close(fd);
+#endif
+        return m_data != nullptr;
+    }
+
+    const unsigned char* Data() const { return m_data; }
+    size_t Size() const { return m_size; }
+
+private:
+    const unsigned char* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+// Bounds-checked cursor over the mapped file
+struct CacheReader {
+    const unsigned char* data;
+    size_t size;
+    size_t offset;
+
+    bool Read(void* out, size_t length)
+    {
+        if (length > size - offset)
+            return false;
+        memcpy(out, data + offset, length);
+        offset += length;
+        return true;
+    }
+};
+
+static void HashBytes(uint64_t& hash, const void* data, size_t length)
+{
+    // FNV-1a
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+}
+
+template <typename T>
+static void HashValue(uint64_t& hash, const T& value)
+{
+    HashBytes(hash, &value, sizeof(value));
+}
+
+FontAtlasCache::FontAtlasCache(const std::string& cachePath) : m_path(cachePath)
+{
+}
+
+uint64_t FontAtlasCache::ComputeKey(const ImFontAtlas* atlas, const char* fontPath, float sizePixels,
+                                    const ImWchar* glyphRanges, const ImFontConfig* fontConfig)
+{
+    // The file's identity stands in for its contents: hashing a multi-megabyte TTF would
+    // cost about as much as the bake the cache saves
+#ifdef _WIN32
+    struct _stat64 info;
+    if (_stat64(fontPath, &info) != 0)
+        return 0;
+#else
+    struct stat info;
+    if (stat(fontPath, &info) != 0)
+        return 0;
+#endif
+    uint64_t hash = 14695981039346656037ull;
+    HashValue(hash, FONT_CACHE_VERSION);
+    HashValue(hash, IMGUI_VERSION_NUM);
+    HashBytes(hash, fontPath, strlen(fontPath));
+    HashValue(hash, static_cast<uint64_t>(info.st_size));
+    HashValue(hash, static_cast<int64_t>(info.st_mtime));
+    HashValue(hash, sizePixels);
+    for (const ImWchar* range = glyphRanges; range && *range; range++)
+        HashValue(hash, *range);
+
+    // Everything else that changes the baked pixels or metrics
+    ImFontConfig config = fontConfig ? *fontConfig : ImFontConfig();
+    HashValue(hash, config.FontNo);
+    HashValue(hash, config.OversampleH);
+    HashValue(hash, config.OversampleV);
+    HashValue(hash, config.PixelSnapH);
+    HashValue(hash, config.GlyphOffset);
+    HashValue(hash, config.GlyphMinAdvanceX);
+    HashValue(hash, config.GlyphMaxAdvanceX);
+    HashValue(hash, config.GlyphExtraAdvanceX);
+    HashValue(hash, config.FontBuilderFlags);
+    HashValue(hash, config.RasterizerMultiply);
+    HashValue(hash, config.RasterizerDensity);
+    HashValue(hash, config.EllipsisChar);
+    HashValue(hash, atlas->Flags);
+    HashValue(hash, atlas->TexDesiredWidth);
+    HashValue(hash, atlas->TexGlyphPadding);
+    HashValue(hash, atlas->FontBuilderFlags);
+    return hash ? hash : 1;
+}
+
+ImFont* FontAtlasCache::LoadOrBuild(ImFontAtlas* atlas, const char* fontPath, float sizePixels,
+                                    const ImWchar* glyphRanges, const ImFontConfig* fontConfig)
+{
+    uint64_t startNs = Clock::System().NowNs();
+    uint64_t key = ComputeKey(atlas, fontPath, sizePixels, glyphRanges, fontConfig);
+    if (key == 0)
+        return nullptr;
+
+    m_hit = Load(atlas, key);
+    if (!m_hit) {
+        if (!atlas->AddFontFromFileTTF(fontPath, sizePixels, fontConfig, glyphRanges))
+            return nullptr;
+        // Bake now rather than on the backend's first texture request, so there's something to save
+        atlas->Build();
+        Save(atlas, key);
+    }
+
+    m_loadNs = Clock::System().NowNs() - startNs;
+    return atlas->Fonts.back();
+}
+
+bool FontAtlasCache::Save(ImFontAtlas* atlas, uint64_t key)
+{
+    if (!atlas->TexReady || !atlas->TexPixelsAlpha8)
+        return false;
+
+    CacheHeader header = {};
+    memcpy(header.magic, FONT_CACHE_MAGIC, sizeof(header.magic));
+    header.version = FONT_CACHE_VERSION;
+    header.key = key;
+    header.imguiVersion = IMGUI_VERSION_NUM;
+    header.glyphSize = sizeof(ImFontGlyph);
+    header.wcharSize = sizeof(ImWchar);
+    header.useColors = atlas->TexPixelsUseColors ? 1 : 0;
+    header.texWidth = atlas->TexWidth;
+    header.texHeight = atlas->TexHeight;
+    header.fontCount = atlas->Fonts.Size;
+    header.customRectCount = atlas->CustomRects.Size;
+    header.packIdMouseCursors = atlas->PackIdMouseCursors;
+    header.packIdLines = atlas->PackIdLines;
+    header.texUvScale = atlas->TexUvScale;
+    header.texUvWhitePixel = atlas->TexUvWhitePixel;
+    memcpy(header.texUvLines, atlas->TexUvLines, sizeof(header.texUvLines));
+
+    // Write to a temporary file and swap it in, so a crash mid-write can't leave a torn cache
+    std::string tempPath = m_path + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file)
+        return false;
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (int i = 0; ok && i < atlas->Fonts.Size; i++) {
+        const ImFont* font = atlas->Fonts[i];
+        CacheFontRecord record = {};
+        record.fontSize = font->FontSize;
+        record.ascent = font->Ascent;
+        record.descent = font->Descent;
+        record.scale = font->Scale;
+        record.fallbackAdvanceX = font->FallbackAdvanceX;
+        record.ellipsisWidth = font->EllipsisWidth;
+        record.ellipsisCharStep = font->EllipsisCharStep;
+        record.ellipsisChar = font->EllipsisChar;
+        record.fallbackChar = font->FallbackChar;
+        record.ellipsisCharCount = font->EllipsisCharCount;
+        record.metricsTotalSurface = font->MetricsTotalSurface;
+        record.fallbackGlyph = font->FallbackGlyph ? static_cast<int32_t>(font->FallbackGlyph - font->Glyphs.Data) : -1;
+        record.glyphCount = font->Glyphs.Size;
+        record.indexCount = font->IndexLookup.Size;
+        snprintf(record.name, sizeof(record.name), "%s", font->GetDebugName());
+        memcpy(record.usedPages, font->Used8kPagesMap, sizeof(record.usedPages));
+
+        ok = font->IndexAdvanceX.Size == font->IndexLookup.Size &&
+             fwrite(&record, sizeof(record), 1, file) == 1 &&
+             fwrite(font->Glyphs.Data, sizeof(ImFontGlyph), font->Glyphs.Size, file) == static_cast<size_t>(font->Glyphs.Size) &&
+             fwrite(font->IndexAdvanceX.Data, sizeof(float), font->IndexAdvanceX.Size, file) == static_cast<size_t>(font->IndexAdvanceX.Size) &&
+             fwrite(font->IndexLookup.Data, sizeof(ImU16), font->IndexLookup.Size, file) == static_cast<size_t>(font->IndexLookup.Size);
+    }
+    for (int i = 0; ok && i < atlas->CustomRects.Size; i++) {
+        const ImFontAtlasCustomRect& rect = atlas->CustomRects[i];
+        CacheCustomRect record = {};
+        record.x = rect.X;
+        record.y = rect.Y;
+        record.width = rect.Width;
+        record.height = rect.Height;
+        record.glyphId = rect.GlyphID;
+        record.glyphColored = rect.GlyphColored;
+        record.glyphAdvanceX = rect.GlyphAdvanceX;
+        record.glyphOffset = rect.GlyphOffset;
+        record.font = rect.Font ? atlas->Fonts.index_from_ptr(atlas->Fonts.find(rect.Font)) : -1;
+        ok = fwrite(&record, sizeof(record), 1, file) == 1;
+    }
+    size_t pixelCount = static_cast<size_t>(atlas->TexWidth) * atlas->TexHeight;
+    ok = ok && fwrite(atlas->TexPixelsAlpha8, 1, pixelCount, file) == pixelCount;
+
+    // The size goes in last, so a short file never validates
+    long fileSize = ftell(file);
+    header.fileSize = static_cast<uint64_t>(fileSize);
+    ok = ok && fileSize > 0 && fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = fclose(file) == 0 && ok;
+
+    if (ok) {
+#ifdef _WIN32
+        ok = MoveFileExA(tempPath.c_str(), m_path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        ok = rename(tempPath.c_str(), m_path.c_str()) == 0;
+#endif
+    }
+    if (!ok)
+        remove(tempPath.c_str());
+    return ok;
+}
+
+bool FontAtlasCache::Load(ImFontAtlas* atlas, uint64_t key)
+{
+    MappedFile file;
+    if (!file.Open(m_path))
+        return false;
+
+    CacheReader reader = { file.Data(), file.Size(), 0 };
+    CacheHeader header;
+    if (!reader.Read(&header, sizeof(header)) ||
+        memcmp(header.magic, FONT_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != FONT_CACHE_VERSION || header.key != key || header.fileSize != file.Size() ||
+        header.imguiVersion != IMGUI_VERSION_NUM || header.glyphSize != sizeof(ImFontGlyph) ||
+        header.wcharSize != sizeof(ImWchar) || header.fontCount <= 0 || header.customRectCount < 0 ||
+        header.texWidth <= 0 || header.texHeight <= 0)
+        return false;
+
+    // Parse and check everything before touching the atlas, so a bad file leaves it as it was
+    struct LoadedFont {
+        CacheFontRecord record;
+        size_t glyphs, advances, lookup;    // Offsets into the mapped file
+    };
+    std::vector<LoadedFont> fonts(header.fontCount);
+    for (auto& font : fonts) {
+        if (!reader.Read(&font.record, sizeof(font.record)) || font.record.glyphCount <= 0 || font.record.indexCount < 0 ||
+            font.record.fallbackGlyph < -1 || font.record.fallbackGlyph >= font.record.glyphCount)
+            return false;
+        font.glyphs = reader.offset;
+        font.advances = font.glyphs + sizeof(ImFontGlyph) * font.record.glyphCount;
+        font.lookup = font.advances + sizeof(float) * font.record.indexCount;
+        reader.offset = font.lookup + sizeof(ImU16) * font.record.indexCount;
+        if (reader.offset > reader.size)
+            return false;
+
+        // ImGui indexes Glyphs with these unchecked; 0xFFFF marks a codepoint without a glyph
+        for (int32_t i = 0; i < font.record.indexCount; i++) {
+            ImU16 index;
+            memcpy(&index, file.Data() + font.lookup + sizeof(ImU16) * i, sizeof(index));
+            if (index != (ImU16)-1 && index >= font.record.glyphCount)
+                return false;
+        }
+    }
+    std::vector<CacheCustomRect> rects(header.customRectCount);
+    for (auto& rect : rects) {
+        if (!reader.Read(&rect, sizeof(rect)) || rect.font < -1 || rect.font >= header.fontCount)
+            return false;
+    }
+    size_t pixelCount = static_cast<size_t>(header.texWidth) * header.texHeight;
+    if (reader.size - reader.offset != pixelCount)
+        return false;
+
+    atlas->Clear();
+    atlas->Sources.resize(header.fontCount);    // Sized once: the fonts point into it
+    for (int i = 0; i < header.fontCount; i++) {
+        const LoadedFont& loaded = fonts[i];
+        const CacheFontRecord& record = loaded.record;
+        ImFont* font = IM_NEW(ImFont);
+        atlas->Fonts.push_back(font);
+
+        // A source without TTF data: only its name and size survive the round trip
+        ImFontConfig& source = atlas->Sources[i];
+        source = ImFontConfig();
+        source.SizePixels = record.fontSize;
+        source.EllipsisChar = static_cast<ImWchar>(record.ellipsisChar);
+        source.DstFont = font;
+        snprintf(source.Name, sizeof(source.Name), "%s", record.name);
+
+        font->ContainerAtlas = atlas;
+        font->Sources = &source;
+        font->SourcesCount = 1;
+        font->FontSize = record.fontSize;
+        font->Ascent = record.ascent;
+        font->Descent = record.descent;
+        font->Scale = record.scale;
+        font->FallbackAdvanceX = record.fallbackAdvanceX;
+        font->EllipsisWidth = record.ellipsisWidth;
+        font->EllipsisCharStep = record.ellipsisCharStep;
+        font->EllipsisChar = static_cast<ImWchar>(record.ellipsisChar);
+        font->FallbackChar = static_cast<ImWchar>(record.fallbackChar);
+        font->EllipsisCharCount = static_cast<short>(record.ellipsisCharCount);
+        font->MetricsTotalSurface = record.metricsTotalSurface;
+        memcpy(font->Used8kPagesMap, record.usedPages, sizeof(font->Used8kPagesMap));
+
+        font->Glyphs.resize(record.glyphCount);
+        memcpy(font->Glyphs.Data, file.Data() + loaded.glyphs, sizeof(ImFontGlyph) * record.glyphCount);
+        font->IndexAdvanceX.resize(record.indexCount);
+        memcpy(font->IndexAdvanceX.Data, file.Data() + loaded.advances, sizeof(float) * record.indexCount);
+        font->IndexLookup.resize(record.indexCount);
+        memcpy(font->IndexLookup.Data, file.Data() + loaded.lookup, sizeof(ImU16) * record.indexCount);
+        font->FallbackGlyph = record.fallbackGlyph >= 0 ? &font->Glyphs[record.fallbackGlyph] : nullptr;
+        font->DirtyLookupTables = false;
+    }
+
+    for (const auto& record : rects) {
+        ImFontAtlasCustomRect rect;
+        rect.X = record.x;
+        rect.Y = record.y;
+        rect.Width = record.width;
+        rect.Height = record.height;
+        rect.GlyphID = record.glyphId;
+        rect.GlyphColored = record.glyphColored;
+        rect.GlyphAdvanceX = record.glyphAdvanceX;
+        rect.GlyphOffset = record.glyphOffset;
+        rect.Font = record.font >= 0 ? atlas->Fonts[record.font] : nullptr;
+        atlas->CustomRects.push_back(rect);
+    }
+    atlas->PackIdMouseCursors = header.packIdMouseCursors;
+    atlas->PackIdLines = header.packIdLines;
+
+    atlas->TexPixelsAlpha8 = static_cast<unsigned char*>(IM_ALLOC(pixelCount));
+    memcpy(atlas->TexPixelsAlpha8, file.Data() + reader.offset, pixelCount);
+    atlas->TexPixelsUseColors = header.useColors != 0;
+    atlas->TexWidth = header.texWidth;
+    atlas->TexHeight = header.texHeight;
+    atlas->TexUvScale = header.texUvScale;
+    atlas->TexUvWhitePixel = header.texUvWhitePixel;
+    memcpy(atlas->TexUvLines, header.texUvLines, sizeof(atlas->TexUvLines));
+    atlas->TexReady = true;
+    return true;
+}
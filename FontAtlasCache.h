@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "imgui/imgui.h"
+
+#define FONT_CACHE_VERSION 1
+
+// Prebaked font atlas on disk, so startup doesn't rasterize the TTF every launch. The file
+// holds the atlas pixels, every font's glyph and lookup tables and metrics, and is keyed by
+// the font file (path, size, modification time), pixel size, glyph ranges and the atlas
+// build settings. Loading maps the file and copies the tables straight into the atlas;
+// the atlas is left built, so ImGui never runs its own Build().
+class FontAtlasCache {
+public:
+    explicit FontAtlasCache(const std::string& cachePath);
+
+    // Load the atlas from the cache when the key matches; otherwise add the font, build the
+    // atlas and write a fresh cache. Returns the font, or nullptr if the TTF couldn't be
+    // loaded (the atlas is left untouched so the caller can fall back).
+    ImFont* LoadOrBuild(ImFontAtlas* atlas, const char* fontPath, float sizePixels, const ImWchar* glyphRanges,
+                        const ImFontConfig* fontConfig = nullptr);
+
+    // Building blocks, exposed for the round-trip check
+    bool Load(ImFontAtlas* atlas, uint64_t key);
+    bool Save(ImFontAtlas* atlas, uint64_t key);
+
+    // 0 if the font file doesn't exist
+    static uint64_t ComputeKey(const ImFontAtlas* atlas, const char* fontPath, float sizePixels,
+                               const ImWchar* glyphRanges, const ImFontConfig* fontConfig);
+
+    bool WasLoadedFromCache() const { return m_hit; }
+    uint64_t GetLastLoadNs() const { return m_loadNs; }
+    const std::string& GetPath() const { return m_path; }
+
+private:
+    std::string m_path;
+    bool m_hit = false;
+    uint64_t m_loadNs = 0;      // Time to produce the atlas, from cache or TTF
+};
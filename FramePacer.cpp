@@ -0,0 +1,154 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#else
+#include <time.h>
+#endif
+
+FramePacer::FramePacer(const Clock& clock)
+    : m_clock(clock), m_spinNs(FRAME_PACER_MAX_SPIN_NS)
+{
+#ifdef _WIN32
+    // High-resolution timers need Windows 10 1803; older systems get a normal one and a wider spin
+    m_timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    m_highResolution = m_timer != NULL;
+    if (!m_timer)
+        m_timer = CreateWaitableTimerExW(NULL, NULL, 0, TIMER_ALL_ACCESS);
+#else
+    m_highResolution = true;
+#endif
+    if (m_highResolution)
+        m_spinNs = 1000000;
+}
+
+FramePacer::~FramePacer()
+{
+#ifdef _WIN32
+    if (m_timer)
+        CloseHandle(m_timer);
+#endif
+}
+
+void FramePacer::SetTargetFps(int fps)
+{
+    if (fps == m_targetFps)
+        return;
+    m_targetFps = (std::max)(fps, 0);
+    m_periodNs = m_targetFps > 0 ? 1000000000ull / m_targetFps : 0;
+    m_deadlineNs = 0;
+}
+
+void FramePacer::Reset()
+{
+    m_deadlineNs = 0;
+    m_lastFrameNs = 0;
+    m_intervalCount = 0;
+    m_intervalNext = 0;
+    m_resyncs = 0;
+}
+
+void FramePacer::Wait()
+{
+    if (m_periodNs > 0) {
+        uint64_t now = m_clock.NowNs();
+        if (m_deadlineNs != 0 && now < m_deadlineNs + m_periodNs) {
+            SleepUntil(m_deadlineNs);
+        } else {
+            // First frame, or a whole period late: start a fresh grid instead of bursting to catch up
+            if (m_deadlineNs != 0)
+                m_resyncs++;
+            m_deadlineNs = now;
+        }
+        m_deadlineNs += m_periodNs;
+    }
+
+    uint64_t frameNs = m_clock.NowNs();
+    if (m_lastFrameNs != 0) {
+        m_intervals[m_intervalNext] = frameNs - m_lastFrameNs;
+        m_intervalNext = (m_intervalNext + 1) % FRAME_PACER_HISTORY;
+        m_intervalCount = (std::min<size_t>)(m_intervalCount + 1, FRAME_PACER_HISTORY);
+    }
+    m_lastFrameNs = frameNs;
+}
+
+void FramePacer::SleepUntil(uint64_t deadlineNs)
+{
+    for (;;) {
+        uint64_t now = m_clock.NowNs();
+        if (now >= deadlineNs)
+            return;
+
+        uint64_t remaining = deadlineNs - now;
+        if (remaining <= m_spinNs) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Sleep up to the spin margin, then widen or decay the margin by how late the timer woke
+        uint64_t requested = remaining - m_spinNs;
+        CoarseSleep(requested);
+        uint64_t slept = m_clock.NowNs() - now;
+        uint64_t lateNs = slept > requested ? slept - requested : 0;
+        uint64_t decayed = m_spinNs - m_spinNs / 16;
+        m_spinNs = (std::min<uint64_t>)((std::max<uint64_t>)({ lateNs * 2, decayed, FRAME_PACER_MIN_SPIN_NS }),
+                                      FRAME_PACER_MAX_SPIN_NS);
+    }
+}
+
+void FramePacer::CoarseSleep(uint64_t durationNs)
+{
+#ifdef _WIN32
+    if (m_timer) {
+        // Negative due time = relative, in 100 ns units
+        LARGE_INTEGER due;
+        due.QuadPart = -static_cast<LONGLONG>(durationNs / 100);
+        if (SetWaitableTimerEx(m_timer, &due, 0, NULL, NULL, NULL, 0)) {
+            WaitForSingleObject(m_timer, INFINITE);
+            return;
+        }
+    }
+    Sleep(static_cast<DWORD>(durationNs / 1000000));
+#else
+    timespec duration;
+    duration.tv_sec = static_cast<time_t>(durationNs / 1000000000ull);
+    duration.tv_nsec = static_cast<long>(durationNs % 1000000000ull);
+    clock_nanosleep(CLOCK_MONOTONIC, 0, &duration, nullptr);
+#endif
+}
+
+FrameIntervalStats FramePacer::GetStats() const
+{
+    FrameIntervalStats stats;
+    stats.count = m_intervalCount;
+    stats.resyncs = m_resyncs;
+    if (m_intervalCount == 0)
+        return stats;
+
+    uint64_t minNs = UINT64_MAX;
+    uint64_t maxNs = 0;
+    double sum = 0.0;
+    for (size_t i = 0; i < m_intervalCount; i++) {
+        minNs = (std::min)(minNs, m_intervals[i]);
+        maxNs = (std::max)(maxNs, m_intervals[i]);
+        sum += static_cast<double>(m_intervals[i]);
+    }
+    double mean = sum / m_intervalCount;
+    double variance = 0.0;
+    for (size_t i = 0; i < m_intervalCount; i++) {
+        double deviation = m_intervals[i] - mean;
+        variance += deviation * deviation;
+    }
+
+    stats.averageMs = mean / 1e6;
+    stats.minMs = minNs / 1e6;
+    stats.maxMs = maxNs / 1e6;
+    stats.jitterMs = std::sqrt(variance / m_intervalCount) / 1e6;
+    return stats;
+}
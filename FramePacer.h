@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "Clock.h"
+
+#define FRAME_PACER_HISTORY 240             // Frame intervals kept for the statistics
+#define FRAME_PACER_MIN_SPIN_NS 250000      // Never trust a timer wake closer than this to the deadline
+#define FRAME_PACER_MAX_SPIN_NS 4000000     // Beyond this, spinning costs more than the jitter it saves
+
+// Measured frame intervals over the last FRAME_PACER_HISTORY frames
+struct FrameIntervalStats {
+    size_t count = 0;
+    double averageMs = 0.0;
+    double minMs = 0.0;
+    double maxMs = 0.0;
+    double jitterMs = 0.0;      // Standard deviation of the intervals
+    uint64_t resyncs = 0;       // Frames that ran a whole period late and restarted the schedule
+};
+
+// Frame-rate cap with precise pacing, kept apart from presentation so it can be measured on
+// its own. Frames are scheduled on a fixed grid (deadline += period), so timer overshoot
+// doesn't accumulate. Each wait sleeps on a high-resolution waitable timer (clock_nanosleep
+// elsewhere) until shortly before the deadline and spins the rest; the spin margin follows
+// the timer's observed wake-up error. The clock must track real time.
+class FramePacer {
+public:
+    explicit FramePacer(const Clock& clock = Clock::System());
+    ~FramePacer();
+
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    // 0 = uncapped (the caller presents at vsync and Wait only measures)
+    void SetTargetFps(int fps);
+    int GetTargetFps() const { return m_targetFps; }
+
+    // Call once per frame after presenting: blocks until the next frame is due and records
+    // the interval since the previous call
+    void Wait();
+
+    // Forget the schedule and intervals, e.g. after the overlay was hidden
+    void Reset();
+
+    FrameIntervalStats GetStats() const;
+    uint64_t GetSpinMarginNs() const { return m_spinNs; }
+    bool HasHighResolutionTimer() const { return m_highResolution; }
+
+private:
+    void SleepUntil(uint64_t deadlineNs);
+    void CoarseSleep(uint64_t durationNs);
+
+    const Clock& m_clock;
+    int m_targetFps = 0;
+    uint64_t m_periodNs = 0;
+    uint64_t m_deadlineNs = 0;      // When the next frame is due, 0 = no schedule yet
+    uint64_t m_lastFrameNs = 0;
+    uint64_t m_spinNs;
+    uint64_t m_resyncs = 0;
+
+    void* m_timer = nullptr;        // Waitable timer HANDLE (Windows only)
+    bool m_highResolution = false;
+
+    uint64_t m_intervals[FRAME_PACER_HISTORY];
+    size_t m_intervalCount = 0;
+    size_t m_intervalNext = 0;
+};
@@ -0,0 +1,124 @@
+#include "HotkeyManager.h"
+
+// The hook procedure has no user data, so it reaches the manager through this
+static HotkeyManager* g_hotkeyManager = nullptr;
+
+HotkeyManager::HotkeyManager() :
+    m_hwnd(NULL),
+    m_hook(NULL),
+    m_hookAlwaysNeeded(false),
+    m_registeredCount(0)
+{
+}
+
+HotkeyManager::~HotkeyManager()
+{
+    Cleanup();
+}
+
+bool HotkeyManager::Initialize(HWND hwnd, const HotkeySettings& settings)
+{
+    m_hwnd = hwnd;
+    g_hotkeyManager = this;
+
+    // Register the global (toggle) chords; only exact-modifier chords can be registered
+    HotkeyChord hookChords[MAX_HOTKEY_CHORDS];
+    int hookChordCount = 0;
+
+    for (int i = 0; i < MAX_HOTKEY_CHORDS; i++)
+    {
+        const HotkeyChord& chord = settings.chords[i];
+        if (chord.key == 0 || chord.action == HOTKEY_ACTION_NONE)
+            continue;
+
+        bool registered = false;
+        if (chord.action != HOTKEY_ACTION_HIDE && !(chord.modifiers & HOTKEY_MOD_ANY))
+        {
+            registered = RegisterHotKey(m_hwnd, m_registeredCount, (chord.modifiers & 0x0F) | MOD_NOREPEAT, chord.key) != FALSE;
+            if (registered)
+                m_registeredActions[m_registeredCount++] = chord.action;
+        }
+
+        if (!registered)
+        {
+            // Someone else owns this chord (or it can't be registered) - handle it in the hook
+            hookChords[hookChordCount++] = chord;
+            if (chord.action != HOTKEY_ACTION_HIDE)
+                m_hookAlwaysNeeded = true;
+        }
+    }
+
+    m_hookMatcher.Compile(hookChords, hookChordCount);
+
+    if (m_hookAlwaysNeeded)
+        return InstallHook();
+    return true;
+}
+
+void HotkeyManager::Cleanup()
+{
+    RemoveHook();
+    for (int i = 0; i < m_registeredCount; i++)
+        UnregisterHotKey(m_hwnd, i);
+    m_registeredCount = 0;
+    m_hookAlwaysNeeded = false;
+    if (g_hotkeyManager == this)
+        g_hotkeyManager = nullptr;
+}
+
+void HotkeyManager::SetOverlayVisible(bool visible)
+{
+    if (visible || m_hookAlwaysNeeded)
+        InstallHook();
+    else
+        RemoveHook();
+}
+
+uint8_t HotkeyManager::GetActionForHotkeyId(WPARAM id) const
+{
+    if (id < (WPARAM)m_registeredCount)
+        return m_registeredActions[id];
+    return HOTKEY_ACTION_NONE;
+}
+
+bool HotkeyManager::InstallHook()
+{
+    if (m_hook)
+        return true;
+
+    // Modifier state may have changed while we weren't listening
+    m_hookMatcher.Reset();
+    m_hook = SetWindowsHookEx(WH_KEYBOARD_LL, LowLevelKeyboardProc, GetModuleHandle(NULL), 0);
+    return m_hook != NULL;
+}
+
+void HotkeyManager::RemoveHook()
+{
+    if (m_hook)
+    {
+        UnhookWindowsHookEx(m_hook);
+        m_hook = NULL;
+    }
+}
+
+// Keyboard hook procedure: one table lookup per key, and nothing is posted unless a chord matches
+LRESULT CALLBACK HotkeyManager::LowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam)
+{
+    if (nCode == HC_ACTION && g_hotkeyManager)
+    {
+        KBDLLHOOKSTRUCT* kbStruct = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
+        bool down = (wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN);
+
+        uint8_t action = g_hotkeyManager->m_hookMatcher.OnKey(static_cast<uint8_t>(kbStruct->vkCode), down);
+        if (action == HOTKEY_ACTION_TOGGLE || action == HOTKEY_ACTION_HIDE)
+        {
+            PostMessage(g_hotkeyManager->m_hwnd, WM_TOGGLE_OVERLAY, action == HOTKEY_ACTION_HIDE ? 1 : 0, 0);
+        }
+        else if (action != HOTKEY_ACTION_NONE)
+        {
+            PostMessage(g_hotkeyManager->m_hwnd, WM_HOTKEY_ACTION, action, 0);
+        }
+    }
+
+    return CallNextHookEx(NULL, nCode, wParam, lParam);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <windows.h>
+#include "HotkeyMatcher.h"
+
+// Define custom message for toggle (wParam 0 = toggle, 1 = hide only)
+#define WM_TOGGLE_OVERLAY (WM_USER + 1)
+
+// Any other action matched by the hook (wParam = HotkeyAction)
+#define WM_HOTKEY_ACTION (WM_USER + 2)
+
+// Hotkey handling for the overlay.
+// Global chords go through RegisterHotKey so no key traffic reaches our process.
+// The low-level keyboard hook is only installed while the overlay is visible (for
+// chords like Enter-to-hide), or permanently as a fallback if a registration fails.
+class HotkeyManager {
+public:
+    HotkeyManager();
+    ~HotkeyManager();
+
+    // Register chords for the window that receives WM_TOGGLE_OVERLAY / WM_HOTKEY_ACTION / WM_HOTKEY
+    bool Initialize(HWND hwnd, const HotkeySettings& settings);
+    void Cleanup();
+
+    // Install or remove the keyboard hook to match overlay visibility
+    void SetOverlayVisible(bool visible);
+
+    // Translate a WM_HOTKEY id into a HotkeyAction
+    uint8_t GetActionForHotkeyId(WPARAM id) const;
+
+    bool IsHookInstalled() const { return m_hook != NULL; }
+
+private:
+    bool InstallHook();
+    void RemoveHook();
+
+    static LRESULT CALLBACK LowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam);
+
+    HWND m_hwnd;
+    HHOOK m_hook;
+    bool m_hookAlwaysNeeded;
+    int m_registeredCount;
+    uint8_t m_registeredActions[MAX_HOTKEY_CHORDS];
+    HotkeyMatcher m_hookMatcher;
+};
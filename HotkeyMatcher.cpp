@@ -0,0 +1,92 @@
+#include "HotkeyMatcher.h"
+#include <cstring>
+
+// Virtual-key codes for the modifier keys (generic and left/right variants)
+static const struct { uint8_t vk; uint8_t side; } s_modifierKeys[] = {
+    { 0x10, 0x01 }, { 0xA0, 0x01 }, { 0xA1, 0x02 },   // Shift, LShift, RShift
+    { 0x11, 0x04 }, { 0xA2, 0x04 }, { 0xA3, 0x08 },   // Control, LControl, RControl
+    { 0x12, 0x10 }, { 0xA4, 0x10 }, { 0xA5, 0x20 },   // Alt, LAlt, RAlt
+    { 0x5B, 0x40 }, { 0x5C, 0x80 },                   // LWin, RWin
+};
+
+HotkeyMatcher::HotkeyMatcher()
+{
+    memset(m_modifierSide, 0, sizeof(m_modifierSide));
+    for (const auto& key : s_modifierKeys)
+        m_modifierSide[key.vk] = key.side;
+
+    // Fold every combination of held left/right modifier keys into a HOTKEY_MOD_* mask
+    for (int held = 0; held < 256; held++) {
+        uint8_t mask = 0;
+        if (held & 0x03) mask |= HOTKEY_MOD_SHIFT;
+        if (held & 0x0C) mask |= HOTKEY_MOD_CTRL;
+        if (held & 0x30) mask |= HOTKEY_MOD_ALT;
+        if (held & 0xC0) mask |= HOTKEY_MOD_WIN;
+        m_modifierFold[held] = mask;
+    }
+
+    Compile(nullptr, 0);
+}
+
+void HotkeyMatcher::Compile(const HotkeyChord* chords, int count)
+{
+    memset(m_slotForKey, 0, sizeof(m_slotForKey));
+    memset(m_actions, 0, sizeof(m_actions));
+    Reset();
+
+    int nextSlot = 1;
+    for (int i = 0; i < count && i < MAX_HOTKEY_CHORDS; i++) {
+        const HotkeyChord& chord = chords[i];
+        if (chord.key == 0 || chord.action == HOTKEY_ACTION_NONE)
+            continue;
+
+        uint8_t slot = m_slotForKey[chord.key];
+        if (slot == 0) {
+            slot = static_cast<uint8_t>(nextSlot++);
+            m_slotForKey[chord.key] = slot;
+        }
+
+        if (chord.modifiers & HOTKEY_MOD_ANY) {
+            // Wildcard chords fill every mask an exact chord hasn't claimed
+            for (int mask = 0; mask < 16; mask++) {
+                if (m_actions[slot][mask] == HOTKEY_ACTION_NONE)
+                    m_actions[slot][mask] = chord.action;
+            }
+        } else {
+            m_actions[slot][chord.modifiers & 0x0F] = chord.action;
+        }
+    }
+}
+
+uint8_t HotkeyMatcher::OnKey(uint8_t vk, bool down)
+{
+    uint8_t side = m_modifierSide[vk];
+    if (side) {
+        if (down)
+            m_heldModifiers |= side;
+        else
+            m_heldModifiers &= ~side;
+        return HOTKEY_ACTION_NONE;
+    }
+
+    uint8_t slot = m_slotForKey[vk];
+    if (slot == 0)
+        return HOTKEY_ACTION_NONE;
+
+    if (!down) {
+        m_keyDown[vk] = 0;
+        return HOTKEY_ACTION_NONE;
+    }
+
+    if (m_keyDown[vk])
+        return HOTKEY_ACTION_NONE;  // Auto-repeat
+    m_keyDown[vk] = 1;
+
+    return m_actions[slot][m_modifierFold[m_heldModifiers]];
+}
+
+void HotkeyMatcher::Reset()
+{
+    memset(m_keyDown, 0, sizeof(m_keyDown));
+    m_heldModifiers = 0;
+}
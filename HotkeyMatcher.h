@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+// Modifier bits (same values as the Win32 MOD_* flags used by RegisterHotKey)
+#define HOTKEY_MOD_ALT      0x01
+#define HOTKEY_MOD_CTRL     0x02
+#define HOTKEY_MOD_SHIFT    0x04
+#define HOTKEY_MOD_WIN      0x08
+#define HOTKEY_MOD_ANY      0x80   // Match regardless of which modifiers are held
+
+// What a chord does
+enum HotkeyAction : uint8_t {
+    HOTKEY_ACTION_NONE = 0,
+    HOTKEY_ACTION_TOGGLE = 1,   // Show/hide the overlay (global)
+    HOTKEY_ACTION_HIDE = 2,     // Hide the overlay (only while visible)
+    HOTKEY_ACTION_DUMP_TRACE = 3    // Start trace recording, or dump the trace if already recording (global)
+};
+
+#define MAX_HOTKEY_CHORDS 8
+
+// One configurable chord. Plain data so it can live in the settings file.
+struct HotkeyChord {
+    uint8_t modifiers;   // HOTKEY_MOD_* bits
+    uint8_t key;         // Virtual-key code, 0 = unused slot
+    uint8_t action;      // HotkeyAction
+};
+
+struct HotkeySettings {
+    HotkeyChord chords[MAX_HOTKEY_CHORDS] = {
+        { HOTKEY_MOD_ALT, 0x20 /* VK_SPACE */, HOTKEY_ACTION_TOGGLE },
+        { HOTKEY_MOD_ANY, 0x0D /* VK_RETURN */, HOTKEY_ACTION_HIDE },
+        { HOTKEY_MOD_CTRL | HOTKEY_MOD_ALT, 'T', HOTKEY_ACTION_DUMP_TRACE },
+    };
+};
+
+// Compact chord matcher for the keyboard hook.
+// The chord table is compiled into flat lookup tables so each key event costs a
+// couple of array reads, and keys that no chord uses return immediately.
+class HotkeyMatcher {
+public:
+    HotkeyMatcher();
+
+    // Build the lookup tables from a chord table (unused slots are skipped)
+    void Compile(const HotkeyChord* chords, int count);
+
+    // Feed one key event. Returns the action to fire, or HOTKEY_ACTION_NONE.
+    // Auto-repeat key downs don't fire again until the key is released.
+    uint8_t OnKey(uint8_t vk, bool down);
+
+    // Forget held keys (call when the hook is (re)installed and may have missed events)
+    void Reset();
+
+    uint8_t GetModifiers() const { return m_modifierFold[m_heldModifiers]; }
+
+private:
+    uint8_t m_modifierSide[256];    // Bit in m_heldModifiers for modifier keys, 0 otherwise
+    uint8_t m_modifierFold[256];    // Held-side bits -> HOTKEY_MOD_* mask
+    uint8_t m_slotForKey[256];      // Chord slot for a key, 0 = no chord uses it
+    uint8_t m_actions[MAX_HOTKEY_CHORDS + 1][16];   // [slot][modifier mask] -> action
+    uint8_t m_keyDown[256];         // Chord keys currently held (for repeat suppression)
+    uint8_t m_heldModifiers;
+};
@@ -0,0 +1,146 @@
+#include "IpHelperConnectionBackend.h"
+#include <cstring>
+
+#pragma comment(lib, "iphlpapi.lib")
+
+bool IpHelperConnectionBackend::ReadTcpTable(ULONG family, std::vector<BYTE>& buffer)
+{
+    for (int attempt = 0; attempt < 3; attempt++)
+    {
+        DWORD size = static_cast<DWORD>(buffer.size());
+        DWORD result = GetExtendedTcpTable(buffer.empty() ? NULL : buffer.data(), &size, FALSE, family,
+                                           TCP_TABLE_OWNER_PID_ALL, 0);
+        if (result == NO_ERROR)
+            return true;
+        if (result != ERROR_INSUFFICIENT_BUFFER)
+            return false;
+        
+        // Leave headroom; the table can grow between the two calls
+        buffer.resize(size + size / 4);
+    }
+    return false;
+}
+
+bool IpHelperConnectionBackend::ReadUdpTable(ULONG family, std::vector<BYTE>& buffer)
+{
+    for (int attempt = 0; attempt < 3; attempt++)
+    {
+        DWORD size = static_cast<DWORD>(buffer.size());
+        DWORD result = GetExtendedUdpTable(buffer.empty() ? NULL : buffer.data(), &size, FALSE, family,
+                                           UDP_TABLE_OWNER_PID, 0);
+        if (result == NO_ERROR)
+            return true;
+        if (result != ERROR_INSUFFICIENT_BUFFER)
+            return false;
+        buffer.resize(size + size / 4);
+    }
+    return false;
+}
+
+bool IpHelperConnectionBackend::Snapshot(std::vector<ConnectionRecord>& records)
+{
+    records.clear();
+    
+    ConnectionRecord record;
+    memset(&record, 0, sizeof(record));
+    
+    if (ReadTcpTable(AF_INET, m_tcp4))
+    {
+        const MIB_TCPTABLE_OWNER_PID* table = reinterpret_cast<const MIB_TCPTABLE_OWNER_PID*>(m_tcp4.data());
+        record.protocol = CONNECTION_TCP;
+        record.family = 4;
+        for (DWORD i = 0; i < table->dwNumEntries; i++)
+        {
+            const MIB_TCPROW_OWNER_PID& row = table->table[i];
+            memcpy(record.localAddress, &row.dwLocalAddr, 4);
+            memcpy(record.remoteAddress, &row.dwRemoteAddr, 4);
+            record.localPort = static_cast<uint16_t>(row.dwLocalPort);
+            record.remotePort = static_cast<uint16_t>(row.dwRemotePort);
+            record.pid = row.dwOwningPid;
+            record.state = static_cast<uint8_t>(row.dwState);
+            records.push_back(record);
+        }
+    }
+    
+    if (ReadTcpTable(AF_INET6, m_tcp6))
+    {
+        const MIB_TCP6TABLE_OWNER_PID* table = reinterpret_cast<const MIB_TCP6TABLE_OWNER_PID*>(m_tcp6.data());
+        record.protocol = CONNECTION_TCP;
+        record.family = 6;
+        for (DWORD i = 0; i < table->dwNumEntries; i++)
+        {
+            const MIB_TCP6ROW_OWNER_PID& row = table->table[i];
+            memcpy(record.localAddress, row.ucLocalAddr, 16);
+            memcpy(record.remoteAddress, row.ucRemoteAddr, 16);
+            record.localPort = static_cast<uint16_t>(row.dwLocalPort);
+            record.remotePort = static_cast<uint16_t>(row.dwRemotePort);
+            record.pid = row.dwOwningPid;
+            record.state = static_cast<uint8_t>(row.dwState);
+            records.push_back(record);
+        }
+    }
+    
+    // UDP is connectionless: one endpoint per socket, no remote side or state
+    memset(&record, 0, sizeof(record));
+    record.protocol = CONNECTION_UDP;
+    
+    if (ReadUdpTable(AF_INET, m_udp4))
+    {
+        const MIB_UDPTABLE_OWNER_PID* table = reinterpret_cast<const MIB_UDPTABLE_OWNER_PID*>(m_udp4.data());
+        record.family = 4;
+        for (DWORD i = 0; i < table->dwNumEntries; i++)
+        {
+            const MIB_UDPROW_OWNER_PID& row = table->table[i];
+            memcpy(record.localAddress, &row.dwLocalAddr, 4);
+            record.localPort = static_cast<uint16_t>(row.dwLocalPort);
+            record.pid = row.dwOwningPid;
+            records.push_back(record);
+        }
+    }
+    
+    if (ReadUdpTable(AF_INET6, m_udp6))
+    {
+        const MIB_UDP6TABLE_OWNER_PID* table = reinterpret_cast<const MIB_UDP6TABLE_OWNER_PID*>(m_udp6.data());
+        record.family = 6;
+        for (DWORD i = 0; i < table->dwNumEntries; i++)
+        {
+            const MIB_UDP6ROW_OWNER_PID& row = table->table[i];
+            memcpy(record.localAddress, row.ucLocalAddr, 16);
+            record.localPort = static_cast<uint16_t>(row.dwLocalPort);
+            record.pid = row.dwOwningPid;
+            records.push_back(record);
+        }
+    }
+    
+    return !records.empty();
+}
+
+bool IpHelperConnectionBackend::GetProcessName(uint32_t pid, char* name, size_t length)
+{
+    if (pid == 0)
+    {
+        strcpy_s(name, length, "System Idle Process");
+        return true;
+    }
+    if (pid == 4)
+    {
+        strcpy_s(name, length, "System");
+        return true;
+    }
+    
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (!process)
+        return false;
+    
+    char path[MAX_PATH];
+    DWORD size = MAX_PATH;
+    BOOL ok = QueryFullProcessImageNameA(process, 0, path, &size);
+    CloseHandle(process);
+    if (!ok)
+        return false;
+    
+    // Just the file name
+    const char* fileName = strrchr(path, '\\');
+    strncpy_s(name, length, fileName ? fileName + 1 : path, _TRUNCATE);
+    return true;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <windows.h>
+#include <iphlpapi.h>
+#include <vector>
+#include "ConnectionMonitor.h"
+
+// Connection monitor backend built on GetExtendedTcpTable/GetExtendedUdpTable (IPv4 and IPv6)
+class IpHelperConnectionBackend : public IConnectionBackend {
+public:
+    bool Snapshot(std::vector<ConnectionRecord>& records) override;
+    bool GetProcessName(uint32_t pid, char* name, size_t length) override;
+
+private:
+    // Fetch one table into buffer, growing it as needed
+    bool ReadTcpTable(ULONG family, std::vector<BYTE>& buffer);
+    bool ReadUdpTable(ULONG family, std::vector<BYTE>& buffer);
+
+    // Buffers are kept between snapshots so steady-state ticks don't allocate
+    std::vector<BYTE> m_tcp4;
+    std::vector<BYTE> m_tcp6;
+    std::vector<BYTE> m_udp4;
+    std::vector<BYTE> m_udp6;
+};
@@ -0,0 +1,104 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <cstring>
+
+void LatencySnapshot::Clear()
+{
+    memset(counts, 0, sizeof(counts));
+    total = 0;
+    max = 0;
+}
+
+void LatencySnapshot::Merge(const LatencySnapshot& other)
+{
+    for (size_t i = 0; i < LATENCY_BUCKET_COUNT; i++)
+        counts[i] += other.counts[i];
+    total += other.total;
+    max = std::max(max, other.max);
+}
+
+uint64_t LatencySnapshot::ValueAtPercentile(double percentile) const
+{
+    if (total == 0)
+        return 0;
+
+    // Rank of the sample we're after (1-based), rounded up so p100 is the last sample
+    double wanted = std::min(std::max(percentile, 0.0), 100.0) / 100.0 * total;
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(wanted + 0.999999));
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < LATENCY_BUCKET_COUNT; i++) {
+        seen += counts[i];
+        if (seen >= rank)
+            return std::min(LatencyHistogram::BucketLowest(i) + LatencyHistogram::BucketWidth(i) / 2, max);
+    }
+    return max;
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+    Reset();
+}
+
+void LatencyHistogram::Snapshot(LatencySnapshot& out) const
+{
+    out.total = 0;
+    for (size_t i = 0; i < LATENCY_BUCKET_COUNT; i++) {
+        out.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+        out.total += out.counts[i];
+    }
+    out.max = m_max.load(std::memory_order_relaxed);
+}
+
+void LatencyHistogram::Reset()
+{
+    for (size_t i = 0; i < LATENCY_BUCKET_COUNT; i++)
+        m_counts[i].store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::BucketLowest(size_t index)
+{
+    if (index < LATENCY_SUB_BUCKETS)
+        return index;
+    int shift = static_cast<int>(index >> LATENCY_SUB_BUCKET_BITS) - 1;
+    return static_cast<uint64_t>(LATENCY_SUB_BUCKETS + (index & (LATENCY_SUB_BUCKETS - 1))) << shift;
+}
+
+uint64_t LatencyHistogram::BucketWidth(size_t index)
+{
+    if (index < LATENCY_SUB_BUCKETS)
+        return 1;
+    return 1ull << ((index >> LATENCY_SUB_BUCKET_BITS) - 1);
+}
+
+LatencyHistogram& LatencyHistogram::For(LatencyOperation operation)
+{
+    static LatencyHistogram histograms[LATENCY_OPERATION_COUNT];
+    return histograms[operation];
+}
+
+const char* LatencyHistogram::OperationName(LatencyOperation operation)
+{
+    switch (operation) {
+    case LATENCY_FRAME_BUILD: return "Frame build";
+    case LATENCY_PRESENT: return "Present";
+    case LATENCY_PROVIDER_COUNTERS: return "PDH counters";
+    case LATENCY_PROVIDER_TEMPERATURE: return "Temperature (WMI)";
+    case LATENCY_PROVIDER_MEMORY: return "Memory";
+    case LATENCY_PROVIDER_BATTERY: return "Battery";
+    case LATENCY_PROVIDER_NETWORK_SPEED: return "Network speeds";
+    case LATENCY_PROVIDER_NETWORK_DETAILS: return "Network details (WLAN)";
+    case LATENCY_PROVIDER_PROCESSES: return "Processes";
+    case LATENCY_PROVIDER_STORAGE: return "Storage";
+    case LATENCY_PROVIDER_CONNECTIONS: return "Connections";
+    case LATENCY_PROVIDER_SELF: return "Self overhead";
+    case LATENCY_COM_WMI_CONNECT: return "COM: WMI connect";
+    case LATENCY_COM_WMI_QUERY: return "COM: WMI query";
+    case LATENCY_COM_ENDPOINT_VOLUME: return "COM: endpoint volume";
+    case LATENCY_COM_AUDIO_CAPTURE: return "COM: capture buffer";
+    case LATENCY_AUDIO_PACKET: return "Audio packet";
+    case LATENCY_OPERATION_COUNT: break;
+    }
+    return "Unknown";
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "Clock.h"
+#include "TraceRecorder.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Log-linear buckets: values below 2^SUB_BUCKET_BITS ns get one bucket each, every power of
+// two above that is split into 2^SUB_BUCKET_BITS linear sub-buckets (~3% relative error).
+// Values past 2^MAX_EXPONENT ns (~69 s) are counted in the top bucket.
+#define LATENCY_SUB_BUCKET_BITS 5
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BUCKET_BITS)
+#define LATENCY_MAX_EXPONENT 36
+#define LATENCY_BUCKET_COUNT ((LATENCY_MAX_EXPONENT - LATENCY_SUB_BUCKET_BITS + 2) << LATENCY_SUB_BUCKET_BITS)
+
+// Instrumented operations
+enum LatencyOperation {
+    LATENCY_FRAME_BUILD,
+    LATENCY_PRESENT,
+    LATENCY_PROVIDER_COUNTERS,
+    LATENCY_PROVIDER_TEMPERATURE,
+    LATENCY_PROVIDER_MEMORY,
+    LATENCY_PROVIDER_BATTERY,
+    LATENCY_PROVIDER_NETWORK_SPEED,
+    LATENCY_PROVIDER_NETWORK_DETAILS,
+    LATENCY_PROVIDER_PROCESSES,
+    LATENCY_PROVIDER_STORAGE,
+    LATENCY_PROVIDER_CONNECTIONS,
+    LATENCY_PROVIDER_SELF,
+    LATENCY_COM_WMI_CONNECT,
+    LATENCY_COM_WMI_QUERY,
+    LATENCY_COM_ENDPOINT_VOLUME,
+    LATENCY_COM_AUDIO_CAPTURE,
+    LATENCY_AUDIO_PACKET,
+    LATENCY_OPERATION_COUNT
+};
+
+// Plain copy of a histogram for reporting; snapshots from several sources can be merged
+struct LatencySnapshot {
+    uint64_t counts[LATENCY_BUCKET_COUNT];
+    uint64_t total;
+    uint64_t max;
+
+    void Clear();
+    void Merge(const LatencySnapshot& other);
+
+    // Smallest recorded value v such that 'percentile' percent of samples are <= v
+    // (bucket midpoint, never above the recorded max). 0 if empty.
+    uint64_t ValueAtPercentile(double percentile) const;
+};
+
+// Fixed-memory latency histogram in nanoseconds. Recording is one relaxed atomic add plus a
+// relaxed max check, so any thread can record without locks.
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void Record(uint64_t ns)
+    {
+        m_counts[BucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+        uint64_t max = m_max.load(std::memory_order_relaxed);
+        while (ns > max && !m_max.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Counts recorded while the snapshot is taken may or may not be included
+    void Snapshot(LatencySnapshot& out) const;
+    void Reset();
+
+    // One histogram per instrumented operation, shared by all threads
+    static LatencyHistogram& For(LatencyOperation operation);
+    static const char* OperationName(LatencyOperation operation);
+
+    static size_t BucketIndex(uint64_t ns)
+    {
+        if (ns < LATENCY_SUB_BUCKETS)
+            return static_cast<size_t>(ns);
+        int msb = MostSignificantBit(ns);
+        if (msb > LATENCY_MAX_EXPONENT)
+            return LATENCY_BUCKET_COUNT - 1;
+        int shift = msb - LATENCY_SUB_BUCKET_BITS;
+        return (static_cast<size_t>(shift + 1) << LATENCY_SUB_BUCKET_BITS) +
+               static_cast<size_t>((ns >> shift) & (LATENCY_SUB_BUCKETS - 1));
+    }
+
+    // Range [lowest, lowest + width) of values that land in a bucket
+    static uint64_t BucketLowest(size_t index);
+    static uint64_t BucketWidth(size_t index);
+
+private:
+    static int MostSignificantBit(uint64_t value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return static_cast<int>(index);
+#else
+        return 63 - __builtin_clzll(value);
+#endif
+    }
+
+    std::atomic<uint64_t> m_counts[LATENCY_BUCKET_COUNT];
+    std::atomic<uint64_t> m_max;
+};
+
+// Records the lifetime of the scope into an operation's histogram, and as a slice in the
+// trace while trace recording is on
+class LatencyScope {
+public:
+    explicit LatencyScope(LatencyOperation operation, const Clock& clock = Clock::System())
+        : m_histogram(LatencyHistogram::For(operation)), m_clock(clock), m_startNs(clock.NowNs()),
+          m_trace(TraceRecorder::IsEnabled() ? LatencyHistogram::OperationName(operation) : nullptr) {}
+    ~LatencyScope() { m_histogram.Record(m_clock.NowNs() - m_startNs); }
+
+    LatencyScope(const LatencyScope&) = delete;
+    LatencyScope& operator=(const LatencyScope&) = delete;
+
+private:
+    LatencyHistogram& m_histogram;
+    const Clock& m_clock;
+    uint64_t m_startNs;
+    TraceScope m_trace;
+};
@@ -0,0 +1,103 @@
+#include "MetricSubscriptions.h"
+
+MetricSubscriptions::MetricSubscriptions() :
+    m_metrics(METRIC_COUNT)
+{
+}
+
+int MetricSubscriptions::Subscribe(int metric, uint32_t intervalMs)
+{
+    int handle;
+    if (!m_freeHandles.empty()) {
+        handle = m_freeHandles.back();
+        m_freeHandles.pop_back();
+    } else {
+        handle = static_cast<int>(m_entries.size());
+        m_entries.push_back({});
+    }
+
+    m_entries[handle] = { metric, intervalMs, true };
+
+    MetricState& state = m_metrics[metric];
+    if (state.subscribers++ == 0)
+        state.sampled = false;   // First subscriber gets a sample right away
+    Resolve(metric);
+    return handle;
+}
+
+void MetricSubscriptions::Unsubscribe(int handle)
+{
+    if (handle < 0 || handle >= static_cast<int>(m_entries.size()) || !m_entries[handle].live)
+        return;
+
+    Entry& entry = m_entries[handle];
+    entry.live = false;
+    m_metrics[entry.metric].subscribers--;
+    m_freeHandles.push_back(handle);
+    Resolve(entry.metric);
+}
+
+void MetricSubscriptions::SetInterval(int handle, uint32_t intervalMs)
+{
+    if (handle < 0 || handle >= static_cast<int>(m_entries.size()) || !m_entries[handle].live)
+        return;
+
+    m_entries[handle].intervalMs = intervalMs;
+    Resolve(m_entries[handle].metric);
+}
+
+// Recompute the fastest interval for one metric (only runs when subscriptions change)
+void MetricSubscriptions::Resolve(int metric)
+{
+    uint32_t fastest = 0;
+    for (const auto& entry : m_entries) {
+        if (entry.live && entry.metric == metric && (fastest == 0 || entry.intervalMs < fastest))
+            fastest = entry.intervalMs;
+    }
+    m_metrics[metric].intervalMs = fastest;
+}
+
+bool MetricSubscriptions::IsDue(int metric, uint64_t nowMs) const
+{
+    const MetricState& state = m_metrics[metric];
+    if (state.subscribers == 0)
+        return false;
+    return !state.sampled || nowMs - state.lastSample >= state.intervalMs;
+}
+
+void MetricSubscriptions::MarkSampled(int metric, uint64_t nowMs)
+{
+    m_metrics[metric].lastSample = nowMs;
+    m_metrics[metric].sampled = true;
+}
+
+MetricSubscription::MetricSubscription(MetricSubscriptions& hub, int metric) :
+    m_hub(hub),
+    m_metric(metric),
+    m_handle(-1),
+    m_intervalMs(0)
+{
+}
+
+void MetricSubscription::Request(bool active, uint32_t intervalMs)
+{
+    if (!active) {
+        Release();
+        return;
+    }
+
+    if (m_handle < 0) {
+        m_handle = m_hub.Subscribe(m_metric, intervalMs);
+    } else if (intervalMs != m_intervalMs) {
+        m_hub.SetInterval(m_handle, intervalMs);
+    }
+    m_intervalMs = intervalMs;
+}
+
+void MetricSubscription::Release()
+{
+    if (m_handle >= 0) {
+        m_hub.Unsubscribe(m_handle);
+        m_handle = -1;
+    }
+}
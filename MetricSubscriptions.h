@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+// Metrics that can be collected on demand
+enum MetricId {
+    METRIC_CPU_USAGE,
+    METRIC_CPU_TEMPERATURE,
+    METRIC_SYSTEM_COUNTERS,    // Commit, paging, disk, run queue, context switches
+    METRIC_MEMORY,
+    METRIC_BATTERY,
+    METRIC_NETWORK_SPEED,
+    METRIC_NETWORK_DETAILS,    // Current network name and Wi-Fi state
+    METRIC_PROCESSES,          // Top CPU and memory consumers
+    METRIC_STORAGE,            // Disk throughput, IOPS, queue depth and free space
+    METRIC_CONNECTIONS,        // TCP/UDP connection table
+    METRIC_SELF,               // The overlay's own CPU, memory, handles, wakeups and allocations
+    METRIC_COUNT
+};
+
+// Reference-counted metric subscriptions.
+// A metric is only collected while it has live subscribers, at the fastest
+// interval any of them asked for.
+class MetricSubscriptions {
+public:
+    MetricSubscriptions();
+
+    // Returns a handle for Unsubscribe/SetInterval
+    int Subscribe(int metric, uint32_t intervalMs);
+    void Unsubscribe(int handle);
+    void SetInterval(int handle, uint32_t intervalMs);
+
+    int GetSubscriberCount(int metric) const { return m_metrics[metric].subscribers; }
+    bool HasSubscribers(int metric) const { return m_metrics[metric].subscribers > 0; }
+
+    // Fastest requested interval, 0 if nobody is subscribed
+    uint32_t GetInterval(int metric) const { return m_metrics[metric].intervalMs; }
+
+    // Scheduling helpers for the collector. A metric is due as soon as it gains its first subscriber.
+    bool IsDue(int metric, uint64_t nowMs) const;
+    void MarkSampled(int metric, uint64_t nowMs);
+
+private:
+    struct Entry {
+        int metric;
+        uint32_t intervalMs;
+        bool live;
+    };
+
+    struct MetricState {
+        int subscribers = 0;
+        uint32_t intervalMs = 0;
+        uint64_t lastSample = 0;
+        bool sampled = false;
+    };
+
+    void Resolve(int metric);
+
+    std::vector<Entry> m_entries;
+    std::vector<int> m_freeHandles;
+    std::vector<MetricState> m_metrics;
+};
+
+// Subscription owned by a widget. Request() every frame with whether the widget is
+// on screen; it only touches the hub when something actually changes.
+class MetricSubscription {
+public:
+    MetricSubscription(MetricSubscriptions& hub, int metric);
+    ~MetricSubscription() { Release(); }
+
+    MetricSubscription(const MetricSubscription&) = delete;
+    MetricSubscription& operator=(const MetricSubscription&) = delete;
+
+    void Request(bool active, uint32_t intervalMs);
+    void Release();
+    bool IsActive() const { return m_handle >= 0; }
+
+private:
+    MetricSubscriptions& m_hub;
+    int m_metric;
+    int m_handle;
+    uint32_t m_intervalMs;
+};
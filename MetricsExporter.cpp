@@ -0,0 +1,404 @@
+#include "MetricsExporter.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+#pragma comment(lib, "ws2_32.lib")
+#define EXPORTER_SEND_FLAGS 0
+#else
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int SOCKET;
+#define INVALID_SOCKET (-1)
+#define SOCKET_ERROR (-1)
+#define SD_SEND SHUT_WR
+#define closesocket close
+#define EXPORTER_SEND_FLAGS MSG_NOSIGNAL    // A client that hung up mustn't raise SIGPIPE
+#endif
+
+// The last call failed only because it would have blocked; try again on the next event
+static bool WouldBlock()
+{
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+static bool MakeNonBlocking(SOCKET socket)
+{
+#ifdef _WIN32
+    u_long nonBlocking = 1;
+    return ioctlsocket(socket, FIONBIO, &nonBlocking) == 0;
+#else
+    int flags = fcntl(socket, F_GETFL, 0);
+    return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+static const std::shared_ptr<const std::string> s_notFound = std::make_shared<const std::string>(
+    "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+
+MetricsExporter::MetricsExporter(const Clock& clock) :
+    m_clock(clock),
+    m_listenSocket(static_cast<uintptr_t>(INVALID_SOCKET)),
+#ifdef _WIN32
+    m_socketEvent(NULL),
+    m_stopEvent(NULL),
+#else
+    m_stopPipe{ -1, -1 },
+#endif
+    m_running(false),
+    m_port(0),
+    m_publishedVersion(0),
+    m_formattedVersion(~0ull),
+    m_scrapes(0),
+    m_timedOut(0)
+{
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    Stop();
+}
+
+bool MetricsExporter::Start(uint16_t port)
+{
+    if (m_running)
+        return true;
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+        return false;
+#endif
+
+    SOCKET listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listenSocket == INVALID_SOCKET)
+    {
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+
+    // Loopback only: nothing off this machine can reach the endpoint
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+#ifdef _WIN32
+    BOOL exclusive = TRUE;
+    setsockopt(listenSocket, SOL_SOCKET, SO_EXCLUSIVEADDRUSE, reinterpret_cast<const char*>(&exclusive), sizeof(exclusive));
+#else
+    // We close connections first, so restarting would otherwise trip over our own TIME_WAITs
+    int reuse = 1;
+    setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+#endif
+
+    socklen_t addressLength = sizeof(address);
+    if (bind(listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR ||
+        listen(listenSocket, SOMAXCONN) == SOCKET_ERROR ||
+        getsockname(listenSocket, reinterpret_cast<sockaddr*>(&address), &addressLength) == SOCKET_ERROR ||
+        !MakeNonBlocking(listenSocket))
+    {
+        closesocket(listenSocket);
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+
+#ifdef _WIN32
+    // One event for the listener and every client; the thread also sleeps on the stop event
+    m_socketEvent = WSACreateEvent();
+    WSAEventSelect(listenSocket, m_socketEvent, FD_ACCEPT);
+    m_stopEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+#else
+    if (pipe(m_stopPipe) != 0)
+    {
+        closesocket(listenSocket);
+        return false;
+    }
+#endif
+
+    m_listenSocket = static_cast<uintptr_t>(listenSocket);
+    m_port = ntohs(address.sin_port);
+    m_running = true;
+    m_thread = std::thread(&MetricsExporter::ServeLoop, this);
+    return true;
+}
+
+void MetricsExporter::Stop()
+{
+    if (!m_running)
+        return;
+
+#ifdef _WIN32
+    SetEvent(m_stopEvent);
+#else
+    char wake = 1;
+    if (write(m_stopPipe[1], &wake, 1) != 1)
+        perror("metrics exporter stop");
+#endif
+    if (m_thread.joinable())
+        m_thread.join();
+
+    closesocket(static_cast<SOCKET>(m_listenSocket));
+    m_listenSocket = static_cast<uintptr_t>(INVALID_SOCKET);
+#ifdef _WIN32
+    WSACloseEvent(m_socketEvent);
+    CloseHandle(m_stopEvent);
+    m_socketEvent = NULL;
+    m_stopEvent = NULL;
+    WSACleanup();
+#else
+    close(m_stopPipe[0]);
+    close(m_stopPipe[1]);
+    m_stopPipe[0] = m_stopPipe[1] = -1;
+#endif
+    m_running = false;
+}
+
+void MetricsExporter::Publish(const MetricsSnapshot& snapshot)
+{
+    std::lock_guard<std::mutex> lock(m_snapshotMutex);
+    m_snapshot = snapshot;
+    m_publishedVersion++;
+}
+
+void MetricsExporter::ServeLoop()
+{
+    TraceRecorder::Instance().SetThreadName("Metrics exporter");
+
+    while (WaitForActivity(m_clock.NowMs()))
+    {
+        // Existing clients first, so a slot freed here can take a connection from the backlog
+        uint64_t nowMs = m_clock.NowMs();
+        ServiceClients(0, nowMs);
+        size_t first = m_clients.size();
+        AcceptClients(nowMs);
+        ServiceClients(first, nowMs);
+    }
+
+    for (auto& client : m_clients)
+        closesocket(static_cast<SOCKET>(client->socket));
+    m_clients.clear();
+}
+
+// Sleep until a socket is ready, the nearest client deadline passes, or Stop is called
+bool MetricsExporter::WaitForActivity(uint64_t nowMs)
+{
+    int timeoutMs = -1;
+    for (const auto& client : m_clients)
+    {
+        int remaining = client->deadlineMs > nowMs ? static_cast<int>(client->deadlineMs - nowMs) : 0;
+        if (timeoutMs < 0 || remaining < timeoutMs)
+            timeoutMs = remaining;
+    }
+
+#ifdef _WIN32
+    HANDLE events[2] = { m_stopEvent, m_socketEvent };
+    DWORD result = WaitForMultipleObjects(2, events, FALSE, timeoutMs < 0 ? INFINITE : static_cast<DWORD>(timeoutMs));
+    if (result == WAIT_OBJECT_0 || result == WAIT_FAILED)
+        return false;
+
+    // Reset before servicing: anything that arrives meanwhile sets it again, and every
+    // socket is tried on each pass, so no readiness is lost
+    WSAResetEvent(m_socketEvent);
+    return true;
+#else
+    std::vector<pollfd> fds;
+    fds.reserve(m_clients.size() + 2);
+    fds.push_back(pollfd{ m_stopPipe[0], POLLIN, 0 });
+    if (m_clients.size() < EXPORTER_MAX_CLIENTS)
+        fds.push_back(pollfd{ static_cast<SOCKET>(m_listenSocket), POLLIN, 0 });
+    for (const auto& client : m_clients)
+        fds.push_back(pollfd{ static_cast<SOCKET>(client->socket), static_cast<short>(client->response ? POLLOUT : POLLIN), 0 });
+
+    if (poll(fds.data(), fds.size(), timeoutMs) < 0 && errno != EINTR)
+        return false;
+    return (fds[0].revents & POLLIN) == 0;
+#endif
+}
+
+void MetricsExporter::AcceptClients(uint64_t nowMs)
+{
+    while (m_clients.size() < EXPORTER_MAX_CLIENTS)
+    {
+        SOCKET socket = accept(static_cast<SOCKET>(m_listenSocket), NULL, NULL);
+        if (socket == INVALID_SOCKET)
+            break;
+
+#ifdef _WIN32
+        // Also makes the socket non-blocking
+        WSAEventSelect(socket, m_socketEvent, FD_READ | FD_WRITE | FD_CLOSE);
+#else
+        MakeNonBlocking(socket);
+#endif
+        std::unique_ptr<Client> client(new Client());
+        client->socket = static_cast<uintptr_t>(socket);
+        client->deadlineMs = nowMs + EXPORTER_CLIENT_TIMEOUT_MS;
+        m_clients.push_back(std::move(client));
+    }
+}
+
+void MetricsExporter::ServiceClients(size_t first, uint64_t nowMs)
+{
+    for (size_t i = first; i < m_clients.size();)
+    {
+        if (ServiceClient(*m_clients[i], nowMs))
+        {
+            i++;
+            continue;
+        }
+        closesocket(static_cast<SOCKET>(m_clients[i]->socket));
+        m_clients[i] = std::move(m_clients.back());
+        m_clients.pop_back();
+    }
+}
+
+bool MetricsExporter::ServiceClient(Client& client, uint64_t nowMs)
+{
+    SOCKET socket = static_cast<SOCKET>(client.socket);
+
+    // Read the request head as far as it has arrived
+    while (!client.response)
+    {
+        int received = recv(socket, client.request + client.requestLength,
+                            static_cast<int>(sizeof(client.request) - 1 - client.requestLength), 0);
+        if (received < 0)
+        {
+            if (!WouldBlock())
+                return false;
+            if (nowMs < client.deadlineMs)
+                return true;
+            m_timedOut++;
+            return false;
+        }
+        if (received == 0 && client.requestLength == 0)
+            return false;
+
+        if (received > 0)
+        {
+            client.requestLength += received;
+            client.request[client.requestLength] = '\0';
+            if (!strstr(client.request, "\r\n\r\n") && client.requestLength < sizeof(client.request) - 1)
+                continue;
+        }
+
+        TraceScope trace("Serve scrape");
+        client.scrape = strncmp(client.request, "GET /metrics ", 13) == 0 || strncmp(client.request, "GET / ", 6) == 0;
+        if (client.scrape)
+        {
+            RebuildResponse();
+            client.response = m_response;
+        }
+        else
+        {
+            client.response = s_notFound;
+        }
+    }
+
+    // Send whatever the socket takes
+    const std::string& response = *client.response;
+    while (client.sent < response.size())
+    {
+        int sent = send(socket, response.data() + client.sent, static_cast<int>(response.size() - client.sent),
+                        EXPORTER_SEND_FLAGS);
+        if (sent < 0)
+        {
+            if (!WouldBlock())
+                return false;
+            if (nowMs < client.deadlineMs)
+                return true;
+            m_timedOut++;
+            return false;
+        }
+        client.sent += sent;
+    }
+
+    if (client.scrape)
+        m_scrapes++;
+    shutdown(socket, SD_SEND);
+    return false;
+}
+
+// Format the whole HTTP response once per published snapshot
+void MetricsExporter::RebuildResponse()
+{
+    MetricsSnapshot snapshot;
+    {
+        std::lock_guard<std::mutex> lock(m_snapshotMutex);
+        if (m_publishedVersion == m_formattedVersion)
+            return;
+        snapshot = m_snapshot;
+        m_formattedVersion = m_publishedVersion;
+    }
+
+    char body[2048];
+    int bodyLength = snprintf(body, sizeof(body),
+        "# TYPE overlay_cpu_usage_percent gauge\n"
+        "overlay_cpu_usage_percent %.1f\n"
+        "# TYPE overlay_cpu_temperature_celsius gauge\n"
+        "# UNIT overlay_cpu_temperature_celsius celsius\n"
+        "overlay_cpu_temperature_celsius %.1f\n"
+        "# TYPE overlay_memory_used_bytes gauge\n"
+        "# UNIT overlay_memory_used_bytes bytes\n"
+        "overlay_memory_used_bytes %llu\n"
+        "# TYPE overlay_memory_total_bytes gauge\n"
+        "# UNIT overlay_memory_total_bytes bytes\n"
+        "overlay_memory_total_bytes %llu\n"
+        "# TYPE overlay_network_receive_bytes_per_second gauge\n"
+        "overlay_network_receive_bytes_per_second %.0f\n"
+        "# TYPE overlay_network_transmit_bytes_per_second gauge\n"
+        "overlay_network_transmit_bytes_per_second %.0f\n",
+        snapshot.cpuUsagePercent,
+        snapshot.cpuTemperatureCelsius,
+        (unsigned long long)snapshot.memoryUsedBytes,
+        (unsigned long long)snapshot.memoryTotalBytes,
+        snapshot.downloadBytesPerSec,
+        snapshot.uploadBytesPerSec);
+
+    if (snapshot.batteryPercent >= 0 && bodyLength > 0 && bodyLength < (int)sizeof(body))
+    {
+        bodyLength += snprintf(body + bodyLength, sizeof(body) - bodyLength,
+            "# TYPE overlay_battery_percent gauge\n"
+            "overlay_battery_percent %d\n"
+            "# TYPE overlay_battery_charging gauge\n"
+            "overlay_battery_charging %d\n",
+            snapshot.batteryPercent, snapshot.batteryCharging);
+    }
+    if (bodyLength > 0 && bodyLength < (int)sizeof(body))
+    {
+        bodyLength += snprintf(body + bodyLength, sizeof(body) - bodyLength, "# EOF\n");
+    }
+    if (bodyLength < 0 || bodyLength >= (int)sizeof(body))
+    {
+        bodyLength = 0;
+    }
+
+    char header[256];
+    int headerLength = snprintf(header, sizeof(header),
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+        "Content-Length: %d\r\n"
+        "Connection: close\r\n\r\n", bodyLength);
+
+    // Clients still sending the previous response keep their own reference to it
+    auto response = std::make_shared<std::string>(header, headerLength);
+    response->append(body, bodyLength);
+    m_response = std::move(response);
+}
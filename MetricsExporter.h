@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Clock.h"
+#include "MetricsSnapshot.h"
+
+#define EXPORTER_MAX_CLIENTS 64              // Further connections wait in the listen backlog
+#define EXPORTER_CLIENT_TIMEOUT_MS 1000      // To send the request and take the whole response
+#define EXPORTER_REQUEST_LIMIT 2048          // Request head bytes kept; the rest is ignored
+
+// Loopback-only HTTP endpoint serving the latest MetricsSnapshot in OpenMetrics text format.
+// Publish() just copies the snapshot under a short lock; everything else (accepting,
+// formatting, sending) happens on the exporter's own thread. The response is formatted
+// once per published snapshot and shared by every scrape until the next one.
+// All sockets are non-blocking and tracked by one event loop, so a client that connects and
+// then stalls only holds its own slot until its deadline; it never delays other scrapes.
+class MetricsExporter {
+public:
+    explicit MetricsExporter(const Clock& clock = Clock::System());
+    ~MetricsExporter();
+
+    // Bind 127.0.0.1:port and start serving (port 0 picks a free one, see GetPort).
+    // Returns false if the port can't be bound.
+    bool Start(uint16_t port);
+    void Stop();
+    bool IsRunning() const { return m_running; }
+    uint16_t GetPort() const { return m_port; }
+
+    void Publish(const MetricsSnapshot& snapshot);
+
+    uint64_t GetScrapeCount() const { return m_scrapes; }
+    uint64_t GetTimedOutCount() const { return m_timedOut; }
+
+private:
+    struct Client {
+        uintptr_t socket = 0;
+        uint64_t deadlineMs = 0;
+        char request[EXPORTER_REQUEST_LIMIT];
+        size_t requestLength = 0;
+        std::shared_ptr<const std::string> response;    // Set once the request head is in
+        size_t sent = 0;
+        bool scrape = false;
+    };
+
+    void ServeLoop();
+    bool WaitForActivity(uint64_t nowMs);    // False once Stop was called
+    void AcceptClients(uint64_t nowMs);
+    void ServiceClients(size_t first, uint64_t nowMs);
+    bool ServiceClient(Client& client, uint64_t nowMs);    // False once the client is finished
+    void RebuildResponse();
+
+    const Clock& m_clock;
+
+    // Socket handles are kept as plain integers so this header doesn't pull in winsock2.h
+    uintptr_t m_listenSocket;
+#ifdef _WIN32
+    void* m_socketEvent;    // Shared by the listener and every client (WSAEventSelect)
+    void* m_stopEvent;
+#else
+    int m_stopPipe[2];
+#endif
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+    uint16_t m_port;
+
+    std::mutex m_snapshotMutex;
+    MetricsSnapshot m_snapshot;
+    uint64_t m_publishedVersion;       // Guarded by m_snapshotMutex
+
+    // Exporter thread only
+    std::vector<std::unique_ptr<Client>> m_clients;
+    uint64_t m_formattedVersion;
+    std::shared_ptr<const std::string> m_response;
+    std::atomic<uint64_t> m_scrapes;
+    std::atomic<uint64_t> m_timedOut;
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+// Latest values of the headline metrics, as published to external consumers
+// (the OpenMetrics exporter and the shared-memory region)
+struct MetricsSnapshot {
+    uint64_t timestampNs = 0;          // Clock::System() time of publication
+    double cpuUsagePercent = 0.0;
+    double cpuTemperatureCelsius = 0.0;
+    uint64_t memoryUsedBytes = 0;
+    uint64_t memoryTotalBytes = 0;
+    double downloadBytesPerSec = 0.0;
+    double uploadBytesPerSec = 0.0;
+    int32_t batteryPercent = -1;       // -1 = no battery
+    int32_t batteryCharging = 0;
+};
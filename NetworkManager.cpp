@@ -6,9 +6,6 @@
 #pragma comment(lib, "ole32.lib")
 
 NetworkManager::NetworkManager() :
-    m_lastInBytes(0),
-    m_lastOutBytes(0),
-    m_lastTickCount(0),
     m_downloadSpeed(0.0f),
     m_uploadSpeed(0.0f),
     m_wifiEnabled(true),
@@ -23,25 +20,24 @@ NetworkManager::~NetworkManager()
     // Nothing to clean up
 }
 
+// Speeds are refreshed by UpdateSpeeds (driven by the overlay's metric collection)
 float NetworkManager::GetDownloadSpeed()
 {
-    UpdateSpeeds();
     return m_downloadSpeed;
 }
 
 float NetworkManager::GetUploadSpeed()
 {
-    UpdateSpeeds();
     return m_uploadSpeed;
 }
 
 void NetworkManager::UpdateSpeeds()
 {
     // Don't update too frequently
-    DWORD currentTickCount = GetTickCount();
-    if (m_lastTickCount != 0 && currentTickCount - m_lastTickCount < 1000)
+    uint64_t sampleNs = m_clock->NowNs();
+    if (m_hasBaseline && sampleNs - m_lastSampleNs < static_cast<uint64_t>(m_updateIntervalMs) * 1000000)
     {
-        return; // Only update once per second
+        return; // Only update once per interval (1s by default)
     }
     
     // Get adapter info
@@ -56,9 +52,13 @@ void NetworkManager::UpdateSpeeds()
         return;
     }
     
-    // Sum up all bytes in/out across all network interfaces
-    ULONG64 totalInBytes = 0;
-    ULONG64 totalOutBytes = 0;
+    // Timestamp taken right after reading the counters, so the rates use the real elapsed time
+    sampleNs = m_clock->NowNs();
+    
+    // Sum up the rates across all network interfaces
+    double inRate = 0.0;
+    double outRate = 0.0;
+    bool hasRate = false;
     
     for (DWORD i = 0; i < ifTable->dwNumEntries; i++)
     {
@@ -69,35 +69,85 @@ void NetworkManager::UpdateSpeeds()
             (row.dwOperStatus == IF_OPER_STATUS_OPERATIONAL || 
              row.dwOperStatus == IF_OPER_STATUS_CONNECTED))
         {
-            totalInBytes += row.dwInOctets;
-            totalOutBytes += row.dwOutOctets;
+            InterfaceRates& rates = m_interfaceRates[row.dwIndex];
+            rates.lastSeenNs = sampleNs;
+            
+            // The first reading of a new interface only sets its baseline
+            bool inReady = rates.in.Update(row.dwInOctets, sampleNs);
+            bool outReady = rates.out.Update(row.dwOutOctets, sampleNs);
+            if (inReady && outReady)
+            {
+                inRate += rates.in.Get();
+                outRate += rates.out.Get();
+                hasRate = true;
+            }
         }
     }
     
-    // Calculate speeds
-    if (m_lastTickCount > 0)
+    // Forget interfaces that went away
+    for (auto it = m_interfaceRates.begin(); it != m_interfaceRates.end(); )
+    {
+        if (it->second.lastSeenNs != sampleNs)
+            it = m_interfaceRates.erase(it);
+        else
+            ++it;
+    }
+    
+    // Speeds in MB/s
+    if (hasRate)
     {
-        float timeDelta = (currentTickCount - m_lastTickCount) / 1000.0f; // Convert to seconds
+        m_downloadSpeed = static_cast<float>(inRate / (1024 * 1024));
+        m_uploadSpeed = static_cast<float>(outRate / (1024 * 1024));
+        m_speedTimestampNs = sampleNs;
+    }
+    
+    // Store the sample time for the interval gate
+    m_lastSampleNs = sampleNs;
+    m_hasBaseline = true;
+}
+
+// Uses the 64-bit MIB_IF_ROW2 counters, so infrequent reads (e.g. while hidden) can't miss a wrap
+bool NetworkManager::ReadInterfaceTraffic(std::vector<InterfaceTraffic>& interfaces)
+{
+    interfaces.clear();
+    
+    PMIB_IF_TABLE2 table = NULL;
+    if (GetIfTable2(&table) != NO_ERROR)
+    {
+        return false;
+    }
+    
+    for (ULONG i = 0; i < table->NumEntries; i++)
+    {
+        const MIB_IF_ROW2& row = table->Table[i];
         
-        if (timeDelta > 0)
+        // Only physical adapters: filter and virtual layers report the same traffic again
+        if (!row.InterfaceAndOperStatusFlags.HardwareInterface || row.Type == IF_TYPE_SOFTWARE_LOOPBACK)
         {
-            // Calculate speeds in MB/s
-            float inDelta = static_cast<float>(totalInBytes - m_lastInBytes);
-            float outDelta = static_cast<float>(totalOutBytes - m_lastOutBytes);
-            
-            m_downloadSpeed = (inDelta / (1024 * 1024)) / timeDelta;
-            m_uploadSpeed = (outDelta / (1024 * 1024)) / timeDelta;
-            
-            // Handle edge cases (like counter rollover)
-            if (m_downloadSpeed < 0) m_downloadSpeed = 0;
-            if (m_uploadSpeed < 0) m_uploadSpeed = 0;
+            continue;
         }
+        
+        InterfaceTraffic traffic;
+        traffic.id = row.InterfaceLuid.Value;
+        traffic.rxBytes = row.InOctets;
+        traffic.txBytes = row.OutOctets;
+        interfaces.push_back(traffic);
     }
     
-    // Store current values for next calculation
-    m_lastInBytes = totalInBytes;
-    m_lastOutBytes = totalOutBytes;
-    m_lastTickCount = currentTickCount;
+    FreeMibTable(table);
+    return true;
+}
+
+// Drop the previous sample and take a fresh baseline, so the next rate isn't
+// averaged over a long idle period (e.g. while the overlay was hidden)
+void NetworkManager::ResetSpeedBaseline()
+{
+    m_hasBaseline = false;
+    m_interfaceRates.clear();
+    m_speedTimestampNs = 0;
+    m_downloadSpeed = 0.0f;
+    m_uploadSpeed = 0.0f;
+    UpdateSpeeds();
 }
 
 std::string NetworkManager::GetCurrentNetworkName()
@@ -265,6 +315,9 @@ bool NetworkManager::IsWifiEnabled()
 
 void NetworkManager::ScanNetworks()
 {
+    if (!m_scanAllowed)
+        return;
+    
     m_scanning = true;
     
     // Clear existing networks
@@ -7,12 +7,17 @@
 #include <utility>
 #include <wlanapi.h>
 #include <algorithm>
+#include <map>
+#include "Clock.h"
+#include "Estimators.h"
+#include "TrafficAccountant.h"
 
 // Settings for network
 struct NetworkSettings {
     bool showNetworkDetails = true;
     bool alwaysOnTop = false;
     bool savePosition = true;
+    float monthlyCapGB = 0.0f;    // Data usage cap, 0 = none
 };
 
 class NetworkManager {
@@ -33,6 +38,19 @@ public:
 
     // Update network statistics
     void UpdateSpeeds();
+    void ResetSpeedBaseline();
+    void SetUpdateInterval(DWORD intervalMs) { m_updateIntervalMs = intervalMs; }
+    void SetClock(const Clock& clock) { m_clock = &clock; }
+    
+    // Acquisition time (Clock::NowNs) of the current speed values, 0 before the first rate
+    uint64_t GetSpeedTimestamp() const { return m_speedTimestampNs; }
+    
+    // 64-bit byte counters of every physical adapter, for data-usage accounting
+    bool ReadInterfaceTraffic(std::vector<InterfaceTraffic>& interfaces);
+    
+    // Power policy can pause Wi-Fi scans
+    void SetScanningAllowed(bool allowed) { m_scanAllowed = allowed; }
+    bool IsScanningAllowed() const { return m_scanAllowed; }
     
     // Get list of available networks
     const std::vector<std::pair<std::string, std::string>>& GetAvailableNetworks() const { return m_availableNetworks; }
@@ -42,15 +60,26 @@ public:
 
 private:
     // Network statistics
-    ULONG64 m_lastInBytes = 0;
-    ULONG64 m_lastOutBytes = 0;
-    DWORD m_lastTickCount = 0;
+    // The interface table's octet counters are 32-bit and wrap, so rates are
+    // taken per interface (keyed by dwIndex) and summed
+    struct InterfaceRates {
+        CounterRate<DWORD> in;
+        CounterRate<DWORD> out;
+        uint64_t lastSeenNs = 0;
+    };
+    std::map<DWORD, InterfaceRates> m_interfaceRates;
+    uint64_t m_lastSampleNs = 0;
+    uint64_t m_speedTimestampNs = 0;
+    bool m_hasBaseline = false;
+    DWORD m_updateIntervalMs = 1000;
+    const Clock* m_clock = &Clock::System();
     float m_downloadSpeed = 0.0f;
     float m_uploadSpeed = 0.0f;
     
     // Network state
     bool m_wifiEnabled = true;
     bool m_scanning = false;
+    bool m_scanAllowed = true;
     std::string m_currentNetwork;
     std::vector<std::pair<std::string, std::string>> m_availableNetworks;  // Name, SSID
 
@@ -0,0 +1,181 @@
+#include "NtProcessBackend.h"
+#include <cstring>
+
+// SystemProcessInformation class and its record layout, followed by one thread record per
+// thread (winternl.h only exposes these fields as reserved)
+static const ULONG SYSTEM_PROCESS_INFORMATION_CLASS = 5;
+static const LONG STATUS_INFO_LENGTH_MISMATCH_CODE = (LONG)0xC0000004L;
+
+struct NtUnicodeString {
+    USHORT Length;
+    USHORT MaximumLength;
+    PWSTR Buffer;
+};
+
+struct NtProcessInformation {
+    ULONG NextEntryOffset;
+    ULONG NumberOfThreads;
+    LARGE_INTEGER WorkingSetPrivateSize;
+    ULONG HardFaultCount;
+    ULONG NumberOfThreadsHighWatermark;
+    ULONGLONG CycleTime;
+    LARGE_INTEGER CreateTime;
+    LARGE_INTEGER UserTime;
+    LARGE_INTEGER KernelTime;
+    NtUnicodeString ImageName;
+    LONG BasePriority;
+    HANDLE UniqueProcessId;
+    HANDLE InheritedFromUniqueProcessId;
+    ULONG HandleCount;
+    ULONG SessionId;
+    ULONG_PTR UniqueProcessKey;
+    SIZE_T PeakVirtualSize;
+    SIZE_T VirtualSize;
+    ULONG PageFaultCount;
+    SIZE_T PeakWorkingSetSize;
+    SIZE_T WorkingSetSize;
+    SIZE_T QuotaPeakPagedPoolUsage;
+    SIZE_T QuotaPagedPoolUsage;
+    SIZE_T QuotaPeakNonPagedPoolUsage;
+    SIZE_T QuotaNonPagedPoolUsage;
+    SIZE_T PagefileUsage;           // Private bytes
+    SIZE_T PeakPagefileUsage;
+    SIZE_T PrivatePageCount;
+    LARGE_INTEGER ReadOperationCount;
+    LARGE_INTEGER WriteOperationCount;
+    LARGE_INTEGER OtherOperationCount;
+    LARGE_INTEGER ReadTransferCount;
+    LARGE_INTEGER WriteTransferCount;
+    LARGE_INTEGER OtherTransferCount;
+};
+
+struct NtThreadInformation {
+    LARGE_INTEGER KernelTime;
+    LARGE_INTEGER UserTime;
+    LARGE_INTEGER CreateTime;
+    ULONG WaitTime;
+    PVOID StartAddress;
+    HANDLE UniqueProcess;
+    HANDLE UniqueThread;
+    LONG Priority;
+    LONG BasePriority;
+    ULONG ContextSwitches;
+    ULONG ThreadState;
+    ULONG WaitReason;
+};
+
+static NtQuerySystemInformationFn LoadQueryFunction()
+{
+    HMODULE ntdll = GetModuleHandleW(L"ntdll.dll");
+    return ntdll ? reinterpret_cast<NtQuerySystemInformationFn>(GetProcAddress(ntdll, "NtQuerySystemInformation")) : nullptr;
+}
+
+// Fetch the whole process list, growing the buffer until it fits (processes can start between calls)
+static bool QueryProcessList(NtQuerySystemInformationFn query, std::vector<BYTE>& buffer)
+{
+    if (!query)
+        return false;
+    
+    LONG status;
+    ULONG needed = 0;
+    while ((status = query(SYSTEM_PROCESS_INFORMATION_CLASS, buffer.data(),
+                           static_cast<ULONG>(buffer.size()), &needed)) == STATUS_INFO_LENGTH_MISMATCH_CODE)
+    {
+        buffer.resize(needed > buffer.size() ? needed + 64 * 1024 : buffer.size() * 2);
+    }
+    return status >= 0;
+}
+
+NtProcessBackend::NtProcessBackend() :
+    m_query(LoadQueryFunction()),
+    m_buffer(256 * 1024)
+{
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    m_processorCount = static_cast<int>(systemInfo.dwNumberOfProcessors);
+}
+
+bool NtProcessBackend::Snapshot(std::vector<ProcessRecord>& records)
+{
+    if (!QueryProcessList(m_query, m_buffer))
+        return false;
+    
+    records.clear();
+    const BYTE* cursor = m_buffer.data();
+    for (;;)
+    {
+        const NtProcessInformation* info = reinterpret_cast<const NtProcessInformation*>(cursor);
+        
+        ProcessRecord record;
+        record.pid = static_cast<uint32_t>(reinterpret_cast<ULONG_PTR>(info->UniqueProcessId));
+        record.startTime = static_cast<uint64_t>(info->CreateTime.QuadPart);
+        record.cpuTimeNs = static_cast<uint64_t>(info->UserTime.QuadPart + info->KernelTime.QuadPart) * 100;  // 100ns units
+        record.workingSet = info->WorkingSetSize;
+        
+        // The idle process has no image name
+        if (info->ImageName.Buffer && info->ImageName.Length > 0)
+        {
+            int length = WideCharToMultiByte(CP_UTF8, 0, info->ImageName.Buffer, info->ImageName.Length / sizeof(WCHAR),
+                                             record.name, PROCESS_NAME_LENGTH - 1, nullptr, nullptr);
+            record.name[length > 0 ? length : 0] = '\0';
+        }
+        else
+        {
+            strcpy_s(record.name, record.pid == 0 ? "System Idle Process" : "System");
+        }
+        
+        // The idle process "uses" all spare CPU; leave it out of the rankings
+        if (record.pid != 0)
+            records.push_back(record);
+        
+        if (info->NextEntryOffset == 0)
+            break;
+        cursor += info->NextEntryOffset;
+    }
+    
+    return true;
+}
+
+NtSelfBackend::NtSelfBackend() :
+    m_query(LoadQueryFunction()),
+    m_buffer(256 * 1024),
+    m_pid(GetCurrentProcessId())
+{
+}
+
+bool NtSelfBackend::Snapshot(SelfProcessRecord& process, std::vector<SelfThreadRecord>& threads)
+{
+    if (!QueryProcessList(m_query, m_buffer))
+        return false;
+    
+    const BYTE* cursor = m_buffer.data();
+    for (;;)
+    {
+        const NtProcessInformation* info = reinterpret_cast<const NtProcessInformation*>(cursor);
+        if (reinterpret_cast<ULONG_PTR>(info->UniqueProcessId) == m_pid)
+        {
+            process.workingSet = info->WorkingSetSize;
+            process.privateBytes = info->PagefileUsage;
+            process.handleCount = info->HandleCount;
+            
+            const NtThreadInformation* thread = reinterpret_cast<const NtThreadInformation*>(info + 1);
+            threads.clear();
+            for (ULONG i = 0; i < info->NumberOfThreads; i++, thread++)
+            {
+                SelfThreadRecord record;
+                record.threadId = static_cast<uint32_t>(reinterpret_cast<ULONG_PTR>(thread->UniqueThread));
+                record.cpuTimeNs = static_cast<uint64_t>(thread->UserTime.QuadPart + thread->KernelTime.QuadPart) * 100;
+                record.contextSwitches = thread->ContextSwitches;
+                record.name[0] = '\0';
+                threads.push_back(record);
+            }
+            return true;
+        }
+        
+        if (info->NextEntryOffset == 0)
+            break;
+        cursor += info->NextEntryOffset;
+    }
+    
+    return false;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <windows.h>
+#include <vector>
+#include "ProcessSampler.h"
+#include "SelfMonitor.h"
+
+typedef LONG (NTAPI* NtQuerySystemInformationFn)(ULONG, PVOID, ULONG, PULONG);
+
+// Process sampler backend built on NtQuerySystemInformation(SystemProcessInformation),
+// which returns every process in one call without opening any process handles
+class NtProcessBackend : public IProcessBackend {
+public:
+    NtProcessBackend();
+
+    bool Snapshot(std::vector<ProcessRecord>& records) override;
+    int GetProcessorCount() const override { return m_processorCount; }
+
+private:
+    NtQuerySystemInformationFn m_query;
+    std::vector<BYTE> m_buffer;     // Reused between snapshots, grown on demand
+    int m_processorCount;
+};
+
+// Self monitor backend on the same call: our own record carries handle count, memory and
+// every thread's CPU times and context switches
+class NtSelfBackend : public ISelfBackend {
+public:
+    NtSelfBackend();
+
+    bool Snapshot(SelfProcessRecord& process, std::vector<SelfThreadRecord>& threads) override;
+
+private:
+    NtQuerySystemInformationFn m_query;
+    std::vector<BYTE> m_buffer;
+    DWORD m_pid;
+};
@@ -7,10 +7,17 @@
 #include <wbemidl.h>
 #include <comdef.h>
 #include <queue>
+#include <algorithm>
 #include <mmdeviceapi.h>
 #include <endpointvolume.h>
 #include <functiondiscoverykeys_devpkey.h>
 #include <shlobj.h>
+#include <shellapi.h>
+#include <cmath>
+#include "PdhCounterBackend.h"
+#include "NtProcessBackend.h"
+#include "PdhStorageBackend.h"
+#include "IpHelperConnectionBackend.h"
 
 #pragma comment(lib, "dwmapi.lib")
 #pragma comment(lib, "d3d11.lib")
@@ -19,63 +26,23 @@
 #pragma comment(lib, "wbemuuid.lib")
 #pragma comment(lib, "Ole32.lib")
 
-// Global variables for the keyboard hook
-HHOOK g_keyboardHook = NULL;
-HWND g_overlayHwnd = NULL;
-
 // Forward declare message handler from imgui_impl_win32.cpp
 extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
-// Keyboard hook procedure
-LRESULT CALLBACK LowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam)
+// Glyphs the UI draws: Latin-1 for text and device/process/network names, plus the symbols
+// and emoji used as icons. Anything else renders as the fallback glyph.
+static const ImWchar s_fontGlyphRanges[] =
 {
-    static bool altKeyPressed = false;
-    
-    if (nCode == HC_ACTION)
-    {
-        KBDLLHOOKSTRUCT* kbStruct = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
-        
-        // Check for Alt key (VK_LMENU or VK_RMENU)
-        if (kbStruct->vkCode == VK_LMENU || kbStruct->vkCode == VK_RMENU)
-        {
-            if (wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN)
-            {
-                altKeyPressed = true;
-            }
-            else if (wParam == WM_KEYUP || wParam == WM_SYSKEYUP)
-            {
-                altKeyPressed = false;
-            }
-        }
-        // Check for Space key while Alt is pressed
-        else if (altKeyPressed && kbStruct->vkCode == VK_SPACE)
-        {
-            if (wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN)
-            {
-                // Send message to toggle overlay
-                if (g_overlayHwnd)
-                {
-                    PostMessage(g_overlayHwnd, WM_TOGGLE_OVERLAY, 0, 0);
-                }
-            }
-        }
-        // Check for Enter key to close the overlay when it's visible
-        else if (kbStruct->vkCode == VK_RETURN)
-        {
-            if (wParam == WM_KEYDOWN)
-            {
-                // Send message to toggle off overlay if it's currently visible
-                if (g_overlayHwnd)
-                {
-                    // We'll use a different message specifically for hiding
-                    PostMessage(g_overlayHwnd, WM_TOGGLE_OVERLAY, 1, 0);
-                }
-            }
-        }
-    }
-    
-    return CallNextHookEx(NULL, nCode, wParam, lParam);
-}
+    0x0020, 0x00FF,     // Basic Latin + Latin-1 Supplement
+    0x2026, 0x2026,     // Ellipsis for clipped text
+    0x21BB, 0x21BB,     // Refresh arrow
+    0x2699, 0x2699,     // Gear
+    0x1F4F6, 0x1F4F6,   // Signal bars
+    0x1F507, 0x1F507,   // Muted speaker
+    0x1F50A, 0x1F50C,   // Speaker, battery, plug
+    0x1F6D1, 0x1F6D1,   // Stop sign
+    0,
+};
 
 LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
 {
@@ -105,6 +72,44 @@ LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
             }
             return 0;
         }
+    case WM_HOTKEY:
+        {
+            // Registered global chords
+            overlay = reinterpret_cast<Overlay*>(GetWindowLongPtr(hWnd, GWLP_USERDATA));
+            if (overlay)
+            {
+                uint8_t action = overlay->m_hotkeyManager.GetActionForHotkeyId(wParam);
+                if (action == HOTKEY_ACTION_TOGGLE)
+                    overlay->Toggle();
+                else if (action == HOTKEY_ACTION_DUMP_TRACE)
+                    overlay->OnTraceHotkey();
+            }
+            return 0;
+        }
+    case WM_HOTKEY_ACTION:
+        {
+            // Chords the keyboard hook matched that aren't show/hide
+            overlay = reinterpret_cast<Overlay*>(GetWindowLongPtr(hWnd, GWLP_USERDATA));
+            if (overlay && wParam == HOTKEY_ACTION_DUMP_TRACE)
+            {
+                overlay->OnTraceHotkey();
+            }
+            return 0;
+        }
+    case WM_TIMER:
+        {
+            overlay = reinterpret_cast<Overlay*>(GetWindowLongPtr(hWnd, GWLP_USERDATA));
+            if (overlay && wParam == TRAFFIC_TIMER_ID)
+            {
+                overlay->UpdateTrafficAccounting();
+            }
+            else if (overlay && wParam == BACKGROUND_TIMER_ID && !overlay->m_isVisible)
+            {
+                // While visible the frame loop collects; while hidden this tick does
+                overlay->CollectMetrics();
+            }
+            return 0;
+        }
     case WM_SIZE:
         {
             overlay = reinterpret_cast<Overlay*>(GetWindowLongPtr(hWnd, GWLP_USERDATA));
@@ -116,6 +121,16 @@ LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
             }
             return 0;
         }
+    case WM_POWERBROADCAST:
+        {
+            // Sent on AC/DC switches and battery percentage changes
+            overlay = reinterpret_cast<Overlay*>(GetWindowLongPtr(hWnd, GWLP_USERDATA));
+            if (overlay && wParam == PBT_APMPOWERSTATUSCHANGE)
+            {
+                overlay->UpdatePowerStatus();
+            }
+            return TRUE;
+        }
     case WM_SYSCOMMAND:
         if ((wParam & 0xfff0) == SC_KEYMENU) // Disable ALT application menu
             return 0;
@@ -135,17 +150,45 @@ Overlay::Overlay() :
     m_mainRenderTargetView(nullptr), 
     m_isRunning(false), 
     m_isVisible(false),
-    m_cpuQuery(NULL), 
-    m_cpuTotal(NULL), 
-    m_pdh_initialized(false), 
+    m_counterRegistry(std::make_unique<PdhCounterBackend>()),
     m_smoothedCpuUsage(0),
+    m_cpuHistory(CPU_SPARKLINE_SECONDS),
+    m_cpuSparkline(DECIMATE_MINMAX),
     m_showSettings(false),
     m_showAudioWindow(false),
     m_showNetworkWindow(false),
     m_showAudioSettings(false),
     m_showNetworkSettings(false),
     m_mouseInsideAudioWindow(false),
-    m_mouseInsideNetworkWindow(false)
+    m_mouseInsideNetworkWindow(false),
+    m_cpuWidgetSub(m_subscriptions, METRIC_CPU_USAGE),
+    m_countersWidgetSub(m_subscriptions, METRIC_SYSTEM_COUNTERS),
+    m_temperatureWidgetSub(m_subscriptions, METRIC_CPU_TEMPERATURE),
+    m_memoryWidgetSub(m_subscriptions, METRIC_MEMORY),
+    m_batteryWidgetSub(m_subscriptions, METRIC_BATTERY),
+    m_networkSpeedWidgetSub(m_subscriptions, METRIC_NETWORK_SPEED),
+    m_networkDetailsWidgetSub(m_subscriptions, METRIC_NETWORK_DETAILS),
+    m_processesWidgetSub(m_subscriptions, METRIC_PROCESSES),
+    m_storageWidgetSub(m_subscriptions, METRIC_STORAGE),
+    m_connectionsWidgetSub(m_subscriptions, METRIC_CONNECTIONS),
+    m_selfWidgetSub(m_subscriptions, METRIC_SELF),
+    m_cpuExporterSub(m_subscriptions, METRIC_CPU_USAGE),
+    m_temperatureExporterSub(m_subscriptions, METRIC_CPU_TEMPERATURE),
+    m_memoryExporterSub(m_subscriptions, METRIC_MEMORY),
+    m_batteryExporterSub(m_subscriptions, METRIC_BATTERY),
+    m_networkSpeedExporterSub(m_subscriptions, METRIC_NETWORK_SPEED),
+    m_cpuAlertSub(m_subscriptions, METRIC_CPU_USAGE),
+    m_temperatureAlertSub(m_subscriptions, METRIC_CPU_TEMPERATURE),
+    m_memoryAlertSub(m_subscriptions, METRIC_MEMORY),
+    m_batteryAlertSub(m_subscriptions, METRIC_BATTERY),
+    m_networkSpeedAlertSub(m_subscriptions, METRIC_NETWORK_SPEED),
+    m_networkDetailsAlertSub(m_subscriptions, METRIC_NETWORK_DETAILS),
+    m_adaptiveSampler(METRIC_COUNT),
+    m_processSampler(std::make_unique<NtProcessBackend>()),
+    m_selfMonitor(std::make_unique<NtSelfBackend>()),
+    m_fontCache(GetFontCachePath()),
+    m_storageMonitor(std::make_unique<PdhStorageBackend>()),
+    m_connectionMonitor(std::make_unique<IpHelperConnectionBackend>())
 {
     // Initialize audio settings
     m_settings.audioSettings.showVisualizer = true;  // Make sure this is true
@@ -154,12 +197,22 @@ Overlay::Overlay() :
     m_settings.audioSettings.alwaysOnTop = false;
     m_settings.audioSettings.savePosition = true;
     
+    // Also precomputes the circle style's trig tables
+    m_visualizerGeometry.SetBands(VISUALIZER_BANDS);
+    m_visualizerFrame.resize(VISUALIZER_BANDS, 0.0f);
+    m_visualizerPeakFrame.resize(VISUALIZER_BANDS, 0.0f);
+    
     m_settings.networkSettings.showNetworkDetails = true;
     m_settings.networkSettings.alwaysOnTop = false;
     m_settings.networkSettings.savePosition = true;
     
-    // Initialize PDH
-    InitializeCpuCounter();
+    // Declare performance counters (the query is opened when the overlay is shown)
+    DeclareCounters();
+    
+    // The adaptive sampler decides when to collect, so the registry collects on every Tick
+    m_counterRegistry.SetInterval(0);
+    ConfigureAdaptiveSampling();
+    AddCollectorJobs();
     
     // AudioManager and NetworkManager are automatically initialized by their constructors
 }
@@ -181,9 +234,6 @@ bool Overlay::Initialize()
                          0, 0, GetSystemMetrics(SM_CXSCREEN), GetSystemMetrics(SM_CYSCREEN), 
                          nullptr, nullptr, wc.hInstance, nullptr);
 
-    // Store global window handle for the keyboard hook
-    g_overlayHwnd = m_hwnd;
-
     // Store pointer to this Overlay instance in window user data
     SetWindowLongPtr(m_hwnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
                         
@@ -210,8 +260,11 @@ bool Overlay::Initialize()
     ShowWindow(m_hwnd, SW_HIDE); // Hide initially
     m_isVisible = false;
 
-    // Setup Dear ImGui context
+    // Setup Dear ImGui context (its allocations count towards the self monitor's figures)
     IMGUI_CHECKVERSION();
+    ImGui::SetAllocatorFunctions(
+        [](size_t size, void*) -> void* { SelfMonitor::CountAllocation(); return malloc(size); },
+        [](void* block, void*) { free(block); });
     ImGui::CreateContext();
     ImGuiIO& io = ImGui::GetIO();
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
@@ -219,8 +272,9 @@ bool Overlay::Initialize()
     // Increase font size - add these lines
     ImFontConfig fontConfig;
     fontConfig.SizePixels = 16.0f; // Increase font size (default is usually around 13)
-    ImFont* emojiFont = io.Fonts->AddFontFromFileTTF(
-        "C:\\Windows\\Fonts\\seguiemj.ttf", 13.5f, NULL, io.Fonts->GetGlyphRangesDefault());
+    
+    // Baked once, then loaded prebaked from the font cache on later launches
+    ImFont* emojiFont = m_fontCache.LoadOrBuild(io.Fonts, "C:\\Windows\\Fonts\\seguiemj.ttf", 13.5f, s_fontGlyphRanges);
     if (emojiFont)
     {
         io.FontDefault = emojiFont; // Make it the universal font
@@ -240,16 +294,39 @@ bool Overlay::Initialize()
     ImGui_ImplWin32_Init(m_hwnd);
     ImGui_ImplDX11_Init(m_pd3dDevice, m_pd3dDeviceContext);
 
-    // Set up keyboard hook
-    g_keyboardHook = SetWindowsHookEx(WH_KEYBOARD_LL, LowLevelKeyboardProc, GetModuleHandle(NULL), 0);
-    if (!g_keyboardHook)
+    // Load settings if available
+    LoadSettings();
+    TraceRecorder::Instance().SetThreadName("Render");
+    TraceRecorder::Instance().SetEnabled(m_settings.traceRecording);
+
+    // Set up hotkeys (registered hotkeys, keyboard hook only where needed)
+    if (!m_hotkeyManager.Initialize(m_hwnd, m_settings.hotkeys))
     {
         MessageBoxW(NULL, L"Failed to set keyboard hook", L"Error", MB_OK | MB_ICONERROR);
         return false;
     }
 
-    // Load settings if available
-    LoadSettings();
+    // Data usage is kept next to the settings file; the first reading is just the baseline
+    std::string settingsPath = GetSettingsFilePath();
+    m_trafficAccountant.Open(settingsPath.substr(0, settingsPath.find_last_of('\\') + 1) + "traffic");
+    UpdateTrafficAccounting();
+    SetTimer(m_hwnd, TRAFFIC_TIMER_ID, TRAFFIC_INTERVAL_MS, NULL);
+
+    // Slow providers run on their own thread from here on
+    m_collector.Start();
+    
+    // Overlay starts hidden, so put background work to sleep straight away
+    RegisterSubsystems();
+    m_activityGovernor.OnOverlayHidden();
+    
+    // Pick the initial power profile; apply it even when it's the default one, or its
+    // sampling budget and scan/visualizer limits would wait for the first power event
+    UpdatePowerStatus(true);
+    
+    // Start external publication and alert rules if enabled (after the subsystems exist)
+    ApplyPublishingSettings();
+    ApplyAlertSettings();
+    ApplyPluginSettings(false);
 
     m_isRunning = true;
     return true;
@@ -272,27 +349,41 @@ void Overlay::Run()
         // Only render if visible
         if (m_isVisible)
         {
-            // Start the Dear ImGui frame
-            ImGui_ImplDX11_NewFrame();
-            ImGui_ImplWin32_NewFrame();
-            ImGui::NewFrame();
-
-            // Render the overlay elements
-            RenderOverlay();
-
-            // Rendering
-            ImGui::Render();
-            const float clear_color_with_alpha[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
-            m_pd3dDeviceContext->OMSetRenderTargets(1, &m_mainRenderTargetView, NULL);
-            m_pd3dDeviceContext->ClearRenderTargetView(m_mainRenderTargetView, clear_color_with_alpha);
-            ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
-
-            m_pSwapChain->Present(1, 0); // Present with vsync
+            {
+                LatencyScope frameScope(LATENCY_FRAME_BUILD);
+                
+                // Start the Dear ImGui frame
+                ImGui_ImplDX11_NewFrame();
+                ImGui_ImplWin32_NewFrame();
+                ImGui::NewFrame();
+
+                // Render the overlay elements
+                RenderOverlay();
+
+                // Rendering
+                ImGui::Render();
+                const float clear_color_with_alpha[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                m_pd3dDeviceContext->OMSetRenderTargets(1, &m_mainRenderTargetView, NULL);
+                m_pd3dDeviceContext->ClearRenderTargetView(m_mainRenderTargetView, clear_color_with_alpha);
+                ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+            }
+
+            // With a cap the pacer times frames, so don't also block on vsync
+            int frameCap = GetFrameCap();
+            m_framePacer.SetTargetFps(frameCap);
+            {
+                LatencyScope presentScope(LATENCY_PRESENT);
+                m_pSwapChain->Present(frameCap > 0 ? 0 : 1, 0);
+            }
+            
+            m_framePacer.Wait();
         }
         else
         {
-            // When not visible, sleep to reduce CPU usage
-            Sleep(10);
+            // When not visible, block until the next message (hotkey, timer, ...) arrives.
+            // The pause isn't a frame interval, so start pacing afresh when shown again.
+            m_framePacer.Reset();
+            WaitMessage();
         }
     }
 }
@@ -300,8 +391,22 @@ void Overlay::Run()
 void Overlay::Toggle()
 {
     m_isVisible = !m_isVisible;
+    
+    // Resume subsystems before the first frame is drawn, suspend them once we're hidden
+    if (m_isVisible)
+        m_activityGovernor.OnOverlayShown();
+    
+    // The keyboard hook is only needed while visible (Enter to hide)
+    m_hotkeyManager.SetOverlayVisible(m_isVisible);
+    
     ShowWindow(m_hwnd, m_isVisible ? SW_SHOW : SW_HIDE);
     
+    if (!m_isVisible)
+    {
+        m_activityGovernor.OnOverlayHidden();
+        ReleaseWidgetSubscriptions();
+    }
+    
     // Update transparency settings based on visibility
     if (m_isVisible)
     {
@@ -321,6 +426,20 @@ void Overlay::RenderOverlay()
 {
     ImGuiIO& io = ImGui::GetIO();
     
+    // Sample whatever the visible widgets subscribed to (last frame's subscriptions)
+    CollectMetrics();
+    
+    const PowerProfile& profile = m_powerPolicy.GetProfile();
+    m_cpuWidgetSub.Request(m_settings.showCpuInfo, profile.sampleIntervalMs);
+    m_countersWidgetSub.Request(m_settings.showCpuInfo || m_settings.showMemoryInfo, profile.sampleIntervalMs);
+    m_temperatureWidgetSub.Request(m_settings.showCpuInfo && m_settings.showCpuTemperature, profile.sampleIntervalMs);
+    m_memoryWidgetSub.Request(m_settings.showMemoryInfo, 1000);
+    m_batteryWidgetSub.Request(m_settings.showBatteryInfo, 5000);
+    m_processesWidgetSub.Request(m_settings.showProcesses,
+        (std::max)(m_settings.processIntervalMs, profile.sampleIntervalMs));
+    m_storageWidgetSub.Request(m_settings.showStorageInfo && m_storageSectionOpen, profile.sampleIntervalMs);
+    m_selfWidgetSub.Request(m_settings.showSelfMonitor, 1000);
+    
     // Store the mouse position at the start of the frame
     static ImVec2 startDragPos;
     static bool dragging = false;
@@ -403,12 +522,24 @@ void Overlay::RenderOverlay()
         ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "CPU INFO");
         
         // Put CPU usage on its own line
-        ImGui::Text("Usage: %d%%", GetCPUUsage());
+        ImGui::Text("Usage: %d%%", m_cpuUsage);
+        if (m_cpuUsageRange.HasValue())
+        {
+            ImGui::SameLine();
+            ImGui::TextDisabled("(%d-%d%%)", m_cpuUsageRange.GetMin(), m_cpuUsageRange.GetMax());
+        }
+        RenderSparkline(m_cpuHistory, m_cpuSparkline, 0.0f, 100.0f);
+        if (m_counterRegistry.IsAvailable(m_counterQueueLength))
+        {
+            ImGui::TextDisabled("Run queue: %d   Context switches: %.0f/s",
+                (int)m_counterRegistry.GetValue(m_counterQueueLength),
+                m_counterRegistry.GetValue(m_counterContextSwitches));
+        }
         
         // CPU temperature on another line
         if (m_settings.showCpuTemperature)
         {
-            ImGui::Text("Temperature: %d°C", GetCPUTemperature());
+            ImGui::Text("Temperature: %d°C", m_cpuTemperature);
         }
         
         // Add a small spacing after the CPU section
@@ -418,7 +549,7 @@ void Overlay::RenderOverlay()
     if (m_settings.showMemoryInfo)
     {
         ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "MEMORY");
-        MEMORYSTATUSEX memInfo = GetMemoryInfo();
+        const MEMORYSTATUSEX& memInfo = m_memoryInfo;
         float usedMemoryGB = (float)(memInfo.ullTotalPhys - memInfo.ullAvailPhys) / (1024 * 1024 * 1024);
         float totalMemoryGB = (float)memInfo.ullTotalPhys / (1024 * 1024 * 1024);
         float memoryUsagePercent = (usedMemoryGB / totalMemoryGB) * 100.0f;
@@ -431,17 +562,25 @@ void Overlay::RenderOverlay()
         float barWidth = 200.0f;
         ImGui::SetCursorPosX((ImGui::GetWindowWidth() - barWidth) * 0.5f);
         ImGui::ProgressBar(memoryUsagePercent / 100.0f, ImVec2(barWidth, 8), "");
+        
+        if (m_counterRegistry.IsAvailable(m_counterCommitted))
+        {
+            ImGui::TextDisabled("Commit: %.0f%%   Page file: %.0f%%   Disk: %.1f MB/s",
+                m_counterRegistry.GetValue(m_counterCommitted),
+                m_counterRegistry.GetValue(m_counterPagingFile),
+                m_counterRegistry.GetValue(m_counterDiskBytes) / (1024 * 1024));
+        }
     }
         
     if (m_settings.showBatteryInfo)
     {
         ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "BATTERY");
         
-        int batteryPercent;
-        bool isCharging;
-        int remainingMinutes;
+        int batteryPercent = m_batteryPercent;
+        bool isCharging = m_batteryCharging;
+        int remainingMinutes = m_batteryMinutes;
         
-        if (GetBatteryStatus(batteryPercent, isCharging, remainingMinutes))
+        if (m_hasBattery)
         {
             // Battery percentage and status
             ImGui::Text("Level:");
@@ -492,6 +631,36 @@ void Overlay::RenderOverlay()
         
         ImGui::Spacing();
     }
+    
+    if (m_settings.showStorageInfo)
+    {
+        RenderStorage();
+    }
+    
+    if (m_settings.showProcesses)
+    {
+        RenderProcesses();
+    }
+    
+    if (m_settings.pluginsEnabled && m_pluginHost.GetPluginCount() > 0)
+    {
+        RenderPlugins();
+    }
+    
+    if (m_settings.showSelfMonitor)
+    {
+        RenderSelfMonitor();
+    }
+    
+    if (m_settings.showLatency)
+    {
+        RenderLatency();
+    }
+    
+    if (m_settings.showSubsystemStatus)
+    {
+        RenderSubsystemStatus();
+    }
         
     ImGui::PopStyleVar();  // Restore item spacing
     
@@ -507,7 +676,15 @@ void Overlay::RenderOverlay()
     {
         RenderNetworkWindow();
     }
-        
+    else
+    {
+        // Network collection only runs while its window is open
+        m_networkSpeedWidgetSub.Release();
+        m_networkDetailsWidgetSub.Release();
+        m_connectionsWidgetSub.Release();
+    }
+    
+    RenderAlertToast();
     
     // Draw background
     ImGui::SetNextWindowPos(ImVec2(0, 0));
@@ -537,204 +714,1290 @@ void Overlay::RenderOverlay()
                              io.MousePos.y >= windowPos.y &&
                              io.MousePos.y <= windowPos.y + windowSize.y);
     
-    // Only toggle OFF if click is outside all windows AND not in Flow Launcher
+    // Only toggle OFF if click is outside all windows AND not in a companion app (e.g. Flow Launcher)
     // AND no popup/combo is active
     if (ImGui::IsMouseClicked(0) && !mouseInsideWindow && !m_mouseInsideAudioWindow && 
-        !m_mouseInsideNetworkWindow && !IsClickedInFlowLauncher() && !popupOpen && !comboActive)
+        !m_mouseInsideNetworkWindow && !IsClickInCompanionWindow() && !popupOpen && !comboActive)
+    {
+        // Add a small delay to prevent immediate toggling
+        static uint64_t lastClickTime = 0;
+        uint64_t currentTime = Clock::System().NowMs();
+        
+        if (currentTime - lastClickTime > 200) { // 200ms debounce
+            Toggle();
+            lastClickTime = currentTime;
+        }
+    }
+}
+
+void Overlay::RenderSettingsPanel()
+{
+    ImGui::PushStyleColor(ImGuiCol_ChildBg, ImVec4(0.15f, 0.15f, 0.15f, 0.9f));
+    
+    // Use a more compact size and style for the settings panel
+    ImGui::BeginChild("SettingsPanel", ImVec2(ImGui::GetWindowWidth() * 0.9f, 240), true);
+    
+    ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "DISPLAY SETTINGS");
+    ImGui::Separator();
+    
+    // Use columns to make the settings more compact
+    ImGui::Columns(2, "SettingsColumns", false);
+    
+    // Left column
+    ImGui::Checkbox("CPU Info", &m_settings.showCpuInfo);
+    ImGui::Checkbox("Memory Info", &m_settings.showMemoryInfo);
+    ImGui::Checkbox("Battery Info", &m_settings.showBatteryInfo);  // Add this line
+    ImGui::Checkbox("Subsystems", &m_settings.showSubsystemStatus);
+    ImGui::Checkbox("Processes", &m_settings.showProcesses);
+    
+    // Right column
+    ImGui::NextColumn();
+    ImGui::Checkbox("CPU Temperature", &m_settings.showCpuTemperature);
+    ImGui::Checkbox("Network Info", &m_settings.showNetworkInfo);
+    ImGui::Checkbox("Storage", &m_settings.showStorageInfo);
+    ImGui::Checkbox("Latency", &m_settings.showLatency);
+    ImGui::Checkbox("Overhead", &m_settings.showSelfMonitor);
+    
+    // Add audio controls checkbox (either column works)
+    ImGui::Checkbox("Audio Controls", &m_settings.showAudioControls);
+    
+    // Reset columns
+    ImGui::Columns(1);
+    ImGui::Separator();
+    
+    // Power policy
+    const char* powerPolicies[] = { "Automatic", "Performance", "Power Saver" };
+    ImGui::SetNextItemWidth(ImGui::GetWindowWidth() * 0.5f);
+    bool powerChanged = ImGui::Combo("Power Policy", &m_settings.powerPolicy, powerPolicies, IM_ARRAYSIZE(powerPolicies));
+    if (m_settings.powerPolicy == POWER_POLICY_AUTOMATIC)
+    {
+        ImGui::SetNextItemWidth(ImGui::GetWindowWidth() * 0.5f);
+        powerChanged |= ImGui::SliderInt("Saver below", &m_settings.powerSaverBatteryPercent, 5, 50, "%d%%");
+    }
+    if (powerChanged)
+    {
+        UpdatePowerStatus();
+    }
+    ImGui::TextDisabled("Active profile: %s", m_powerPolicy.GetProfile().name);
+    ImGui::Separator();
+    
+    // Frame caps per overlay state (take effect on the next frame)
+    if (ImGui::TreeNode("Frame Rate"))
+    {
+        ImGui::SetNextItemWidth(ImGui::GetWindowWidth() * 0.5f);
+        ImGui::SliderInt("Stats", &m_settings.frameCapStats, 0, 240, m_settings.frameCapStats > 0 ? "%d fps" : "Vsync");
+        ImGui::SetNextItemWidth(ImGui::GetWindowWidth() * 0.5f);
+        ImGui::SliderInt("Visualizer", &m_settings.frameCapVisualizer, 0, 240, m_settings.frameCapVisualizer > 0 ? "%d fps" : "Vsync");
+        
+        FrameIntervalStats frames = m_framePacer.GetStats();
+        int frameCap = m_framePacer.GetTargetFps();
+        if (frameCap > 0)
+            ImGui::TextDisabled("Capped at %d fps (%s timer, %.2f ms spin)", frameCap,
+                m_framePacer.HasHighResolutionTimer() ? "high-resolution" : "standard", m_framePacer.GetSpinMarginNs() / 1e6);
+        else
+            ImGui::TextDisabled("Presenting at vsync");
+        if (frames.count > 0)
+            ImGui::TextDisabled("Interval %.2f ms (%.2f-%.2f), jitter %.3f ms", frames.averageMs, frames.minMs, frames.maxMs, frames.jitterMs);
+        ImGui::TreePop();
+    }
+    ImGui::Separator();
+    
+    // Process panel
+    if (m_settings.showProcesses)
+    {
+        ImGui::SetNextItemWidth(ImGui::GetWindowWidth() * 0.5f);
+        ImGui::SliderInt("Top processes", &m_settings.processTopCount, 1, MAX_TOP_PROCESSES);
+        ImGui::SetNextItemWidth(ImGui::GetWindowWidth() * 0.5f);
+        ImGui::SliderInt("Process interval", &m_settings.processIntervalMs, 500, 10000, "%d ms");
+        ImGui::Separator();
+    }
+    
+    // Loopback metrics endpoint (applied on Save)
+    if (ImGui::TreeNode("Metrics Export"))
+    {
+        ImGui::Checkbox("Serve OpenMetrics on 127.0.0.1", &m_settings.exporterEnabled);
+        ImGui::SetNextItemWidth(ImGui::GetWindowWidth() * 0.3f);
+        ImGui::InputInt("Port", &m_settings.exporterPort, 0);
+        m_settings.exporterPort = (std::min)((std::max)(m_settings.exporterPort, 1024), 65535);
+        if (m_metricsExporter.IsRunning())
+            ImGui::TextDisabled("http://127.0.0.1:%d/metrics (%llu scrapes)", m_metricsExporter.GetPort(),
+                                (unsigned long long)m_metricsExporter.GetScrapeCount());
+        else if (m_settings.exporterEnabled)
+            ImGui::TextDisabled("Not running (port in use?)");
+        ImGui::Checkbox("Publish to shared memory", &m_settings.sharedMetricsEnabled);
+        if (m_sharedMetrics.IsOpen())
+            ImGui::TextDisabled("%s (%llu updates)", OVERLAY_SHARED_METRICS_NAME,
+                                (unsigned long long)m_sharedMetrics.GetPublishCount());
+        ImGui::TreePop();
+    }
+    ImGui::Separator();
+    
+    // Alert rules (applied on Save)
+    if (ImGui::TreeNode("Alerts"))
+    {
+        ImGui::Checkbox("Enable alerts", &m_settings.alerts.enabled);
+        for (int i = 0; i < MAX_ALERT_RULES; i++)
+        {
+            AlertRule& rule = m_settings.alerts.rules[i];
+            if (!rule.name[0])
+                continue;
+            
+            ImGui::PushID(i);
+            bool enabled = rule.enabled != 0;
+            if (ImGui::Checkbox(rule.name, &enabled))
+                rule.enabled = enabled ? 1 : 0;
+            if (enabled)
+            {
+                ImGui::SetNextItemWidth(ImGui::GetWindowWidth() * 0.3f);
+                ImGui::InputFloat("Threshold", &rule.conditions[0].threshold, 0.0f, 0.0f, "%.1f");
+                if (m_alertEngine.IsFiring(i))
+                {
+                    ImGui::SameLine();
+                    ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.3f, 1.0f), "firing");
+                }
+            }
+            ImGui::PopID();
+        }
+        ImGui::TreePop();
+    }
+    ImGui::Separator();
+    
+    // Third-party metric providers (applied on Save)
+    if (ImGui::TreeNode("Plugins"))
+    {
+        ImGui::Checkbox("Load plugins", &m_settings.pluginsEnabled);
+        ImGui::SetNextItemWidth(ImGui::GetWindowWidth() * 0.5f);
+        ImGui::SliderInt("Time budget", &m_settings.pluginBudgetMs, 5, 200, "%d ms");
+        if (m_settings.pluginsEnabled && ImGui::SmallButton("Reload"))
+            ApplyPluginSettings(true);
+        ImGui::TextDisabled("%s", GetPluginDirectory().c_str());
+        for (size_t i = 0; i < m_pluginHost.GetPluginCount(); i++)
+        {
+            ImGui::Text("%s", m_pluginHost.GetPluginName(i));
+            ImGui::SameLine(160);
+            ImGui::TextDisabled("%s, %.2f ms", PluginHost::StateName(m_pluginHost.GetState(i)),
+                                m_pluginHost.GetLastDurationNs(i) / 1e6);
+        }
+        for (const auto& error : m_pluginHost.GetLoadErrors())
+            ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.3f, 1.0f), "%s", error.c_str());
+        ImGui::TreePop();
+    }
+    ImGui::Separator();
+    
+    // Timeline trace (takes effect immediately)
+    if (ImGui::TreeNode("Tracing"))
+    {
+        if (ImGui::Checkbox("Record trace", &m_settings.traceRecording))
+            TraceRecorder::Instance().SetEnabled(m_settings.traceRecording);
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Dump trace"))
+            DumpTrace();
+        ImGui::TextDisabled("Ctrl+Alt+T starts recording, then dumps");
+        if (!m_lastTracePath.empty())
+            ImGui::TextDisabled("%s", m_lastTracePath.c_str());
+        ImGui::TreePop();
+    }
+    ImGui::Separator();
+    
+    // Window titles whose clicks shouldn't dismiss the overlay
+    if (ImGui::TreeNode("Companion Apps"))
+    {
+        for (int i = 0; i < MAX_TRACKED_TITLES; i++)
+        {
+            ImGui::PushID(i);
+            ImGui::SetNextItemWidth(ImGui::GetWindowWidth() * 0.7f);
+            ImGui::InputText("##CompanionTitle", m_settings.windowTracking.titles[i], TRACKED_TITLE_LENGTH);
+            ImGui::PopID();
+        }
+        ImGui::TextDisabled("Tracking %d window(s)", (int)m_windowTracker.GetTrackedCount());
+        ImGui::TreePop();
+    }
+    ImGui::Separator();
+    
+    // Save/Cancel buttons - put them on the same line
+    ImGui::SetCursorPosX((ImGui::GetWindowWidth() - 240) * 0.5f);  // Center the buttons
+    if (ImGui::Button("Save", ImVec2(100, 0)))
+    {
+        m_windowTracker.SetSettings(m_settings.windowTracking);
+        ApplyPublishingSettings();
+        ApplyAlertSettings();
+        ApplyPluginSettings(false);
+        SaveSettings();
+        m_settings.saveToFile = true;
+        m_showSettings = false;
+    }
+    
+    ImGui::SameLine();
+    
+    if (ImGui::Button("Cancel", ImVec2(100, 0)))
+    {
+        if (m_settings.saveToFile)
+        {
+            LoadSettings();
+        }
+        else
+        {
+            m_settings = OverlaySettings();
+        }
+        m_showSettings = false;
+    }
+    
+    ImGui::EndChild();
+    ImGui::PopStyleColor(1);
+}
+
+bool Overlay::CreateDeviceD3D()
+{
+    // Setup swap chain
+    DXGI_SWAP_CHAIN_DESC sd;
+    ZeroMemory(&sd, sizeof(sd));
+    sd.BufferCount = 2;
+    sd.BufferDesc.Width = 0;
+    sd.BufferDesc.Height = 0;
+    sd.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    sd.BufferDesc.RefreshRate.Numerator = 0;     // Leave the rate to the display; frames are paced by FramePacer
+    sd.BufferDesc.RefreshRate.Denominator = 1;
+    sd.Flags = DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH;
+    sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+    sd.OutputWindow = m_hwnd;
+    sd.SampleDesc.Count = 1;
+    sd.SampleDesc.Quality = 0;
+    sd.Windowed = TRUE;
+    sd.SwapEffect = DXGI_SWAP_EFFECT_DISCARD;
+
+    UINT createDeviceFlags = 0;
+    D3D_FEATURE_LEVEL featureLevel;
+    const D3D_FEATURE_LEVEL featureLevelArray[2] = { D3D_FEATURE_LEVEL_11_0, D3D_FEATURE_LEVEL_10_0 };
+    HRESULT res = D3D11CreateDeviceAndSwapChain(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, createDeviceFlags,
+        featureLevelArray, 2, D3D11_SDK_VERSION, &sd, &m_pSwapChain, &m_pd3dDevice, &featureLevel, &m_pd3dDeviceContext);
+    
+    if (res != S_OK)
+        return false;
+
+    CreateRenderTarget();
+    return true;
+}
+
+void Overlay::CreateRenderTarget()
+{
+    ID3D11Texture2D* pBackBuffer;
+    m_pSwapChain->GetBuffer(0, IID_PPV_ARGS(&pBackBuffer));
+    m_pd3dDevice->CreateRenderTargetView(pBackBuffer, nullptr, &m_mainRenderTargetView);
+    pBackBuffer->Release();
+}
+
+void Overlay::CleanupRenderTarget()
+{
+    if (m_mainRenderTargetView) { m_mainRenderTargetView->Release(); m_mainRenderTargetView = nullptr; }
+}
+
+void Overlay::CleanupDeviceD3D()
+{
+    CleanupRenderTarget();
+    if (m_pSwapChain) { m_pSwapChain->Release(); m_pSwapChain = nullptr; }
+    if (m_pd3dDeviceContext) { m_pd3dDeviceContext->Release(); m_pd3dDeviceContext = nullptr; }
+    if (m_pd3dDevice) { m_pd3dDevice->Release(); m_pd3dDevice = nullptr; }
+}
+
+// Register everything that does background work with the activity governor
+void Overlay::RegisterSubsystems()
+{
+    m_activityGovernor.Register("Visualizer capture", ActivityState::Suspended, [this](ActivityState state)
+    {
+        if (state == ActivityState::Active)
+        {
+            if (CanRunVisualizer())
+                m_audioManager.StartVisualizerCapture();
+        }
+        else
+        {
+            m_audioManager.StopVisualizerCapture();
+        }
+    });
+    
+    m_countersSubsystem = m_activityGovernor.Register("Performance counters", ActivityState::Suspended, [this](ActivityState state)
+    {
+        // Reopening the query also takes the baseline sample the first reading needs
+        if (state == ActivityState::Active)
+        {
+            m_cpuUsageAverage.Reset();
+            m_cpuUsageRange.Reset();
+            m_counterRegistry.Open();
+        }
+        else
+        {
+            m_counterRegistry.Close();
+        }
+    });
+    
+    m_activityGovernor.Register("Window tracking", ActivityState::Suspended, [this](ActivityState state)
+    {
+        // WinEvents wake our message loop, so only listen while clicks can dismiss the overlay
+        if (state == ActivityState::Active)
+            m_windowTracker.Start();
+        else
+            m_windowTracker.Stop();
+    });
+    
+    m_networkSpeedSubsystem = m_activityGovernor.Register("Network speeds", ActivityState::Suspended, [this](ActivityState state)
+    {
+        if (state == ActivityState::Active)
+            m_networkManager.ResetSpeedBaseline();
+    });
+    
+    m_activityGovernor.Register("Storage counters", ActivityState::Suspended, [this](ActivityState state)
+    {
+        // Reopening starts the disk rates from a fresh baseline
+        if (state == ActivityState::Active)
+            m_storageMonitor.Open();
+        else
+            m_storageMonitor.Close();
+    });
+    
+    m_activityGovernor.Register("Connection monitor", ActivityState::Suspended, [this](ActivityState state)
+    {
+        if (state == ActivityState::Active)
+            m_connectionMonitor.Reset();
+    });
+    
+    m_activityGovernor.Register("Process sampler", ActivityState::Suspended, [this](ActivityState state)
+    {
+        // Don't let the first reading after a pause average over the whole time we were hidden
+        if (state == ActivityState::Active)
+            m_processSampler.Reset();
+    });
+    
+    m_activityGovernor.Register("Self monitor", ActivityState::Suspended, [this](ActivityState state)
+    {
+        // Rates shouldn't span the time we were hidden
+        if (state == ActivityState::Active)
+            m_selfMonitor.Reset();
+    });
+    
+    m_activityGovernor.Register("Plugins", ActivityState::Suspended, [this](ActivityState state)
+    {
+        // Plugins stay loaded and open; their thread just stops calling them
+        m_pluginHost.SetPaused(state != ActivityState::Active);
+    });
+}
+
+// Visualizer capture runs only when it's on screen and the power profile allows it
+bool Overlay::CanRunVisualizer()
+{
+    return m_showAudioWindow && m_settings.audioSettings.showVisualizer &&
+           m_powerPolicy.GetProfile().allowVisualizer;
+}
+
+// The font cache lives next to the settings file
+std::string Overlay::GetFontCachePath()
+{
+    std::string settingsPath = GetSettingsFilePath();
+    return settingsPath.substr(0, settingsPath.find_last_of('\\') + 1) + "fonts.cache";
+}
+
+// Frame cap for the current overlay state, never above the power profile's (0 = vsync)
+int Overlay::GetFrameCap()
+{
+    int stateCap = CanRunVisualizer() ? m_settings.frameCapVisualizer : m_settings.frameCapStats;
+    int profileCap = m_powerPolicy.GetProfile().frameCap;
+    if (stateCap <= 0)
+        return profileCap;
+    if (profileCap <= 0)
+        return stateCap;
+    return (std::min)(stateCap, profileCap);
+}
+
+// Read the current power state and switch profiles if needed
+void Overlay::UpdatePowerStatus(bool forceApply)
+{
+    PowerStatus status;
+    SYSTEM_POWER_STATUS sps;
+    if (GetSystemPowerStatus(&sps))
+    {
+        status.onAC = (sps.ACLineStatus != 0);  // 255 = unknown, treat as AC
+        status.hasBattery = (sps.BatteryFlag != 128 && sps.BatteryFlag != 255);
+        status.batteryPercent = (sps.BatteryLifePercent <= 100) ? sps.BatteryLifePercent : 100;
+    }
+    
+    m_powerPolicy.SetMode(m_settings.powerPolicy);
+    m_powerPolicy.SetLowBatteryPercent(m_settings.powerSaverBatteryPercent);
+    if (m_powerPolicy.Update(status) || forceApply)
+    {
+        ApplyPowerProfile();
+    }
+}
+
+void Overlay::ApplyPowerProfile()
+{
+    const PowerProfile& profile = m_powerPolicy.GetProfile();
+    
+    m_counterRegistry.ResetSchedule();
+    m_adaptiveSampler.SetBudget(profile.samplingBudget);
+    m_networkManager.SetScanningAllowed(profile.allowWifiScan);
+    
+    if (!profile.allowVisualizer)
+    {
+        m_audioManager.StopVisualizerCapture();
+    }
+    else if (m_isVisible && CanRunVisualizer())
+    {
+        m_audioManager.StartVisualizerCapture();
+    }
+}
+
+// Collect only the metrics that some widget is subscribed to. Subscribers set the fastest
+// rate; the adaptive sampler slows a metric down while its value stays flat.
+void Overlay::CollectMetrics()
+{
+    uint64_t now = Clock::System().NowMs();
+    
+    // CPU usage and the system counters share the registry's single batched query
+    bool cpuDue = IsMetricDue(METRIC_CPU_USAGE, now);
+    bool countersDue = IsMetricDue(METRIC_SYSTEM_COUNTERS, now);
+    if (cpuDue || countersDue)
+    {
+        LatencyScope scope(LATENCY_PROVIDER_COUNTERS);
+        if (m_counterRegistry.Tick(now))
+        {
+            m_cpuUsage = GetCPUUsage();
+            RecordCpuHistory(now);
+        }
+        
+        // Both ride on the same query, so both count as sampled even if only one was due
+        if (m_subscriptions.HasSubscribers(METRIC_CPU_USAGE))
+            MarkMetricSampled(METRIC_CPU_USAGE, m_counterRegistry.GetValue(m_counterCpuTotal), now);
+        if (m_subscriptions.HasSubscribers(METRIC_SYSTEM_COUNTERS))
+            MarkMetricSampled(METRIC_SYSTEM_COUNTERS, m_counterRegistry.GetValue(m_counterCommitted), now);
+    }
+    
+    // Temperature, memory, battery and network details block in the OS (WMI, WLAN), so they
+    // run on the collector thread: a due metric queues its job, and the sample is picked up
+    // on a later pass. A metric stays due until its sample arrives; Request ignores repeats.
+    // Samples count from when they were acquired, not from when they were picked up.
+    if (m_collector.TakeResult(m_temperatureJob))
+    {
+        m_cpuTemperature = m_temperatureSample.value;
+        MarkMetricSampled(METRIC_CPU_TEMPERATURE, m_cpuTemperature, m_temperatureSample.timestampNs / 1000000);
+    }
+    if (IsMetricDue(METRIC_CPU_TEMPERATURE, now))
+        m_collector.Request(m_temperatureJob);
+    
+    if (m_collector.TakeResult(m_memoryJob))
+    {
+        m_memoryInfo = m_memorySample.value;
+        MarkMetricSampled(METRIC_MEMORY, m_memoryInfo.dwMemoryLoad, m_memorySample.timestampNs / 1000000);
+    }
+    if (IsMetricDue(METRIC_MEMORY, now))
+        m_collector.Request(m_memoryJob);
+    
+    if (m_collector.TakeResult(m_batteryJob))
+    {
+        const BatterySample& battery = m_batterySample.value;
+        m_hasBattery = battery.present;
+        m_batteryPercent = battery.percent;
+        m_batteryCharging = battery.charging;
+        m_batteryMinutes = battery.minutes;
+        MarkMetricSampled(METRIC_BATTERY, m_batteryPercent + (m_batteryCharging ? 1000 : 0),
+                          m_batterySample.timestampNs / 1000000);
+    }
+    if (IsMetricDue(METRIC_BATTERY, now))
+        m_collector.Request(m_batteryJob);
+    
+    if (IsMetricDue(METRIC_NETWORK_SPEED, now))
+    {
+        LatencyScope scope(LATENCY_PROVIDER_NETWORK_SPEED);
+        // The manager's own gate only guards against sampling faster than subscribers asked for
+        m_networkManager.SetUpdateInterval(m_subscriptions.GetInterval(METRIC_NETWORK_SPEED));
+        uint64_t previousSpeedNs = m_networkManager.GetSpeedTimestamp();
+        m_networkManager.UpdateSpeeds();
+        
+        // Only a new rate is a sample: the first call just sets the baseline, and feeding the
+        // held value again would look flat and back the sampler off for nothing
+        uint64_t speedNs = m_networkManager.GetSpeedTimestamp();
+        if (speedNs != previousSpeedNs)
+        {
+            MarkMetricSampled(METRIC_NETWORK_SPEED,
+                              m_networkManager.GetDownloadSpeed() + m_networkManager.GetUploadSpeed(),
+                              speedNs / 1000000);
+        }
+    }
+    
+    if (m_collector.TakeResult(m_networkDetailsJob))
+    {
+        m_networkName = m_networkDetailsSample.value.name;
+        m_wifiEnabled = m_networkDetailsSample.value.wifiEnabled;
+        MarkMetricSampled(METRIC_NETWORK_DETAILS, m_wifiEnabled ? 1.0 : 0.0, m_networkDetailsSample.timestampNs / 1000000);
+    }
+    if (IsMetricDue(METRIC_NETWORK_DETAILS, now))
+        m_collector.Request(m_networkDetailsJob);
+    
+    if (IsMetricDue(METRIC_PROCESSES, now))
+    {
+        LatencyScope scope(LATENCY_PROVIDER_PROCESSES);
+        m_processSampler.SetTopCount(m_settings.processTopCount);
+        m_processSampler.Sample();
+        MarkMetricSampled(METRIC_PROCESSES, m_processSampler.GetTotalCpuPercent(), now);
+    }
+    
+    if (IsMetricDue(METRIC_STORAGE, now))
+    {
+        LatencyScope scope(LATENCY_PROVIDER_STORAGE);
+        m_storageMonitor.Sample();
+        MarkMetricSampled(METRIC_STORAGE, m_storageMonitor.GetTotalBytesPerSec() / (1024 * 1024), now);
+    }
+    
+    if (IsMetricDue(METRIC_CONNECTIONS, now))
+    {
+        LatencyScope scope(LATENCY_PROVIDER_CONNECTIONS);
+        m_connectionMonitor.Sample();
+        MarkMetricSampled(METRIC_CONNECTIONS,
+            m_connectionMonitor.GetOpenedPerSec() + m_connectionMonitor.GetClosedPerSec(), now);
+    }
+    
+    if (IsMetricDue(METRIC_SELF, now))
+    {
+        LatencyScope scope(LATENCY_PROVIDER_SELF);
+        m_selfMonitor.Sample();
+        MarkMetricSampled(METRIC_SELF, m_selfMonitor.GetCpuPercent(), now);
+    }
+    
+    // Hand a fresh snapshot to external consumers only when something was actually sampled
+    if (m_metricsSampled)
+    {
+        m_metricsSampled = false;
+        PublishMetrics();
+        EvaluateAlerts(now);
+    }
+}
+
+// The collector thread's jobs. Each writes only its own sample; COM is set up for the
+// thread once and the WMI connection is kept open across samples.
+void Overlay::AddCollectorJobs()
+{
+    m_collector.SetThreadHooks(
+        []() { CoInitializeEx(NULL, COINIT_MULTITHREADED); },
+        [this]() { CloseWmi(); CoUninitialize(); });
+    
+    m_temperatureJob = m_collector.Add([this]()
+    {
+        LatencyScope scope(LATENCY_PROVIDER_TEMPERATURE);
+        m_temperatureSample.value = GetCPUTemperature();
+        m_temperatureSample.timestampNs = Clock::System().NowNs();
+    });
+    m_memoryJob = m_collector.Add([this]()
+    {
+        LatencyScope scope(LATENCY_PROVIDER_MEMORY);
+        m_memorySample.value = GetMemoryInfo();
+        m_memorySample.timestampNs = Clock::System().NowNs();
+    });
+    m_batteryJob = m_collector.Add([this]()
+    {
+        LatencyScope scope(LATENCY_PROVIDER_BATTERY);
+        BatterySample& battery = m_batterySample.value;
+        battery.present = GetBatteryStatus(battery.percent, battery.charging, battery.minutes);
+        m_batterySample.timestampNs = Clock::System().NowNs();
+    });
+    m_networkDetailsJob = m_collector.Add([this]()
+    {
+        LatencyScope scope(LATENCY_PROVIDER_NETWORK_DETAILS);
+        m_networkDetailsSample.value.name = m_networkProbe.GetCurrentNetworkName();
+        m_networkDetailsSample.value.wifiEnabled = m_networkProbe.IsWifiEnabled();
+        m_networkDetailsSample.timestampNs = Clock::System().NowNs();
+    });
+}
+
+// Per-metric change thresholds and the slowest interval each metric may back off to
+void Overlay::ConfigureAdaptiveSampling()
+{
+    struct { int metric; uint32_t maxIntervalMs; double changeThreshold; } configs[] = {
+        { METRIC_CPU_USAGE,        4000,  5.0 },    // percent
+        { METRIC_CPU_TEMPERATURE,  10000, 2.0 },    // degrees
+        { METRIC_SYSTEM_COUNTERS,  8000,  1.0 },    // commit percent
+        { METRIC_MEMORY,           8000,  1.0 },    // load percent
+        { METRIC_BATTERY,          60000, 1.0 },    // percent (charging flips count as a change)
+        { METRIC_NETWORK_SPEED,    8000,  0.05 },   // MB/s
+        { METRIC_NETWORK_DETAILS,  15000, 0.5 },    // Wi-Fi on/off
+        { METRIC_PROCESSES,        10000, 5.0 },    // total process CPU percent
+        { METRIC_STORAGE,          8000,  1.0 },    // MB/s across all disks
+        { METRIC_CONNECTIONS,      10000, 1.0 },    // opened + closed per second
+        { METRIC_SELF,             4000,  1.0 },    // own CPU percent
+    };
+    
+    for (const auto& entry : configs)
+    {
+        AdaptiveSamplingConfig config;
+        config.maxIntervalMs = entry.maxIntervalMs;
+        config.changeThreshold = entry.changeThreshold;
+        m_adaptiveSampler.Configure(entry.metric, config);
+    }
+}
+
+// A metric is due once its adaptive interval has elapsed; the fastest subscriber sets the floor
+bool Overlay::IsMetricDue(int metric, uint64_t now)
+{
+    bool subscribed = m_subscriptions.HasSubscribers(metric);
+    m_adaptiveSampler.SetActive(metric, subscribed);
+    if (!subscribed)
+        return false;
+    
+    m_adaptiveSampler.SetMinInterval(metric, m_subscriptions.GetInterval(metric));
+    return m_adaptiveSampler.IsDue(metric, now);
+}
+
+void Overlay::MarkMetricSampled(int metric, double value, uint64_t now)
+{
+    m_adaptiveSampler.OnSample(metric, value, now);
+    m_subscriptions.MarkSampled(metric, now);
+    m_metricsSampled = true;
+}
+
+// Widgets aren't rendered while hidden, so drop their subscriptions explicitly
+void Overlay::ReleaseWidgetSubscriptions()
+{
+    m_cpuWidgetSub.Release();
+    m_countersWidgetSub.Release();
+    m_temperatureWidgetSub.Release();
+    m_memoryWidgetSub.Release();
+    m_batteryWidgetSub.Release();
+    m_networkSpeedWidgetSub.Release();
+    m_networkDetailsWidgetSub.Release();
+    m_processesWidgetSub.Release();
+    m_storageWidgetSub.Release();
+    m_connectionsWidgetSub.Release();
+    m_selfWidgetSub.Release();
+}
+
+// Start or stop the endpoint and the shared-memory region to match the settings. While either
+// runs, its subscriptions keep the published metrics collected even when the overlay is hidden.
+void Overlay::ApplyPublishingSettings()
+{
+    if (m_metricsExporter.IsRunning() &&
+        (!m_settings.exporterEnabled || m_metricsExporter.GetPort() != m_settings.exporterPort))
+        m_metricsExporter.Stop();
+    if (m_settings.exporterEnabled && !m_metricsExporter.IsRunning())
+        m_metricsExporter.Start(static_cast<uint16_t>(m_settings.exporterPort));
+    
+    if (m_settings.sharedMetricsEnabled)
+        m_sharedMetrics.Open();
+    else
+        m_sharedMetrics.Close();
+    
+    bool enabled = m_metricsExporter.IsRunning() || m_sharedMetrics.IsOpen();
+    const PowerProfile& profile = m_powerPolicy.GetProfile();
+    m_cpuExporterSub.Request(enabled, profile.sampleIntervalMs);
+    m_temperatureExporterSub.Request(enabled, profile.sampleIntervalMs);
+    m_memoryExporterSub.Request(enabled, BACKGROUND_INTERVAL_MS);
+    m_batteryExporterSub.Request(enabled, 5000);
+    m_networkSpeedExporterSub.Request(enabled, profile.networkIntervalMs);
+    
+    UpdateBackgroundCollection();
+}
+
+// Plugins are (re)loaded when turned on, when the budget changes, or on request; otherwise
+// a Save leaves the running ones alone
+void Overlay::ApplyPluginSettings(bool reload)
+{
+    if (m_pluginHost.IsRunning())
+    {
+        if (!reload && m_settings.pluginsEnabled && m_settings.pluginBudgetMs == m_pluginBudgetApplied)
+            return;
+        m_pluginHost.Stop();
+    }
+    
+    m_pluginHost.UnloadAll();
+    if (!m_settings.pluginsEnabled)
+        return;
+    
+    m_pluginHost.SetBudgetMs(static_cast<uint32_t>(m_settings.pluginBudgetMs));
+    m_pluginHost.LoadDirectory(GetPluginDirectory());
+    m_pluginHost.SetPaused(!m_isVisible);
+    m_pluginHost.Start();
+    m_pluginBudgetApplied = m_settings.pluginBudgetMs;
+}
+
+// Plugins live in a folder next to the settings file (created so it's easy to find)
+std::string Overlay::GetPluginDirectory()
+{
+    std::string settingsPath = GetSettingsFilePath();
+    std::string directory = settingsPath.substr(0, settingsPath.find_last_of('\\') + 1) + "plugins";
+    CreateDirectoryA(directory.c_str(), NULL);
+    return directory;
+}
+
+// Keep collecting while hidden for whoever still needs the numbers (publishing, alert rules):
+// the counter query and the speed baseline stay alive and a timer replaces the frame loop
+void Overlay::UpdateBackgroundCollection()
+{
+    bool publishing = m_metricsExporter.IsRunning() || m_sharedMetrics.IsOpen();
+    uint32_t alertSignals = m_alertEngine.GetSignalMask();
+    
+    bool needCounters = publishing || (alertSignals & (1u << ALERT_SIGNAL_CPU_USAGE));
+    bool needNetwork = publishing || (alertSignals & ((1u << ALERT_SIGNAL_DOWNLOAD_SPEED) |
+                                                      (1u << ALERT_SIGNAL_UPLOAD_SPEED)));
+    m_activityGovernor.SetHiddenState(m_countersSubsystem,
+        needCounters ? ActivityState::Active : ActivityState::Suspended);
+    m_activityGovernor.SetHiddenState(m_networkSpeedSubsystem,
+        needNetwork ? ActivityState::Active : ActivityState::Suspended);
+    
+    if (publishing || alertSignals)
+        SetTimer(m_hwnd, BACKGROUND_TIMER_ID, BACKGROUND_INTERVAL_MS, NULL);
+    else
+        KillTimer(m_hwnd, BACKGROUND_TIMER_ID);
+}
+
+void Overlay::PublishMetrics()
+{
+    if (!m_metricsExporter.IsRunning() && !m_sharedMetrics.IsOpen())
+        return;
+    
+    MetricsSnapshot snapshot;
+    snapshot.timestampNs = Clock::System().NowNs();
+    snapshot.cpuUsagePercent = m_cpuUsage;
+    snapshot.cpuTemperatureCelsius = m_cpuTemperature;
+    snapshot.memoryTotalBytes = m_memoryInfo.ullTotalPhys;
+    snapshot.memoryUsedBytes = m_memoryInfo.ullTotalPhys - m_memoryInfo.ullAvailPhys;
+    snapshot.downloadBytesPerSec = m_networkManager.GetDownloadSpeed() * 1024.0 * 1024.0;    // Manager reports MB/s
+    snapshot.uploadBytesPerSec = m_networkManager.GetUploadSpeed() * 1024.0 * 1024.0;
+    snapshot.batteryPercent = m_hasBattery ? m_batteryPercent : -1;
+    snapshot.batteryCharging = m_batteryCharging ? 1 : 0;
+    m_metricsExporter.Publish(snapshot);
+    m_sharedMetrics.Publish(snapshot);
+}
+
+// Compile the enabled rules and subscribe to exactly the signals they look at
+void Overlay::ApplyAlertSettings()
+{
+    if (m_settings.alerts.enabled)
+        m_alertEngine.Compile(m_settings.alerts.rules, MAX_ALERT_RULES);
+    else
+        m_alertEngine.Compile(nullptr, 0);
+    
+    uint32_t signals = m_alertEngine.GetSignalMask();
+    const PowerProfile& profile = m_powerPolicy.GetProfile();
+    m_cpuAlertSub.Request((signals & (1u << ALERT_SIGNAL_CPU_USAGE)) != 0, profile.sampleIntervalMs);
+    m_temperatureAlertSub.Request((signals & (1u << ALERT_SIGNAL_CPU_TEMPERATURE)) != 0, 5000);
+    m_memoryAlertSub.Request((signals & (1u << ALERT_SIGNAL_MEMORY_LOAD)) != 0, 2000);
+    m_batteryAlertSub.Request((signals & ((1u << ALERT_SIGNAL_BATTERY_PERCENT) |
+                                          (1u << ALERT_SIGNAL_BATTERY_CHARGING))) != 0, 10000);
+    m_networkSpeedAlertSub.Request((signals & ((1u << ALERT_SIGNAL_DOWNLOAD_SPEED) |
+                                               (1u << ALERT_SIGNAL_UPLOAD_SPEED))) != 0, profile.networkIntervalMs);
+    m_networkDetailsAlertSub.Request((signals & (1u << ALERT_SIGNAL_NETWORK_CONNECTED)) != 0, 5000);
+    
+    UpdateBackgroundCollection();
+}
+
+// Feed the latest samples to the rules; only subscribed metrics are current, so only those count
+void Overlay::EvaluateAlerts(uint64_t now)
+{
+    if (m_alertEngine.GetRuleCount() == 0)
+        return;
+    
+    if (m_subscriptions.HasSubscribers(METRIC_CPU_USAGE))
+        m_alertEngine.SetSignal(ALERT_SIGNAL_CPU_USAGE, static_cast<float>(m_cpuUsage));
+    if (m_subscriptions.HasSubscribers(METRIC_CPU_TEMPERATURE) && m_cpuTemperature > 0)
+        m_alertEngine.SetSignal(ALERT_SIGNAL_CPU_TEMPERATURE, static_cast<float>(m_cpuTemperature));
+    if (m_subscriptions.HasSubscribers(METRIC_MEMORY))
+        m_alertEngine.SetSignal(ALERT_SIGNAL_MEMORY_LOAD, static_cast<float>(m_memoryInfo.dwMemoryLoad));
+    if (m_subscriptions.HasSubscribers(METRIC_BATTERY))
+    {
+        if (m_hasBattery)
+        {
+            m_alertEngine.SetSignal(ALERT_SIGNAL_BATTERY_PERCENT, static_cast<float>(m_batteryPercent));
+            m_alertEngine.SetSignal(ALERT_SIGNAL_BATTERY_CHARGING, m_batteryCharging ? 1.0f : 0.0f);
+        }
+        else
+        {
+            m_alertEngine.ClearSignal(ALERT_SIGNAL_BATTERY_PERCENT);
+            m_alertEngine.ClearSignal(ALERT_SIGNAL_BATTERY_CHARGING);
+        }
+    }
+    if (m_subscriptions.HasSubscribers(METRIC_NETWORK_SPEED))
+    {
+        m_alertEngine.SetSignal(ALERT_SIGNAL_DOWNLOAD_SPEED, m_networkManager.GetDownloadSpeed());
+        m_alertEngine.SetSignal(ALERT_SIGNAL_UPLOAD_SPEED, m_networkManager.GetUploadSpeed());
+    }
+    if (m_subscriptions.HasSubscribers(METRIC_NETWORK_DETAILS) && !m_networkName.empty())
+        m_alertEngine.SetSignal(ALERT_SIGNAL_NETWORK_CONNECTED, m_networkName != "Not Connected" ? 1.0f : 0.0f);
+    
+    m_alertEvents.clear();
+    m_alertEngine.Evaluate(now, m_alertEvents);
+    for (const AlertEvent& event : m_alertEvents)
+    {
+        if (event.fired)
+            ShowNotification("Overlay alert", m_settings.alerts.rules[event.rule].name, true);
+    }
+}
+
+// Toast on the overlay while it's visible, a tray balloon while it's hidden
+void Overlay::ShowNotification(const char* title, const char* text, bool warning)
+{
+    if (m_isVisible)
+    {
+        m_alertToastTitle = title;
+        m_alertToast = text;
+        m_alertToastWarning = warning;
+        m_alertToastUntilMs = Clock::System().NowMs() + ALERT_TOAST_MS;
+        return;
+    }
+    
+    NOTIFYICONDATAW data = {};
+    data.cbSize = sizeof(data);
+    data.hWnd = m_hwnd;
+    data.uID = 1;
+    data.uFlags = NIF_ICON | NIF_TIP | NIF_INFO;
+    data.hIcon = LoadIcon(NULL, warning ? IDI_WARNING : IDI_INFORMATION);
+    wcscpy_s(data.szTip, L"Windows Info Overlay");
+    MultiByteToWideChar(CP_UTF8, 0, title, -1, data.szInfoTitle, ARRAYSIZE(data.szInfoTitle));
+    MultiByteToWideChar(CP_UTF8, 0, text, -1, data.szInfo, ARRAYSIZE(data.szInfo));
+    data.dwInfoFlags = warning ? NIIF_WARNING : NIIF_INFO;
+    
+    m_trayIconAdded = Shell_NotifyIconW(m_trayIconAdded ? NIM_MODIFY : NIM_ADD, &data) || m_trayIconAdded;
+}
+
+// First press starts recording (there's nothing useful to dump yet), later presses dump
+void Overlay::OnTraceHotkey()
+{
+    if (!TraceRecorder::IsEnabled())
+    {
+        m_settings.traceRecording = true;
+        TraceRecorder::Instance().SetEnabled(true);
+        ShowNotification("Trace", "Recording started, press again to dump", false);
+        return;
+    }
+    
+    DumpTrace();
+}
+
+// Write the recorded timeline next to the settings file as Chrome trace-event JSON
+void Overlay::DumpTrace()
+{
+    SYSTEMTIME time;
+    GetLocalTime(&time);
+    char fileName[64];
+    snprintf(fileName, sizeof(fileName), "trace-%04d%02d%02d-%02d%02d%02d.json",
+             time.wYear, time.wMonth, time.wDay, time.wHour, time.wMinute, time.wSecond);
+    
+    std::string settingsPath = GetSettingsFilePath();
+    std::string path = settingsPath.substr(0, settingsPath.find_last_of('\\') + 1) + fileName;
+    if (TraceRecorder::Instance().WriteChromeJson(path))
+    {
+        m_lastTracePath = path;
+        ShowNotification("Trace written", path.c_str(), false);
+    }
+    else
+    {
+        ShowNotification("Trace", "Couldn't write the trace file", true);
+    }
+}
+
+void Overlay::RenderAlertToast()
+{
+    if (m_alertToastUntilMs == 0 || Clock::System().NowMs() >= m_alertToastUntilMs)
+        return;
+    
+    ImGuiIO& io = ImGui::GetIO();
+    ImGui::SetNextWindowPos(ImVec2(io.DisplaySize.x * 0.5f, 40.0f), ImGuiCond_Always, ImVec2(0.5f, 0.0f));
+    ImGui::SetNextWindowBgAlpha(0.95f);
+    ImGui::Begin("##AlertToast", nullptr,
+        ImGuiWindowFlags_NoDecoration |
+        ImGuiWindowFlags_AlwaysAutoResize |
+        ImGuiWindowFlags_NoSavedSettings |
+        ImGuiWindowFlags_NoFocusOnAppearing |
+        ImGuiWindowFlags_NoNav |
+        ImGuiWindowFlags_NoInputs);
+    ImGui::TextColored(m_alertToastWarning ? ImVec4(1.0f, 0.6f, 0.2f, 1.0f) : ImVec4(0.4f, 0.8f, 1.0f, 1.0f),
+                       "%s", m_alertToastTitle.c_str());
+    ImGui::SameLine();
+    ImGui::TextUnformatted(m_alertToast.c_str());
+    ImGui::End();
+}
+
+void Overlay::UpdateTrafficAccounting()
+{
+    if (!m_trafficAccountant.IsOpen() || !m_networkManager.ReadInterfaceTraffic(m_interfaceTraffic))
+        return;
+    
+    SYSTEMTIME today;
+    GetLocalTime(&today);
+    uint32_t dayKey = today.wYear * 10000 + today.wMonth * 100 + today.wDay;
+    m_trafficAccountant.Integrate(m_interfaceTraffic, dayKey);
+}
+
+void Overlay::RenderDataUsage()
+{
+    SYSTEMTIME today;
+    GetLocalTime(&today);
+    uint32_t dayKey = today.wYear * 10000 + today.wMonth * 100 + today.wDay;
+    TrafficBucket day = m_trafficAccountant.GetDay(dayKey);
+    TrafficBucket month = m_trafficAccountant.GetMonth(TrafficAccountant::MonthKey(dayKey));
+    
+    const double MB = 1024.0 * 1024.0;
+    const double GB = 1024.0 * MB;
+    ImGui::Text("Today: %.1f MB down, %.1f MB up", day.rxBytes / MB, day.txBytes / MB);
+    
+    double monthGB = (month.rxBytes + month.txBytes) / GB;
+    float cap = m_settings.networkSettings.monthlyCapGB;
+    if (cap > 0.0f)
+    {
+        float used = static_cast<float>(monthGB / cap);
+        ImVec4 color = used >= 1.0f ? ImVec4(1.0f, 0.0f, 0.0f, 1.0f) :
+                       used >= 0.8f ? ImVec4(1.0f, 1.0f, 0.0f, 1.0f) :
+                                      ImVec4(0.0f, 1.0f, 0.0f, 1.0f);
+        ImGui::Text("This month: %.2f of %.1f GB", monthGB, cap);
+        ImGui::PushStyleColor(ImGuiCol_PlotHistogram, color);
+        ImGui::ProgressBar((std::min)(used, 1.0f), ImVec2(200, 8), "");
+        ImGui::PopStyleColor(1);
+    }
+    else
     {
-        // Add a small delay to prevent immediate toggling
-        static DWORD lastClickTime = 0;
-        DWORD currentTime = GetTickCount();
-        
-        if (currentTime - lastClickTime > 200) { // 200ms debounce
-            Toggle();
-            lastClickTime = currentTime;
-        }
+        ImGui::Text("This month: %.2f GB", monthGB);
     }
+    
+    ImGui::Spacing();
 }
 
-void Overlay::RenderSettingsPanel()
+void Overlay::RenderConnections()
 {
-    ImGui::PushStyleColor(ImGuiCol_ChildBg, ImVec4(0.15f, 0.15f, 0.15f, 0.9f));
-    
-    // Use a more compact size and style for the settings panel
-    ImGui::BeginChild("SettingsPanel", ImVec2(ImGui::GetWindowWidth() * 0.9f, 140), true);
-    
-    ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "DISPLAY SETTINGS");
-    ImGui::Separator();
-    
-    // Use columns to make the settings more compact
-    ImGui::Columns(2, "SettingsColumns", false);
-    
-    // Left column
-    ImGui::Checkbox("CPU Info", &m_settings.showCpuInfo);
-    ImGui::Checkbox("Memory Info", &m_settings.showMemoryInfo);
-    ImGui::Checkbox("Battery Info", &m_settings.showBatteryInfo);  // Add this line
-    
-    // Right column
-    ImGui::NextColumn();
-    ImGui::Checkbox("CPU Temperature", &m_settings.showCpuTemperature);
-    ImGui::Checkbox("Network Info", &m_settings.showNetworkInfo);
-    
-    // Add audio controls checkbox (either column works)
-    ImGui::Checkbox("Audio Controls", &m_settings.showAudioControls);
+    // Collapsed by default; the connection table is only read while this is open
+    ImGui::SetNextItemOpen(m_connectionsSectionOpen, ImGuiCond_Once);
+    m_connectionsSectionOpen = ImGui::CollapsingHeader("Connections");
+    if (!m_connectionsSectionOpen)
+        return;
     
-    // Reset columns
-    ImGui::Columns(1);
-    ImGui::Separator();
+    const ConnectionMonitor& monitor = m_connectionMonitor;
+    ImGui::Text("TCP: %d   UDP: %d", monitor.GetTcpCount(), monitor.GetUdpCount());
+    ImGui::TextDisabled("Established %d   Listen %d   Time wait %d   Close wait %d",
+        monitor.GetStateCount(TCP_STATE_ESTABLISHED), monitor.GetStateCount(TCP_STATE_LISTEN),
+        monitor.GetStateCount(TCP_STATE_TIME_WAIT), monitor.GetStateCount(TCP_STATE_CLOSE_WAIT));
+    ImGui::Text("Opened: %.1f/s   Closed: %.1f/s", monitor.GetOpenedPerSec(), monitor.GetClosedPerSec());
     
-    // Save/Cancel buttons - put them on the same line
-    ImGui::SetCursorPosX((ImGui::GetWindowWidth() - 240) * 0.5f);  // Center the buttons
-    if (ImGui::Button("Save", ImVec2(100, 0)))
+    for (const auto& process : monitor.GetTopProcesses())
     {
-        SaveSettings();
-        m_settings.saveToFile = true;
-        m_showSettings = false;
+        if (process.name[0])
+            ImGui::Text("%s", process.name);
+        else
+            ImGui::Text("PID %u", process.pid);
+        ImGui::SameLine(220);
+        ImGui::Text("%d", process.connections);
     }
     
-    ImGui::SameLine();
+    ImGui::Spacing();
+}
+
+// Latest published values of every loaded plugin; never waits on a plugin
+void Overlay::RenderPlugins()
+{
+    if (!ImGui::CollapsingHeader("PLUGINS", ImGuiTreeNodeFlags_DefaultOpen))
+        return;
     
-    if (ImGui::Button("Cancel", ImVec2(100, 0)))
+    OverlayPluginSample samples[OVERLAY_PLUGIN_MAX_METRICS];
+    for (size_t i = 0; i < m_pluginHost.GetPluginCount(); i++)
     {
-        if (m_settings.saveToFile)
+        PluginState state = m_pluginHost.GetState(i);
+        uint32_t count = m_pluginHost.ReadSamples(i, samples, OVERLAY_PLUGIN_MAX_METRICS);
+        
+        ImGui::TextDisabled("%s", m_pluginHost.GetPluginName(i));
+        if (state != PLUGIN_RUNNING)
         {
-            LoadSettings();
+            ImGui::SameLine();
+            ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.3f, 1.0f), "(%s)", PluginHost::StateName(state));
         }
-        else
+        
+        for (uint32_t m = 0; m < m_pluginHost.GetMetricCount(i); m++)
         {
-            memset(&m_settings, 0, sizeof(m_settings));
+            const OverlayPluginMetric& metric = m_pluginHost.GetMetric(i, m);
+            ImGui::Text("%s", metric.name);
+            ImGui::SameLine(120);
+            if (m < count && samples[m].valid)
+                ImGui::Text("%.2f %s", samples[m].value, metric.unit);
+            else
+                ImGui::TextDisabled("--");
         }
-        m_showSettings = false;
     }
     
-    ImGui::EndChild();
-    ImGui::PopStyleColor(1);
+    ImGui::Spacing();
 }
 
-bool Overlay::CreateDeviceD3D()
+void Overlay::RenderStorage()
 {
-    // Setup swap chain
-    DXGI_SWAP_CHAIN_DESC sd;
-    ZeroMemory(&sd, sizeof(sd));
-    sd.BufferCount = 2;
-    sd.BufferDesc.Width = 0;
-    sd.BufferDesc.Height = 0;
-    sd.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-    sd.BufferDesc.RefreshRate.Numerator = 60;
-    sd.BufferDesc.RefreshRate.Denominator = 1;
-    sd.Flags = DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH;
-    sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-    sd.OutputWindow = m_hwnd;
-    sd.SampleDesc.Count = 1;
-    sd.SampleDesc.Quality = 0;
-    sd.Windowed = TRUE;
-    sd.SwapEffect = DXGI_SWAP_EFFECT_DISCARD;
-
-    UINT createDeviceFlags = 0;
-    D3D_FEATURE_LEVEL featureLevel;
-    const D3D_FEATURE_LEVEL featureLevelArray[2] = { D3D_FEATURE_LEVEL_11_0, D3D_FEATURE_LEVEL_10_0 };
-    HRESULT res = D3D11CreateDeviceAndSwapChain(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, createDeviceFlags,
-        featureLevelArray, 2, D3D11_SDK_VERSION, &sd, &m_pSwapChain, &m_pd3dDevice, &featureLevel, &m_pd3dDeviceContext);
+    // Collapsing the section also unsubscribes it, so a closed section costs nothing
+    ImGui::SetNextItemOpen(m_storageSectionOpen, ImGuiCond_Once);
+    m_storageSectionOpen = ImGui::CollapsingHeader("STORAGE");
+    if (!m_storageSectionOpen)
+        return;
     
-    if (res != S_OK)
-        return false;
-
-    CreateRenderTarget();
-    return true;
+    const double MB = 1024.0 * 1024.0;
+    for (const auto& disk : m_storageMonitor.GetDisks())
+    {
+        ImGui::Text("%s", disk.name);
+        ImGui::SameLine(120);
+        ImGui::Text("R %.1f  W %.1f MB/s", disk.readBytesPerSec / MB, disk.writeBytesPerSec / MB);
+        ImGui::TextDisabled("    IOPS %.0f/%.0f   Queue %u", disk.readsPerSec, disk.writesPerSec, disk.queueLength);
+    }
+    
+    for (const auto& volume : m_storageMonitor.GetVolumes())
+    {
+        const double GB = 1024.0 * MB;
+        float used = volume.totalBytes ? 1.0f - (float)volume.freeBytes / volume.totalBytes : 0.0f;
+        
+        ImGui::Text("%s", volume.name);
+        ImGui::SameLine(120);
+        ImGui::Text("%.1f GB free of %.1f GB", volume.freeBytes / GB, volume.totalBytes / GB);
+        
+        float barWidth = 200.0f;
+        ImGui::SetCursorPosX((ImGui::GetWindowWidth() - barWidth) * 0.5f);
+        ImGui::ProgressBar(used, ImVec2(barWidth, 8), "");
+    }
+    
+    ImGui::Spacing();
 }
 
-void Overlay::CreateRenderTarget()
+// Keep the history at one point per second. The sampler backs off while CPU is flat, so
+// short gaps are filled with the held value; longer ones (e.g. while hidden) are skipped.
+void Overlay::RecordCpuHistory(uint64_t now)
 {
-    ID3D11Texture2D* pBackBuffer;
-    m_pSwapChain->GetBuffer(0, IID_PPV_ARGS(&pBackBuffer));
-    m_pd3dDevice->CreateRenderTargetView(pBackBuffer, nullptr, &m_mainRenderTargetView);
-    pBackBuffer->Release();
+    uint64_t elapsed = now - m_cpuHistoryLastMs;
+    if (m_cpuHistoryLastMs != 0 && elapsed < 1000)
+        return;
+    
+    uint64_t points = (m_cpuHistoryLastMs != 0 && elapsed <= 10000) ? elapsed / 1000 : 1;
+    for (uint64_t i = 0; i < points; i++)
+        m_cpuHistory.Push(static_cast<float>(m_cpuUsage));
+    m_cpuHistoryLastMs = now;
 }
 
-void Overlay::CleanupRenderTarget()
+// Line chart of a history ring, decimated to the available width (cached between frames)
+void Overlay::RenderSparkline(const HistoryRing& history, ChartDecimator& decimator, float minValue, float maxValue)
 {
-    if (m_mainRenderTargetView) { m_mainRenderTargetView->Release(); m_mainRenderTargetView = nullptr; }
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImVec2 size(ImGui::GetContentRegionAvail().x, CPU_SPARKLINE_HEIGHT);
+    ImGui::Dummy(size);
+    if (history.Size() < 2 || size.x < 2.0f)
+        return;
+    
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    drawList->AddRectFilled(origin, ImVec2(origin.x + size.x, origin.y + size.y), IM_COL32(255, 255, 255, 16));
+    
+    decimator.SetWidth(static_cast<int>(size.x));
+    const std::vector<ChartPoint>& points = decimator.Update(history);
+    
+    // The newest sample sits at the right edge; a ring that isn't full yet doesn't stretch
+    float xScale = size.x / static_cast<float>(history.Capacity() - 1);
+    float right = origin.x + size.x;
+    uint64_t newest = history.End() - 1;
+    float yScale = size.y / (maxValue - minValue);
+    
+    m_sparklinePoints.clear();
+    for (const ChartPoint& point : points)
+    {
+        float value = (std::min)((std::max)(point.value, minValue), maxValue);
+        m_sparklinePoints.push_back(ImVec2(right - static_cast<float>(newest - point.index) * xScale,
+                                           origin.y + size.y - (value - minValue) * yScale));
+    }
+    drawList->AddPolyline(m_sparklinePoints.data(), static_cast<int>(m_sparklinePoints.size()),
+                          IM_COL32(255, 220, 0, 255), ImDrawFlags_None, 1.0f);
 }
 
-void Overlay::CleanupDeviceD3D()
+// p50/p90/p99/p99.9/max of every instrumented operation that has recorded anything
+void Overlay::RenderLatency()
 {
-    CleanupRenderTarget();
-    if (m_pSwapChain) { m_pSwapChain->Release(); m_pSwapChain = nullptr; }
-    if (m_pd3dDeviceContext) { m_pd3dDeviceContext->Release(); m_pd3dDeviceContext = nullptr; }
-    if (m_pd3dDevice) { m_pd3dDevice->Release(); m_pd3dDevice = nullptr; }
+    ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "LATENCY");
+    
+    uint64_t now = Clock::System().NowMs();
+    if (m_latencySnapshots.empty() || now - m_latencySnapshotMs >= 1000)
+    {
+        m_latencySnapshots.resize(LATENCY_OPERATION_COUNT);
+        for (int i = 0; i < LATENCY_OPERATION_COUNT; i++)
+            LatencyHistogram::For(static_cast<LatencyOperation>(i)).Snapshot(m_latencySnapshots[i]);
+        m_latencySnapshotMs = now;
+    }
+    
+    ImGui::TextDisabled("Operation");
+    ImGui::SameLine(170);
+    ImGui::TextDisabled("  p50    p90    p99  p99.9    max (ms)");
+    for (int i = 0; i < LATENCY_OPERATION_COUNT; i++)
+    {
+        const LatencySnapshot& snapshot = m_latencySnapshots[i];
+        if (snapshot.total == 0)
+            continue;
+        
+        ImGui::Text("%s", LatencyHistogram::OperationName(static_cast<LatencyOperation>(i)));
+        ImGui::SameLine(170);
+        ImGui::Text("%5.2f  %5.2f  %5.2f  %5.2f  %5.2f",
+            snapshot.ValueAtPercentile(50.0) / 1e6, snapshot.ValueAtPercentile(90.0) / 1e6,
+            snapshot.ValueAtPercentile(99.0) / 1e6, snapshot.ValueAtPercentile(99.9) / 1e6,
+            snapshot.max / 1e6);
+    }
+    
+    FrameIntervalStats frames = m_framePacer.GetStats();
+    if (frames.count > 0)
+    {
+        ImGui::Text("Frame interval");
+        ImGui::SameLine(170);
+        ImGui::Text("%5.2f avg  %5.2f min  %5.2f max  %.3f jitter", frames.averageMs, frames.minMs, frames.maxMs, frames.jitterMs);
+    }
+    
+    if (ImGui::SmallButton("Reset##Latency"))
+    {
+        for (int i = 0; i < LATENCY_OPERATION_COUNT; i++)
+            LatencyHistogram::For(static_cast<LatencyOperation>(i)).Reset();
+        m_latencySnapshots.clear();
+    }
+    ImGui::Spacing();
 }
 
-// Initialize the PDH query for CPU usage
-void Overlay::InitializeCpuCounter()
+void Overlay::RenderProcesses()
 {
-    PDH_STATUS status = PdhOpenQuery(NULL, 0, &m_cpuQuery);
-    if (status != ERROR_SUCCESS) return;
-
-    // Add the counter
-    status = PdhAddEnglishCounter(m_cpuQuery, "\\Processor(_Total)\\% Processor Time", 0, &m_cpuTotal);
-    if (status != ERROR_SUCCESS) {
-        PdhCloseQuery(m_cpuQuery);
+    ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "PROCESSES");
+    
+    const auto& topCpu = m_processSampler.GetTopByCpu();
+    const auto& topMemory = m_processSampler.GetTopByMemory();
+    if (topMemory.empty())
+    {
+        ImGui::TextDisabled("Sampling...");
+        ImGui::Spacing();
         return;
     }
+    
+    ImGui::TextDisabled("Top CPU");
+    for (const auto& process : topCpu)
+    {
+        ImGui::Text("%s", process.name);
+        ImGui::SameLine(200);
+        ImGui::Text("%5.1f%%", process.cpuPercent);
+        ImGui::SameLine(270);
+        ImGui::TextDisabled("%.0f MB", process.workingSet / (1024.0 * 1024.0));
+    }
+    
+    ImGui::TextDisabled("Top memory");
+    for (const auto& process : topMemory)
+    {
+        ImGui::Text("%s", process.name);
+        ImGui::SameLine(200);
+        ImGui::Text("%.0f MB", process.workingSet / (1024.0 * 1024.0));
+    }
+    
+    ImGui::TextDisabled("%d processes, sampled in %.2f ms", (int)m_processSampler.GetProcessCount(),
+        m_processSampler.GetLastSampleCostNs() / 1e6);
+    ImGui::Spacing();
+}
 
-    // First call to collect, subsequent calls will use this as baseline
-    status = PdhCollectQueryData(m_cpuQuery);
-    if (status != ERROR_SUCCESS) {
-        PdhCloseQuery(m_cpuQuery);
+// The overlay's own footprint: per-thread CPU and wakeups, memory, handles, allocations
+void Overlay::RenderSelfMonitor()
+{
+    ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "OVERHEAD");
+    
+    const SelfProcessRecord& process = m_selfMonitor.GetProcess();
+    if (process.workingSet == 0)
+    {
+        ImGui::TextDisabled("Sampling...");
+        ImGui::Spacing();
         return;
     }
-
-    m_pdh_initialized = true;
+    
+    const double MB = 1024.0 * 1024.0;
+    ImGui::Text("CPU %.2f%%", m_selfMonitor.GetCpuPercent());
+    ImGui::SameLine(120);
+    ImGui::Text("Working set %.1f MB, private %.1f MB", process.workingSet / MB, process.privateBytes / MB);
+    ImGui::Text("Wakeups %.0f/s", m_selfMonitor.GetContextSwitchesPerSec());
+    ImGui::SameLine(120);
+    ImGui::Text("Allocations %.0f/s, %u handles", m_selfMonitor.GetAllocationsPerSec(), process.handleCount);
+    
+    for (const auto& thread : m_selfMonitor.GetThreads())
+    {
+        ImGui::TextDisabled("%s", thread.name);
+        ImGui::SameLine(200);
+        ImGui::Text("%5.2f%%", thread.cpuPercent);
+        ImGui::SameLine(270);
+        ImGui::TextDisabled("%.0f/s", thread.switchesPerSec);
+    }
+    
+    ImGui::TextDisabled("Sampled in %.2f ms", m_selfMonitor.GetLastSampleCostNs() / 1e6);
+    ImGui::Spacing();
 }
 
-// Implement real CPU usage monitoring
-int Overlay::GetCPUUsage()
+void Overlay::RenderSubsystemStatus()
 {
-    if (!m_pdh_initialized) return 0;
-
-    PDH_FMT_COUNTERVALUE counterVal;
+    ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "SUBSYSTEMS");
+    
+    for (const auto& subsystem : m_activityGovernor.GetSubsystems())
+    {
+        ImVec4 color = subsystem.state == ActivityState::Active ? ImVec4(0.0f, 1.0f, 0.0f, 1.0f) :
+                       subsystem.state == ActivityState::Downshifted ? ImVec4(1.0f, 1.0f, 0.0f, 1.0f) :
+                                                                     ImVec4(0.6f, 0.6f, 0.6f, 1.0f);
+        ImGui::Text("%s", subsystem.name.c_str());
+        ImGui::SameLine(180);
+        ImGui::TextColored(color, "%s", ActivityGovernor::StateName(subsystem.state));
+        ImGui::SameLine(280);
+        ImGui::TextDisabled("resumed %dx", subsystem.resumeCount);
+    }
+    
+    // Current adaptive sampling intervals for the metrics that are being collected
+    static const char* metricNames[METRIC_COUNT] = {
+        "CPU", "Temperature", "Counters", "Memory", "Battery", "Net speed", "Net details", "Processes", "Storage", "Connections",
+        "Self"
+    };
+    for (int metric = 0; metric < METRIC_COUNT; metric++)
+    {
+        if (!m_subscriptions.HasSubscribers(metric))
+            continue;
+        ImGui::TextDisabled("%s", metricNames[metric]);
+        ImGui::SameLine(180);
+        ImGui::TextDisabled("every %u ms", m_adaptiveSampler.GetInterval(metric));
+    }
     
-    // Collect current value
-    PDH_STATUS status = PdhCollectQueryData(m_cpuQuery);
-    if (status != ERROR_SUCCESS) return 0;
+    ImGui::TextDisabled("Font atlas");
+    ImGui::SameLine(180);
+    ImGui::TextDisabled("%s in %.1f ms", m_fontCache.WasLoadedFromCache() ? "cached" : "baked",
+        m_fontCache.GetLastLoadNs() / 1e6);
     
-    // Format the performance data
-    status = PdhGetFormattedCounterValue(m_cpuTotal, PDH_FMT_LONG, NULL, &counterVal);
-    if (status != ERROR_SUCCESS) return 0;
+    ImGui::Spacing();
+}
+
+// Every provider's counters go into the registry's single query
+void Overlay::DeclareCounters()
+{
+    // Processor
+    m_counterCpuTotal = m_counterRegistry.Declare(COUNTER_PROCESSOR, "\\Processor(_Total)\\% Processor Time", "CPU");
     
-    int currentCpuUsage = static_cast<int>(counterVal.longValue);
+    // Memory
+    m_counterCommitted = m_counterRegistry.Declare(COUNTER_MEMORY, "\\Memory\\% Committed Bytes In Use", "Commit");
     
-    // Add to history
-    m_cpuUsageHistory.push_back(currentCpuUsage);
+    // Paging
+    m_counterPagingFile = m_counterRegistry.Declare(COUNTER_PAGING, "\\Paging File(_Total)\\% Usage", "Page file");
     
-    // Keep history to fixed size
-    if (m_cpuUsageHistory.size() > CPU_HISTORY_SIZE) {
-        m_cpuUsageHistory.erase(m_cpuUsageHistory.begin());
-    }
+    // Disk
+    m_counterDiskBytes = m_counterRegistry.Declare(COUNTER_DISK, "\\PhysicalDisk(_Total)\\Disk Bytes/sec", "Disk");
     
-    // Calculate average
-    int totalUsage = 0;
-    for (const auto& usage : m_cpuUsageHistory) {
-        totalUsage += usage;
-    }
+    // System
+    m_counterQueueLength = m_counterRegistry.Declare(COUNTER_SYSTEM, "\\System\\Processor Queue Length", "Run queue");
+    m_counterContextSwitches = m_counterRegistry.Declare(COUNTER_SYSTEM, "\\System\\Context Switches/sec", "Context switches");
+}
+
+// Implement real CPU usage monitoring
+// (reads the value collected by the counter registry's last tick)
+int Overlay::GetCPUUsage()
+{
+    if (!m_counterRegistry.IsAvailable(m_counterCpuTotal)) return 0;
     
-    m_smoothedCpuUsage = m_cpuUsageHistory.size() > 0 ? 
-        totalUsage / static_cast<int>(m_cpuUsageHistory.size()) : currentCpuUsage;
+    int currentCpuUsage = static_cast<int>(m_counterRegistry.GetValue(m_counterCpuTotal));
+    
+    // Average over the last CPU_HISTORY_SIZE samples; the range shows the spikes it smooths out
+    m_smoothedCpuUsage = m_cpuUsageAverage.Update(currentCpuUsage);
+    m_cpuUsageRange.Update(currentCpuUsage);
     
     return m_smoothedCpuUsage;
 }
 
-// Implement real CPU temperature monitoring using WMI
-int Overlay::GetCPUTemperature()
+// Connect to ROOT\WMI once; the connection is reused by every temperature sample.
+// Collector thread only (COM is initialized for it by the thread hooks).
+void Overlay::OpenWmi()
 {
-    int temperature = 0;
-    
-    // Initialize COM
-    HRESULT hr = CoInitializeEx(0, COINIT_MULTITHREADED);
-    if (FAILED(hr)) return 0;
+    if (m_wbemServices)
+        return;
     
-    // Set general COM security levels
-    hr = CoInitializeSecurity(
+    // Process-wide and only allowed once; a second call fails with RPC_E_TOO_LATE, which is fine
+    CoInitializeSecurity(
         NULL,
         -1,                          // COM authentication
         NULL,                        // Authentication services
@@ -745,28 +2008,22 @@ int Overlay::GetCPUTemperature()
         EOAC_NONE,                   // Additional capabilities 
         NULL                         // Reserved
     );
-
-    if (FAILED(hr)) {
-        CoUninitialize();
-        return 0;
-    }
     
     // Obtain the initial locator to WMI
-    IWbemLocator *pLoc = NULL;
-    hr = CoCreateInstance(
+    HRESULT hr = CoCreateInstance(
         CLSID_WbemLocator,             
         0, 
         CLSCTX_INPROC_SERVER, 
-        IID_IWbemLocator, (LPVOID *) &pLoc);
+        IID_IWbemLocator, (LPVOID *) &m_wbemLocator);
     
     if (FAILED(hr)) {
-        CoUninitialize();
-        return 0;
+        m_wbemLocator = NULL;
+        return;
     }
     
     // Connect to WMI through the IWbemLocator::ConnectServer method
-    IWbemServices *pSvc = NULL;
-    hr = pLoc->ConnectServer(
+    uint64_t connectStartNs = Clock::System().NowNs();
+    hr = m_wbemLocator->ConnectServer(
         _bstr_t(L"ROOT\\WMI"),      // Object path of WMI namespace
         NULL,                    // User name. NULL = current user
         NULL,                    // User password. NULL = current
@@ -774,18 +2031,19 @@ int Overlay::GetCPUTemperature()
         0,                       // Security flags - use 0 instead of NULL
         0,                       // Authority (e.g. Kerberos)
         0,                       // Context object 
-        &pSvc                    // pointer to IWbemServices proxy
+        &m_wbemServices          // pointer to IWbemServices proxy
     );
+    LatencyHistogram::For(LATENCY_COM_WMI_CONNECT).Record(Clock::System().NowNs() - connectStartNs);
     
     if (FAILED(hr)) {
-        pLoc->Release();     
-        CoUninitialize();
-        return 0;
+        m_wbemServices = NULL;
+        CloseWmi();
+        return;
     }
     
     // Set security levels on the proxy
     hr = CoSetProxyBlanket(
-        pSvc,                        // Indicates the proxy to set
+        m_wbemServices,              // Indicates the proxy to set
         RPC_C_AUTHN_WINNT,           // RPC_C_AUTHN_xxx
         RPC_C_AUTHZ_NONE,            // RPC_C_AUTHZ_xxx
         NULL,                        // Server principal name 
@@ -796,17 +2054,37 @@ int Overlay::GetCPUTemperature()
     );
 
     if (FAILED(hr)) {
-        pSvc->Release();
-        pLoc->Release();     
-        CoUninitialize();
-        return 0;
+        CloseWmi();
     }
+}
+
+void Overlay::CloseWmi()
+{
+    if (m_wbemServices) {
+        m_wbemServices->Release();
+        m_wbemServices = NULL;
+    }
+    if (m_wbemLocator) {
+        m_wbemLocator->Release();
+        m_wbemLocator = NULL;
+    }
+}
+
+// Real CPU temperature from WMI's ACPI thermal zones (collector thread only)
+int Overlay::GetCPUTemperature()
+{
+    int temperature = 0;
+    
+    OpenWmi();
+    if (!m_wbemServices)
+        return 0;
     
     // Use the IWbemServices pointer to make requests of WMI
     IEnumWbemClassObject* pEnumerator = NULL;
     BSTR wqlBstr = SysAllocString(L"WQL");
     BSTR queryBstr = SysAllocString(L"SELECT * FROM MSAcpi_ThermalZoneTemperature");
-    hr = pSvc->ExecQuery(
+    uint64_t queryStartNs = Clock::System().NowNs();
+    HRESULT hr = m_wbemServices->ExecQuery(
         wqlBstr, 
         queryBstr,
         WBEM_FLAG_FORWARD_ONLY | WBEM_FLAG_RETURN_IMMEDIATELY, 
@@ -816,9 +2094,8 @@ int Overlay::GetCPUTemperature()
     SysFreeString(queryBstr);
     
     if (FAILED(hr)) {
-        pSvc->Release();
-        pLoc->Release();
-        CoUninitialize();
+        // The WMI service may have restarted; reconnect on the next sample
+        CloseWmi();
         return 65; // Fallback value if WMI query fails
     }
     
@@ -828,6 +2105,8 @@ int Overlay::GetCPUTemperature()
    
     while (pEnumerator) {
         HRESULT hr = pEnumerator->Next(WBEM_INFINITE, 1, &pclsObj, &uReturn);
+        LatencyHistogram::For(LATENCY_COM_WMI_QUERY).Record(Clock::System().NowNs() - queryStartNs);
+        queryStartNs = Clock::System().NowNs();
 
         if (uReturn == 0) break;
 
@@ -841,6 +2120,7 @@ int Overlay::GetCPUTemperature()
             double kelvin = vtProp.intVal / 10.0;
             temperature = static_cast<int>(kelvin - 273.15);
             VariantClear(&vtProp);
+            pclsObj->Release();
             break;
         }
         
@@ -849,17 +2129,15 @@ int Overlay::GetCPUTemperature()
         if (SUCCEEDED(hr)) {
             temperature = vtProp.intVal;
             VariantClear(&vtProp);
+            pclsObj->Release();
             break;
         }
         
         pclsObj->Release();
     }
     
-    // Clean up
+    // Clean up (the connection stays open for the next sample)
     pEnumerator->Release();
-    pSvc->Release();
-    pLoc->Release();
-    CoUninitialize();
     
     return temperature > 0 ? temperature : 65; // Return sensible default if we failed
 }
@@ -871,57 +2149,12 @@ MEMORYSTATUSEX Overlay::GetMemoryInfo()
     return memInfo;
 }
 
-bool Overlay::IsClickedInFlowLauncher()
+// Companion app rectangles are kept current by the window tracker, so this is just a rectangle test.
+// The overlay covers the screen from (0,0), so ImGui mouse coordinates are screen coordinates.
+bool Overlay::IsClickInCompanionWindow()
 {
-    // First approach: Find Flow Launcher by window class or title
-    HWND flowLauncherHwnd = FindWindowW(NULL, L"Flow.Launcher");
-    if (!flowLauncherHwnd)
-    {
-        // Try alternative names if the above doesn't find it
-        flowLauncherHwnd = FindWindowW(NULL, L"Flow Launcher");
-    }
-    
-    if (flowLauncherHwnd)
-    {
-        // Get Flow Launcher's position and size
-        RECT rect;
-        if (GetWindowRect(flowLauncherHwnd, &rect))
-        {
-            // Get current mouse position
-            POINT mousePos;
-            GetCursorPos(&mousePos);
-            
-            // Check if mouse is inside Flow Launcher's rectangle
-            if (mousePos.x >= rect.left && mousePos.x <= rect.right &&
-                mousePos.y >= rect.top && mousePos.y <= rect.bottom)
-            {
-                return true;
-            }
-        }
-    }
-    
-    // Second approach: Define a fixed area where Flow Launcher appears
-    // This is a fallback if we couldn't find the window
     ImGuiIO& io = ImGui::GetIO();
-    float screenWidth = io.DisplaySize.x;
-    float screenHeight = io.DisplaySize.y;
-    
-    // Assume Flow Launcher appears in the center top portion of screen
-    // Adjust these values based on your Flow Launcher's typical position
-    float flowLeft = screenWidth * 0.2f;
-    float flowRight = screenWidth * 0.8f;
-    float flowTop = screenHeight * 0.1f;
-    float flowBottom = screenHeight * 0.3f;
-    
-    // Check if mouse is inside estimated Flow Launcher area
-    ImVec2 mousePos = io.MousePos;
-    if (mousePos.x >= flowLeft && mousePos.x <= flowRight &&
-        mousePos.y >= flowTop && mousePos.y <= flowBottom)
-    {
-        return true;
-    }
-    
-    return false;
+    return m_windowTracker.HitTest(static_cast<int>(io.MousePos.x), static_cast<int>(io.MousePos.y));
 }
 
 void Overlay::SaveSettings()
@@ -930,6 +2163,8 @@ void Overlay::SaveSettings()
     FILE* file = fopen(filePath.c_str(), "wb");
     if (file)
     {
+        SettingsFileHeader header = { SETTINGS_FILE_MAGIC, SETTINGS_FILE_VERSION, sizeof(OverlaySettings) };
+        fwrite(&header, sizeof(header), 1, file);
         fwrite(&m_settings, sizeof(OverlaySettings), 1, file);
         fclose(file);
     }
@@ -939,16 +2174,31 @@ void Overlay::LoadSettings()
 {
     std::string filePath = GetSettingsFilePath();
     FILE* file = fopen(filePath.c_str(), "rb");
+    bool loaded = false;
     if (file)
     {
-        fread(&m_settings, sizeof(OverlaySettings), 1, file);
+        // Read into a copy so a short or mismatched file never leaves half-overwritten settings
+        SettingsFileHeader header = {};
+        OverlaySettings settings;
+        if (fread(&header, sizeof(header), 1, file) == 1 &&
+            header.magic == SETTINGS_FILE_MAGIC &&
+            header.version == SETTINGS_FILE_VERSION &&
+            header.size == sizeof(OverlaySettings) &&
+            fread(&settings, sizeof(OverlaySettings), 1, file) == 1)
+        {
+            m_settings = settings;
+            loaded = true;
+        }
         fclose(file);
     }
-    else
+    
+    if (!loaded)
     {
-        // No settings file exists yet, use defaults
-        memset(&m_settings, 0, sizeof(m_settings));
+        // No settings file yet, or one written by an incompatible build: use defaults
+        m_settings = OverlaySettings();
     }
+    
+    m_windowTracker.SetSettings(m_settings.windowTracking);
 }
 
 std::string Overlay::GetSettingsFilePath()
@@ -983,6 +2233,16 @@ void Overlay::ToggleAudioWindow()
         
         // Make sure we have updated device information
         m_audioManager.RefreshDevices();
+        
+        // Only capture loopback audio while there is a visualizer to feed
+        if (CanRunVisualizer() && !m_audioManager.IsVisualizerActive())
+        {
+            m_audioManager.StartVisualizerCapture();
+        }
+    }
+    else if (!m_showAudioWindow)
+    {
+        m_audioManager.StopVisualizerCapture();
     }
 }
 
@@ -1011,7 +2271,7 @@ void Overlay::RenderAudioWindow()
     // Set position for the audio window
     ImGui::SetNextWindowPos(m_audioWindowPos, ImGuiCond_FirstUseEver);
     ImGui::SetNextWindowBgAlpha(0.9f);
-    ImGui::SetNextWindowSizeConstraints(ImVec2(350, 250), ImVec2(500, 400));
+    ImGui::SetNextWindowSizeConstraints(ImVec2(350, 250), ImVec2(500, 520));
     
     // Variables for dragging
     static bool audioDragging = false;
@@ -1058,6 +2318,7 @@ void Overlay::RenderAudioWindow()
     if (ImGui::Button("X"))
     {
         m_showAudioWindow = false;
+        m_audioManager.StopVisualizerCapture();
         ImGui::End();
         return;
     }
@@ -1159,6 +2420,13 @@ void Overlay::RenderAudioWindow()
         ImGui::PopStyleColor(2);
     }
     
+    // Audio visualizer
+    if (m_settings.audioSettings.showVisualizer)
+    {
+        ImGui::Separator();
+        RenderVisualizer();
+    }
+    
     ImGui::PopFont();
     ImGui::End();
     
@@ -1172,6 +2440,32 @@ void Overlay::RenderAudioWindow()
     m_mouseInsideAudioWindow = mouseInsideAudio;
 }
 
+// Draw the visualizer straight into the window's draw list (see VisualizerGeometry)
+void Overlay::RenderVisualizer()
+{
+    const float height = 80.0f;
+    const float width = ImGui::GetContentRegionAvail().x;
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImGui::Dummy(ImVec2(width, height));
+    
+    if (!m_powerPolicy.GetProfile().allowVisualizer)
+    {
+        ImVec2 textSize = ImGui::CalcTextSize("Visualizer paused (power saving)");
+        ImGui::GetWindowDrawList()->AddText(
+            ImVec2(origin.x + (width - textSize.x) * 0.5f, origin.y + (height - textSize.y) * 0.5f),
+            IM_COL32(160, 160, 160, 255), "Visualizer paused (power saving)");
+        return;
+    }
+    
+    if (!m_audioManager.IsVisualizerActive())
+    {
+        return;
+    }
+    
+    m_audioManager.GetVisualizerSnapshot(m_visualizerFrame, m_visualizerPeakFrame);
+    m_visualizerGeometry.Draw(ImGui::GetWindowDrawList(), m_settings.audioSettings.visualizerStyle,
+                              origin, width, height, m_visualizerFrame.data(), m_visualizerPeakFrame.data());
+}
 
 void Overlay::RenderAudioSettingsPanel()
 {
@@ -1229,7 +2523,7 @@ void Overlay::RenderAudioSettingsPanel()
         }
         
         // Start or stop visualizer based on settings
-        if (m_settings.audioSettings.showVisualizer) {
+        if (CanRunVisualizer()) {
             if (!m_audioManager.IsVisualizerActive()) {
                 m_audioManager.StartVisualizerCapture();
             }
@@ -1252,18 +2546,35 @@ void Overlay::Cleanup()
     m_isRunning = false;
     
     // Cleanup PDH resources
-    if (m_pdh_initialized) {
-        PdhCloseQuery(m_cpuQuery);
-        m_pdh_initialized = false;
-    }
-    
-    // Unhook keyboard hook
-    if (g_keyboardHook)
+    m_counterRegistry.Close();
+    
+    // Count the last partial interval and fold the journal into the snapshot
+    KillTimer(m_hwnd, TRAFFIC_TIMER_ID);
+    UpdateTrafficAccounting();
+    m_trafficAccountant.Close();
+    
+    KillTimer(m_hwnd, BACKGROUND_TIMER_ID);
+    m_collector.Stop();
+    m_metricsExporter.Stop();
+    m_sharedMetrics.Close();
+    m_pluginHost.Stop();
+    m_pluginHost.UnloadAll();
+    
+    // Remove the alert tray icon (only added once an alert fired while hidden)
+    if (m_trayIconAdded)
     {
-        UnhookWindowsHookEx(g_keyboardHook);
-        g_keyboardHook = NULL;
+        NOTIFYICONDATAW data = {};
+        data.cbSize = sizeof(data);
+        data.hWnd = m_hwnd;
+        data.uID = 1;
+        Shell_NotifyIconW(NIM_DELETE, &data);
+        m_trayIconAdded = false;
     }
     
+    // Unhook keyboard hook and release registered hotkeys
+    m_hotkeyManager.Cleanup();
+    m_windowTracker.Stop();
+    
     // Cleanup
     ImGui_ImplDX11_Shutdown();
     ImGui_ImplWin32_Shutdown();
@@ -1299,7 +2610,7 @@ void Overlay::RenderNetworkWindow()
     // Set position for the network window
     ImGui::SetNextWindowPos(m_networkWindowPos, ImGuiCond_FirstUseEver);
     ImGui::SetNextWindowBgAlpha(0.92f);
-    ImGui::SetNextWindowSizeConstraints(ImVec2(350, 250), ImVec2(500, 400));
+    ImGui::SetNextWindowSizeConstraints(ImVec2(350, 250), ImVec2(500, 560));
 
     // Dragging logic (Ctrl+Drag)
     static bool dragging = false;
@@ -1343,30 +2654,52 @@ void Overlay::RenderNetworkWindow()
 
     // Show network settings panel if enabled (stub)
     if (m_showNetworkSettings) {
-        ImGui::Text("Network settings panel (not implemented)");
+        ImGui::SetNextItemWidth(120);
+        ImGui::InputFloat("Monthly cap (GB)", &m_settings.networkSettings.monthlyCapGB, 1.0f, 10.0f, "%.1f");
+        if (m_settings.networkSettings.monthlyCapGB < 0.0f)
+            m_settings.networkSettings.monthlyCapGB = 0.0f;
+        ImGui::SameLine();
+        if (ImGui::Button("Save")) {
+            SaveSettings();
+            m_showNetworkSettings = false;
+        }
+        ImGui::TextDisabled("0 = no cap");
         ImGui::Separator();
     }
 
-    // Current network info
-    std::string networkName = m_networkManager.GetCurrentNetworkName();
-    bool wifiEnabled = m_networkManager.IsWifiEnabled();
+    // Current network info (collected on demand through the widget subscriptions)
+    m_networkSpeedWidgetSub.Request(true, m_powerPolicy.GetProfile().networkIntervalMs);
+    m_networkDetailsWidgetSub.Request(m_settings.networkSettings.showNetworkDetails, 3000);
     float downloadSpeed = m_networkManager.GetDownloadSpeed();
     float uploadSpeed = m_networkManager.GetUploadSpeed();
 
-    ImGui::Text("Current Network: %s", networkName.c_str());
-    ImGui::Text("WiFi: %s", wifiEnabled ? "Enabled" : "Disabled");
+    if (m_settings.networkSettings.showNetworkDetails) {
+        ImGui::Text("Current Network: %s", m_networkName.c_str());
+        ImGui::Text("WiFi: %s", m_wifiEnabled ? "Enabled" : "Disabled");
+    }
     ImGui::Text("Download: %.2f MB/s", downloadSpeed);
     ImGui::Text("Upload: %.2f MB/s", uploadSpeed);
 
     ImGui::Spacing();
+    
+    RenderDataUsage();
+    
+    m_connectionsWidgetSub.Request(m_connectionsSectionOpen, m_powerPolicy.GetProfile().networkIntervalMs);
+    RenderConnections();
 
     // Refresh networks button
     ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.2f, 0.4f, 0.6f, 1.0f));
     ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.3f, 0.5f, 0.7f, 1.0f));
+    ImGui::BeginDisabled(!m_networkManager.IsScanningAllowed());
     if (ImGui::Button("↻ Refresh Networks", ImVec2(160, 0))) {
         m_networkManager.ScanNetworks();
     }
+    ImGui::EndDisabled();
     ImGui::PopStyleColor(2);
+    if (!m_networkManager.IsScanningAllowed()) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("Scans paused (power saving)");
+    }
 
     ImGui::Separator();
 
@@ -1377,7 +2710,10 @@ void Overlay::RenderNetworkWindow()
 
     const auto& networks = m_networkManager.GetAvailableNetworks();
     ImGui::Text("Available Networks:");
-    ImGui::BeginChild("##NetworkList", ImVec2(0, ImGui::GetWindowHeight() - 250), true);
+    // Give the list whatever is left, keeping room for the connect controls
+    bool hasSelection = selectedNetwork >= 0 && selectedNetwork < (int)networks.size();
+    float listHeight = ImGui::GetContentRegionAvail().y - (hasSelection ? 90.0f : 0.0f);
+    ImGui::BeginChild("##NetworkList", ImVec2(0, (std::max)(listHeight, 60.0f)), true);
 
     int idx = 0;
     for (const auto& net : networks) {
@@ -8,17 +8,68 @@
 #include <vector>
 #include <queue>
 #include <string>
-#include <pdh.h>
 
 // Include our new manager classes
 #include "AudioManager.h"
 #include "NetworkManager.h"
-
-// Define custom message for toggle
-#define WM_TOGGLE_OVERLAY (WM_USER + 1)
+#include "ActivityGovernor.h"
+#include "PowerPolicy.h"
+#include "HotkeyManager.h"
+#include "WindowTracker.h"
+#include "CounterRegistry.h"
+#include "MetricSubscriptions.h"
+#include "AdaptiveSampler.h"
+#include "Clock.h"
+#include "Estimators.h"
+#include "ProcessSampler.h"
+#include "StorageMonitor.h"
+#include "ConnectionMonitor.h"
+#include "MetricsExporter.h"
+#include "SharedMetricsPublisher.h"
+#include "AlertEngine.h"
+#include "ChartDecimation.h"
+#include "LatencyHistogram.h"
+#include "TraceRecorder.h"
+#include "PluginHost.h"
+#include "SelfMonitor.h"
+#include "VisualizerGeometry.h"
+#include "FramePacer.h"
+#include "FontAtlasCache.h"
+#include "BackgroundCollector.h"
 
 #define CPU_HISTORY_SIZE 10
 
+// CPU sparkline: one point per second for the last hour
+#define CPU_SPARKLINE_SECONDS 3600
+#define CPU_SPARKLINE_HEIGHT 36.0f
+
+// Data-usage accounting runs off a window timer so it keeps counting while hidden
+#define TRAFFIC_TIMER_ID 1
+#define TRAFFIC_INTERVAL_MS 30000
+
+// While metrics are published or watched by alert rules, they keep being collected off this
+// timer when the overlay is hidden
+#define BACKGROUND_TIMER_ID 2
+#define BACKGROUND_INTERVAL_MS 1000
+#define ALERT_TOAST_MS 6000
+#define DEFAULT_EXPORTER_PORT 9184
+
+// WMI interfaces, only touched in Overlay.cpp on the collector thread
+struct IWbemLocator;
+struct IWbemServices;
+
+// Settings file header; a file from another build (different magic, version or struct size)
+// is ignored and the defaults are used instead of reading a mismatched layout
+#define SETTINGS_FILE_MAGIC 0x534F5657u    // "WVOS"
+#define SETTINGS_FILE_VERSION 1u            // Bumped when OverlaySettings changes incompatibly
+
+struct SettingsFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+};
+
 // Structure to hold overlay configuration settings
 struct OverlaySettings 
 {
@@ -28,6 +79,26 @@ struct OverlaySettings
     bool showNetworkInfo = true;
     bool showAudioControls = true;
     bool showBatteryInfo = true;
+    bool showSubsystemStatus = false;
+    bool showProcesses = true;
+    bool showStorageInfo = true;
+    bool showLatency = false;
+    bool showSelfMonitor = false;
+    bool traceRecording = false;
+    int processTopCount = 5;
+    int processIntervalMs = 2000;
+    bool exporterEnabled = false;
+    int exporterPort = DEFAULT_EXPORTER_PORT;
+    bool sharedMetricsEnabled = false;
+    bool pluginsEnabled = false;
+    int pluginBudgetMs = PLUGIN_DEFAULT_BUDGET_MS;
+    int powerPolicy = POWER_POLICY_AUTOMATIC;
+    int powerSaverBatteryPercent = 20;
+    int frameCapStats = 30;         // Frames per second while only stats are shown, 0 = vsync
+    int frameCapVisualizer = 60;    // Frames per second while the visualizer animates, 0 = vsync
+    HotkeySettings hotkeys;
+    AlertSettings alerts;
+    WindowTrackingSettings windowTracking;
     bool saveToFile = false;
     AudioSettings audioSettings;
     NetworkSettings networkSettings;
@@ -75,6 +146,8 @@ private:
     void RenderSettingsPanel();
     void RenderAudioWindow();
     void RenderAudioSettingsPanel();
+    void RenderVisualizer();
+    void RenderSubsystemStatus();
     void RenderNetworkWindow();
     void RenderNetworkSettingsPanel();
 
@@ -82,20 +155,73 @@ private:
     void ToggleAudioWindow();
     void ToggleNetworkWindow();
 
+    // Background activity
+    void RegisterSubsystems();
+    bool CanRunVisualizer();
+    int GetFrameCap();
+
+    // Power policy
+    void UpdatePowerStatus(bool forceApply = false);
+    void ApplyPowerProfile();
+
+    // Demand-driven collection
+    void CollectMetrics();
+    void ReleaseWidgetSubscriptions();
+    void ConfigureAdaptiveSampling();
+    bool IsMetricDue(int metric, uint64_t now);
+    void MarkMetricSampled(int metric, double value, uint64_t now);
+
+    // External consumers (OpenMetrics endpoint, shared memory)
+    void ApplyPublishingSettings();
+    void PublishMetrics();
+    void UpdateBackgroundCollection();
+
+    // Third-party metric providers (OverlayPluginApi.h)
+    void ApplyPluginSettings(bool reload);
+    std::string GetPluginDirectory();
+    void RenderPlugins();
+
+    // Alert rules
+    void ApplyAlertSettings();
+    void EvaluateAlerts(uint64_t now);
+    void ShowNotification(const char* title, const char* text, bool warning);
+    void RenderAlertToast();
+
+    // Trace recording (TraceRecorder)
+    void OnTraceHotkey();
+    void DumpTrace();
+
+    // Performance counters
+    void DeclareCounters();
+
     // CPU monitoring
-    void InitializeCpuCounter();
     int GetCPUUsage();
     int GetCPUTemperature();
+    void OpenWmi();
+    void CloseWmi();
+    
+    // Slow providers on the collector thread (see CollectMetrics)
+    void AddCollectorJobs();
 
     // Other system info
     MEMORYSTATUSEX GetMemoryInfo();
     bool GetBatteryStatus(int& batteryPercent, bool& isCharging, int& remainingMinutes);
-    bool IsClickedInFlowLauncher();
+    void RecordCpuHistory(uint64_t now);
+    void RenderSparkline(const HistoryRing& history, ChartDecimator& decimator, float minValue, float maxValue);
+    void RenderProcesses();
+    void RenderSelfMonitor();
+    void RenderLatency();
+    void RenderStorage();
+    void RenderConnections();
+    void RenderDataUsage();
+    void UpdateTrafficAccounting();
+    bool IsClickInCompanionWindow();
 
     // Settings
     void SaveSettings();
     void LoadSettings();
     std::string GetSettingsFilePath();
+    std::string GetFontCachePath();
 
     // Class members
     bool m_isRunning;
@@ -110,16 +236,161 @@ private:
     ImVec2 m_networkWindowPos;
     OverlaySettings m_settings;
 
+    // Performance counters (one batched query, see DeclareCounters)
+    CounterRegistry m_counterRegistry;
+    int m_counterCpuTotal = -1;
+    int m_counterCommitted = -1;
+    int m_counterPagingFile = -1;
+    int m_counterDiskBytes = -1;
+    int m_counterQueueLength = -1;
+    int m_counterContextSwitches = -1;
+
     // CPU monitoring variables
-    PDH_HQUERY m_cpuQuery;
-    PDH_HCOUNTER m_cpuTotal;
-    bool m_pdh_initialized;
-    std::vector<int> m_cpuUsageHistory;
+    MovingAverage<int, CPU_HISTORY_SIZE> m_cpuUsageAverage;
+    SlidingMinMax<int, CPU_HISTORY_SIZE> m_cpuUsageRange;     // Raw samples behind the average
     int m_smoothedCpuUsage;
 
+    // Long CPU history, drawn decimated to the sparkline's pixel width
+    HistoryRing m_cpuHistory;
+    ChartDecimator m_cpuSparkline;
+    uint64_t m_cpuHistoryLastMs = 0;
+    std::vector<ImVec2> m_sparklinePoints;
+
+    // Metric subscriptions: each widget subscribes to what it shows, and
+    // CollectMetrics only samples metrics that have live subscribers
+    MetricSubscriptions m_subscriptions;
+    MetricSubscription m_cpuWidgetSub;
+    MetricSubscription m_countersWidgetSub;
+    MetricSubscription m_temperatureWidgetSub;
+    MetricSubscription m_memoryWidgetSub;
+    MetricSubscription m_batteryWidgetSub;
+    MetricSubscription m_networkSpeedWidgetSub;
+    MetricSubscription m_networkDetailsWidgetSub;
+    MetricSubscription m_processesWidgetSub;
+    MetricSubscription m_storageWidgetSub;
+    MetricSubscription m_connectionsWidgetSub;
+    MetricSubscription m_selfWidgetSub;
+
+    // Held while metrics are published externally, visible or not
+    MetricSubscription m_cpuExporterSub;
+    MetricSubscription m_temperatureExporterSub;
+    MetricSubscription m_memoryExporterSub;
+    MetricSubscription m_batteryExporterSub;
+    MetricSubscription m_networkSpeedExporterSub;
+
+    // Held for the signals the compiled alert rules look at
+    MetricSubscription m_cpuAlertSub;
+    MetricSubscription m_temperatureAlertSub;
+    MetricSubscription m_memoryAlertSub;
+    MetricSubscription m_batteryAlertSub;
+    MetricSubscription m_networkSpeedAlertSub;
+    MetricSubscription m_networkDetailsAlertSub;
+
+    // Subscribers set the fastest rate; the sampler backs off while a metric is flat
+    AdaptiveSampler m_adaptiveSampler;
+
+    // Top CPU/memory consumers
+    ProcessSampler m_processSampler;
+
+    // What the overlay itself costs
+    SelfMonitor m_selfMonitor;
+
+    // Disks and volumes (only sampled while the section is expanded)
+    StorageMonitor m_storageMonitor;
+    bool m_storageSectionOpen = true;
+
+    // TCP/UDP connections (network window, only while expanded)
+    ConnectionMonitor m_connectionMonitor;
+    bool m_connectionsSectionOpen = false;
+
+    // Loopback OpenMetrics endpoint; fed from CollectMetrics whenever something was sampled
+    MetricsExporter m_metricsExporter;
+
+    // Named shared-memory region (SharedMetrics.h) for local tools
+    SharedMetricsPublisher m_sharedMetrics;
+    bool m_metricsSampled = false;
+    int m_countersSubsystem = -1;
+    int m_networkSpeedSubsystem = -1;
+
+    // Blocking OS queries (WMI, power status, WLAN) run on this thread. A job's sample is
+    // only written by the collector between Request and completion, and only read here
+    // after TakeResult hands it over, so none of them need a lock.
+    struct BatterySample
+    {
+        bool present = false;
+        int percent = 0;
+        bool charging = false;
+        int minutes = -1;
+    };
+    struct NetworkDetailsSample
+    {
+        std::string name;
+        bool wifiEnabled = false;
+    };
+    BackgroundCollector m_collector;
+    int m_temperatureJob = -1;
+    int m_memoryJob = -1;
+    int m_batteryJob = -1;
+    int m_networkDetailsJob = -1;
+    Timestamped<int> m_temperatureSample;
+    Timestamped<MEMORYSTATUSEX> m_memorySample;
+    Timestamped<BatterySample> m_batterySample;
+    Timestamped<NetworkDetailsSample> m_networkDetailsSample;
+    NetworkManager m_networkProbe;              // The collector's own instance; shares nothing with m_networkManager
+    IWbemLocator* m_wbemLocator = nullptr;      // Connected once per collector thread, not per sample
+    IWbemServices* m_wbemServices = nullptr;
+    
+    // Plugins run on the host's own collection thread; the UI only reads their published samples
+    PluginHost m_pluginHost;
+    int m_pluginBudgetApplied = 0;
+
+    // Latency percentiles, refreshed from the shared histograms once a second
+    std::vector<LatencySnapshot> m_latencySnapshots;
+    uint64_t m_latencySnapshotMs = 0;
+
+    // Threshold rules; fire a toast while visible, a tray balloon while hidden
+    AlertEngine m_alertEngine;
+    std::vector<AlertEvent> m_alertEvents;
+    std::string m_alertToastTitle;
+    std::string m_alertToast;
+    bool m_alertToastWarning = false;
+    uint64_t m_alertToastUntilMs = 0;
+    bool m_trayIconAdded = false;
+
+    // Where the last trace dump went (shown in settings)
+    std::string m_lastTracePath;
+
+    // Persistent per-day/per-month data usage
+    TrafficAccountant m_trafficAccountant;
+    std::vector<InterfaceTraffic> m_interfaceTraffic;
+
+    // Latest collected samples
+    int m_cpuUsage = 0;
+    int m_cpuTemperature = 0;
+    MEMORYSTATUSEX m_memoryInfo = GetMemoryStatusEx();
+    bool m_hasBattery = false;
+    int m_batteryPercent = 0;
+    bool m_batteryCharging = false;
+    int m_batteryMinutes = -1;
+    std::string m_networkName;
+    bool m_wifiEnabled = false;
+
+    // Power policy and frame pacing
+    PowerPolicy m_powerPolicy;
+    FramePacer m_framePacer;
+
     // Manager instances
     AudioManager m_audioManager;
     NetworkManager m_networkManager;
+    ActivityGovernor m_activityGovernor;
+    HotkeyManager m_hotkeyManager;
+    WindowTracker m_windowTracker;
+
+    // Visualizer render state (reused every frame to avoid allocations)
+    std::vector<float> m_visualizerFrame;
+    std::vector<float> m_visualizerPeakFrame;
+    VisualizerGeometry m_visualizerGeometry;
 
     ImFont* m_emojiFont = nullptr;
+    FontAtlasCache m_fontCache;
 };
\ No newline at end of file
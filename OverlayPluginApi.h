@@ -0,0 +1,104 @@
+/*
+ * Plugin interface for third-party metric providers in Windows Info Overlay.
+ *
+ * A plugin is a DLL (a shared object elsewhere) in the overlay's plugins directory that
+ * exports OverlayPluginGetInfo. It describes itself once: a name, the metrics it provides
+ * and a collection interval. The overlay then calls collect() on its own collection thread
+ * with one preallocated sample slot per declared metric, and the plugin writes its values
+ * into those slots in place. Nothing is allocated and no strings cross the boundary after
+ * the plugin has been loaded.
+ *
+ * Rules for collect():
+ *   - Keep it short. A call that runs past the overlay's time budget counts as an overrun,
+ *     and a plugin that overruns several times in a row is disabled. A call that never
+ *     returns trips the watchdog: the plugin is disabled and its thread abandoned.
+ *   - Only touch the slots you were given. Set 'valid' on the slots you filled; slots left
+ *     at 0 show as "no data" for this tick.
+ *   - collect() and close() are only ever called from one thread at a time.
+ *
+ * Plain C so plugins can be written in anything that can export a C function. Layout only
+ * ever grows at the end; the host checks 'apiVersion' and 'size'.
+ *
+ *     static const OverlayPluginMetric metrics[] = { { "Build queue", "jobs", 0.0, 0.0 } };
+ *
+ *     static int Collect(void* context, OverlayPluginSample* samples, uint32_t count)
+ *     {
+ *         samples[0].value = QueryBuildQueueLength();
+ *         samples[0].valid = 1;
+ *         return 0;
+ *     }
+ *
+ *     static const OverlayPluginInfo info = {
+ *         OVERLAY_PLUGIN_API_VERSION, sizeof(OverlayPluginInfo), "Build farm",
+ *         1, metrics, 2000, NULL, NULL, Collect, NULL
+ *     };
+ *
+ *     OVERLAY_PLUGIN_EXPORT const OverlayPluginInfo* OverlayPluginGetInfo(uint32_t hostApiVersion)
+ *     {
+ *         return &info;
+ *     }
+ */
+#ifndef OVERLAY_PLUGIN_API_H
+#define OVERLAY_PLUGIN_API_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OVERLAY_PLUGIN_API_VERSION 1u           /* Bumped on incompatible changes */
+#define OVERLAY_PLUGIN_ENTRY_POINT "OverlayPluginGetInfo"
+
+#define OVERLAY_PLUGIN_MAX_METRICS 16
+#define OVERLAY_PLUGIN_NAME_LENGTH 32
+#define OVERLAY_PLUGIN_UNIT_LENGTH 8
+
+#ifdef _WIN32
+#define OVERLAY_PLUGIN_EXPORT __declspec(dllexport)
+#else
+#define OVERLAY_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+/* One metric the plugin provides */
+typedef struct OverlayPluginMetric {
+    char name[OVERLAY_PLUGIN_NAME_LENGTH];    /* Label on the overlay */
+    char unit[OVERLAY_PLUGIN_UNIT_LENGTH];    /* Shown after the value, may be empty */
+    double minValue;                          /* Display range; equal values = none */
+    double maxValue;
+} OverlayPluginMetric;
+
+/* Sample slot owned by the host; one per declared metric, in declaration order */
+typedef struct OverlayPluginSample {
+    double value;
+    uint32_t valid;       /* Nonzero if 'value' was produced by this call */
+    uint32_t reserved;
+} OverlayPluginSample;
+
+/* Return codes for open() and collect() */
+#define OVERLAY_PLUGIN_OK 0
+#define OVERLAY_PLUGIN_RETRY 1      /* Nothing this time, keep calling */
+#define OVERLAY_PLUGIN_FAILED -1    /* Give up on this plugin */
+
+typedef struct OverlayPluginInfo {
+    uint32_t apiVersion;              /* OVERLAY_PLUGIN_API_VERSION the plugin was built against */
+    uint32_t size;                    /* sizeof(OverlayPluginInfo) */
+    const char* name;                 /* Copied by the host when the plugin is loaded */
+    uint32_t metricCount;             /* 1..OVERLAY_PLUGIN_MAX_METRICS */
+    const OverlayPluginMetric* metrics;
+    uint32_t intervalMs;              /* How often collect() should run */
+    void* context;                    /* Passed back to every callback */
+
+    int (*open)(void* context);       /* Optional; called on the collection thread before the first collect() */
+    int (*collect)(void* context, OverlayPluginSample* samples, uint32_t count);
+    void (*close)(void* context);     /* Optional; called before the plugin is unloaded */
+} OverlayPluginInfo;
+
+/* The one exported function. Return NULL to refuse loading (e.g. hostApiVersion too old). */
+typedef const OverlayPluginInfo* (*OverlayPluginGetInfoFn)(uint32_t hostApiVersion);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OVERLAY_PLUGIN_API_H */
@@ -0,0 +1,66 @@
+#include "PdhCounterBackend.h"
+
+#pragma comment(lib, "pdh.lib")
+
+PdhCounterBackend::PdhCounterBackend() :
+    m_query(NULL)
+{
+}
+
+PdhCounterBackend::~PdhCounterBackend()
+{
+    Close();
+}
+
+bool PdhCounterBackend::Open()
+{
+    if (m_query)
+        return true;
+    return PdhOpenQuery(NULL, 0, &m_query) == ERROR_SUCCESS;
+}
+
+void PdhCounterBackend::Close()
+{
+    if (m_query)
+    {
+        PdhCloseQuery(m_query);   // Also removes every counter in the query
+        m_query = NULL;
+    }
+    m_counters.clear();
+}
+
+bool PdhCounterBackend::AddCounter(const std::string& path, int index)
+{
+    if (index >= static_cast<int>(m_counters.size()))
+        m_counters.resize(index + 1, NULL);
+
+    PDH_HCOUNTER counter = NULL;
+    if (PdhAddEnglishCounterA(m_query, path.c_str(), 0, &counter) != ERROR_SUCCESS)
+        return false;
+
+    m_counters[index] = counter;
+    return true;
+}
+
+bool PdhCounterBackend::Prime()
+{
+    // First collect is the baseline for rate counters, subsequent calls produce values
+    return PdhCollectQueryData(m_query) == ERROR_SUCCESS;
+}
+
+bool PdhCounterBackend::Collect(double* values, size_t count)
+{
+    if (PdhCollectQueryData(m_query) != ERROR_SUCCESS)
+        return false;
+
+    for (size_t i = 0; i < count && i < m_counters.size(); i++)
+    {
+        if (!m_counters[i])
+            continue;
+
+        PDH_FMT_COUNTERVALUE counterVal;
+        if (PdhGetFormattedCounterValue(m_counters[i], PDH_FMT_DOUBLE, NULL, &counterVal) == ERROR_SUCCESS)
+            values[i] = counterVal.doubleValue;
+    }
+    return true;
+}
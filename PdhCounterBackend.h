@@ -0,0 +1,23 @@
+#pragma once
+
+#include <windows.h>
+#include <pdh.h>
+#include <vector>
+#include "CounterRegistry.h"
+
+// Counter registry backend built on a single PDH query
+class PdhCounterBackend : public ICounterBackend {
+public:
+    PdhCounterBackend();
+    ~PdhCounterBackend() override;
+
+    bool Open() override;
+    void Close() override;
+    bool AddCounter(const std::string& path, int index) override;
+    bool Prime() override;
+    bool Collect(double* values, size_t count) override;
+
+private:
+    PDH_HQUERY m_query;
+    std::vector<PDH_HCOUNTER> m_counters;   // Indexed like the registry, NULL if unavailable
+};
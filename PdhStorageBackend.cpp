@@ -0,0 +1,145 @@
+#include "PdhStorageBackend.h"
+#include <cstring>
+
+#pragma comment(lib, "pdh.lib")
+
+static const char* s_diskCounterPaths[] = {
+    "\\PhysicalDisk(*)\\Disk Read Bytes/sec",
+    "\\PhysicalDisk(*)\\Disk Write Bytes/sec",
+    "\\PhysicalDisk(*)\\Disk Reads/sec",
+    "\\PhysicalDisk(*)\\Disk Writes/sec",
+    "\\PhysicalDisk(*)\\Current Disk Queue Length"
+};
+
+PdhStorageBackend::PdhStorageBackend(const Clock& clock) :
+    m_clock(clock),
+    m_query(NULL)
+{
+    memset(m_counters, 0, sizeof(m_counters));
+    memset(m_itemCounts, 0, sizeof(m_itemCounts));
+}
+
+PdhStorageBackend::~PdhStorageBackend()
+{
+    Close();
+}
+
+bool PdhStorageBackend::Open()
+{
+    if (m_query)
+        return true;
+    if (PdhOpenQuery(NULL, 0, &m_query) != ERROR_SUCCESS)
+        return false;
+    
+    for (int i = 0; i < DISK_COUNTER_COUNT; i++)
+    {
+        if (PdhAddEnglishCounterA(m_query, s_diskCounterPaths[i], 0, &m_counters[i]) != ERROR_SUCCESS)
+        {
+            Close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void PdhStorageBackend::Close()
+{
+    if (m_query)
+    {
+        PdhCloseQuery(m_query);
+        m_query = NULL;
+    }
+    memset(m_counters, 0, sizeof(m_counters));
+}
+
+bool PdhStorageBackend::ReadArray(int id)
+{
+    DWORD bufferSize = static_cast<DWORD>(m_arrays[id].size());
+    DWORD itemCount = 0;
+    PDH_STATUS status = PdhGetRawCounterArrayA(m_counters[id], &bufferSize, &itemCount,
+        reinterpret_cast<PPDH_RAW_COUNTER_ITEM_A>(m_arrays[id].data()));
+    if (status == PDH_MORE_DATA)
+    {
+        m_arrays[id].resize(bufferSize);
+        status = PdhGetRawCounterArrayA(m_counters[id], &bufferSize, &itemCount,
+            reinterpret_cast<PPDH_RAW_COUNTER_ITEM_A>(m_arrays[id].data()));
+    }
+    m_itemCounts[id] = status == ERROR_SUCCESS ? itemCount : 0;
+    return status == ERROR_SUCCESS;
+}
+
+bool PdhStorageBackend::CollectDisks(std::vector<DiskCounters>& disks)
+{
+    disks.clear();
+    if (!m_query || PdhCollectQueryData(m_query) != ERROR_SUCCESS)
+        return false;
+    
+    for (int i = 0; i < DISK_COUNTER_COUNT; i++)
+    {
+        if (!ReadArray(i))
+            return false;
+    }
+    
+    const PDH_RAW_COUNTER_ITEM_A* items[DISK_COUNTER_COUNT];
+    for (int i = 0; i < DISK_COUNTER_COUNT; i++)
+        items[i] = reinterpret_cast<const PDH_RAW_COUNTER_ITEM_A*>(m_arrays[i].data());
+    
+    // Stamp with the same clock as every other sampler; PDH's FILETIME is wall time and
+    // jumps with clock adjustments, which would skew or stall the rates
+    uint64_t nowNs = m_clock.NowNs();
+    
+    // Instances come back in the same order for every counter of one collection
+    DWORD count = m_itemCounts[0];
+    for (int i = 1; i < DISK_COUNTER_COUNT; i++)
+        if (m_itemCounts[i] < count)
+            count = m_itemCounts[i];
+    
+    for (DWORD n = 0; n < count; n++)
+    {
+        const char* name = items[DISK_READ_BYTES][n].szName;
+        if (strcmp(name, "_Total") == 0)
+            continue;
+        
+        DiskCounters disk;
+        strncpy_s(disk.name, name, _TRUNCATE);
+        disk.readBytes = static_cast<uint64_t>(items[DISK_READ_BYTES][n].RawValue.FirstValue);
+        disk.writeBytes = static_cast<uint64_t>(items[DISK_WRITE_BYTES][n].RawValue.FirstValue);
+        disk.reads = static_cast<uint64_t>(items[DISK_READS][n].RawValue.FirstValue);
+        disk.writes = static_cast<uint64_t>(items[DISK_WRITES][n].RawValue.FirstValue);
+        disk.queueLength = static_cast<uint32_t>(items[DISK_QUEUE_LENGTH][n].RawValue.FirstValue);
+        disk.timestampNs = nowNs;
+        disks.push_back(disk);
+    }
+    
+    return true;
+}
+
+bool PdhStorageBackend::CollectVolumes(std::vector<VolumeSpace>& volumes)
+{
+    volumes.clear();
+    
+    DWORD drives = GetLogicalDrives();
+    for (int i = 0; i < 26; i++)
+    {
+        if (!(drives & (1u << i)))
+            continue;
+        
+        char root[] = { static_cast<char>('A' + i), ':', '\\', '\0' };
+        if (GetDriveTypeA(root) != DRIVE_FIXED)
+            continue;
+        
+        ULARGE_INTEGER freeBytes, totalBytes;
+        if (!GetDiskFreeSpaceExA(root, &freeBytes, &totalBytes, NULL))
+            continue;
+        
+        VolumeSpace volume;
+        volume.name[0] = root[0];
+        volume.name[1] = ':';
+        volume.name[2] = '\0';
+        volume.freeBytes = freeBytes.QuadPart;
+        volume.totalBytes = totalBytes.QuadPart;
+        volumes.push_back(volume);
+    }
+    
+    return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <windows.h>
+#include <pdh.h>
+#include <vector>
+#include "Clock.h"
+#include "StorageMonitor.h"
+
+// Storage backend: one PDH query with wildcard PhysicalDisk counters read as raw
+// 64-bit arrays, plus GetDiskFreeSpaceEx for fixed volumes
+class PdhStorageBackend : public IStorageBackend {
+public:
+    explicit PdhStorageBackend(const Clock& clock = Clock::System());
+    ~PdhStorageBackend() override;
+
+    bool Open() override;
+    void Close() override;
+    bool CollectDisks(std::vector<DiskCounters>& disks) override;
+    bool CollectVolumes(std::vector<VolumeSpace>& volumes) override;
+
+private:
+    enum DiskCounterId {
+        DISK_READ_BYTES,
+        DISK_WRITE_BYTES,
+        DISK_READS,
+        DISK_WRITES,
+        DISK_QUEUE_LENGTH,
+        DISK_COUNTER_COUNT
+    };
+
+    // Fetch one counter's raw instance array into m_arrays[id]
+    bool ReadArray(int id);
+
+    const Clock& m_clock;
+    PDH_HQUERY m_query;
+    PDH_HCOUNTER m_counters[DISK_COUNTER_COUNT];
+    std::vector<BYTE> m_arrays[DISK_COUNTER_COUNT];   // Reused PDH_RAW_COUNTER_ITEM_A buffers
+    DWORD m_itemCounts[DISK_COUNTER_COUNT];
+};
@@ -0,0 +1,525 @@
+#include "PluginHost.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <dlfcn.h>
+#endif
+
+#ifdef _WIN32
+#define PLUGIN_LIBRARY_SUFFIX ".dll"
+#else
+#define PLUGIN_LIBRARY_SUFFIX ".so"
+#endif
+
+// A call in progress is tagged (sequence << 16) | (plugin index + 1); 0 = no call
+#define PLUGIN_CALL_IDLE 0ull
+#define PLUGIN_CALL_ABANDONED (~0ull)
+
+struct PluginHost::Plugin {
+    std::string path;
+    void* library = nullptr;
+    OverlayPluginInfo info = {};
+    char name[OVERLAY_PLUGIN_NAME_LENGTH] = {};
+    OverlayPluginMetric metrics[OVERLAY_PLUGIN_MAX_METRICS] = {};
+    uint64_t intervalNs = 0;
+
+    // Collection thread only
+    bool opened = false;
+    uint64_t nextDueNs = 0;
+    uint32_t overruns = 0;
+    OverlayPluginSample working[OVERLAY_PLUGIN_MAX_METRICS] = {};
+
+    // Shared with readers
+    mutable std::mutex publishMutex;
+    OverlayPluginSample published[OVERLAY_PLUGIN_MAX_METRICS] = {};
+    uint64_t publishedNs = 0;
+    bool hasSamples = false;
+    std::atomic<int> state{ PLUGIN_RUNNING };
+    std::atomic<uint64_t> lastDurationNs{ 0 };
+};
+
+struct PluginHost::Collector {
+    std::vector<std::shared_ptr<Plugin>> plugins;
+    const Clock* clock = nullptr;
+    uint64_t budgetNs = 0;
+
+    std::atomic<uint64_t> call{ PLUGIN_CALL_IDLE };
+    std::atomic<bool> paused{ false };
+
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    bool kicked = false;
+    bool stop = false;
+    bool exited = false;
+    std::thread thread;
+};
+
+static void* OpenLibrary(const std::string& path, std::string& error)
+{
+#ifdef _WIN32
+    // Let a plugin's own dependencies resolve from its directory
+    HMODULE module = LoadLibraryExA(path.c_str(), NULL, LOAD_WITH_ALTERED_SEARCH_PATH);
+    if (!module)
+        error = "LoadLibrary failed (error " + std::to_string(GetLastError()) + ")";
+    return module;
+#else
+    void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle)
+        error = dlerror();
+    return handle;
+#endif
+}
+
+static void* FindSymbol(void* library, const char* name)
+{
+#ifdef _WIN32
+    return reinterpret_cast<void*>(GetProcAddress(static_cast<HMODULE>(library), name));
+#else
+    return dlsym(library, name);
+#endif
+}
+
+static void CloseLibrary(void* library)
+{
+#ifdef _WIN32
+    FreeLibrary(static_cast<HMODULE>(library));
+#else
+    dlclose(library);
+#endif
+}
+
+static std::vector<std::string> ListLibraries(const std::string& directory)
+{
+    std::vector<std::string> names;
+    const size_t suffixLength = strlen(PLUGIN_LIBRARY_SUFFIX);
+
+#ifdef _WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA((directory + "\\*" PLUGIN_LIBRARY_SUFFIX).c_str(), &data);
+    if (find == INVALID_HANDLE_VALUE)
+        return names;
+    do {
+        if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+            names.push_back(data.cFileName);
+    } while (FindNextFileA(find, &data));
+    FindClose(find);
+#else
+    DIR* dir = opendir(directory.c_str());
+    if (!dir)
+        return names;
+    while (dirent* entry = readdir(dir)) {
+        size_t length = strlen(entry->d_name);
+        if (length > suffixLength && strcmp(entry->d_name + length - suffixLength, PLUGIN_LIBRARY_SUFFIX) == 0)
+            names.push_back(entry->d_name);
+    }
+    closedir(dir);
+#endif
+
+    // Load order decides display order; keep it stable
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+PluginHost::PluginHost(const Clock& clock) : m_clock(clock)
+{
+}
+
+PluginHost::~PluginHost()
+{
+    Stop();
+    UnloadAll();
+}
+
+int PluginHost::LoadDirectory(const std::string& directory)
+{
+    int loaded = 0;
+    for (const auto& name : ListLibraries(directory)) {
+#ifdef _WIN32
+        if (Load(directory + "\\" + name))
+#else
+        if (Load(directory + "/" + name))
+#endif
+            loaded++;
+    }
+    return loaded;
+}
+
+bool PluginHost::Load(const std::string& path)
+{
+    if (m_running)
+        return false;
+    if (m_plugins.size() >= PLUGIN_MAX_LOADED) {
+        m_loadErrors.push_back(path + ": too many plugins");
+        return false;
+    }
+
+    std::string error;
+    void* library = OpenLibrary(path, error);
+    if (!library) {
+        m_loadErrors.push_back(path + ": " + error);
+        return false;
+    }
+
+    auto getInfo = reinterpret_cast<OverlayPluginGetInfoFn>(FindSymbol(library, OVERLAY_PLUGIN_ENTRY_POINT));
+    const OverlayPluginInfo* info = getInfo ? getInfo(OVERLAY_PLUGIN_API_VERSION) : nullptr;
+
+    const char* reason = nullptr;
+    if (!getInfo)
+        reason = "no " OVERLAY_PLUGIN_ENTRY_POINT " export";
+    else if (!info)
+        reason = "plugin declined to load";
+    else if (info->apiVersion != OVERLAY_PLUGIN_API_VERSION || info->size < sizeof(OverlayPluginInfo))
+        reason = "built for a different plugin API version";
+    else if (!info->collect || !info->metrics || info->metricCount == 0 || info->metricCount > OVERLAY_PLUGIN_MAX_METRICS)
+        reason = "invalid plugin description";
+
+    if (reason) {
+        CloseLibrary(library);
+        m_loadErrors.push_back(path + ": " + reason);
+        return false;
+    }
+
+    // Copy the description so nothing but the callbacks is read from the plugin afterwards
+    auto plugin = std::make_shared<Plugin>();
+    plugin->path = path;
+    plugin->library = library;
+    memcpy(&plugin->info, info, sizeof(OverlayPluginInfo));
+    plugin->info.size = sizeof(OverlayPluginInfo);
+
+    const char* name = info->name ? info->name : path.c_str() + path.find_last_of("\\/") + 1;
+    strncpy(plugin->name, name, OVERLAY_PLUGIN_NAME_LENGTH - 1);
+    for (uint32_t i = 0; i < info->metricCount; i++) {
+        plugin->metrics[i] = info->metrics[i];
+        plugin->metrics[i].name[OVERLAY_PLUGIN_NAME_LENGTH - 1] = '\0';
+        plugin->metrics[i].unit[OVERLAY_PLUGIN_UNIT_LENGTH - 1] = '\0';
+    }
+    plugin->intervalNs = std::max<uint64_t>(info->intervalMs, PLUGIN_MIN_INTERVAL_MS) * 1000000ull;
+
+    m_plugins.push_back(plugin);
+    return true;
+}
+
+void PluginHost::UnloadAll()
+{
+    if (m_running)
+        return;
+
+    for (auto& plugin : m_plugins) {
+        // A hung call may still come back into the library one day
+        if (plugin->state.load() != PLUGIN_HUNG)
+            CloseLibrary(plugin->library);
+    }
+    m_plugins.clear();
+    m_loadErrors.clear();
+}
+
+bool PluginHost::Start()
+{
+    if (m_running)
+        return true;
+    if (m_plugins.empty())
+        return false;
+
+    // Plugins disabled in a previous run get another chance (hung ones never do)
+    for (auto& plugin : m_plugins) {
+        if (plugin->state.load() != PLUGIN_HUNG) {
+            plugin->state.store(PLUGIN_RUNNING);
+            plugin->overruns = 0;
+            plugin->nextDueNs = 0;
+        }
+    }
+
+    StartCollector();
+    m_watchdogStop = false;
+    m_watchdog = std::thread(&PluginHost::WatchdogLoop, this);
+    m_running = true;
+    return true;
+}
+
+void PluginHost::StartCollector()
+{
+    auto collector = std::make_shared<Collector>();
+    collector->plugins = m_plugins;
+    collector->clock = &m_clock;
+    collector->budgetNs = static_cast<uint64_t>(m_budgetMs) * 1000000ull;
+    collector->paused.store(m_paused.load());
+    collector->thread = std::thread(&PluginHost::CollectLoop, collector);
+
+    std::lock_guard<std::mutex> lock(m_collectorMutex);
+    m_collector = collector;
+}
+
+void PluginHost::Stop()
+{
+    if (!m_running)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_watchdogMutex);
+        m_watchdogStop = true;
+    }
+    m_watchdogWake.notify_all();
+    m_watchdog.join();
+
+    std::shared_ptr<Collector> collector;
+    {
+        std::lock_guard<std::mutex> lock(m_collectorMutex);
+        collector.swap(m_collector);
+    }
+
+    // The thread closes its plugins on the way out. A plugin stuck in a call doesn't get to
+    // hold up shutdown for longer than the watchdog would have allowed.
+    bool exited;
+    {
+        std::unique_lock<std::mutex> lock(collector->wakeMutex);
+        collector->stop = true;
+        collector->kicked = true;
+        collector->wake.notify_all();
+        exited = collector->done.wait_for(lock, std::chrono::milliseconds(m_watchdogMs), [&] { return collector->exited; });
+    }
+    if (!exited && AbandonCall(*collector, collector->call.load()))
+        collector->thread.detach();
+    else
+        collector->thread.join();
+
+    m_running = false;
+}
+
+void PluginHost::SetPaused(bool paused)
+{
+    m_paused.store(paused);
+
+    std::lock_guard<std::mutex> lock(m_collectorMutex);
+    if (!m_collector)
+        return;
+    m_collector->paused.store(paused);
+    {
+        std::lock_guard<std::mutex> wakeLock(m_collector->wakeMutex);
+        m_collector->kicked = true;
+    }
+    m_collector->wake.notify_all();
+}
+
+// Take a stuck call away from its thread. Fails if the call finished in the meantime.
+bool PluginHost::AbandonCall(Collector& collector, uint64_t call)
+{
+    if (call == PLUGIN_CALL_IDLE || call == PLUGIN_CALL_ABANDONED)
+        return false;
+    if (!collector.call.compare_exchange_strong(call, PLUGIN_CALL_ABANDONED))
+        return false;
+
+    collector.plugins[(call & 0xFFFF) - 1]->state.store(PLUGIN_HUNG);
+    return true;
+}
+
+void PluginHost::WatchdogLoop()
+{
+    const uint64_t limitNs = static_cast<uint64_t>(m_watchdogMs) * 1000000ull;
+    const auto checkInterval = std::chrono::milliseconds(std::max<uint32_t>(m_watchdogMs / 4, 1));
+    uint64_t observedCall = PLUGIN_CALL_IDLE;
+    uint64_t observedSinceNs = 0;
+    TraceRecorder::Instance().SetThreadName("Plugin watchdog");
+
+    std::unique_lock<std::mutex> lock(m_watchdogMutex);
+    while (!m_watchdogWake.wait_for(lock, checkInterval, [this] { return m_watchdogStop; })) {
+        // Only this thread replaces the collector while running, so no lock to read it
+        uint64_t call = m_collector->call.load();
+        uint64_t now = m_clock.NowNs();
+
+        // Call tags are unique, so seeing the same one for the whole limit means one call took that long
+        if (call != observedCall) {
+            observedCall = call;
+            observedSinceNs = now;
+            continue;
+        }
+        if (call == PLUGIN_CALL_IDLE || now - observedSinceNs < limitNs)
+            continue;
+
+        if (AbandonCall(*m_collector, call)) {
+            m_collector->thread.detach();
+            StartCollector();
+        }
+        observedCall = PLUGIN_CALL_IDLE;
+    }
+}
+
+void PluginHost::CollectLoop(std::shared_ptr<Collector> owner)
+{
+    Collector& collector = *owner;
+    TraceRecorder::Instance().SetThreadName("Plugin collection");
+    uint64_t sequence = 0;
+    uint64_t call = PLUGIN_CALL_IDLE;
+
+    // Every callback runs between these two; a failed Leave means the watchdog gave up on
+    // the call, and from then on this thread must not touch anything but 'owner'
+    auto enter = [&](size_t index) {
+        call = (++sequence << 16) | (index + 1);
+        collector.call.store(call);
+    };
+    auto leave = [&]() {
+        uint64_t expected = call;
+        return collector.call.compare_exchange_strong(expected, PLUGIN_CALL_IDLE);
+    };
+    auto close = [&](Plugin& plugin, size_t index) {
+        if (plugin.opened && plugin.info.close) {
+            enter(index);
+            plugin.info.close(plugin.info.context);
+            if (!leave())
+                return false;
+        }
+        plugin.opened = false;
+        return true;
+    };
+    auto disable = [&](Plugin& plugin, size_t index, PluginState state) {
+        plugin.state.store(state);
+        return close(plugin, index);
+    };
+
+    for (;;) {
+        uint64_t wakeNs = collector.clock->NowNs() + 1000000000ull;
+
+        for (size_t i = 0; i < collector.plugins.size() && !collector.paused.load(); i++) {
+            Plugin& plugin = *collector.plugins[i];
+            if (plugin.state.load() != PLUGIN_RUNNING)
+                continue;
+
+            if (!plugin.opened) {
+                int result = OVERLAY_PLUGIN_OK;
+                if (plugin.info.open) {
+                    enter(i);
+                    result = plugin.info.open(plugin.info.context);
+                    if (!leave())
+                        return;
+                }
+                plugin.opened = true;
+                if (result == OVERLAY_PLUGIN_FAILED) {
+                    if (!disable(plugin, i, PLUGIN_FAILED))
+                        return;
+                    continue;
+                }
+            }
+
+            uint64_t start = collector.clock->NowNs();
+            if (start < plugin.nextDueNs) {
+                wakeNs = std::min(wakeNs, plugin.nextDueNs);
+                continue;
+            }
+
+            for (uint32_t m = 0; m < plugin.info.metricCount; m++)
+                plugin.working[m].valid = 0;
+
+            enter(i);
+            int result = plugin.info.collect(plugin.info.context, plugin.working, plugin.info.metricCount);
+            if (!leave())
+                return;
+
+            uint64_t end = collector.clock->NowNs();
+            plugin.lastDurationNs.store(end - start);
+            plugin.nextDueNs = end + plugin.intervalNs;
+            wakeNs = std::min(wakeNs, plugin.nextDueNs);
+
+            if (result == OVERLAY_PLUGIN_FAILED) {
+                if (!disable(plugin, i, PLUGIN_FAILED))
+                    return;
+                continue;
+            }
+            if (result == OVERLAY_PLUGIN_OK) {
+                std::lock_guard<std::mutex> lock(plugin.publishMutex);
+                memcpy(plugin.published, plugin.working, plugin.info.metricCount * sizeof(OverlayPluginSample));
+                plugin.publishedNs = end;
+                plugin.hasSamples = true;
+            }
+
+            // The budget is enforced after the fact; the watchdog covers calls that never end
+            if (end - start > collector.budgetNs) {
+                if (++plugin.overruns >= PLUGIN_MAX_OVERRUNS && !disable(plugin, i, PLUGIN_OVER_BUDGET))
+                    return;
+            }
+            else {
+                plugin.overruns = 0;
+            }
+        }
+
+        // Sleep until the next plugin is due, or until unpaused / stopped
+        std::unique_lock<std::mutex> lock(collector.wakeMutex);
+        if (!collector.kicked) {
+            uint64_t now = collector.clock->NowNs();
+            if (collector.paused.load())
+                collector.wake.wait(lock, [&] { return collector.kicked; });
+            else if (wakeNs > now)
+                collector.wake.wait_for(lock, std::chrono::nanoseconds(wakeNs - now), [&] { return collector.kicked; });
+        }
+        collector.kicked = false;
+        if (collector.stop)
+            break;
+    }
+
+    for (size_t i = 0; i < collector.plugins.size(); i++) {
+        Plugin& plugin = *collector.plugins[i];
+        if (plugin.state.load() != PLUGIN_HUNG && !close(plugin, i))
+            return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(collector.wakeMutex);
+        collector.exited = true;
+    }
+    collector.done.notify_all();
+}
+
+const char* PluginHost::GetPluginName(size_t plugin) const
+{
+    return m_plugins[plugin]->name;
+}
+
+uint32_t PluginHost::GetMetricCount(size_t plugin) const
+{
+    return m_plugins[plugin]->info.metricCount;
+}
+
+const OverlayPluginMetric& PluginHost::GetMetric(size_t plugin, uint32_t metric) const
+{
+    return m_plugins[plugin]->metrics[metric];
+}
+
+PluginState PluginHost::GetState(size_t plugin) const
+{
+    return static_cast<PluginState>(m_plugins[plugin]->state.load());
+}
+
+uint64_t PluginHost::GetLastDurationNs(size_t plugin) const
+{
+    return m_plugins[plugin]->lastDurationNs.load();
+}
+
+uint32_t PluginHost::ReadSamples(size_t plugin, OverlayPluginSample* samples, uint32_t count, uint64_t* timestampNs) const
+{
+    const Plugin& source = *m_plugins[plugin];
+    std::lock_guard<std::mutex> lock(source.publishMutex);
+    if (!source.hasSamples)
+        return 0;
+
+    count = std::min(count, source.info.metricCount);
+    memcpy(samples, source.published, count * sizeof(OverlayPluginSample));
+    if (timestampNs)
+        *timestampNs = source.publishedNs;
+    return count;
+}
+
+const char* PluginHost::StateName(PluginState state)
+{
+    switch (state) {
+    case PLUGIN_RUNNING: return "Running";
+    case PLUGIN_OVER_BUDGET: return "Over budget";
+    case PLUGIN_HUNG: return "Hung";
+    case PLUGIN_FAILED: return "Failed";
+    }
+    return "Unknown";
+}
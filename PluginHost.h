@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Clock.h"
+#include "OverlayPluginApi.h"
+
+#define PLUGIN_DEFAULT_BUDGET_MS 25
+#define PLUGIN_DEFAULT_WATCHDOG_MS 2000
+#define PLUGIN_MAX_OVERRUNS 3           // Consecutive over-budget calls before a plugin is disabled
+#define PLUGIN_MIN_INTERVAL_MS 100
+#define PLUGIN_MAX_LOADED 64
+
+enum PluginState {
+    PLUGIN_RUNNING,
+    PLUGIN_OVER_BUDGET,    // Disabled after too many slow calls
+    PLUGIN_HUNG,           // A call never came back; the library is never unloaded
+    PLUGIN_FAILED          // open() or collect() gave up
+};
+
+// Loads metric provider plugins (OverlayPluginApi.h) and runs them on one collection thread.
+// Each plugin writes into its own preallocated sample slots; finished samples are copied
+// under a per-plugin lock into a published set that the UI reads. Calls over the time budget
+// are counted and repeat offenders disabled. A watchdog thread notices a call that doesn't
+// return at all: that plugin is marked hung, the stuck thread is abandoned (it can't be
+// killed safely) and a fresh collection thread carries on with the remaining plugins.
+class PluginHost {
+public:
+    explicit PluginHost(const Clock& clock = Clock::System());
+    ~PluginHost();
+
+    PluginHost(const PluginHost&) = delete;
+    PluginHost& operator=(const PluginHost&) = delete;
+
+    // Loading, unloading and configuration only while stopped
+    int LoadDirectory(const std::string& directory);    // Every *.dll (*.so elsewhere); returns how many loaded
+    bool Load(const std::string& path);                  // Reason goes to GetLoadErrors on failure
+    void UnloadAll();
+    const std::vector<std::string>& GetLoadErrors() const { return m_loadErrors; }
+
+    void SetBudgetMs(uint32_t budgetMs) { m_budgetMs = budgetMs; }          // Per collect() call
+    void SetWatchdogMs(uint32_t watchdogMs) { m_watchdogMs = watchdogMs; }
+
+    bool Start();
+    void Stop();
+    bool IsRunning() const { return m_running; }
+
+    // A paused host calls nothing; plugins stay loaded and open
+    void SetPaused(bool paused);
+
+    size_t GetPluginCount() const { return m_plugins.size(); }
+    const char* GetPluginName(size_t plugin) const;
+    uint32_t GetMetricCount(size_t plugin) const;
+    const OverlayPluginMetric& GetMetric(size_t plugin, uint32_t metric) const;
+    PluginState GetState(size_t plugin) const;
+    uint64_t GetLastDurationNs(size_t plugin) const;
+
+    // Copy the latest published samples (at most 'count'); returns how many were copied.
+    // Nothing is copied until the plugin's first successful collect().
+    uint32_t ReadSamples(size_t plugin, OverlayPluginSample* samples, uint32_t count, uint64_t* timestampNs = nullptr) const;
+
+    static const char* StateName(PluginState state);
+
+private:
+    struct Plugin;
+    struct Collector;
+
+    void StartCollector();
+    void WatchdogLoop();
+    static void CollectLoop(std::shared_ptr<Collector> collector);
+    static bool AbandonCall(Collector& collector, uint64_t call);
+
+    const Clock& m_clock;
+    std::vector<std::shared_ptr<Plugin>> m_plugins;
+    std::vector<std::string> m_loadErrors;
+    uint32_t m_budgetMs = PLUGIN_DEFAULT_BUDGET_MS;
+    uint32_t m_watchdogMs = PLUGIN_DEFAULT_WATCHDOG_MS;
+    std::atomic<bool> m_paused{ false };
+    bool m_running = false;
+
+    std::mutex m_collectorMutex;          // The watchdog replaces m_collector while running
+    std::shared_ptr<Collector> m_collector;
+
+    std::thread m_watchdog;
+    std::mutex m_watchdogMutex;
+    std::condition_variable m_watchdogWake;
+    bool m_watchdogStop = false;
+};
@@ -0,0 +1,42 @@
+#include "PowerPolicy.h"
+
+static const PowerProfile s_performance = { "Performance", 0,  250, 1000, 20.0, true,  true  };
+static const PowerProfile s_balanced    = { "Balanced",    30, 1000, 2000, 6.0,  false, false };
+static const PowerProfile s_saver       = { "Power Saver", 15, 3000, 5000, 2.0,  false, false };
+
+const PowerProfile& PowerPolicy::Performance() { return s_performance; }
+const PowerProfile& PowerPolicy::Balanced() { return s_balanced; }
+const PowerProfile& PowerPolicy::Saver() { return s_saver; }
+
+PowerPolicy::PowerPolicy() :
+    m_profile(&s_performance)
+{
+}
+
+bool PowerPolicy::Update(const PowerStatus& status)
+{
+    const PowerProfile* previous = m_profile;
+    m_profile = Select(status);
+    m_status = status;
+    m_lowBattery = m_mode == POWER_POLICY_AUTOMATIC && m_profile == &s_saver;
+    return m_profile != previous;
+}
+
+const PowerProfile* PowerPolicy::Select(const PowerStatus& status) const
+{
+    if (m_mode == POWER_POLICY_PERFORMANCE)
+        return &s_performance;
+    if (m_mode == POWER_POLICY_POWER_SAVER)
+        return &s_saver;
+
+    // Automatic: desktops and plugged-in laptops always get full rate
+    if (status.onAC || !status.hasBattery)
+        return &s_performance;
+
+    // Hysteresis so we don't flap between profiles around the threshold
+    int threshold = m_lowBatteryPercent;
+    if (m_lowBattery)
+        threshold += m_hysteresisPercent;
+
+    return status.batteryPercent <= threshold ? &s_saver : &s_balanced;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+// User-selectable power policy (stored in the settings file, so keep the values stable)
+enum PowerPolicyMode {
+    POWER_POLICY_AUTOMATIC = 0,    // Follow AC/battery state
+    POWER_POLICY_PERFORMANCE = 1,  // Always full rate
+    POWER_POLICY_POWER_SAVER = 2   // Always minimal rate
+};
+
+// Snapshot of the machine's power state
+struct PowerStatus {
+    bool onAC = true;
+    bool hasBattery = false;
+    int batteryPercent = 100;
+};
+
+// Everything the rest of the overlay needs to know to throttle itself
+struct PowerProfile {
+    const char* name;
+    int frameCap;             // Max frames per second, 0 = present at vsync rate
+    int sampleIntervalMs;     // Interval for CPU/temperature sampling
+    int networkIntervalMs;    // Interval for network speed sampling
+    double samplingBudget;    // Max samples per second across all metrics
+    bool allowVisualizer;     // Whether loopback audio capture may run
+    bool allowWifiScan;       // Whether Wi-Fi scans may run
+};
+
+// Picks a power profile from the policy mode and the current power status.
+// Has no OS dependencies; the overlay feeds it power events.
+class PowerPolicy {
+public:
+    PowerPolicy();
+
+    void SetMode(int mode) { m_mode = mode; }
+    void SetLowBatteryPercent(int percent) { m_lowBatteryPercent = percent; }
+
+    // Re-evaluate after a power event. Returns true if the active profile changed.
+    bool Update(const PowerStatus& status);
+
+    const PowerProfile& GetProfile() const { return *m_profile; }
+    const PowerStatus& GetStatus() const { return m_status; }
+
+    static const PowerProfile& Performance();
+    static const PowerProfile& Balanced();
+    static const PowerProfile& Saver();
+
+private:
+    const PowerProfile* Select(const PowerStatus& status) const;
+
+    int m_mode = POWER_POLICY_AUTOMATIC;
+    int m_lowBatteryPercent = 20;
+    int m_hysteresisPercent = 3;   // Battery must recover this far above the threshold to leave Saver
+    bool m_lowBattery = false;     // Automatic mode picked Saver for low battery (a forced Saver doesn't count)
+    PowerStatus m_status;
+    const PowerProfile* m_profile;
+};
@@ -0,0 +1,64 @@
+#include "ProcFs.h"
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+bool ReadProcFile(const std::string& path, std::string& text)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    // Reuse the string's capacity; steady-state reads don't allocate
+    text.clear();
+    char chunk[4096];
+    ssize_t length;
+    while ((length = read(fd, chunk, sizeof(chunk))) > 0)
+        text.append(chunk, static_cast<size_t>(length));
+    close(fd);
+    return length == 0;
+}
+
+uint64_t ProcKeyValue(const std::string& text, const char* key)
+{
+    size_t keyLength = strlen(key);
+    for (size_t line = 0; line < text.size(); ) {
+        if (text.compare(line, keyLength, key) == 0)
+            return strtoull(text.c_str() + line + keyLength, nullptr, 10);
+        line = text.find('\n', line);
+        if (line == std::string::npos)
+            break;
+        line++;
+    }
+    return 0;
+}
+
+bool IsWholeDisk(const char* name)
+{
+    static const char* const virtualPrefixes[] = { "loop", "ram", "zram", "dm-", "md", "sr" };
+    for (const char* prefix : virtualPrefixes) {
+        if (strncmp(name, prefix, strlen(prefix)) == 0)
+            return false;
+    }
+
+    size_t length = strlen(name);
+    if (length == 0 || !isdigit(static_cast<unsigned char>(name[length - 1])))
+        return true;
+
+    // nvme0n1p2, mmcblk0p1: a 'p' between digits marks a partition
+    size_t digits = length;
+    while (digits > 0 && isdigit(static_cast<unsigned char>(name[digits - 1])))
+        digits--;
+    if (digits >= 2 && name[digits - 1] == 'p' && isdigit(static_cast<unsigned char>(name[digits - 2])))
+        return false;
+
+    // sda1, vdb2, xvda1: these disks end in a letter, so a trailing number is a partition
+    static const char* const letterDisks[] = { "sd", "hd", "vd", "xvd" };
+    for (const char* prefix : letterDisks) {
+        if (strncmp(name, prefix, strlen(prefix)) == 0)
+            return false;
+    }
+    return true;
+}
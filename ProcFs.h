@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Small helpers shared by the Linux /proc backends. They exist so the platform-neutral
+// engines can be run and tested off Windows; none of this is part of the Windows build.
+
+// Read a whole /proc file into 'text'. /proc files report a size of 0, so this reads until
+// EOF. Returns false if the file can't be opened.
+bool ReadProcFile(const std::string& path, std::string& text);
+
+// Number after "key" in a "Key:   123 kB" style file (status, meminfo), 0 if absent.
+// 'key' should include the colon; matches only at the start of a line.
+uint64_t ProcKeyValue(const std::string& text, const char* key);
+
+// Whether a /proc/diskstats device is a whole physical disk: partitions, loop, RAM and
+// device-mapper devices are skipped so totals don't count the same I/O twice
+bool IsWholeDisk(const char* name);
@@ -0,0 +1,147 @@
+#include "ProcNetConnectionBackend.h"
+#include "ProcFs.h"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <unistd.h>
+
+// Kernel TCP states (include/net/tcp_states.h) mapped to the MIB-style TcpState
+static const uint8_t s_linuxTcpStates[] = {
+    TCP_STATE_UNKNOWN,
+    TCP_STATE_ESTABLISHED,   // 1
+    TCP_STATE_SYN_SENT,
+    TCP_STATE_SYN_RCVD,
+    TCP_STATE_FIN_WAIT1,
+    TCP_STATE_FIN_WAIT2,
+    TCP_STATE_TIME_WAIT,
+    TCP_STATE_CLOSED,
+    TCP_STATE_CLOSE_WAIT,
+    TCP_STATE_LAST_ACK,
+    TCP_STATE_LISTEN,
+    TCP_STATE_CLOSING        // 11
+};
+
+// "0100007F": the address is printed as 32-bit words in host order, so copying the words
+// back out gives the bytes in network order
+static void ParseAddress(const char* hex, uint8_t* address, size_t words)
+{
+    char word[9] = {};
+    for (size_t i = 0; i < words; i++) {
+        memcpy(word, hex + i * 8, 8);
+        uint32_t value = static_cast<uint32_t>(strtoul(word, nullptr, 16));
+        memcpy(address + i * 4, &value, 4);
+    }
+}
+
+ProcNetConnectionBackend::ProcNetConnectionBackend(const std::string& procRoot) :
+    m_root(procRoot)
+{
+}
+
+bool ProcNetConnectionBackend::ReadTable(const char* table, uint8_t protocol, uint8_t family,
+                                         std::vector<ConnectionRecord>& records)
+{
+    if (!ReadProcFile(m_root + "/net/" + table, m_text))
+        return false;
+
+    size_t words = family == 6 ? 4 : 1;
+    ConnectionRecord record;
+    memset(&record, 0, sizeof(record));
+    record.protocol = protocol;
+    record.family = family;
+
+    // "sl: local:port remote:port st tx:rx tr:when retrnsmt uid timeout inode ..." after a header line
+    for (size_t line = m_text.find('\n'); line != std::string::npos; line = m_text.find('\n', line)) {
+        line++;
+        char local[33];
+        char remote[33];
+        unsigned int localPort, remotePort, state;
+        unsigned long long inode;
+        if (sscanf(m_text.c_str() + line, "%*u: %32[0-9A-Fa-f]:%x %32[0-9A-Fa-f]:%x %x %*s %*s %*s %*u %*u %llu",
+                   local, &localPort, remote, &remotePort, &state, &inode) != 6 ||
+            strlen(local) != words * 8 || strlen(remote) != words * 8)
+            continue;
+
+        ParseAddress(local, record.localAddress, words);
+        ParseAddress(remote, record.remoteAddress, words);
+        record.localPort = static_cast<uint16_t>(localPort);
+        record.remotePort = static_cast<uint16_t>(remotePort);
+        record.state = protocol == CONNECTION_TCP && state < sizeof(s_linuxTcpStates)
+                           ? s_linuxTcpStates[state]
+                           : static_cast<uint8_t>(TCP_STATE_UNKNOWN);
+        records.push_back(record);
+        m_inodes.push_back(inode);
+    }
+    return true;
+}
+
+void ProcNetConnectionBackend::MapSocketOwners()
+{
+    m_owners.clear();
+    DIR* processes = opendir(m_root.c_str());
+    if (!processes)
+        return;
+
+    std::string path;
+    char target[64];
+    while (dirent* process = readdir(processes)) {
+        if (!isdigit(static_cast<unsigned char>(process->d_name[0])))
+            continue;
+        path.assign(m_root).append("/").append(process->d_name).append("/fd");
+        DIR* fds = opendir(path.c_str());
+        if (!fds)
+            continue;    // Not ours to look at, or already gone
+
+        uint32_t pid = static_cast<uint32_t>(strtoul(process->d_name, nullptr, 10));
+        size_t directoryLength = path.size();
+        while (dirent* fd = readdir(fds)) {
+            if (fd->d_name[0] == '.')
+                continue;
+            path.resize(directoryLength);
+            path.append("/").append(fd->d_name);
+            ssize_t length = readlink(path.c_str(), target, sizeof(target) - 1);
+            if (length <= 8 || strncmp(target, "socket:[", 8) != 0)
+                continue;
+            target[length] = '\0';
+            m_owners.emplace(strtoull(target + 8, nullptr, 10), pid);
+        }
+        closedir(fds);
+    }
+    closedir(processes);
+}
+
+bool ProcNetConnectionBackend::Snapshot(std::vector<ConnectionRecord>& records)
+{
+    records.clear();
+    m_inodes.clear();
+    bool any = ReadTable("tcp", CONNECTION_TCP, 4, records);
+    any = ReadTable("tcp6", CONNECTION_TCP, 6, records) || any;
+    any = ReadTable("udp", CONNECTION_UDP, 4, records) || any;
+    any = ReadTable("udp6", CONNECTION_UDP, 6, records) || any;
+    if (!any)
+        return false;
+
+    MapSocketOwners();
+    for (size_t i = 0; i < records.size(); i++) {
+        auto owner = m_owners.find(m_inodes[i]);
+        if (owner != m_owners.end())
+            records[i].pid = owner->second;
+    }
+    return true;
+}
+
+bool ProcNetConnectionBackend::GetProcessName(uint32_t pid, char* name, size_t length)
+{
+    if (length == 0 || !ReadProcFile(m_root + "/" + std::to_string(pid) + "/comm", m_text) || m_text.empty())
+        return false;
+    size_t nameLength = m_text.find('\n');
+    if (nameLength == std::string::npos)
+        nameLength = m_text.size();
+    if (nameLength >= length)
+        nameLength = length - 1;
+    memcpy(name, m_text.data(), nameLength);
+    name[nameLength] = '\0';
+    return true;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ConnectionMonitor.h"
+
+// Connection monitor backend for Linux built on /proc/net/{tcp,tcp6,udp,udp6}. Owning PIDs
+// come from matching socket inodes against the /proc/<pid>/fd links, which only covers the
+// processes we're allowed to inspect; the rest report pid 0.
+// Not part of the Windows build; it lets the monitor run (and be tested) elsewhere.
+// The proc root is a parameter so tests can point it at synthetic files.
+class ProcNetConnectionBackend : public IConnectionBackend {
+public:
+    explicit ProcNetConnectionBackend(const std::string& procRoot = "/proc");
+
+    bool Snapshot(std::vector<ConnectionRecord>& records) override;
+    bool GetProcessName(uint32_t pid, char* name, size_t length) override;
+
+private:
+    // Append the rows of one /proc/net table; false if it can't be read
+    bool ReadTable(const char* table, uint8_t protocol, uint8_t family, std::vector<ConnectionRecord>& records);
+    void MapSocketOwners();
+
+    std::string m_root;
+    std::string m_text;                                 // Reused for every file read
+    std::vector<uint64_t> m_inodes;                     // Parallel to the snapshot's records
+    std::unordered_map<uint64_t, uint32_t> m_owners;    // Socket inode -> pid, rebuilt per snapshot
+};
@@ -0,0 +1,68 @@
+#include "ProcProcessBackend.h"
+#include "ProcFs.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <unistd.h>
+
+ProcProcessBackend::ProcProcessBackend(const std::string& procRoot, int processorCount) :
+    m_root(procRoot),
+    m_processorCount(processorCount > 0 ? processorCount : static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN))),
+    m_nsPerTick(1000000000ull / sysconf(_SC_CLK_TCK)),
+    m_pageSize(static_cast<uint64_t>(sysconf(_SC_PAGESIZE)))
+{
+}
+
+bool ProcProcessBackend::ReadProcess(const char* pid, ProcessRecord& record)
+{
+    m_path.assign(m_root).append("/").append(pid).append("/stat");
+    if (!ReadProcFile(m_path, m_text))
+        return false;
+
+    // "pid (comm) state ppid ..." - comm may contain spaces and parentheses, so parse from the last ')'
+    size_t nameStart = m_text.find('(');
+    size_t nameEnd = m_text.rfind(')');
+    if (nameStart == std::string::npos || nameEnd == std::string::npos || nameEnd < nameStart)
+        return false;
+
+    record.pid = static_cast<uint32_t>(strtoul(pid, nullptr, 10));
+    size_t nameLength = std::min<size_t>(nameEnd - nameStart - 1, PROCESS_NAME_LENGTH - 1);
+    memcpy(record.name, m_text.c_str() + nameStart + 1, nameLength);
+    record.name[nameLength] = '\0';
+
+    // Fields from 3 (state) on, numbered as in proc(5): utime 14, stime 15, starttime 22, rss 24
+    uint64_t fields[25] = {};
+    const char* field = m_text.c_str() + nameEnd + 2;
+    for (int i = 3; i <= 24 && *field; i++) {
+        fields[i] = strtoull(field, nullptr, 10);
+        const char* next = strchr(field, ' ');
+        if (!next)
+            break;
+        field = next + 1;
+    }
+    record.cpuTimeNs = (fields[14] + fields[15]) * m_nsPerTick;
+    record.startTime = fields[22];
+    record.workingSet = fields[24] * m_pageSize;
+    return true;
+}
+
+bool ProcProcessBackend::Snapshot(std::vector<ProcessRecord>& records)
+{
+    DIR* directory = opendir(m_root.c_str());
+    if (!directory)
+        return false;
+
+    records.clear();
+    while (dirent* entry = readdir(directory)) {
+        if (!isdigit(static_cast<unsigned char>(entry->d_name[0])))
+            continue;
+        // Processes can exit between listing and reading; just skip them
+        ProcessRecord record;
+        if (ReadProcess(entry->d_name, record))
+            records.push_back(record);
+    }
+    closedir(directory);
+    return true;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "ProcessSampler.h"
+
+// Process sampler backend for Linux built on /proc/<pid>/stat: CPU time, resident set,
+// name and start time (so reused PIDs are told apart) all come from that one file.
+// Not part of the Windows build; it lets the sampler run (and be tested) elsewhere.
+// The proc root and processor count are parameters so tests can use a synthetic /proc.
+class ProcProcessBackend : public IProcessBackend {
+public:
+    explicit ProcProcessBackend(const std::string& procRoot = "/proc", int processorCount = 0);
+
+    bool Snapshot(std::vector<ProcessRecord>& records) override;
+    int GetProcessorCount() const override { return m_processorCount; }
+
+private:
+    bool ReadProcess(const char* pid, ProcessRecord& record);
+
+    std::string m_root;
+    int m_processorCount;
+    uint64_t m_nsPerTick;
+    uint64_t m_pageSize;
+    std::string m_path;
+    std::string m_text;         // Reused for every file read
+};
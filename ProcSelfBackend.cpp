@@ -0,0 +1,88 @@
+#include "ProcSelfBackend.h"
+#include "ProcFs.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <unistd.h>
+
+ProcSelfBackend::ProcSelfBackend(const std::string& selfRoot) :
+    m_root(selfRoot),
+    m_nsPerTick(1000000000ull / sysconf(_SC_CLK_TCK))
+{
+}
+
+bool ProcSelfBackend::ReadThread(const char* tid, SelfThreadRecord& record)
+{
+    record.threadId = static_cast<uint32_t>(strtoul(tid, nullptr, 10));
+
+    // "tid (comm) state ppid ..." - comm may contain spaces and parentheses, so parse from the last ')'
+    m_path.assign(m_root).append("/task/").append(tid).append("/stat");
+    if (!ReadProcFile(m_path, m_text))
+        return false;
+    size_t nameStart = m_text.find('(');
+    size_t nameEnd = m_text.rfind(')');
+    if (nameStart == std::string::npos || nameEnd == std::string::npos || nameEnd < nameStart)
+        return false;
+
+    size_t nameLength = std::min<size_t>(nameEnd - nameStart - 1, SELF_THREAD_NAME_LENGTH - 1);
+    memcpy(record.name, m_text.c_str() + nameStart + 1, nameLength);
+    record.name[nameLength] = '\0';
+
+    // utime and stime are fields 14 and 15; field 3 (state) follows the ')'
+    const char* field = m_text.c_str() + nameEnd + 2;
+    for (int i = 3; i < 14 && field; i++) {
+        field = strchr(field, ' ');
+        if (field)
+            field++;
+    }
+    if (!field)
+        return false;
+    char* end;
+    uint64_t ticks = strtoull(field, &end, 10);
+    ticks += strtoull(end, nullptr, 10);
+    record.cpuTimeNs = ticks * m_nsPerTick;
+
+    m_path.assign(m_root).append("/task/").append(tid).append("/status");
+    if (!ReadProcFile(m_path, m_text))
+        return false;
+    record.contextSwitches = ProcKeyValue(m_text, "voluntary_ctxt_switches:") +
+                             ProcKeyValue(m_text, "nonvoluntary_ctxt_switches:");
+    return true;
+}
+
+bool ProcSelfBackend::Snapshot(SelfProcessRecord& process, std::vector<SelfThreadRecord>& threads)
+{
+    if (!ReadProcFile(m_root + "/status", m_text))
+        return false;
+    process.workingSet = ProcKeyValue(m_text, "VmRSS:") * 1024;
+    process.privateBytes = ProcKeyValue(m_text, "RssAnon:") * 1024;
+
+    // Count before listing threads so the task directory isn't in the count, and skip the
+    // descriptor the fd listing itself holds
+    process.handleCount = 0;
+    if (DIR* fds = opendir((m_root + "/fd").c_str())) {
+        long listing = dirfd(fds);
+        while (dirent* entry = readdir(fds)) {
+            if (entry->d_name[0] != '.' && strtol(entry->d_name, nullptr, 10) != listing)
+                process.handleCount++;
+        }
+        closedir(fds);
+    }
+
+    DIR* tasks = opendir((m_root + "/task").c_str());
+    if (!tasks)
+        return false;
+
+    threads.clear();
+    while (dirent* entry = readdir(tasks)) {
+        if (entry->d_name[0] == '.')
+            continue;
+        // Threads can exit between listing and reading; just skip them
+        SelfThreadRecord record;
+        if (ReadThread(entry->d_name, record))
+            threads.push_back(record);
+    }
+    closedir(tasks);
+    return true;
+}
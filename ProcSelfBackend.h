@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "SelfMonitor.h"
+
+// Self monitor backend for Linux built on /proc/self: task/<tid>/stat for CPU time and
+// names, task/<tid>/status for context switches, status for memory and fd/ for handles.
+// Not part of the Windows build; it lets the monitor run (and be tested) elsewhere.
+// The root is a parameter so tests can point it at synthetic files.
+class ProcSelfBackend : public ISelfBackend {
+public:
+    explicit ProcSelfBackend(const std::string& selfRoot = "/proc/self");
+
+    bool Snapshot(SelfProcessRecord& process, std::vector<SelfThreadRecord>& threads) override;
+
+private:
+    bool ReadThread(const char* tid, SelfThreadRecord& record);
+
+    std::string m_root;
+    uint64_t m_nsPerTick;
+    std::string m_path;
+    std::string m_text;         // Reused for every file read
+};
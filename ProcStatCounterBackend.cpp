@@ -0,0 +1,165 @@
+#include "ProcStatCounterBackend.h"
+#include "ProcFs.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+ProcStatCounterBackend::ProcStatCounterBackend(const std::string& procRoot, const Clock& clock) :
+    m_root(procRoot), m_clock(clock)
+{
+}
+
+bool ProcStatCounterBackend::Open()
+{
+    if (m_open)
+        return true;
+    // Everything but the disk counter comes from these two, so without them there's no query
+    std::string text;
+    if (!ReadProcFile(m_root + "/stat", text) || !ReadProcFile(m_root + "/meminfo", text))
+        return false;
+    m_open = true;
+    return true;
+}
+
+void ProcStatCounterBackend::Close()
+{
+    m_open = false;
+    m_wantsDisk = false;
+    m_sources.clear();
+    m_previousNs = 0;
+}
+
+bool ProcStatCounterBackend::AddCounter(const std::string& path, int index)
+{
+    if (index >= static_cast<int>(m_sources.size()))
+        m_sources.resize(index + 1, SOURCE_NONE);
+
+    Source source = SourceForPath(path);
+    if (source == SOURCE_NONE)
+        return false;
+    if (source == SOURCE_DISK_BYTES) {
+        std::string text;
+        if (!ReadProcFile(m_root + "/diskstats", text))
+            return false;
+        m_wantsDisk = true;
+    }
+    m_sources[index] = source;
+    return true;
+}
+
+ProcStatCounterBackend::Source ProcStatCounterBackend::SourceForPath(const std::string& path)
+{
+    static const struct {
+        const char* path;
+        Source source;
+    } paths[] = {
+        { "\\Processor(_Total)\\% Processor Time", SOURCE_CPU_PERCENT },
+        { "\\System\\Context Switches/sec", SOURCE_CONTEXT_SWITCHES },
+        { "\\System\\Processor Queue Length", SOURCE_RUN_QUEUE },
+        { "\\Memory\\% Committed Bytes In Use", SOURCE_COMMIT_PERCENT },
+        { "\\Paging File(_Total)\\% Usage", SOURCE_SWAP_PERCENT },
+        { "\\PhysicalDisk(_Total)\\Disk Bytes/sec", SOURCE_DISK_BYTES },
+    };
+    for (const auto& entry : paths) {
+        if (path == entry.path)
+            return entry.source;
+    }
+    return SOURCE_NONE;
+}
+
+bool ProcStatCounterBackend::Read(Raw& raw)
+{
+    // "cpu  user nice system idle iowait irq softirq steal ..." in clock ticks
+    if (!ReadProcFile(m_root + "/stat", m_text) || m_text.compare(0, 4, "cpu ") != 0)
+        return false;
+    const char* field = m_text.c_str() + 4;
+    uint64_t ticks[8] = {};
+    for (int i = 0; i < 8; i++) {
+        char* end;
+        ticks[i] = strtoull(field, &end, 10);
+        if (end == field)
+            break;
+        field = end;
+    }
+    raw.cpuTotal = 0;
+    for (uint64_t value : ticks)
+        raw.cpuTotal += value;
+    raw.cpuBusy = raw.cpuTotal - ticks[3] - ticks[4];    // Minus idle and iowait
+    raw.contextSwitches = ProcKeyValue(m_text, "ctxt ");
+    raw.runQueue = ProcKeyValue(m_text, "procs_running ");
+
+    if (!ReadProcFile(m_root + "/meminfo", m_text))
+        return false;
+    raw.committedKb = ProcKeyValue(m_text, "Committed_AS:");
+    raw.commitLimitKb = ProcKeyValue(m_text, "CommitLimit:");
+    raw.swapTotalKb = ProcKeyValue(m_text, "SwapTotal:");
+    raw.swapFreeKb = ProcKeyValue(m_text, "SwapFree:");
+
+    raw.diskBytes = 0;
+    if (m_wantsDisk && ReadProcFile(m_root + "/diskstats", m_text)) {
+        // "major minor name reads merged sectorsRead msRead writes merged sectorsWritten ..."
+        for (size_t line = 0; line < m_text.size(); ) {
+            char name[64];
+            unsigned long long sectorsRead = 0;
+            unsigned long long sectorsWritten = 0;
+            if (sscanf(m_text.c_str() + line, "%*u %*u %63s %*u %*u %llu %*u %*u %*u %llu",
+                       name, &sectorsRead, &sectorsWritten) == 3 && IsWholeDisk(name))
+                raw.diskBytes += (sectorsRead + sectorsWritten) * 512;
+            line = m_text.find('\n', line);
+            if (line == std::string::npos)
+                break;
+            line++;
+        }
+    }
+    return true;
+}
+
+bool ProcStatCounterBackend::Prime()
+{
+    // Baseline for the rate counters, like PDH's first collect
+    if (!m_open || !Read(m_previous))
+        return false;
+    m_previousNs = m_clock.NowNs();
+    return true;
+}
+
+bool ProcStatCounterBackend::Collect(double* values, size_t count)
+{
+    Raw raw;
+    if (!m_open || !Read(raw))
+        return false;
+
+    uint64_t nowNs = m_clock.NowNs();
+    double seconds = (nowNs - m_previousNs) * 1e-9;
+    for (size_t i = 0; i < count && i < m_sources.size(); i++) {
+        switch (m_sources[i]) {
+        case SOURCE_CPU_PERCENT:
+            if (raw.cpuTotal > m_previous.cpuTotal && raw.cpuBusy >= m_previous.cpuBusy)
+                values[i] = 100.0 * (raw.cpuBusy - m_previous.cpuBusy) / (raw.cpuTotal - m_previous.cpuTotal);
+            break;
+        case SOURCE_CONTEXT_SWITCHES:
+            if (seconds > 0.0 && raw.contextSwitches >= m_previous.contextSwitches)
+                values[i] = (raw.contextSwitches - m_previous.contextSwitches) / seconds;
+            break;
+        case SOURCE_RUN_QUEUE:
+            values[i] = static_cast<double>(raw.runQueue);
+            break;
+        case SOURCE_COMMIT_PERCENT:
+            values[i] = raw.commitLimitKb ? 100.0 * raw.committedKb / raw.commitLimitKb : 0.0;
+            break;
+        case SOURCE_SWAP_PERCENT:
+            values[i] = raw.swapTotalKb ? 100.0 * (raw.swapTotalKb - raw.swapFreeKb) / raw.swapTotalKb : 0.0;
+            break;
+        case SOURCE_DISK_BYTES:
+            if (seconds > 0.0 && raw.diskBytes >= m_previous.diskBytes)
+                values[i] = (raw.diskBytes - m_previous.diskBytes) / seconds;
+            break;
+        default:
+            break;
+        }
+    }
+
+    m_previous = raw;
+    m_previousNs = nowNs;
+    return true;
+}
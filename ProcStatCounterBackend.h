@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Clock.h"
+#include "CounterRegistry.h"
+
+// Counter registry backend for Linux built on /proc/stat, /proc/meminfo and /proc/diskstats.
+// It answers the same English PDH paths the overlay declares, so the registry can be run
+// (and tested) off Windows; paths it has no source for are reported unavailable, as PDH does.
+// The proc root is a parameter so tests can point it at synthetic files.
+class ProcStatCounterBackend : public ICounterBackend {
+public:
+    explicit ProcStatCounterBackend(const std::string& procRoot = "/proc", const Clock& clock = Clock::System());
+
+    bool Open() override;
+    void Close() override;
+    bool AddCounter(const std::string& path, int index) override;
+    bool Prime() override;
+    bool Collect(double* values, size_t count) override;
+
+private:
+    enum Source {
+        SOURCE_NONE = -1,
+        SOURCE_CPU_PERCENT,          // \Processor(_Total)\% Processor Time
+        SOURCE_CONTEXT_SWITCHES,     // \System\Context Switches/sec
+        SOURCE_RUN_QUEUE,            // \System\Processor Queue Length
+        SOURCE_COMMIT_PERCENT,       // \Memory\% Committed Bytes In Use
+        SOURCE_SWAP_PERCENT,         // \Paging File(_Total)\% Usage
+        SOURCE_DISK_BYTES            // \PhysicalDisk(_Total)\Disk Bytes/sec
+    };
+
+    // Raw counts from one pass over the files; rates come from two of these
+    struct Raw {
+        uint64_t cpuBusy = 0;
+        uint64_t cpuTotal = 0;
+        uint64_t contextSwitches = 0;
+        uint64_t runQueue = 0;
+        uint64_t committedKb = 0;
+        uint64_t commitLimitKb = 0;
+        uint64_t swapTotalKb = 0;
+        uint64_t swapFreeKb = 0;
+        uint64_t diskBytes = 0;
+    };
+
+    static Source SourceForPath(const std::string& path);
+    bool Read(Raw& raw);
+
+    std::string m_root;
+    const Clock& m_clock;
+    bool m_open = false;
+    bool m_wantsDisk = false;
+    std::vector<Source> m_sources;    // Indexed like the registry
+    Raw m_previous;
+    uint64_t m_previousNs = 0;
+    std::string m_text;               // Reused for every file read
+};
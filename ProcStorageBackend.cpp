@@ -0,0 +1,93 @@
+#include "ProcStorageBackend.h"
+#include "ProcFs.h"
+#include <cstdio>
+#include <cstring>
+#include <sys/statvfs.h>
+
+ProcStorageBackend::ProcStorageBackend(const std::string& procRoot, const Clock& clock) :
+    m_root(procRoot), m_clock(clock)
+{
+}
+
+bool ProcStorageBackend::Open()
+{
+    if (m_open)
+        return true;
+    m_open = ReadProcFile(m_root + "/diskstats", m_text);
+    return m_open;
+}
+
+void ProcStorageBackend::Close()
+{
+    m_open = false;
+}
+
+bool ProcStorageBackend::CollectDisks(std::vector<DiskCounters>& disks)
+{
+    disks.clear();
+    if (!m_open || !ReadProcFile(m_root + "/diskstats", m_text))
+        return false;
+    uint64_t nowNs = m_clock.NowNs();
+
+    // "major minor name reads merged sectorsRead msRead writes merged sectorsWritten msWritten inFlight ..."
+    // Names key the per-disk rates, so one too long to store is skipped rather than cut short
+    // into a name another disk might share; the kernel keeps them under STORAGE_NAME_LENGTH anyway
+    for (size_t line = 0; line < m_text.size(); ) {
+        char name[64];
+        unsigned long long reads = 0, sectorsRead = 0, writes = 0, sectorsWritten = 0, inFlight = 0;
+        if (sscanf(m_text.c_str() + line, "%*u %*u %63s %llu %*u %llu %*u %llu %*u %llu %*u %llu",
+                   name, &reads, &sectorsRead, &writes, &sectorsWritten, &inFlight) == 6 &&
+            strlen(name) < STORAGE_NAME_LENGTH && IsWholeDisk(name)) {
+            DiskCounters disk;
+            memcpy(disk.name, name, strlen(name) + 1);
+            disk.readBytes = sectorsRead * 512;    // diskstats sectors are always 512 bytes
+            disk.writeBytes = sectorsWritten * 512;
+            disk.reads = reads;
+            disk.writes = writes;
+            disk.queueLength = static_cast<uint32_t>(inFlight);
+            disk.timestampNs = nowNs;
+            disks.push_back(disk);
+        }
+        line = m_text.find('\n', line);
+        if (line == std::string::npos)
+            break;
+        line++;
+    }
+    return true;
+}
+
+bool ProcStorageBackend::CollectVolumes(std::vector<VolumeSpace>& volumes)
+{
+    volumes.clear();
+    if (!ReadProcFile(m_root + "/mounts", m_text))
+        return false;
+
+    // "device mountPoint type options 0 0"; only block-device filesystems count as volumes
+    for (size_t line = 0; line < m_text.size(); ) {
+        char device[256];
+        char mountPoint[256];
+        if (sscanf(m_text.c_str() + line, "%255s %255s", device, mountPoint) == 2 &&
+            strncmp(device, "/dev/", 5) == 0) {
+            struct statvfs info;
+            if (statvfs(mountPoint, &info) == 0 && info.f_blocks > 0) {
+                // Only shown, never matched on, so a path too long to store keeps its end behind
+                // "...", since that's the part that tells one mount from another
+                VolumeSpace volume;
+                int length = snprintf(volume.name, sizeof(volume.name), "%s", mountPoint);
+                if (length >= static_cast<int>(sizeof(volume.name))) {
+                    size_t keep = sizeof(volume.name) - 4;
+                    memcpy(volume.name, "...", 3);
+                    memcpy(volume.name + 3, mountPoint + length - keep, keep + 1);
+                }
+                volume.freeBytes = static_cast<uint64_t>(info.f_bavail) * info.f_frsize;
+                volume.totalBytes = static_cast<uint64_t>(info.f_blocks) * info.f_frsize;
+                volumes.push_back(volume);
+            }
+        }
+        line = m_text.find('\n', line);
+        if (line == std::string::npos)
+            break;
+        line++;
+    }
+    return true;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Clock.h"
+#include "StorageMonitor.h"
+
+// Storage backend for Linux built on /proc/diskstats (sector and I/O counts per whole disk,
+// in-flight I/Os as the queue length) and /proc/mounts plus statvfs for volume space.
+// Not part of the Windows build; it lets the storage rate engine run (and be tested) elsewhere.
+// The proc root is a parameter so tests can point it at synthetic files.
+class ProcStorageBackend : public IStorageBackend {
+public:
+    explicit ProcStorageBackend(const std::string& procRoot = "/proc", const Clock& clock = Clock::System());
+
+    bool Open() override;
+    void Close() override;
+    bool CollectDisks(std::vector<DiskCounters>& disks) override;
+    bool CollectVolumes(std::vector<VolumeSpace>& volumes) override;
+
+private:
+    std::string m_root;
+    const Clock& m_clock;
+    bool m_open = false;
+    std::string m_text;         // Reused for every file read
+};
@@ -0,0 +1,98 @@
+#include "ProcessSampler.h"
+#include <algorithm>
+#include <cstring>
+
+ProcessSampler::ProcessSampler(std::unique_ptr<IProcessBackend> backend, const Clock& clock)
+    : m_backend(std::move(backend)), m_clock(clock)
+{
+}
+
+void ProcessSampler::SetTopCount(size_t count)
+{
+    m_topCount = std::min<size_t>(std::max<size_t>(count, 1), MAX_TOP_PROCESSES);
+}
+
+void ProcessSampler::Reset()
+{
+    m_history.clear();
+    m_records.clear();
+    m_stats.clear();
+    m_lastSampleNs = 0;
+    m_topCpu.clear();
+    m_topMemory.clear();
+    m_totalCpu = 0.0;
+}
+
+bool ProcessSampler::Sample()
+{
+    uint64_t startNs = m_clock.NowNs();
+    if (!m_backend->Snapshot(m_records))
+        return false;
+
+    uint64_t nowNs = m_clock.NowNs();
+    uint64_t elapsedNs = m_lastSampleNs ? nowNs - m_lastSampleNs : 0;
+    double capacityNs = static_cast<double>(elapsedNs) * std::max(1, m_backend->GetProcessorCount());
+
+    m_generation++;
+    m_stats.resize(m_records.size());
+    m_totalCpu = 0.0;
+
+    for (size_t i = 0; i < m_records.size(); i++) {
+        const ProcessRecord& record = m_records[i];
+        ProcessStats& stats = m_stats[i];
+        stats.pid = record.pid;
+        stats.workingSet = record.workingSet;
+        stats.cpuPercent = 0.0;
+        memcpy(stats.name, record.name, sizeof(stats.name));
+
+        // A PID that was reused gets a different start time, so it starts with a fresh baseline
+        auto result = m_history.try_emplace(ProcessKey{ record.pid, record.startTime }, History{ record.cpuTimeNs, 0 });
+        History& history = result.first->second;
+        if (!result.second && capacityNs > 0.0 && record.cpuTimeNs >= history.cpuTimeNs) {
+            stats.cpuPercent = (record.cpuTimeNs - history.cpuTimeNs) * 100.0 / capacityNs;
+            m_totalCpu += stats.cpuPercent;
+        }
+        history.cpuTimeNs = record.cpuTimeNs;
+        history.generation = m_generation;
+    }
+
+    // Drop processes that have exited since the last snapshot
+    for (auto it = m_history.begin(); it != m_history.end(); ) {
+        if (it->second.generation != m_generation)
+            it = m_history.erase(it);
+        else
+            ++it;
+    }
+
+    // CPU figures need two snapshots; until then only memory is ranked
+    if (elapsedNs > 0)
+        SelectTop(m_topCpu, true);
+    SelectTop(m_topMemory, false);
+
+    m_lastSampleNs = nowNs;
+    m_timestampNs = nowNs;
+    m_lastCostNs = m_clock.NowNs() - startNs;
+    return true;
+}
+
+// Partial selection: nth_element puts the top N in front in linear time, then only those N get sorted
+void ProcessSampler::SelectTop(std::vector<ProcessStats>& out, bool byCpu)
+{
+    m_order.resize(m_stats.size());
+    for (size_t i = 0; i < m_order.size(); i++)
+        m_order[i] = static_cast<uint32_t>(i);
+
+    auto greater = [this, byCpu](uint32_t a, uint32_t b) {
+        return byCpu ? m_stats[a].cpuPercent > m_stats[b].cpuPercent
+                     : m_stats[a].workingSet > m_stats[b].workingSet;
+    };
+
+    size_t count = std::min(m_topCount, m_order.size());
+    if (count < m_order.size())
+        std::nth_element(m_order.begin(), m_order.begin() + count, m_order.end(), greater);
+    std::sort(m_order.begin(), m_order.begin() + count, greater);
+
+    out.resize(count);
+    for (size_t i = 0; i < count; i++)
+        out[i] = m_stats[m_order[i]];
+}
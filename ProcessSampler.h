@@ -0,0 +1,102 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+#include "Clock.h"
+
+#define PROCESS_NAME_LENGTH 64
+#define MAX_TOP_PROCESSES 16
+
+// One process as reported by a backend snapshot
+struct ProcessRecord {
+    uint32_t pid;
+    uint64_t startTime;      // Backend-defined; only used to tell reused PIDs apart
+    uint64_t cpuTimeNs;      // Total user + kernel time consumed so far
+    uint64_t workingSet;     // Bytes
+    char name[PROCESS_NAME_LENGTH];
+};
+
+// Per-process figures derived from two snapshots
+struct ProcessStats {
+    uint32_t pid;
+    double cpuPercent;       // Of the whole machine (all logical processors)
+    uint64_t workingSet;
+    char name[PROCESS_NAME_LENGTH];
+};
+
+// Platform side of the sampler: one system-wide process snapshot per call
+class IProcessBackend {
+public:
+    virtual ~IProcessBackend() = default;
+
+    // Replace 'records' with the current process list. Returns false on failure.
+    virtual bool Snapshot(std::vector<ProcessRecord>& records) = 0;
+
+    virtual int GetProcessorCount() const = 0;
+};
+
+// Samples the process list and ranks the top consumers.
+// Each sample is diffed against the previous one in a hash map keyed by PID and
+// start time, and the top-N lists come from a partial selection rather than a sort.
+// All containers are reused between samples so steady-state ticks don't allocate.
+class ProcessSampler {
+public:
+    explicit ProcessSampler(std::unique_ptr<IProcessBackend> backend, const Clock& clock = Clock::System());
+
+    void SetTopCount(size_t count);
+
+    // Take a snapshot and refresh the rankings. Returns false if the backend failed.
+    bool Sample();
+
+    // Forget the previous snapshot (e.g. after a long pause) so the next CPU figures aren't averaged over it
+    void Reset();
+
+    const std::vector<ProcessStats>& GetTopByCpu() const { return m_topCpu; }
+    const std::vector<ProcessStats>& GetTopByMemory() const { return m_topMemory; }
+    size_t GetProcessCount() const { return m_records.size(); }
+    double GetTotalCpuPercent() const { return m_totalCpu; }
+
+    // Wall time the last Sample() took, including the backend snapshot
+    uint64_t GetLastSampleCostNs() const { return m_lastCostNs; }
+    uint64_t GetTimestamp() const { return m_timestampNs; }
+
+private:
+    struct ProcessKey {
+        uint32_t pid;
+        uint64_t startTime;
+        bool operator==(const ProcessKey& other) const { return pid == other.pid && startTime == other.startTime; }
+    };
+
+    struct ProcessKeyHash {
+        size_t operator()(const ProcessKey& key) const
+        {
+            uint64_t h = key.startTime * 0x9E3779B97F4A7C15ull ^ key.pid;
+            return static_cast<size_t>(h ^ (h >> 32));
+        }
+    };
+
+    struct History {
+        uint64_t cpuTimeNs;
+        uint64_t generation;
+    };
+
+    void SelectTop(std::vector<ProcessStats>& out, bool byCpu);
+
+    std::unique_ptr<IProcessBackend> m_backend;
+    const Clock& m_clock;
+    std::vector<ProcessRecord> m_records;
+    std::vector<ProcessStats> m_stats;
+    std::vector<uint32_t> m_order;
+    std::unordered_map<ProcessKey, History, ProcessKeyHash> m_history;
+    std::vector<ProcessStats> m_topCpu;
+    std::vector<ProcessStats> m_topMemory;
+    size_t m_topCount = 5;
+    uint64_t m_generation = 0;
+    uint64_t m_lastSampleNs = 0;
+    uint64_t m_timestampNs = 0;
+    uint64_t m_lastCostNs = 0;
+    double m_totalCpu = 0.0;
+};
@@ -0,0 +1,42 @@
+#include "RectSet.h"
+
+void RectSet::Set(uintptr_t id, int left, int top, int right, int bottom)
+{
+    for (auto& rect : m_rects) {
+        if (rect.id == id) {
+            rect.left = left; rect.top = top; rect.right = right; rect.bottom = bottom;
+            return;
+        }
+    }
+    m_rects.push_back({ id, left, top, right, bottom });
+}
+
+void RectSet::Remove(uintptr_t id)
+{
+    for (size_t i = 0; i < m_rects.size(); i++) {
+        if (m_rects[i].id == id) {
+            // Order doesn't matter, so swap with the last entry
+            m_rects[i] = m_rects.back();
+            m_rects.pop_back();
+            return;
+        }
+    }
+}
+
+bool RectSet::Has(uintptr_t id) const
+{
+    for (const auto& rect : m_rects) {
+        if (rect.id == id)
+            return true;
+    }
+    return false;
+}
+
+bool RectSet::Contains(int x, int y) const
+{
+    for (const auto& rect : m_rects) {
+        if (x >= rect.left && x <= rect.right && y >= rect.top && y <= rect.bottom)
+            return true;
+    }
+    return false;
+}
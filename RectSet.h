@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Small set of screen rectangles keyed by an opaque id (e.g. a window handle).
+// Only touched from one thread, so hit tests need no locking.
+class RectSet {
+public:
+    struct Rect {
+        uintptr_t id;
+        int left, top, right, bottom;
+    };
+
+    // Insert or update the rectangle for id
+    void Set(uintptr_t id, int left, int top, int right, int bottom);
+    void Remove(uintptr_t id);
+    void Clear() { m_rects.clear(); }
+
+    bool Has(uintptr_t id) const;
+    bool Contains(int x, int y) const;   // Edges are inclusive, matching the old click test
+
+    const std::vector<Rect>& GetRects() const { return m_rects; }
+
+private:
+    std::vector<Rect> m_rects;
+};
@@ -0,0 +1,123 @@
+#include "SelfMonitor.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+std::atomic<uint64_t> SelfMonitor::s_allocations{ 0 };
+
+// Global allocation functions, replaced to count allocations for the self monitor. One
+// relaxed increment on top of malloc; the matching deletes must be replaced along with them.
+void* operator new(std::size_t size)
+{
+    SelfMonitor::CountAllocation();
+    if (void* block = std::malloc(size ? size : 1))
+        return block;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    SelfMonitor::CountAllocation();
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return ::operator new(size, tag);
+}
+
+void operator delete(void* block) noexcept { std::free(block); }
+void operator delete[](void* block) noexcept { std::free(block); }
+void operator delete(void* block, std::size_t) noexcept { std::free(block); }
+void operator delete[](void* block, std::size_t) noexcept { std::free(block); }
+void operator delete(void* block, const std::nothrow_t&) noexcept { std::free(block); }
+void operator delete[](void* block, const std::nothrow_t&) noexcept { std::free(block); }
+
+SelfMonitor::SelfMonitor(std::unique_ptr<ISelfBackend> backend, const Clock& clock)
+    : m_backend(std::move(backend)), m_clock(clock)
+{
+}
+
+void SelfMonitor::Reset()
+{
+    m_history.clear();
+    m_threads.clear();
+    m_lastSampleNs = 0;
+    m_cpuPercent = 0.0;
+    m_switchesPerSec = 0.0;
+    m_allocationsPerSec = 0.0;
+}
+
+bool SelfMonitor::Sample()
+{
+    uint64_t startNs = m_clock.NowNs();
+    if (!m_backend->Snapshot(m_process, m_records))
+        return false;
+
+    uint64_t nowNs = m_clock.NowNs();
+    uint64_t allocations = GetAllocationCount();
+    double seconds = m_lastSampleNs ? (nowNs - m_lastSampleNs) * 1e-9 : 0.0;
+
+    // Both lists sorted by thread id, so matching threads up is a single merge pass
+    std::sort(m_records.begin(), m_records.end(), [](const SelfThreadRecord& a, const SelfThreadRecord& b) {
+        return a.threadId < b.threadId;
+    });
+
+    m_threads.clear();
+    m_nextHistory.clear();
+    uint64_t cpuNs = 0;
+    uint64_t switches = 0;
+    size_t previous = 0;
+
+    for (const auto& record : m_records) {
+        while (previous < m_history.size() && m_history[previous].threadId < record.threadId)
+            previous++;
+
+        const History* history = previous < m_history.size() && m_history[previous].threadId == record.threadId
+            ? &m_history[previous] : nullptr;
+        if (history && seconds > 0.0 && record.cpuTimeNs >= history->cpuTimeNs &&
+            record.contextSwitches >= history->contextSwitches) {
+            SelfThreadStats stats;
+            stats.threadId = record.threadId;
+            stats.cpuPercent = (record.cpuTimeNs - history->cpuTimeNs) * 1e-7 / seconds;
+            stats.switchesPerSec = (record.contextSwitches - history->contextSwitches) / seconds;
+            if (!TraceRecorder::Instance().GetThreadName(record.threadId, stats.name, sizeof(stats.name))) {
+                if (record.name[0])
+                    memcpy(stats.name, record.name, sizeof(stats.name));
+                else
+                    snprintf(stats.name, sizeof(stats.name), "Thread %u", record.threadId);
+            }
+            m_threads.push_back(stats);
+
+            cpuNs += record.cpuTimeNs - history->cpuTimeNs;
+            switches += record.contextSwitches - history->contextSwitches;
+        }
+
+        m_nextHistory.push_back(History{ record.threadId, record.cpuTimeNs, record.contextSwitches });
+    }
+    m_history.swap(m_nextHistory);
+
+    std::sort(m_threads.begin(), m_threads.end(), [](const SelfThreadStats& a, const SelfThreadStats& b) {
+        return a.cpuPercent > b.cpuPercent;
+    });
+
+    // Threads that exited since the last snapshot take their final interval with them
+    if (seconds > 0.0) {
+        m_cpuPercent = cpuNs * 1e-7 / seconds;
+        m_switchesPerSec = switches / seconds;
+        m_allocationsPerSec = (allocations - m_lastAllocations) / seconds;
+    }
+
+    m_lastAllocations = allocations;
+    m_lastSampleNs = nowNs;
+    m_lastCostNs = m_clock.NowNs() - startNs;
+    return true;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Clock.h"
+
+#define SELF_THREAD_NAME_LENGTH 32
+
+// One of our threads as reported by a backend snapshot
+struct SelfThreadRecord {
+    uint32_t threadId;
+    uint64_t cpuTimeNs;          // User + kernel time so far
+    uint64_t contextSwitches;    // Times the thread was switched in so far
+    char name[SELF_THREAD_NAME_LENGTH];    // Backend's idea of the name, may be empty
+};
+
+// Process-wide figures from the same snapshot
+struct SelfProcessRecord {
+    uint64_t workingSet;         // Bytes resident
+    uint64_t privateBytes;       // Bytes committed privately (anonymous resident memory on Linux)
+    uint32_t handleCount;        // Kernel handles (open file descriptors on Linux)
+};
+
+// Per-thread figures derived from two snapshots
+struct SelfThreadStats {
+    uint32_t threadId;
+    double cpuPercent;           // Of one logical processor
+    double switchesPerSec;
+    char name[SELF_THREAD_NAME_LENGTH];
+};
+
+// Platform side of the monitor: one snapshot of our own process per call
+class ISelfBackend {
+public:
+    virtual ~ISelfBackend() = default;
+
+    // Replace 'threads' with our current threads. Returns false on failure.
+    virtual bool Snapshot(SelfProcessRecord& process, std::vector<SelfThreadRecord>& threads) = 0;
+};
+
+// What the overlay itself costs: CPU per thread, memory, handles, wakeups and allocations.
+// Threads are named from TraceRecorder::SetThreadName where our code named them, and from
+// the backend otherwise. Containers are reused, so steady-state samples don't allocate.
+class SelfMonitor {
+public:
+    explicit SelfMonitor(std::unique_ptr<ISelfBackend> backend, const Clock& clock = Clock::System());
+
+    // Take a snapshot and refresh the rates. Returns false if the backend failed.
+    bool Sample();
+
+    // Forget the previous snapshot so the next rates aren't averaged over a pause
+    void Reset();
+
+    // Busiest first; threads only appear once they've been seen in two snapshots
+    const std::vector<SelfThreadStats>& GetThreads() const { return m_threads; }
+    double GetCpuPercent() const { return m_cpuPercent; }
+    double GetContextSwitchesPerSec() const { return m_switchesPerSec; }
+    double GetAllocationsPerSec() const { return m_allocationsPerSec; }
+    const SelfProcessRecord& GetProcess() const { return m_process; }
+    uint64_t GetLastSampleCostNs() const { return m_lastCostNs; }
+
+    // Heap allocations made through operator new (replaced in SelfMonitor.cpp) and anything
+    // else routed through CountAllocation, such as ImGui's allocator
+    static void CountAllocation() { s_allocations.fetch_add(1, std::memory_order_relaxed); }
+    static uint64_t GetAllocationCount() { return s_allocations.load(std::memory_order_relaxed); }
+
+private:
+    struct History {
+        uint32_t threadId;
+        uint64_t cpuTimeNs;
+        uint64_t contextSwitches;
+    };
+
+    std::unique_ptr<ISelfBackend> m_backend;
+    const Clock& m_clock;
+    SelfProcessRecord m_process = {};
+    std::vector<SelfThreadRecord> m_records;
+    std::vector<History> m_history;          // Sorted by thread id
+    std::vector<History> m_nextHistory;
+    std::vector<SelfThreadStats> m_threads;
+    uint64_t m_lastSampleNs = 0;
+    uint64_t m_lastAllocations = 0;
+    uint64_t m_lastCostNs = 0;
+    double m_cpuPercent = 0.0;
+    double m_switchesPerSec = 0.0;
+    double m_allocationsPerSec = 0.0;
+
+    static std::atomic<uint64_t> s_allocations;
+};
@@ -0,0 +1,77 @@
+/*
+ * Shared-memory metrics published by Windows Info Overlay.
+ *
+ * The overlay writes its latest snapshot into a named region with the fixed layout below.
+ * Writers bump 'sequence' to an odd value, update the payload, then bump it to the next
+ * even value; readers copy the payload and retry if the sequence was odd or changed
+ * meanwhile (a seqlock). Reading takes no locks and no syscalls once the region is mapped.
+ *
+ * Plain C so scripts and tools in any language with a C FFI can use it. Link against the
+ * OverlayMetricsReader library, or reimplement the protocol from this header.
+ */
+#ifndef OVERLAY_SHARED_METRICS_H
+#define OVERLAY_SHARED_METRICS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef _WIN32
+#define OVERLAY_SHARED_METRICS_NAME "Local\\WindowsInfoOverlayMetrics"
+#else
+#define OVERLAY_SHARED_METRICS_NAME "/WindowsInfoOverlayMetrics"
+#endif
+
+#define OVERLAY_SHARED_METRICS_MAGIC 0x4D564F57u    /* "WOVM" */
+#define OVERLAY_SHARED_METRICS_VERSION 1u            /* Bumped on incompatible layout changes */
+
+/* Payload; new fields are only ever appended (readers check 'size') */
+typedef struct OverlayMetricsSample {
+    uint64_t timestampNs;          /* Monotonic publisher clock */
+    uint64_t publishCount;         /* 0 = nothing published since the region was (re)opened */
+    double cpuUsagePercent;
+    double cpuTemperatureCelsius;
+    uint64_t memoryUsedBytes;
+    uint64_t memoryTotalBytes;
+    double downloadBytesPerSec;
+    double uploadBytesPerSec;
+    int32_t batteryPercent;        /* -1 = no battery */
+    int32_t batteryCharging;
+} OverlayMetricsSample;
+
+typedef struct OverlaySharedMetrics {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;                 /* sizeof(OverlaySharedMetrics) as written by the publisher */
+    uint32_t publisherPid;
+    volatile uint64_t sequence;    /* Odd while a write is in progress */
+    OverlayMetricsSample sample;
+} OverlaySharedMetrics;
+
+/* Return codes */
+#define OVERLAY_METRICS_OK 0
+#define OVERLAY_METRICS_NOT_PUBLISHED -1    /* Overlay not running or publication disabled */
+#define OVERLAY_METRICS_INCOMPATIBLE -2     /* Unknown magic, version or size */
+#define OVERLAY_METRICS_BUSY -3             /* Writer kept the region busy for every retry */
+#define OVERLAY_METRICS_NO_SAMPLE -4        /* Mapped, but nothing published yet */
+
+typedef struct OverlayMetricsReader {
+    const OverlaySharedMetrics* view;
+    void* handle;                  /* Platform mapping handle */
+} OverlayMetricsReader;
+
+/* Map the region read-only */
+int OverlayMetricsOpen(OverlayMetricsReader* reader);
+
+/* Copy a consistent sample; retries up to maxRetries times while a write is in progress */
+int OverlayMetricsRead(const OverlayMetricsReader* reader, OverlayMetricsSample* sample, int maxRetries);
+
+void OverlayMetricsClose(OverlayMetricsReader* reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OVERLAY_SHARED_METRICS_H */
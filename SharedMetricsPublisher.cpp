@@ -0,0 +1,125 @@
+#include "SharedMetricsPublisher.h"
+#include <atomic>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+SharedMetricsPublisher::~SharedMetricsPublisher()
+{
+    Close();
+}
+
+bool SharedMetricsPublisher::Open(const char* name)
+{
+    if (m_view)
+        return true;
+
+#ifdef _WIN32
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0,
+                                        sizeof(OverlaySharedMetrics), name);
+    if (!mapping)
+        return false;
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, sizeof(OverlaySharedMetrics));
+    if (!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+    m_handle = mapping;
+#else
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0)
+        return false;
+
+    void* view = MAP_FAILED;
+    if (ftruncate(fd, sizeof(OverlaySharedMetrics)) == 0)
+        view = mmap(nullptr, sizeof(OverlaySharedMetrics), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) {
+        shm_unlink(name);
+        return false;
+    }
+    strncpy(m_name, name, sizeof(m_name) - 1);
+#endif
+
+    m_view = static_cast<OverlaySharedMetrics*>(view);
+
+    // Readers that kept an old mapping open must never see the sequence go backwards
+    uint64_t sequence = m_view->magic == OVERLAY_SHARED_METRICS_MAGIC ? (m_view->sequence + 1) & ~1ull : 0;
+    m_view->magic = 0;
+
+    // Clearing the sample is a write like any other: a reader that got past the magic check
+    // before it was cleared must see an odd sequence, or a changed one, and retry
+    m_view->sequence = sequence + 1;
+    std::atomic_thread_fence(std::memory_order_release);
+
+    m_view->version = OVERLAY_SHARED_METRICS_VERSION;
+    m_view->size = sizeof(OverlaySharedMetrics);
+#ifdef _WIN32
+    m_view->publisherPid = GetCurrentProcessId();
+#else
+    m_view->publisherPid = static_cast<uint32_t>(getpid());
+#endif
+    memset(&m_view->sample, 0, sizeof(m_view->sample));
+
+    std::atomic_thread_fence(std::memory_order_release);
+    m_view->sequence = sequence + 2;
+
+    // The magic goes in last: readers treat the header as valid once they see it
+    std::atomic_thread_fence(std::memory_order_release);
+    m_view->magic = OVERLAY_SHARED_METRICS_MAGIC;
+    return true;
+}
+
+void SharedMetricsPublisher::Close()
+{
+    if (!m_view)
+        return;
+
+    // Readers still holding a mapping see "nothing published" rather than stale values
+    m_view->magic = 0;
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_view);
+    CloseHandle(static_cast<HANDLE>(m_handle));
+#else
+    munmap(m_view, sizeof(OverlaySharedMetrics));
+    shm_unlink(m_name);
+#endif
+    m_view = nullptr;
+    m_handle = nullptr;
+}
+
+// Seqlock write: odd sequence, payload, next even sequence
+void SharedMetricsPublisher::Publish(const MetricsSnapshot& snapshot)
+{
+    if (!m_view)
+        return;
+
+    OverlayMetricsSample sample;
+    sample.timestampNs = snapshot.timestampNs;
+    sample.publishCount = ++m_publishCount;
+    sample.cpuUsagePercent = snapshot.cpuUsagePercent;
+    sample.cpuTemperatureCelsius = snapshot.cpuTemperatureCelsius;
+    sample.memoryUsedBytes = snapshot.memoryUsedBytes;
+    sample.memoryTotalBytes = snapshot.memoryTotalBytes;
+    sample.downloadBytesPerSec = snapshot.downloadBytesPerSec;
+    sample.uploadBytesPerSec = snapshot.uploadBytesPerSec;
+    sample.batteryPercent = snapshot.batteryPercent;
+    sample.batteryCharging = snapshot.batteryCharging;
+
+    uint64_t sequence = m_view->sequence;
+    m_view->sequence = sequence + 1;
+    std::atomic_thread_fence(std::memory_order_release);
+
+    memcpy(&m_view->sample, &sample, sizeof(sample));
+
+    std::atomic_thread_fence(std::memory_order_release);
+    m_view->sequence = sequence + 2;
+}
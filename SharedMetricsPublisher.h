@@ -0,0 +1,33 @@
+#pragma once
+
+#include "MetricsSnapshot.h"
+#include "SharedMetrics.h"
+
+// Writer side of the shared-memory metrics region (layout and protocol in SharedMetrics.h).
+// There is exactly one writer, the overlay's main thread, so publishing is two sequence
+// increments around a plain copy: no locks, no syscalls.
+class SharedMetricsPublisher {
+public:
+    SharedMetricsPublisher() = default;
+    ~SharedMetricsPublisher();
+
+    SharedMetricsPublisher(const SharedMetricsPublisher&) = delete;
+    SharedMetricsPublisher& operator=(const SharedMetricsPublisher&) = delete;
+
+    // Create (or take over) the named region. Returns false if it can't be created.
+    bool Open(const char* name = OVERLAY_SHARED_METRICS_NAME);
+    void Close();
+    bool IsOpen() const { return m_view != nullptr; }
+
+    void Publish(const MetricsSnapshot& snapshot);
+
+    uint64_t GetPublishCount() const { return m_publishCount; }
+
+private:
+    OverlaySharedMetrics* m_view = nullptr;
+    void* m_handle = nullptr;
+    uint64_t m_publishCount = 0;
+#ifndef _WIN32
+    char m_name[64] = {};
+#endif
+};
@@ -0,0 +1,107 @@
+#include "SharedMetrics.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#define ACQUIRE_FENCE() MemoryBarrier()
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ACQUIRE_FENCE() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#endif
+
+int OverlayMetricsOpen(OverlayMetricsReader* reader)
+{
+    reader->view = NULL;
+    reader->handle = NULL;
+
+#ifdef _WIN32
+    HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, OVERLAY_SHARED_METRICS_NAME);
+    if (!mapping)
+        return OVERLAY_METRICS_NOT_PUBLISHED;
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, sizeof(OverlaySharedMetrics));
+    if (!view) {
+        CloseHandle(mapping);
+        return OVERLAY_METRICS_NOT_PUBLISHED;
+    }
+    reader->handle = mapping;
+#else
+    int fd = shm_open(OVERLAY_SHARED_METRICS_NAME, O_RDONLY, 0);
+    if (fd < 0)
+        return OVERLAY_METRICS_NOT_PUBLISHED;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(OverlaySharedMetrics)) {
+        close(fd);
+        return OVERLAY_METRICS_INCOMPATIBLE;
+    }
+
+    void* view = mmap(NULL, sizeof(OverlaySharedMetrics), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED)
+        return OVERLAY_METRICS_NOT_PUBLISHED;
+#endif
+
+    reader->view = (const OverlaySharedMetrics*)view;
+
+    /* A zero magic means the publisher hasn't finished setting up; Read reports that */
+    if (reader->view->magic != 0 &&
+        (reader->view->magic != OVERLAY_SHARED_METRICS_MAGIC ||
+         reader->view->version != OVERLAY_SHARED_METRICS_VERSION ||
+         reader->view->size < sizeof(OverlaySharedMetrics))) {
+        OverlayMetricsClose(reader);
+        return OVERLAY_METRICS_INCOMPATIBLE;
+    }
+    return OVERLAY_METRICS_OK;
+}
+
+int OverlayMetricsRead(const OverlayMetricsReader* reader, OverlayMetricsSample* sample, int maxRetries)
+{
+    const OverlaySharedMetrics* view = reader->view;
+    if (!view)
+        return OVERLAY_METRICS_NOT_PUBLISHED;
+    if (view->magic != OVERLAY_SHARED_METRICS_MAGIC)
+        return OVERLAY_METRICS_NO_SAMPLE;
+
+    for (int attempt = 0; attempt <= maxRetries; attempt++) {
+        uint64_t before = view->sequence;
+        ACQUIRE_FENCE();
+        if (before & 1)
+            continue;    /* Write in progress */
+
+        OverlayMetricsSample copy;
+        memcpy(&copy, (const void*)&view->sample, sizeof(copy));
+
+        /* The payload loads must complete before the sequence is checked again */
+        ACQUIRE_FENCE();
+        if (view->sequence != before)
+            continue;    /* Torn: a write started while we were copying */
+
+        /* A publisher that (re)opened the region clears the sample before its first write */
+        if (before == 0 || copy.publishCount == 0)
+            return OVERLAY_METRICS_NO_SAMPLE;
+        *sample = copy;
+        return OVERLAY_METRICS_OK;
+    }
+    return OVERLAY_METRICS_BUSY;
+}
+
+void OverlayMetricsClose(OverlayMetricsReader* reader)
+{
+    if (reader->view) {
+#ifdef _WIN32
+        UnmapViewOfFile(reader->view);
+#else
+        munmap((void*)reader->view, sizeof(OverlaySharedMetrics));
+#endif
+    }
+#ifdef _WIN32
+    if (reader->handle)
+        CloseHandle((HANDLE)reader->handle);
+#endif
+    reader->view = NULL;
+    reader->handle = NULL;
+}
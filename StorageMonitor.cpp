@@ -0,0 +1,74 @@
+#include "StorageMonitor.h"
+#include <cstring>
+#include <iterator>
+
+StorageMonitor::StorageMonitor(std::unique_ptr<IStorageBackend> backend)
+    : m_backend(std::move(backend))
+{
+}
+
+StorageMonitor::~StorageMonitor()
+{
+    Close();
+}
+
+bool StorageMonitor::Open()
+{
+    if (m_open)
+        return true;
+
+    // Rates need a fresh baseline after a pause
+    m_rates.clear();
+    m_disks.clear();
+    m_totalBytesPerSec = 0.0;
+    m_open = m_backend->Open();
+    return m_open;
+}
+
+void StorageMonitor::Close()
+{
+    if (!m_open)
+        return;
+    m_backend->Close();
+    m_open = false;
+}
+
+bool StorageMonitor::Sample()
+{
+    if (!m_open || !m_backend->CollectDisks(m_counters))
+        return false;
+
+    m_disks.resize(m_counters.size());
+    m_totalBytesPerSec = 0.0;
+
+    for (size_t i = 0; i < m_counters.size(); i++) {
+        const DiskCounters& counters = m_counters[i];
+        DiskRates& rates = m_rates[counters.name];
+        rates.readBytes.Update(counters.readBytes, counters.timestampNs);
+        rates.writeBytes.Update(counters.writeBytes, counters.timestampNs);
+        rates.reads.Update(counters.reads, counters.timestampNs);
+        rates.writes.Update(counters.writes, counters.timestampNs);
+
+        DiskStats& stats = m_disks[i];
+        memcpy(stats.name, counters.name, sizeof(stats.name));
+        stats.readBytesPerSec = rates.readBytes.Get();
+        stats.writeBytesPerSec = rates.writeBytes.Get();
+        stats.readsPerSec = rates.reads.Get();
+        stats.writesPerSec = rates.writes.Get();
+        stats.queueLength = counters.queueLength;
+        m_totalBytesPerSec += stats.readBytesPerSec + stats.writeBytesPerSec;
+    }
+
+    // Disks that disappeared (e.g. a removed USB drive) drop their history
+    if (m_rates.size() > m_counters.size()) {
+        for (auto it = m_rates.begin(); it != m_rates.end(); ) {
+            bool present = false;
+            for (const auto& counters : m_counters)
+                present = present || it->first == counters.name;
+            it = present ? std::next(it) : m_rates.erase(it);
+        }
+    }
+
+    m_backend->CollectVolumes(m_volumes);
+    return true;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Estimators.h"
+
+#define STORAGE_NAME_LENGTH 32
+
+// Cumulative counters for one physical disk as read from the backend
+struct DiskCounters {
+    char name[STORAGE_NAME_LENGTH];
+    uint64_t readBytes;
+    uint64_t writeBytes;
+    uint64_t reads;
+    uint64_t writes;
+    uint32_t queueLength;    // Instantaneous, not cumulative
+    uint64_t timestampNs;    // Acquisition time of these counters
+};
+
+// Free space for one mounted volume
+struct VolumeSpace {
+    char name[STORAGE_NAME_LENGTH];
+    uint64_t freeBytes;
+    uint64_t totalBytes;
+};
+
+// Rates derived for one physical disk
+struct DiskStats {
+    char name[STORAGE_NAME_LENGTH];
+    double readBytesPerSec;
+    double writeBytesPerSec;
+    double readsPerSec;
+    double writesPerSec;
+    uint32_t queueLength;
+};
+
+// Platform side of the storage monitor
+class IStorageBackend {
+public:
+    virtual ~IStorageBackend() = default;
+
+    virtual bool Open() = 0;
+    virtual void Close() = 0;
+
+    // Every physical disk's counters, collected in one batched query
+    virtual bool CollectDisks(std::vector<DiskCounters>& disks) = 0;
+    virtual bool CollectVolumes(std::vector<VolumeSpace>& volumes) = 0;
+};
+
+// Per-disk throughput, IOPS and queue depth plus per-volume free space.
+// Backends report raw 64-bit cumulative counters and the monitor does the rate
+// math itself, so there's no 32-bit formatting or wraparound in the way.
+class StorageMonitor {
+public:
+    explicit StorageMonitor(std::unique_ptr<IStorageBackend> backend);
+    ~StorageMonitor();
+
+    bool Open();
+    void Close();
+    bool IsOpen() const { return m_open; }
+
+    // Collect once and refresh the rates. Returns false if the backend failed.
+    bool Sample();
+
+    const std::vector<DiskStats>& GetDisks() const { return m_disks; }
+    const std::vector<VolumeSpace>& GetVolumes() const { return m_volumes; }
+
+    // Sum over all disks, handy as a single activity figure
+    double GetTotalBytesPerSec() const { return m_totalBytesPerSec; }
+
+private:
+    struct DiskRates {
+        CounterRate<uint64_t> readBytes;
+        CounterRate<uint64_t> writeBytes;
+        CounterRate<uint64_t> reads;
+        CounterRate<uint64_t> writes;
+    };
+
+    std::unique_ptr<IStorageBackend> m_backend;
+    std::vector<DiskCounters> m_counters;
+    std::map<std::string, DiskRates> m_rates;
+    std::vector<DiskStats> m_disks;
+    std::vector<VolumeSpace> m_volumes;
+    double m_totalBytesPerSec = 0.0;
+    bool m_open = false;
+};
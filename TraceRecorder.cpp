@@ -0,0 +1,246 @@
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static_assert((TRACE_EVENTS_PER_THREAD & (TRACE_EVENTS_PER_THREAD - 1)) == 0, "TRACE_EVENTS_PER_THREAD must be a power of two");
+
+std::atomic<bool> TraceRecorder::s_enabled{ false };
+
+static uint32_t CurrentThreadId()
+{
+#ifdef _WIN32
+    return static_cast<uint32_t>(GetCurrentThreadId());
+#else
+    return static_cast<uint32_t>(syscall(SYS_gettid));
+#endif
+}
+
+static uint32_t CurrentProcessId()
+{
+#ifdef _WIN32
+    return static_cast<uint32_t>(GetCurrentProcessId());
+#else
+    return static_cast<uint32_t>(getpid());
+#endif
+}
+
+// A thread's claim on a ring. Rings are handed back when the thread exits and reused by the
+// next new thread (the visualizer's capture thread comes and goes with the overlay), so
+// memory stays bounded by the number of threads alive at once. Events carry their own
+// thread id, so a reused ring still attributes its older events correctly.
+struct ThreadBufferLease {
+    TraceRecorder::ThreadBuffer* buffer = nullptr;
+    uint32_t threadId = 0;
+
+    ~ThreadBufferLease()
+    {
+        if (buffer)
+            buffer->inUse.store(false, std::memory_order_release);
+    }
+};
+
+static thread_local ThreadBufferLease t_lease;
+
+TraceRecorder::TraceRecorder() : m_clock(Clock::System())
+{
+}
+
+TraceRecorder& TraceRecorder::Instance()
+{
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+void TraceRecorder::Record(const char* name, char phase)
+{
+    ThreadBuffer* buffer = t_lease.buffer ? t_lease.buffer : AcquireBuffer();
+
+    // Single writer per ring: fill the slot, then publish it by advancing the head
+    uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    TraceEvent& event = buffer->events[head & (TRACE_EVENTS_PER_THREAD - 1)];
+    event.timestampNs = m_clock.NowNs();
+    event.name = name;
+    event.threadId = t_lease.threadId;
+    event.phase = phase;
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::AcquireBuffer()
+{
+    std::lock_guard<std::mutex> lock(m_registryMutex);
+
+    ThreadBuffer* buffer = nullptr;
+    for (auto& candidate : m_buffers) {
+        bool expected = false;
+        if (candidate->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            buffer = candidate.get();
+            break;
+        }
+    }
+    if (!buffer) {
+        m_buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffer = m_buffers.back().get();
+        buffer->inUse.store(true, std::memory_order_relaxed);
+    }
+
+    t_lease.buffer = buffer;
+    t_lease.threadId = CurrentThreadId();
+    return buffer;
+}
+
+void TraceRecorder::SetThreadName(const char* name)
+{
+    uint32_t threadId = CurrentThreadId();
+    std::lock_guard<std::mutex> lock(m_registryMutex);
+
+    ThreadName* entry = nullptr;
+    for (auto& existing : m_threadNames) {
+        if (existing.threadId == threadId)
+            entry = &existing;
+    }
+    if (!entry) {
+        m_threadNames.push_back(ThreadName{ threadId, {} });
+        entry = &m_threadNames.back();
+    }
+    strncpy(entry->name, name, TRACE_THREAD_NAME_LENGTH - 1);
+    entry->name[TRACE_THREAD_NAME_LENGTH - 1] = '\0';
+}
+
+bool TraceRecorder::GetThreadName(uint32_t threadId, char* name, size_t size)
+{
+    std::lock_guard<std::mutex> lock(m_registryMutex);
+    for (const auto& entry : m_threadNames) {
+        if (entry.threadId == threadId) {
+            snprintf(name, size, "%s", entry.name);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TraceRecorder::Collect(std::vector<TraceEvent>& events)
+{
+    for (auto& buffer : m_buffers) {
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t begin = head > TRACE_EVENTS_PER_THREAD ? head - TRACE_EVENTS_PER_THREAD : 0;
+        size_t copied = events.size();
+        for (uint64_t i = begin; i < head; i++)
+            events.push_back(buffer->events[i & (TRACE_EVENTS_PER_THREAD - 1)]);
+
+        // Whatever the writer lapped while we were copying is suspect: drop it. That includes
+        // the slot it may be filling right now (index 'after', which is also after - N).
+        uint64_t after = buffer->head.load(std::memory_order_acquire);
+        uint64_t safeBegin = after + 1 > TRACE_EVENTS_PER_THREAD ? after + 1 - TRACE_EVENTS_PER_THREAD : 0;
+        if (safeBegin > begin) {
+            size_t lapped = static_cast<size_t>(std::min(safeBegin, head) - begin);
+            events.erase(events.begin() + copied, events.begin() + copied + lapped);
+        }
+    }
+}
+
+void TraceRecorder::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_registryMutex);
+    for (auto& buffer : m_buffers)
+        buffer->head.store(0, std::memory_order_relaxed);
+}
+
+static void AppendEscaped(std::string& out, const char* text)
+{
+    for (const char* p = text; *p; p++) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        }
+        else if (c < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        }
+        else {
+            out += static_cast<char>(c);
+        }
+    }
+}
+
+std::string TraceRecorder::FormatChromeJson()
+{
+    std::vector<TraceEvent> events;
+    std::vector<ThreadName> names;
+    {
+        std::lock_guard<std::mutex> lock(m_registryMutex);
+        events.reserve(m_buffers.size() * TRACE_EVENTS_PER_THREAD);
+        Collect(events);
+        names = m_threadNames;
+    }
+
+    // Rings are per thread but reused ones can hold several threads; viewers want each
+    // thread's events in time order
+    std::stable_sort(events.begin(), events.end(), [](const TraceEvent& a, const TraceEvent& b) {
+        return a.timestampNs < b.timestampNs;
+    });
+    uint64_t originNs = events.empty() ? 0 : events.front().timestampNs;
+    uint32_t pid = CurrentProcessId();
+
+    std::string out;
+    out.reserve(events.size() * 80 + 256);
+    out += "{\"traceEvents\":[";
+    bool first = true;
+    char line[160];
+
+    for (const auto& name : names) {
+        snprintf(line, sizeof(line), "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"",
+                 first ? "" : ",", pid, name.threadId);
+        out += line;
+        AppendEscaped(out, name.name);
+        out += "\"}}";
+        first = false;
+    }
+
+    // An end whose begin was overwritten would close whatever slice happens to be open
+    std::unordered_map<uint32_t, uint32_t> depth;
+    for (const auto& event : events) {
+        uint32_t& open = depth[event.threadId];
+        if (event.phase == 'E') {
+            if (open == 0)
+                continue;
+            open--;
+        }
+        else {
+            open++;
+        }
+
+        uint64_t relativeNs = event.timestampNs - originNs;
+        snprintf(line, sizeof(line), "%s\n{\"ph\":\"%c\",\"pid\":%u,\"tid\":%u,\"ts\":%llu.%03u,\"name\":\"",
+                 first ? "" : ",", event.phase, pid, event.threadId,
+                 static_cast<unsigned long long>(relativeNs / 1000), static_cast<unsigned>(relativeNs % 1000));
+        out += line;
+        AppendEscaped(out, event.name);
+        out += "\"}";
+        first = false;
+    }
+
+    out += "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return out;
+}
+
+bool TraceRecorder::WriteChromeJson(const std::string& path)
+{
+    std::string json = FormatChromeJson();
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    bool written = fwrite(json.data(), 1, json.size(), file) == json.size();
+    return fclose(file) == 0 && written;
+}
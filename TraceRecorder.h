@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Clock.h"
+
+#define TRACE_EVENTS_PER_THREAD 8192    // Power of two
+#define TRACE_THREAD_NAME_LENGTH 32
+
+struct TraceEvent {
+    uint64_t timestampNs;
+    const char* name;      // Must outlive the recorder (string literals)
+    uint32_t threadId;
+    char phase;            // 'B' or 'E'
+};
+
+// Begin/end events for the timeline of every thread, dumped as Chrome trace-event JSON
+// (chrome://tracing, Perfetto).
+// Each thread records into its own fixed ring, so recording is a couple of plain stores and
+// a release store of the ring head: no locks, no allocation. While disabled, TraceScope costs
+// one relaxed load. Rings wrap, so a dump holds the most recent events of each thread; the
+// dump skips any slot a writer overwrote while it was being copied, and the slot one could be
+// overwriting as it finishes, so a full ring dumps TRACE_EVENTS_PER_THREAD - 1 events.
+class TraceRecorder {
+public:
+    static TraceRecorder& Instance();
+
+    static bool IsEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+    void SetEnabled(bool enabled) { s_enabled.store(enabled, std::memory_order_relaxed); }
+
+    void Begin(const char* name) { Record(name, 'B'); }
+    void End(const char* name) { Record(name, 'E'); }
+
+    // Label the calling thread in the dump
+    void SetThreadName(const char* name);
+    bool GetThreadName(uint32_t threadId, char* name, size_t size);
+
+    // Everything currently held in the rings, oldest first per thread. End events whose
+    // begin was already overwritten are dropped so every slice in the output is well formed.
+    std::string FormatChromeJson();
+    bool WriteChromeJson(const std::string& path);
+
+    // Drop all recorded events (not meant to race with recording threads)
+    void Clear();
+
+private:
+    struct ThreadBuffer {
+        std::atomic<uint64_t> head{ 0 };
+        std::atomic<bool> inUse{ false };
+        TraceEvent events[TRACE_EVENTS_PER_THREAD];
+    };
+
+    struct ThreadName {
+        uint32_t threadId;
+        char name[TRACE_THREAD_NAME_LENGTH];
+    };
+
+    TraceRecorder();
+
+    void Record(const char* name, char phase);
+    ThreadBuffer* AcquireBuffer();
+    void Collect(std::vector<TraceEvent>& events);
+
+    const Clock& m_clock;
+    std::mutex m_registryMutex;    // Only taken when a thread records for the first time, and by dumps
+    std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+    std::vector<ThreadName> m_threadNames;
+
+    static std::atomic<bool> s_enabled;
+    friend struct ThreadBufferLease;
+};
+
+// Records a begin event now and the matching end event when the scope closes
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) : m_name(TraceRecorder::IsEnabled() ? name : nullptr)
+    {
+        if (m_name)
+            TraceRecorder::Instance().Begin(m_name);
+    }
+
+    ~TraceScope()
+    {
+        if (m_name)
+            TraceRecorder::Instance().End(m_name);
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* m_name;
+};
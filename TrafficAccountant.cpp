@@ -0,0 +1,257 @@
+#include "TrafficAccountant.h"
+#include <cstddef>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+static const uint32_t JOURNAL_MAGIC = 0x4A524654;    // "TFRJ"
+static const uint32_t SNAPSHOT_MAGIC = 0x53524654;   // "TFRS"
+static const uint32_t SNAPSHOT_VERSION = 1;
+
+// Make written data survive a crash of the process (and, where possible, of the OS)
+static void FlushFile(FILE* file)
+{
+    fflush(file);
+#ifdef _WIN32
+    _commit(_fileno(file));
+#else
+    fsync(fileno(file));
+#endif
+}
+
+// Atomically replace 'to' with 'from'
+static bool ReplaceAtomically(const std::string& from, const std::string& to)
+{
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+TrafficAccountant::TrafficAccountant()
+{
+    memset(&m_state, 0, sizeof(m_state));
+}
+
+TrafficAccountant::~TrafficAccountant()
+{
+    Close();
+}
+
+bool TrafficAccountant::Open(const std::string& basePath)
+{
+    Close();
+
+    m_snapshotPath = basePath + ".snap";
+    m_journalPath = basePath + ".journal";
+    m_adapters.clear();
+
+    LoadSnapshot();
+    ReplayJournal();
+
+    // Start every run from a clean journal so a torn tail is never appended to
+    if (!Compact())
+        return false;
+    return m_journal != nullptr;
+}
+
+void TrafficAccountant::Close()
+{
+    if (!m_journal)
+        return;
+    Compact();
+    fclose(m_journal);
+    m_journal = nullptr;
+}
+
+void TrafficAccountant::Integrate(const std::vector<InterfaceTraffic>& interfaces, uint32_t dayKey)
+{
+    uint64_t rx = 0;
+    uint64_t tx = 0;
+
+    for (const InterfaceTraffic& traffic : interfaces) {
+        auto result = m_adapters.try_emplace(traffic.id, AdapterState{ traffic.rxBytes, traffic.txBytes });
+        AdapterState& state = result.first->second;
+        if (result.second)
+            continue;
+
+        // Counters only go backwards when the adapter was reset; count from zero then
+        rx += traffic.rxBytes >= state.rxBytes ? traffic.rxBytes - state.rxBytes : traffic.rxBytes;
+        tx += traffic.txBytes >= state.txBytes ? traffic.txBytes - state.txBytes : traffic.txBytes;
+        state.rxBytes = traffic.rxBytes;
+        state.txBytes = traffic.txBytes;
+    }
+
+    if (rx == 0 && tx == 0)
+        return;
+
+    Apply(dayKey, rx, tx);
+    Append(dayKey, rx, tx);
+
+    if (m_journalRecords >= m_compactThreshold)
+        Compact();
+}
+
+TrafficBucket TrafficAccountant::GetDay(uint32_t dayKey) const
+{
+    const TrafficBucket* bucket = FindInRing(const_cast<TrafficBucket*>(m_state.days), TRAFFIC_DAY_BUCKETS, dayKey);
+    return bucket ? *bucket : TrafficBucket{ dayKey, 0, 0 };
+}
+
+TrafficBucket TrafficAccountant::GetMonth(uint32_t monthKey) const
+{
+    const TrafficBucket* bucket = FindInRing(const_cast<TrafficBucket*>(m_state.months), TRAFFIC_MONTH_BUCKETS, monthKey);
+    return bucket ? *bucket : TrafficBucket{ monthKey, 0, 0 };
+}
+
+void TrafficAccountant::Apply(uint32_t dayKey, uint64_t rxBytes, uint64_t txBytes)
+{
+    AddToRing(m_state.days, TRAFFIC_DAY_BUCKETS, dayKey, rxBytes, txBytes);
+    AddToRing(m_state.months, TRAFFIC_MONTH_BUCKETS, MonthKey(dayKey), rxBytes, txBytes);
+}
+
+// Rings are kept oldest-first; a new key evicts the oldest bucket
+void TrafficAccountant::AddToRing(TrafficBucket* ring, size_t size, uint32_t key, uint64_t rxBytes, uint64_t txBytes)
+{
+    TrafficBucket& newest = ring[size - 1];
+    if (newest.key != key) {
+        // Keys only move forward; anything older than the newest bucket is folded into it
+        if (newest.key > key) {
+            TrafficBucket* bucket = FindInRing(ring, size, key);
+            if (!bucket)
+                bucket = &newest;
+            bucket->rxBytes += rxBytes;
+            bucket->txBytes += txBytes;
+            return;
+        }
+        memmove(ring, ring + 1, (size - 1) * sizeof(TrafficBucket));
+        newest = TrafficBucket{ key, 0, 0 };
+    }
+    newest.rxBytes += rxBytes;
+    newest.txBytes += txBytes;
+}
+
+TrafficBucket* TrafficAccountant::FindInRing(TrafficBucket* ring, size_t size, uint32_t key)
+{
+    for (size_t i = size; i-- > 0; ) {
+        if (ring[i].key == key)
+            return &ring[i];
+    }
+    return nullptr;
+}
+
+bool TrafficAccountant::LoadSnapshot()
+{
+    memset(&m_state, 0, sizeof(m_state));
+
+    FILE* file = fopen(m_snapshotPath.c_str(), "rb");
+    if (!file)
+        return false;
+
+    Snapshot snapshot;
+    bool valid = fread(&snapshot, sizeof(snapshot), 1, file) == 1 &&
+                 snapshot.magic == SNAPSHOT_MAGIC && snapshot.version == SNAPSHOT_VERSION &&
+                 snapshot.crc == Crc32(&snapshot, offsetof(Snapshot, crc));
+    fclose(file);
+
+    if (valid) {
+        m_state = snapshot;
+        m_sequence = snapshot.lastSequence;
+    }
+    return valid;
+}
+
+// Apply every intact record newer than the snapshot; stop at the first torn or corrupt one
+void TrafficAccountant::ReplayJournal()
+{
+    FILE* file = fopen(m_journalPath.c_str(), "rb");
+    if (!file)
+        return;
+
+    JournalRecord record;
+    while (fread(&record, sizeof(record), 1, file) == 1) {
+        if (record.magic != JOURNAL_MAGIC || record.crc != Crc32(&record, offsetof(JournalRecord, crc)))
+            break;
+        if (record.sequence <= m_state.lastSequence)
+            continue;    // Already folded into the snapshot (crash between snapshot and truncate)
+
+        Apply(record.dayKey, record.rxBytes, record.txBytes);
+        m_sequence = record.sequence;
+    }
+    fclose(file);
+}
+
+bool TrafficAccountant::Append(uint32_t dayKey, uint64_t rxBytes, uint64_t txBytes)
+{
+    if (!m_journal)
+        return false;
+
+    JournalRecord record;
+    memset(&record, 0, sizeof(record));
+    record.magic = JOURNAL_MAGIC;
+    record.dayKey = dayKey;
+    record.sequence = ++m_sequence;
+    record.rxBytes = rxBytes;
+    record.txBytes = txBytes;
+    record.crc = Crc32(&record, offsetof(JournalRecord, crc));
+
+    if (fwrite(&record, sizeof(record), 1, m_journal) != 1)
+        return false;
+    FlushFile(m_journal);
+    m_journalRecords++;
+    return true;
+}
+
+// Snapshot goes to a temp file, is flushed, and atomically replaces the old one;
+// only then is the journal truncated. Records are sequence-numbered, so a crash
+// between those two steps can't count anything twice.
+bool TrafficAccountant::Compact()
+{
+    m_state.magic = SNAPSHOT_MAGIC;
+    m_state.version = SNAPSHOT_VERSION;
+    m_state.lastSequence = m_sequence;
+    m_state.crc = Crc32(&m_state, offsetof(Snapshot, crc));
+
+    std::string tempPath = m_snapshotPath + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file)
+        return false;
+    bool written = fwrite(&m_state, sizeof(m_state), 1, file) == 1;
+    FlushFile(file);
+    fclose(file);
+    if (!written || !ReplaceAtomically(tempPath, m_snapshotPath))
+        return false;
+
+    if (m_journal)
+        fclose(m_journal);
+    m_journal = fopen(m_journalPath.c_str(), "wb");
+    m_journalRecords = 0;
+    return m_journal != nullptr;
+}
+
+uint32_t TrafficAccountant::Crc32(const void* data, size_t length)
+{
+    static uint32_t table[256];
+    static bool initialized = false;
+    if (!initialized) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        initialized = true;
+    }
+
+    uint32_t crc = 0xFFFFFFFFu;
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < length; i++)
+        crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
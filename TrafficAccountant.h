@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define TRAFFIC_DAY_BUCKETS 62
+#define TRAFFIC_MONTH_BUCKETS 24
+
+// Bytes transferred in one day (key yyyymmdd) or month (key yyyymm)
+struct TrafficBucket {
+    uint32_t key;
+    uint64_t rxBytes;
+    uint64_t txBytes;
+};
+
+// Cumulative 64-bit byte counters for one adapter
+struct InterfaceTraffic {
+    uint64_t id;         // Stable per adapter (e.g. its LUID)
+    uint64_t rxBytes;
+    uint64_t txBytes;
+};
+
+// Persistent per-day and per-month data usage.
+// Adapter byte counters are turned into deltas and added to fixed-size day and month
+// rings. Every change is appended to a journal of checksummed records; the journal is
+// periodically folded into a fixed-size snapshot, so loading at startup reads a bounded
+// amount of data no matter how long the accountant has been running. A torn journal
+// tail (crash mid-write) is detected by its checksum and dropped.
+class TrafficAccountant {
+public:
+    TrafficAccountant();
+    ~TrafficAccountant();
+
+    // Load state from basePath + ".snap" / ".journal". Missing files start empty.
+    bool Open(const std::string& basePath);
+
+    // Compact and close the journal
+    void Close();
+    bool IsOpen() const { return m_journal != nullptr; }
+
+    // Feed the current counters of every adapter. dayKey is the local date as yyyymmdd.
+    // The first reading of an adapter only sets its baseline.
+    void Integrate(const std::vector<InterfaceTraffic>& interfaces, uint32_t dayKey);
+
+    TrafficBucket GetDay(uint32_t dayKey) const;
+    TrafficBucket GetMonth(uint32_t monthKey) const;
+
+    // Fold the journal into a fresh snapshot and truncate it
+    bool Compact();
+
+    // Journal records since the last compaction
+    uint32_t GetJournalLength() const { return m_journalRecords; }
+
+    static uint32_t MonthKey(uint32_t dayKey) { return dayKey / 100; }
+
+private:
+    struct JournalRecord {
+        uint32_t magic;
+        uint32_t dayKey;
+        uint64_t sequence;
+        uint64_t rxBytes;
+        uint64_t txBytes;
+        uint32_t crc;
+        uint32_t reserved;
+    };
+
+    struct Snapshot {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t lastSequence;    // Journal records up to here are already folded in
+        TrafficBucket days[TRAFFIC_DAY_BUCKETS];
+        TrafficBucket months[TRAFFIC_MONTH_BUCKETS];
+        uint32_t crc;
+        uint32_t reserved;
+    };
+
+    struct AdapterState {
+        uint64_t rxBytes;
+        uint64_t txBytes;
+    };
+
+    void Apply(uint32_t dayKey, uint64_t rxBytes, uint64_t txBytes);
+    static void AddToRing(TrafficBucket* ring, size_t size, uint32_t key, uint64_t rxBytes, uint64_t txBytes);
+    static TrafficBucket* FindInRing(TrafficBucket* ring, size_t size, uint32_t key);
+    bool LoadSnapshot();
+    void ReplayJournal();
+    bool Append(uint32_t dayKey, uint64_t rxBytes, uint64_t txBytes);
+
+    static uint32_t Crc32(const void* data, size_t length);
+
+    std::string m_snapshotPath;
+    std::string m_journalPath;
+    FILE* m_journal = nullptr;
+    uint32_t m_journalRecords = 0;
+    uint32_t m_compactThreshold = 1024;
+    uint64_t m_sequence = 0;
+    Snapshot m_state;
+    std::unordered_map<uint64_t, AdapterState> m_adapters;
+};
@@ -0,0 +1,113 @@
+#include "VisualizerGeometry.h"
+#include <cmath>
+
+// Write an arbitrary quad into space previously reserved with PrimReserve
+static inline void PrimQuad(ImDrawList* drawList, const ImVec2& a, const ImVec2& b, const ImVec2& c, const ImVec2& d, const ImVec2& uv, ImU32 col)
+{
+    ImDrawIdx idx = (ImDrawIdx)drawList->_VtxCurrentIdx;
+    drawList->PrimWriteIdx(idx); drawList->PrimWriteIdx((ImDrawIdx)(idx + 1)); drawList->PrimWriteIdx((ImDrawIdx)(idx + 2));
+    drawList->PrimWriteIdx(idx); drawList->PrimWriteIdx((ImDrawIdx)(idx + 2)); drawList->PrimWriteIdx((ImDrawIdx)(idx + 3));
+    drawList->PrimWriteVtx(a, uv, col);
+    drawList->PrimWriteVtx(b, uv, col);
+    drawList->PrimWriteVtx(c, uv, col);
+    drawList->PrimWriteVtx(d, uv, col);
+}
+
+VisualizerGeometry::VisualizerGeometry(int bands)
+{
+    SetBands(bands);
+}
+
+void VisualizerGeometry::SetBands(int bands)
+{
+    m_bands = bands > 0 ? bands : 0;
+    m_cos.resize(m_bands + 1);
+    m_sin.resize(m_bands + 1);
+    for (int i = 0; i <= m_bands; i++) {
+        float angle = (2.0f * 3.14159265f * i) / (m_bands ? m_bands : 1) - 3.14159265f * 0.5f;
+        m_cos[i] = cosf(angle);
+        m_sin[i] = sinf(angle);
+    }
+}
+
+int VisualizerGeometry::GetVertexCount(int style) const
+{
+    // Two quads per band (per segment for the line)
+    return (style == VISUALIZER_LINE ? m_bands - 1 : m_bands) * 8;
+}
+
+void VisualizerGeometry::Draw(ImDrawList* drawList, int style, const ImVec2& origin, float width, float height,
+                              const float* levels, const float* peaks) const
+{
+    if (m_bands < 2)
+        return;
+
+    const ImVec2 uv = ImGui::GetFontTexUvWhitePixel();
+    const ImU32 barColor = IM_COL32(51, 204, 255, 230);
+    const ImU32 fillColor = IM_COL32(51, 204, 255, 70);
+    const ImU32 peakColor = IM_COL32(255, 255, 255, 220);
+    const int bands = m_bands;
+    const float bottom = origin.y + height;
+
+    switch (style) {
+    case VISUALIZER_LINE: {
+        // Filled area plus a 2px line, one quad each per segment
+        const float step = width / (bands - 1);
+        const float thickness = 1.0f;
+        drawList->PrimReserve((bands - 1) * 12, (bands - 1) * 8);
+        for (int i = 0; i < bands - 1; i++) {
+            float x0 = origin.x + step * i;
+            float x1 = x0 + step;
+            float y0 = bottom - levels[i] * height;
+            float y1 = bottom - levels[i + 1] * height;
+            PrimQuad(drawList, ImVec2(x0, y0), ImVec2(x1, y1), ImVec2(x1, bottom), ImVec2(x0, bottom), uv, fillColor);
+            PrimQuad(drawList, ImVec2(x0, y0 - thickness), ImVec2(x1, y1 - thickness),
+                ImVec2(x1, y1 + thickness), ImVec2(x0, y0 + thickness), uv, barColor);
+        }
+        break;
+    }
+
+    case VISUALIZER_CIRCLE: {
+        // Radial bars with a peak tick, corners taken from the trig tables
+        const ImVec2 center(origin.x + width * 0.5f, origin.y + height * 0.5f);
+        const float innerRadius = height * 0.2f;
+        const float maxLength = height * 0.5f - innerRadius;
+        drawList->PrimReserve(bands * 12, bands * 8);
+        for (int i = 0; i < bands; i++) {
+            const float c0 = m_cos[i], s0 = m_sin[i];
+            const float c1 = m_cos[i + 1], s1 = m_sin[i + 1];
+            float outer = innerRadius + levels[i] * maxLength;
+            float peak = innerRadius + peaks[i] * maxLength;
+            PrimQuad(drawList,
+                ImVec2(center.x + c0 * innerRadius, center.y + s0 * innerRadius),
+                ImVec2(center.x + c0 * outer, center.y + s0 * outer),
+                ImVec2(center.x + c1 * outer, center.y + s1 * outer),
+                ImVec2(center.x + c1 * innerRadius, center.y + s1 * innerRadius),
+                uv, barColor);
+            PrimQuad(drawList,
+                ImVec2(center.x + c0 * peak, center.y + s0 * peak),
+                ImVec2(center.x + c0 * (peak + 2.0f), center.y + s0 * (peak + 2.0f)),
+                ImVec2(center.x + c1 * (peak + 2.0f), center.y + s1 * (peak + 2.0f)),
+                ImVec2(center.x + c1 * peak, center.y + s1 * peak),
+                uv, peakColor);
+        }
+        break;
+    }
+
+    default: {
+        // Bars: one rect per band plus a 2px peak marker
+        const float step = width / bands;
+        const float gap = step > 4.0f ? 1.0f : 0.0f;
+        drawList->PrimReserve(bands * 12, bands * 8);
+        for (int i = 0; i < bands; i++) {
+            float x0 = origin.x + step * i + gap;
+            float x1 = origin.x + step * (i + 1) - gap;
+            float top = bottom - levels[i] * height;
+            float peak = bottom - peaks[i] * height;
+            drawList->PrimRect(ImVec2(x0, top), ImVec2(x1, bottom), barColor);
+            drawList->PrimRect(ImVec2(x0, peak - 2.0f), ImVec2(x1, peak), peakColor);
+        }
+        break;
+    }
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+#include "imgui/imgui.h"
+
+enum VisualizerStyle {
+    VISUALIZER_BARS,
+    VISUALIZER_LINE,
+    VISUALIZER_CIRCLE
+};
+
+// Batched draw-list geometry for the audio visualizer styles.
+// Every style reserves its whole geometry up front with a single PrimReserve and never
+// touches the clip rect or texture, so it merges into the window's existing draw command.
+// The circle style takes its corners from trig tables built when the band count is set.
+class VisualizerGeometry {
+public:
+    explicit VisualizerGeometry(int bands = 0);
+
+    void SetBands(int bands);
+    int GetBands() const { return m_bands; }
+
+    // levels and peaks hold one 0..1 value per band
+    void Draw(ImDrawList* drawList, int style, const ImVec2& origin, float width, float height,
+              const float* levels, const float* peaks) const;
+
+    // Vertices Draw adds for a style at the current band count
+    int GetVertexCount(int style) const;
+
+private:
+    int m_bands = 0;
+    std::vector<float> m_cos;    // One entry per band edge (bands + 1)
+    std::vector<float> m_sin;
+};
@@ -0,0 +1,73 @@
+#include "VisualizerSmoother.h"
+#include "Estimators.h"
+#include <cmath>
+#include <algorithm>
+
+VisualizerSmoother::VisualizerSmoother(size_t bands)
+{
+    Resize(bands);
+}
+
+void VisualizerSmoother::Resize(size_t bands)
+{
+    m_levels.assign(bands, 0.0f);
+    m_peaks.assign(bands, 0.0f);
+    m_peakStart.assign(bands, 0.0f);
+    m_peakHoldEnd.assign(bands, 0.0);
+    m_hasTime = false;
+}
+
+void VisualizerSmoother::Reset()
+{
+    Resize(m_levels.size());
+}
+
+void VisualizerSmoother::Update(const float* target, double now)
+{
+    if (!target)
+        return;
+
+    double dt = m_hasTime ? now - m_lastTime : 0.0;
+    if (dt < 0.0)
+        dt = 0.0;
+    m_lastTime = now;
+    m_hasTime = true;
+
+    // Exponential approach: the same total dt gives the same result however it is split up
+    const float attack = Ewma<float>::TimeConstantAlpha(dt, m_settings.attackTime);
+    const float release = Ewma<float>::TimeConstantAlpha(dt, m_settings.releaseTime);
+
+    for (size_t i = 0; i < m_levels.size(); i++) {
+        float level = Ewma<float>::Step(m_levels[i], target[i], target[i] > m_levels[i] ? attack : release);
+        m_levels[i] = level;
+
+        if (level >= m_peaks[i]) {
+            // New peak: restart the hold period
+            m_peaks[i] = level;
+            m_peakStart[i] = level;
+            m_peakHoldEnd[i] = now + m_settings.peakHoldTime;
+        } else if (now > m_peakHoldEnd[i]) {
+            // Closed-form fall from the hold point so the marker position is exact for any frame rate
+            double fallTime = now - m_peakHoldEnd[i];
+            float peak = m_peakStart[i] - static_cast<float>(0.5 * m_settings.peakGravity * fallTime * fallTime);
+            m_peaks[i] = std::max(peak, level);
+        }
+    }
+}
+
+void VisualizerSmoother::InterpolateSnapshots(const float* previous, double previousTime,
+                                              const float* current, double currentTime,
+                                              double now, size_t bands, float* output)
+{
+    double interval = currentTime - previousTime;
+    float alpha = 1.0f;
+    if (previous && interval > 0.0) {
+        alpha = static_cast<float>((now - currentTime) / interval);
+        alpha = std::min(1.0f, std::max(0.0f, alpha));
+    }
+
+    for (size_t i = 0; i < bands; i++) {
+        float from = previous ? previous[i] : current[i];
+        output[i] = from + (current[i] - from) * alpha;
+    }
+}
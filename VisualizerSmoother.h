@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// Time constants for the visualizer smoothing (all in seconds)
+struct VisualizerSmootherSettings {
+    float attackTime = 0.025f;   // Time constant while a band is rising
+    float releaseTime = 0.09f;   // Time constant while a band is falling
+    float peakHoldTime = 0.35f;  // How long a peak marker stays put before it starts falling
+    float peakGravity = 3.0f;    // Peak fall acceleration in full-scale units per second squared
+};
+
+// Frame-rate-independent smoothing for visualizer bands.
+// All decay is computed from elapsed time rather than per call, so the result
+// only depends on the timestamps passed in and not on how often Update runs.
+class VisualizerSmoother {
+public:
+    explicit VisualizerSmoother(size_t bands = 0);
+
+    void Resize(size_t bands);
+    void Reset();
+    void SetSettings(const VisualizerSmootherSettings& settings) { m_settings = settings; }
+
+    // Advance the smoothed levels towards target (one value per band) up to time 'now'
+    void Update(const float* target, double now);
+
+    const std::vector<float>& GetLevels() const { return m_levels; }
+    const std::vector<float>& GetPeaks() const { return m_peaks; }
+
+    // Blend two capture snapshots for render time 'now'. Rendering runs one snapshot
+    // interval behind the newest capture so there is always a pair to interpolate between.
+    static void InterpolateSnapshots(const float* previous, double previousTime,
+                                     const float* current, double currentTime,
+                                     double now, size_t bands, float* output);
+
+private:
+    VisualizerSmootherSettings m_settings;
+    std::vector<float> m_levels;
+    std::vector<float> m_peaks;
+    std::vector<float> m_peakStart;     // Peak value when the current hold began
+    std::vector<double> m_peakHoldEnd;  // Time when the peak starts to fall
+    double m_lastTime = 0.0;
+    bool m_hasTime = false;
+};
@@ -0,0 +1,157 @@
+#include "WindowTracker.h"
+#include <cstring>
+
+// WinEvent callbacks carry no user data, so they reach the tracker through this
+static WindowTracker* g_windowTracker = nullptr;
+
+WindowTracker::WindowTracker() :
+    m_lifetimeHook(NULL),
+    m_changeHook(NULL)
+{
+    SetSettings(WindowTrackingSettings());
+}
+
+WindowTracker::~WindowTracker()
+{
+    Stop();
+}
+
+void WindowTracker::SetSettings(const WindowTrackingSettings& settings)
+{
+    m_titles.clear();
+    for (int i = 0; i < MAX_TRACKED_TITLES; i++)
+    {
+        // Settings come from disk, so don't trust the terminator
+        char title[TRACKED_TITLE_LENGTH];
+        memcpy(title, settings.titles[i], TRACKED_TITLE_LENGTH);
+        title[TRACKED_TITLE_LENGTH - 1] = '\0';
+        if (title[0] == '\0')
+            continue;
+
+        int size_needed = MultiByteToWideChar(CP_UTF8, 0, title, -1, nullptr, 0);
+        std::wstring wTitle(size_needed, 0);
+        MultiByteToWideChar(CP_UTF8, 0, title, -1, &wTitle[0], size_needed);
+        wTitle.resize(size_needed - 1);  // Drop the terminator
+        m_titles.push_back(wTitle);
+    }
+
+    if (IsRunning())
+        Rebuild();
+}
+
+void WindowTracker::Start()
+{
+    if (m_lifetimeHook)
+        return;
+
+    g_windowTracker = this;
+
+    // Only the events we handle: CREATE..HIDE (create, destroy, show, hide) and the adjacent
+    // LOCATIONCHANGE..NAMECHANGE pair. A single CREATE..NAMECHANGE range would also deliver
+    // REORDER, FOCUS, SELECTION* and STATECHANGE, which fire constantly and are all dropped.
+    // Hooks can't filter by object, so LOCATIONCHANGE for carets and cursors still arrives
+    // and is rejected first thing in WinEventProc.
+    DWORD flags = WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS;
+    m_lifetimeHook = SetWinEventHook(EVENT_OBJECT_CREATE, EVENT_OBJECT_HIDE, NULL, WinEventProc, 0, 0, flags);
+    m_changeHook = SetWinEventHook(EVENT_OBJECT_LOCATIONCHANGE, EVENT_OBJECT_NAMECHANGE, NULL, WinEventProc,
+                                   0, 0, flags);
+
+    // Pick up windows that already exist
+    Rebuild();
+}
+
+void WindowTracker::Stop()
+{
+    if (m_lifetimeHook)
+    {
+        UnhookWinEvent(m_lifetimeHook);
+        m_lifetimeHook = NULL;
+    }
+    if (m_changeHook)
+    {
+        UnhookWinEvent(m_changeHook);
+        m_changeHook = NULL;
+    }
+    m_rects.Clear();
+    if (g_windowTracker == this)
+        g_windowTracker = nullptr;
+}
+
+void WindowTracker::Rebuild()
+{
+    m_rects.Clear();
+    if (!m_titles.empty())
+        EnumWindows(EnumWindowsProc, reinterpret_cast<LPARAM>(this));
+}
+
+BOOL CALLBACK WindowTracker::EnumWindowsProc(HWND hwnd, LPARAM lParam)
+{
+    reinterpret_cast<WindowTracker*>(lParam)->RefreshWindow(hwnd);
+    return TRUE;
+}
+
+void CALLBACK WindowTracker::WinEventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG idObject,
+                                          LONG idChild, DWORD idEventThread, DWORD dwmsEventTime)
+{
+    // Ignore carets, cursors and child objects - we only care about whole windows. This is
+    // what keeps the LOCATIONCHANGE stream from caret blinks and mouse moves cheap.
+    if (idObject != OBJID_WINDOW || idChild != CHILDID_SELF || !hwnd || !g_windowTracker)
+        return;
+
+    g_windowTracker->OnWindowEvent(event, hwnd);
+}
+
+void WindowTracker::OnWindowEvent(DWORD event, HWND hwnd)
+{
+    switch (event)
+    {
+    case EVENT_OBJECT_DESTROY:
+    case EVENT_OBJECT_HIDE:
+        m_rects.Remove(reinterpret_cast<uintptr_t>(hwnd));
+        break;
+
+    case EVENT_OBJECT_LOCATIONCHANGE:
+        // Cheap path for the most frequent event: only refresh windows we already track
+        if (m_rects.Has(reinterpret_cast<uintptr_t>(hwnd)))
+        {
+            RECT rect;
+            if (GetWindowRect(hwnd, &rect))
+                m_rects.Set(reinterpret_cast<uintptr_t>(hwnd), rect.left, rect.top, rect.right, rect.bottom);
+        }
+        break;
+
+    case EVENT_OBJECT_CREATE:
+    case EVENT_OBJECT_SHOW:
+    case EVENT_OBJECT_NAMECHANGE:
+        RefreshWindow(hwnd);
+        break;
+    }
+}
+
+// Add, refresh or drop a window depending on whether it's a visible companion window
+void WindowTracker::RefreshWindow(HWND hwnd)
+{
+    RECT rect;
+    if (IsWindowVisible(hwnd) && IsCompanionWindow(hwnd) && GetWindowRect(hwnd, &rect))
+        m_rects.Set(reinterpret_cast<uintptr_t>(hwnd), rect.left, rect.top, rect.right, rect.bottom);
+    else
+        m_rects.Remove(reinterpret_cast<uintptr_t>(hwnd));
+}
+
+bool WindowTracker::IsCompanionWindow(HWND hwnd) const
+{
+    // Only top-level windows
+    if (GetAncestor(hwnd, GA_ROOT) != hwnd)
+        return false;
+
+    wchar_t title[TRACKED_TITLE_LENGTH];
+    if (GetWindowTextW(hwnd, title, TRACKED_TITLE_LENGTH) == 0)
+        return false;
+
+    for (const auto& tracked : m_titles)
+    {
+        if (tracked == title)
+            return true;
+    }
+    return false;
+}
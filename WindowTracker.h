@@ -0,0 +1,49 @@
+#pragma once
+
+#include <windows.h>
+#include <string>
+#include <vector>
+#include "RectSet.h"
+
+#define MAX_TRACKED_TITLES 4
+#define TRACKED_TITLE_LENGTH 64
+
+// Companion apps whose windows shouldn't dismiss the overlay when clicked (stored in the settings file)
+struct WindowTrackingSettings {
+    char titles[MAX_TRACKED_TITLES][TRACKED_TITLE_LENGTH] = { "Flow.Launcher", "Flow Launcher" };
+};
+
+// Keeps the screen rectangles of companion app windows up to date from WinEvent
+// notifications (create/destroy/show/hide/move/rename) instead of polling with FindWindow.
+// Out-of-context WinEvents are delivered through our own message loop, so the rectangle
+// set is only ever touched on the UI thread and hit tests need no locking.
+class WindowTracker {
+public:
+    WindowTracker();
+    ~WindowTracker();
+
+    void SetSettings(const WindowTrackingSettings& settings);
+
+    // Start/stop listening. Only needed while the overlay is visible.
+    void Start();
+    void Stop();
+    bool IsRunning() const { return m_lifetimeHook != NULL; }
+
+    bool HitTest(int x, int y) const { return m_rects.Contains(x, y); }
+    size_t GetTrackedCount() const { return m_rects.GetRects().size(); }
+
+private:
+    void Rebuild();
+    void OnWindowEvent(DWORD event, HWND hwnd);
+    void RefreshWindow(HWND hwnd);
+    bool IsCompanionWindow(HWND hwnd) const;
+
+    static void CALLBACK WinEventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG idObject,
+                                      LONG idChild, DWORD idEventThread, DWORD dwmsEventTime);
+    static BOOL CALLBACK EnumWindowsProc(HWND hwnd, LPARAM lParam);
+
+    HWINEVENTHOOK m_lifetimeHook;    // CREATE..HIDE
+    HWINEVENTHOOK m_changeHook;      // LOCATIONCHANGE, NAMECHANGE
+    std::vector<std::wstring> m_titles;
+    RectSet m_rects;
+};
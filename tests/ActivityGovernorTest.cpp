@@ -0,0 +1,123 @@
+// Activity governor hide/show transitions: each subsystem moves to its own hidden state on
+// hide and back to Active on show, SetHiddenState applies at once while hidden and only on
+// the next hide while shown, resumeCount counts real resumes, and the state callback fires
+// only when a subsystem's state actually changes
+
+#include "TestSupport.h"
+#include "ActivityGovernor.h"
+#include <vector>
+
+// Records every state a subsystem's callback was given
+struct Recorder {
+    std::vector<ActivityState> states;
+    ActivityGovernor::StateCallback Callback()
+    {
+        return [this](ActivityState state) { states.push_back(state); };
+    }
+};
+
+static void TestHideShow()
+{
+    ActivityGovernor governor;
+    Recorder capture;
+    Recorder counters;
+    Recorder tracker;
+    int captureIndex = governor.Register("Visualizer capture", ActivityState::Suspended, capture.Callback());
+    int countersIndex = governor.Register("Performance counters", ActivityState::Downshifted, counters.Callback());
+    int trackerIndex = governor.Register("Window tracking", ActivityState::Active, tracker.Callback());
+
+    // Subsystems start out Active, and registering calls nothing
+    CHECK(governor.GetState(captureIndex) == ActivityState::Active);
+    CHECK(capture.states.empty() && counters.states.empty() && tracker.states.empty());
+    CHECK(!governor.IsOverlayVisible());
+
+    governor.OnOverlayHidden();
+    CHECK(!governor.IsOverlayVisible());
+    CHECK(governor.GetState(captureIndex) == ActivityState::Suspended);
+    CHECK(governor.GetState(countersIndex) == ActivityState::Downshifted);
+    CHECK(governor.GetState(trackerIndex) == ActivityState::Active);
+    CHECK(capture.states.size() == 1 && capture.states[0] == ActivityState::Suspended);
+    CHECK(counters.states.size() == 1 && counters.states[0] == ActivityState::Downshifted);
+    CHECK(tracker.states.empty());
+
+    governor.OnOverlayShown();
+    CHECK(governor.IsOverlayVisible());
+    CHECK(governor.GetState(captureIndex) == ActivityState::Active);
+    CHECK(governor.GetState(countersIndex) == ActivityState::Active);
+    CHECK(capture.states.size() == 2 && capture.states[1] == ActivityState::Active);
+    CHECK(counters.states.size() == 2 && counters.states[1] == ActivityState::Active);
+    CHECK(tracker.states.empty());
+
+    // Repeating a transition changes nothing and calls nothing
+    governor.OnOverlayShown();
+    CHECK(capture.states.size() == 2 && counters.states.size() == 2);
+    governor.OnOverlayHidden();
+    governor.OnOverlayHidden();
+    CHECK(capture.states.size() == 3 && counters.states.size() == 3);
+    CHECK(capture.states[2] == ActivityState::Suspended);
+}
+
+static void TestSetHiddenState()
+{
+    ActivityGovernor governor;
+    Recorder counters;
+    int index = governor.Register("Performance counters", ActivityState::Suspended, counters.Callback());
+
+    // While shown, the new hidden state waits for the next hide
+    governor.OnOverlayShown();
+    governor.SetHiddenState(index, ActivityState::Downshifted);
+    CHECK(governor.GetState(index) == ActivityState::Active);
+    CHECK(counters.states.empty());
+    governor.OnOverlayHidden();
+    CHECK(governor.GetState(index) == ActivityState::Downshifted);
+    CHECK(counters.states.size() == 1);
+
+    // While hidden it applies at once (an alert starts needing the counters, then stops)
+    governor.SetHiddenState(index, ActivityState::Suspended);
+    CHECK(governor.GetState(index) == ActivityState::Suspended);
+    CHECK(counters.states.size() == 2 && counters.states[1] == ActivityState::Suspended);
+    governor.SetHiddenState(index, ActivityState::Downshifted);
+    CHECK(governor.GetState(index) == ActivityState::Downshifted);
+    CHECK(governor.GetSubsystems()[index].hiddenState == ActivityState::Downshifted);
+
+    // Setting the state it's already in calls nothing
+    governor.SetHiddenState(index, ActivityState::Downshifted);
+    CHECK(counters.states.size() == 3);
+
+    // Hidden state Active keeps it running while hidden
+    governor.SetHiddenState(index, ActivityState::Active);
+    CHECK(governor.GetState(index) == ActivityState::Active);
+    CHECK(counters.states.size() == 4);
+}
+
+static void TestResumeCount()
+{
+    ActivityGovernor governor;
+    int capture = governor.Register("Visualizer capture", ActivityState::Suspended, nullptr);
+    int tracker = governor.Register("Window tracking", ActivityState::Active, nullptr);
+
+    // Showing something that never stopped isn't a resume
+    governor.OnOverlayShown();
+    CHECK(governor.GetSubsystems()[capture].resumeCount == 0);
+
+    for (int i = 0; i < 3; i++) {
+        governor.OnOverlayHidden();
+        governor.OnOverlayShown();
+    }
+    governor.OnOverlayShown();
+    CHECK(governor.GetSubsystems()[capture].resumeCount == 3);
+    CHECK(governor.GetSubsystems()[tracker].resumeCount == 0);
+
+    // A subsystem without a callback still changes state
+    governor.OnOverlayHidden();
+    CHECK(governor.GetState(capture) == ActivityState::Suspended);
+    CHECK(governor.GetState(tracker) == ActivityState::Active);
+}
+
+int main()
+{
+    TestHideShow();
+    TestSetHiddenState();
+    TestResumeCount();
+    return TestResult("ActivityGovernorTest");
+}
@@ -0,0 +1,197 @@
+// Adaptive sampler: the global budget holds even when it stretches intervals past their
+// maximum, raising and lowering a minimum leaves the configured maximum intact, and the
+// sample count against reconstruction error for a replayed signal compared with fixed-rate
+// sampling at the same count
+
+#include "TestSupport.h"
+#include "AdaptiveSampler.h"
+#include <vector>
+
+static const uint64_t TICK_MS = 10;
+
+// Load-like signal: long idle stretches at a steady level with bursts of activity
+// (a step, a ramp and an oscillation) in between
+static double Signal(uint64_t ms)
+{
+    double t = ms * 0.001;
+    if (t < 30.0)
+        return 5.0;
+    if (t < 45.0)
+        return 60.0;
+    if (t < 90.0)
+        return 5.0;
+    if (t < 100.0)
+        return 5.0 + (t - 90.0) * 6.0;
+    if (t < 150.0)
+        return 65.0;
+    if (t < 165.0)
+        return 40.0 + 25.0 * std::sin(t * 1.5);
+    return 5.0;
+}
+
+struct Replay {
+    uint64_t samples = 0;
+    double meanError = 0.0;    // Mean absolute error of a sample-and-hold reconstruction
+};
+
+// Drive one metric from the signal on a 10 ms tick and hold the last sample in between
+static Replay ReplayAdaptive(const AdaptiveSamplingConfig& config, double budget, uint64_t durationMs)
+{
+    AdaptiveSampler sampler(1);
+    sampler.Configure(0, config);
+    sampler.SetActive(0, true);
+    sampler.SetBudget(budget);
+
+    Replay replay;
+    double held = 0.0;
+    double errorSum = 0.0;
+    uint64_t ticks = 0;
+    for (uint64_t now = 0; now < durationMs; now += TICK_MS) {
+        double value = Signal(now);
+        if (sampler.IsDue(0, now)) {
+            sampler.OnSample(0, value, now);
+            held = value;
+        }
+        errorSum += std::fabs(value - held);
+        ticks++;
+    }
+    replay.samples = sampler.GetSampleCount(0);
+    replay.meanError = errorSum / ticks;
+    return replay;
+}
+
+static Replay ReplayFixed(uint64_t intervalMs, uint64_t durationMs)
+{
+    Replay replay;
+    double held = 0.0;
+    double errorSum = 0.0;
+    uint64_t ticks = 0;
+    for (uint64_t now = 0; now < durationMs; now += TICK_MS) {
+        double value = Signal(now);
+        if (now % intervalMs == 0) {
+            held = value;
+            replay.samples++;
+        }
+        errorSum += std::fabs(value - held);
+        ticks++;
+    }
+    replay.meanError = errorSum / ticks;
+    return replay;
+}
+
+static void TestBudgetBeyondMaximum()
+{
+    // Four flat metrics back off to 1 s each (4 samples/s); a budget of 1 sample/s has to
+    // stretch them to 4 s, past their maximum
+    AdaptiveSamplingConfig config;
+    config.minIntervalMs = 250;
+    config.maxIntervalMs = 1000;
+
+    AdaptiveSampler sampler(4);
+    for (int metric = 0; metric < 4; metric++) {
+        sampler.Configure(metric, config);
+        sampler.SetActive(metric, true);
+    }
+    sampler.SetBudget(1.0);
+
+    uint64_t durationMs = 200000;
+    for (uint64_t now = 0; now < durationMs; now += TICK_MS) {
+        for (int metric = 0; metric < 4; metric++) {
+            if (sampler.IsDue(metric, now))
+                sampler.OnSample(metric, 1.0, now);
+        }
+    }
+
+    uint64_t total = 0;
+    for (int metric = 0; metric < 4; metric++) {
+        CHECK(sampler.GetInterval(metric) == 4000);
+        total += sampler.GetSampleCount(metric);
+    }
+    double rate = total / (durationMs * 0.001);
+    CHECK(rate <= 1.0 + 0.1);
+    CHECK(rate >= 0.9);
+
+    // Without a budget they settle at their own maximum again
+    sampler.SetBudget(0.0);
+    for (int metric = 0; metric < 4; metric++)
+        CHECK(sampler.GetInterval(metric) == 1000);
+}
+
+static void TestMinimumOverride()
+{
+    AdaptiveSamplingConfig config;
+    config.minIntervalMs = 250;
+    config.maxIntervalMs = 2000;
+    AdaptiveSampler sampler(1);
+    sampler.Configure(0, config);
+    sampler.SetActive(0, true);
+
+    // A subscriber asking for 5 s raises the floor above the configured maximum
+    sampler.SetMinInterval(0, 5000);
+    CHECK(sampler.GetInterval(0) == 5000);
+    sampler.OnSample(0, 1.0, 0);
+    sampler.OnSample(0, 1.0, 5000);
+    CHECK(sampler.GetInterval(0) == 5000);
+
+    // Once it goes back to 250 ms, a flat metric backs off to the original 2 s, not 5 s
+    sampler.SetMinInterval(0, 250);
+    CHECK(sampler.GetInterval(0) == 2000);
+    uint64_t now = 5000;
+    for (int i = 0; i < 10; i++) {
+        now += sampler.GetInterval(0);
+        sampler.OnSample(0, 1.0, now);
+    }
+    CHECK(sampler.GetInterval(0) == 2000);
+
+    // And a moving one snaps back to the lowered minimum
+    sampler.OnSample(0, 50.0, now + 2000);
+    CHECK(sampler.GetInterval(0) == 250);
+}
+
+static void TestSamplesAgainstError()
+{
+    AdaptiveSamplingConfig config;
+    config.minIntervalMs = 250;
+    config.maxIntervalMs = 2000;
+    config.changeThreshold = 1.0;
+    uint64_t durationMs = 200000;
+
+    Replay full = ReplayFixed(config.minIntervalMs, durationMs);
+    Replay adaptive = ReplayAdaptive(config, 0.0, durationMs);
+    Replay sameCount = ReplayFixed(durationMs / adaptive.samples / TICK_MS * TICK_MS, durationMs);
+    printf("full rate:   %5llu samples, mean error %.3f\n", (unsigned long long)full.samples, full.meanError);
+    printf("adaptive:    %5llu samples, mean error %.3f\n", (unsigned long long)adaptive.samples, adaptive.meanError);
+    printf("fixed, same: %5llu samples, mean error %.3f\n", (unsigned long long)sameCount.samples, sameCount.meanError);
+
+    // Under a quarter of the samples of the full rate, and less error than a fixed interval
+    // spending the same number (what remains is mostly the delay in noticing a step after
+    // backing off)
+    CHECK(adaptive.samples * 4 < full.samples);
+    CHECK(adaptive.meanError < sameCount.meanError);
+    CHECK(adaptive.meanError < full.meanError * 6.0);
+
+    // A tighter budget never spends more than it allows, and as it tightens the sample
+    // count falls and the error grows. Where a step lands against the sampling phase makes
+    // a budget that barely binds a toss-up against none, so the trend starts at 2/s.
+    uint64_t previousSamples = adaptive.samples;
+    double previousError = 0.0;
+    const double budgets[] = { 2.0, 1.0, 0.5, 0.25 };
+    for (double budget : budgets) {
+        Replay limited = ReplayAdaptive(config, budget, durationMs);
+        printf("budget %.2f: %5llu samples, mean error %.3f\n", budget, (unsigned long long)limited.samples,
+               limited.meanError);
+        CHECK(limited.samples <= budget * durationMs * 0.001 * 1.05);
+        CHECK(limited.samples <= previousSamples);
+        CHECK(limited.meanError >= previousError);
+        previousSamples = limited.samples;
+        previousError = limited.meanError;
+    }
+}
+
+int main()
+{
+    TestBudgetBeyondMaximum();
+    TestMinimumOverride();
+    TestSamplesAgainstError();
+    return TestResult("AdaptiveSamplerTest");
+}
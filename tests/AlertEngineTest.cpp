@@ -0,0 +1,303 @@
+// Alert engine against replayed series: hold times, hysteresis and cooldowns on the
+// default rules with exact firing times, rules over signals that aren't known yet, and
+// long random replays checked event-for-event against a plain evaluator that looks at
+// every rule on every tick (so skipping unchanged rules never changes an outcome).
+// Also reports the cost of a 500-rule tick.
+
+#include "TestSupport.h"
+#include "AlertEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#define REPLAY_TICKS 20000
+#define REPLAY_RULES 64
+#define BENCHMARK_RULES 500
+#define BENCHMARK_BUDGET_NS 50000.0
+
+struct Sample {
+    uint64_t timeMs;
+    int signal;
+    float value;
+};
+
+// Feed the series in order, evaluating after every timestamp; returns the events
+static std::vector<AlertEvent> Replay(AlertEngine& engine, const std::vector<Sample>& series)
+{
+    std::vector<AlertEvent> events;
+    for (size_t i = 0; i < series.size(); i++) {
+        engine.SetSignal(series[i].signal, series[i].value);
+        if (i + 1 == series.size() || series[i + 1].timeMs != series[i].timeMs)
+            engine.Evaluate(series[i].timeMs, events);
+    }
+    return events;
+}
+
+// One sample of the same value per second for the given number of seconds, from timeMs on
+static void AppendSeconds(std::vector<Sample>& series, uint64_t& timeMs, int signal, float value, int seconds)
+{
+    for (int i = 0; i < seconds; i++) {
+        series.push_back(Sample{ timeMs, signal, value });
+        timeMs += 1000;
+    }
+}
+
+static void TestCpuHoldHysteresisCooldown()
+{
+    AlertSettings settings;
+    AlertEngine engine;
+    engine.Compile(settings.rules, MAX_ALERT_RULES);
+    CHECK(engine.GetRuleCount() == 3);    // The download rule is disabled by default
+    CHECK(engine.GetSignalMask() == ((1u << ALERT_SIGNAL_CPU_USAGE) | (1u << ALERT_SIGNAL_CPU_TEMPERATURE) |
+                                     (1u << ALERT_SIGNAL_BATTERY_PERCENT) | (1u << ALERT_SIGNAL_BATTERY_CHARGING)));
+
+    std::vector<Sample> series;
+    uint64_t t = 0;
+    AppendSeconds(series, t, ALERT_SIGNAL_CPU_USAGE, 95.0f, 25);    // Not long enough
+    AppendSeconds(series, t, ALERT_SIGNAL_CPU_USAGE, 85.0f, 1);     // Resets the hold
+    uint64_t holdStart = t;
+    AppendSeconds(series, t, ALERT_SIGNAL_CPU_USAGE, 95.0f, 40);    // Fires 30 s in
+    AppendSeconds(series, t, ALERT_SIGNAL_CPU_USAGE, 82.0f, 20);    // Within hysteresis: keeps firing
+    uint64_t clearAt = t;
+    AppendSeconds(series, t, ALERT_SIGNAL_CPU_USAGE, 70.0f, 10);    // Clears
+    AppendSeconds(series, t, ALERT_SIGNAL_CPU_USAGE, 99.0f, 60);    // Holds, but inside the cooldown
+    uint64_t cooldownEnd = holdStart + 30000 + 300000;
+    while (t < cooldownEnd + 5000)
+        AppendSeconds(series, t, ALERT_SIGNAL_CPU_USAGE, t % 2000 ? 97.0f : 98.0f, 1);
+
+    std::vector<AlertEvent> events = Replay(engine, series);
+    CHECK(events.size() == 3);
+    if (events.size() == 3) {
+        CHECK(events[0].rule == 0 && events[0].fired && events[0].timeMs == holdStart + 30000);
+        CHECK(events[1].rule == 0 && !events[1].fired && events[1].timeMs == clearAt);
+        CHECK(events[2].rule == 0 && events[2].fired && events[2].timeMs == cooldownEnd);
+    }
+    CHECK(engine.IsFiring(0));
+}
+
+static void TestMultiSignalAndUnknownValues()
+{
+    AlertSettings settings;
+    AlertEngine engine;
+    engine.Compile(settings.rules, MAX_ALERT_RULES);
+    std::vector<AlertEvent> events;
+
+    // A rule never holds while one of its signals has no value
+    engine.SetSignal(ALERT_SIGNAL_BATTERY_PERCENT, 10.0f);
+    engine.Evaluate(1000, events);
+    CHECK(events.empty());
+
+    engine.SetSignal(ALERT_SIGNAL_BATTERY_CHARGING, 0.0f);
+    engine.Evaluate(2000, events);
+    CHECK(events.size() == 1 && events[0].rule == 2 && events[0].fired);
+
+    // Plugging in clears it at once (no hysteresis on the charging flag)
+    engine.SetSignal(ALERT_SIGNAL_BATTERY_CHARGING, 1.0f);
+    engine.Evaluate(3000, events);
+    CHECK(events.size() == 2 && !events[1].fired && events[1].timeMs == 3000);
+
+    // Losing a value clears a firing rule too
+    engine.SetSignal(ALERT_SIGNAL_CPU_TEMPERATURE, 90.0f);
+    engine.Evaluate(4000, events);
+    engine.Evaluate(9000, events);
+    CHECK(engine.IsFiring(1));
+    engine.ClearSignal(ALERT_SIGNAL_CPU_TEMPERATURE);
+    engine.Evaluate(10000, events);
+    CHECK(!engine.IsFiring(1));
+    CHECK(events.size() == 4 && events[2].rule == 1 && events[2].fired && events[2].timeMs == 9000 &&
+          events[3].rule == 1 && !events[3].fired);
+
+    // Recompiling resets state but keeps the known values
+    engine.SetSignal(ALERT_SIGNAL_BATTERY_CHARGING, 0.0f);
+    engine.Compile(settings.rules, MAX_ALERT_RULES);
+    events.clear();
+    engine.Evaluate(11000, events);
+    CHECK(events.size() == 1 && events[0].rule == 2 && events[0].fired);
+}
+
+// Straightforward evaluator with the same semantics, looking at every rule on every tick
+class ReferenceEngine {
+public:
+    ReferenceEngine(const std::vector<AlertRule>& rules) : m_rules(rules), m_state(rules.size()) {}
+
+    void SetSignal(int signal, float value) { m_values[signal] = value; m_known[signal] = true; }
+
+    void Evaluate(uint64_t nowMs, std::vector<AlertEvent>& events)
+    {
+        for (size_t i = 0; i < m_rules.size(); i++) {
+            const AlertRule& rule = m_rules[i];
+            State& state = m_state[i];
+            int used = 0;
+            bool holds = true;
+            for (const AlertCondition& condition : rule.conditions) {
+                if (!condition.used || condition.signal >= ALERT_SIGNAL_COUNT)
+                    continue;
+                used++;
+                float threshold = condition.threshold;
+                if (state.firing)
+                    threshold += condition.comparison == ALERT_ABOVE ? -condition.hysteresis : condition.hysteresis;
+                float value = m_values[condition.signal];
+                holds = holds && m_known[condition.signal] &&
+                        (condition.comparison == ALERT_ABOVE ? value > threshold : value < threshold);
+            }
+            if (!rule.enabled || used == 0)
+                continue;
+
+            if (!holds) {
+                state.holding = false;
+                if (state.firing) {
+                    state.firing = false;
+                    events.push_back(AlertEvent{ static_cast<int>(i), false, nowMs });
+                }
+                continue;
+            }
+            if (!state.holding) {
+                state.holding = true;
+                state.since = nowMs;
+            }
+            if (!state.firing && nowMs - state.since >= rule.holdMs &&
+                (!state.hasFired || nowMs - state.lastFired >= rule.cooldownMs)) {
+                state.firing = true;
+                state.hasFired = true;
+                state.lastFired = nowMs;
+                events.push_back(AlertEvent{ static_cast<int>(i), true, nowMs });
+            }
+        }
+    }
+
+private:
+    struct State {
+        bool holding = false;
+        bool firing = false;
+        bool hasFired = false;
+        uint64_t since = 0;
+        uint64_t lastFired = 0;
+    };
+
+    std::vector<AlertRule> m_rules;
+    std::vector<State> m_state;
+    float m_values[ALERT_SIGNAL_COUNT] = {};
+    bool m_known[ALERT_SIGNAL_COUNT] = {};
+};
+
+static uint32_t NextRandom(uint32_t& state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+static std::vector<AlertRule> MakeRandomRules(uint32_t& random, int count)
+{
+    std::vector<AlertRule> rules(count);
+    for (int i = 0; i < count; i++) {
+        AlertRule& rule = rules[i];
+        memset(&rule, 0, sizeof(rule));
+        snprintf(rule.name, sizeof(rule.name), "rule %d", i);
+        rule.enabled = NextRandom(random) % 8 != 0;
+        for (AlertCondition& condition : rule.conditions) {
+            condition.used = NextRandom(random) % 3 != 0;
+            condition.signal = static_cast<uint8_t>(NextRandom(random) % ALERT_SIGNAL_COUNT);
+            condition.comparison = NextRandom(random) % 2 ? ALERT_ABOVE : ALERT_BELOW;
+            condition.threshold = static_cast<float>(NextRandom(random) % 100);
+            condition.hysteresis = static_cast<float>(NextRandom(random) % 15);
+        }
+        rule.holdMs = (NextRandom(random) % 4) * 2000;
+        rule.cooldownMs = (NextRandom(random) % 4) * 10000;
+    }
+    return rules;
+}
+
+// Random walks with pauses (unchanged values), jumps and signals dropping out
+static void TestRandomReplays()
+{
+    int mismatches = 0;
+    size_t totalEvents = 0;
+    for (uint32_t seed = 1; seed <= 5; seed++) {
+        uint32_t random = seed * 7919;
+        std::vector<AlertRule> rules = MakeRandomRules(random, REPLAY_RULES);
+        AlertEngine engine;
+        engine.Compile(rules.data(), static_cast<int>(rules.size()));
+        ReferenceEngine reference(rules);
+
+        float values[ALERT_SIGNAL_COUNT];
+        for (float& value : values)
+            value = static_cast<float>(NextRandom(random) % 100);
+
+        std::vector<AlertEvent> events;
+        std::vector<AlertEvent> expected;
+        uint64_t t = 0;
+        for (int tick = 0; tick < REPLAY_TICKS; tick++) {
+            t += 100 + NextRandom(random) % 1400;
+            for (int signal = 0; signal < ALERT_SIGNAL_COUNT; signal++) {
+                uint32_t roll = NextRandom(random) % 10;
+                if (roll < 5)
+                    continue;    // Unchanged this tick
+                if (roll == 9)
+                    values[signal] = static_cast<float>(NextRandom(random) % 100);
+                else
+                    values[signal] = (std::min)(100.0f, (std::max)(0.0f, values[signal] + static_cast<float>(NextRandom(random) % 9) - 4.0f));
+                engine.SetSignal(signal, values[signal]);
+                reference.SetSignal(signal, values[signal]);
+            }
+            engine.Evaluate(t, events);
+            reference.Evaluate(t, expected);
+        }
+
+        totalEvents += events.size();
+        if (events.size() != expected.size()) {
+            mismatches++;
+            continue;
+        }
+        for (size_t i = 0; i < events.size(); i++) {
+            if (events[i].rule != expected[i].rule || events[i].fired != expected[i].fired ||
+                events[i].timeMs != expected[i].timeMs)
+                mismatches++;
+        }
+        for (int rule = 0; rule < REPLAY_RULES; rule++) {
+            bool firing = false;
+            for (const AlertEvent& event : expected) {
+                if (event.rule == rule)
+                    firing = event.fired;
+            }
+            if (engine.IsFiring(rule) != firing)
+                mismatches++;
+        }
+    }
+    printf("5 replays of %d ticks over %d rules: %zu events, %d mismatches\n", REPLAY_TICKS, REPLAY_RULES, totalEvents, mismatches);
+    CHECK(totalEvents > 1000);
+    CHECK(mismatches == 0);
+}
+
+static void TestTickCost()
+{
+    uint32_t random = 4242;
+    std::vector<AlertRule> rules = MakeRandomRules(random, BENCHMARK_RULES);
+    AlertEngine engine;
+    engine.Compile(rules.data(), static_cast<int>(rules.size()));
+
+    // Every signal changes every tick, so no rule is skipped
+    std::vector<AlertEvent> events;
+    std::vector<double> ticks;
+    for (int tick = 0; tick < 2000; tick++) {
+        for (int signal = 0; signal < ALERT_SIGNAL_COUNT; signal++)
+            engine.SetSignal(signal, static_cast<float>((tick * 7 + signal * 13) % 100));
+        events.clear();
+        auto begin = std::chrono::steady_clock::now();
+        engine.Evaluate(static_cast<uint64_t>(tick) * 1000, events);
+        ticks.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count());
+    }
+    std::sort(ticks.begin(), ticks.end());
+    double median = ticks[ticks.size() / 2];
+    printf("%zu compiled rules, all signals changing: %.2f us per tick (median)\n", engine.GetRuleCount(), median / 1000.0);
+    CHECK(median < BENCHMARK_BUDGET_NS);
+}
+
+int main()
+{
+    TestCpuHoldHysteresisCooldown();
+    TestMultiSignalAndUnknownValues();
+    TestRandomReplays();
+    TestTickCost();
+    return TestResult("AlertEngineTest");
+}
@@ -0,0 +1,131 @@
+// Background collector: requests never queue a job twice, results are handed over exactly
+// once, a slow job never blocks the owner's Request/TakeResult, jobs and thread hooks run on
+// the worker thread, and Stop waits for the job in progress
+
+#include "TestSupport.h"
+#include "BackgroundCollector.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+static bool WaitForResult(BackgroundCollector& collector, int job, int timeoutMs = 2000)
+{
+    for (int waited = 0; waited < timeoutMs; waited++) {
+        if (collector.TakeResult(job))
+            return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+static void TestHandOff()
+{
+    BackgroundCollector collector;
+    std::thread::id owner = std::this_thread::get_id();
+    std::thread::id worker;
+    std::thread::id hookThread;
+    int starts = 0;
+    int stops = 0;
+    int runs = 0;
+    int sample = 0;
+
+    int job = collector.Add([&]() {
+        worker = std::this_thread::get_id();
+        runs++;
+        sample = runs * 10;
+    });
+    collector.SetThreadHooks([&]() { starts++; hookThread = std::this_thread::get_id(); }, [&]() { stops++; });
+
+    // Nothing runs before Start
+    CHECK(!collector.Request(job));
+    CHECK(collector.Start());
+
+    CHECK(collector.Request(job));
+    CHECK(WaitForResult(collector, job));
+    CHECK(runs == 1 && sample == 10);
+    CHECK(worker != owner);
+    CHECK(hookThread == worker);
+
+    // Taken once only
+    CHECK(!collector.TakeResult(job));
+
+    // Repeated requests while a result is outstanding don't pile up
+    CHECK(collector.Request(job));
+    for (int i = 0; i < 100; i++)
+        collector.Request(job);
+    CHECK(WaitForResult(collector, job));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(!collector.TakeResult(job));
+    CHECK(runs == 2 && sample == 20);
+
+    collector.Stop();
+    CHECK(starts == 1 && stops == 1);
+    CHECK(!collector.IsRunning());
+}
+
+static void TestSlowJob()
+{
+    BackgroundCollector collector;
+    std::atomic<bool> release{ false };
+    std::atomic<int> fastRuns{ 0 };
+    int slow = collector.Add([&]() {
+        while (!release.load())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+    int fast = collector.Add([&]() { fastRuns++; });
+    collector.Start();
+
+    // The owner's side stays non-blocking while the slow job holds the worker
+    CHECK(collector.Request(slow));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    auto begin = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < 1000; frame++) {
+        collector.Request(slow);
+        collector.Request(fast);
+        collector.TakeResult(slow);
+        collector.TakeResult(fast);
+    }
+    double frameUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count() / 1000;
+    printf("owner side with the worker busy: %.3f us per frame\n", frameUs);
+    CHECK(frameUs < 100.0);
+    CHECK(collector.IsBusy(slow));
+    CHECK(collector.IsBusy(fast));
+    CHECK(fastRuns == 0);
+
+    // Once released, the queued fast job runs once
+    release = true;
+    CHECK(WaitForResult(collector, slow));
+    CHECK(WaitForResult(collector, fast));
+    CHECK(fastRuns == 1);
+    CHECK(collector.GetLastDurationNs(slow) >= 20000000ull);
+    collector.Stop();
+}
+
+static void TestStopWaits()
+{
+    BackgroundCollector collector;
+    std::atomic<bool> finished{ false };
+    int job = collector.Add([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        finished = true;
+    });
+    collector.Start();
+    collector.Request(job);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    collector.Stop();
+    CHECK(finished);
+
+    // Restarting forgets whatever was outstanding
+    CHECK(collector.Start());
+    CHECK(collector.Request(job));
+    CHECK(WaitForResult(collector, job));
+    collector.Stop();
+}
+
+int main()
+{
+    TestHandOff();
+    TestSlowJob();
+    TestStopWaits();
+    return TestResult("BackgroundCollectorTest");
+}
@@ -0,0 +1,120 @@
+// Chart decimation on a 24 h / 1 Hz history at 300 px, in both modes: the per-frame cost
+// with a new sample every frame (the worst case; at 1 Hz most frames have none) and with
+// nothing new, against a 50 us budget on the best of a few rounds' medians. Also checks
+// that the incrementally maintained min/max points match a fresh rebuild, and that every
+// frame's point set is ordered, taken from the ring and bounded by the pixel width.
+
+#include "TestSupport.h"
+#include "ChartDecimation.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#define HISTORY_SECONDS 86400
+#define CHART_WIDTH 300
+#define BENCHMARK_ROUNDS 5
+#define BENCHMARK_FRAMES 2000
+#define BENCHMARK_BUDGET_NS 50000.0
+
+static float NextValue(uint32_t& state, float& value)
+{
+    state = state * 1664525u + 1013904223u;
+    value += static_cast<float>(static_cast<int>(state >> 24) - 128) / 64.0f;
+    value = (std::min)((std::max)(value, 0.0f), 100.0f);
+    return (state & 0x3FF) == 0 ? 100.0f : value;
+}
+
+static bool SamePoints(const std::vector<ChartPoint>& a, const std::vector<ChartPoint>& b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].index != b[i].index || a[i].value != b[i].value)
+            return false;
+    }
+    return true;
+}
+
+// At most one point (LTTB) or two (min/max) per pixel column plus the partial buckets at
+// either end, in time order and inside the ring; LTTB keeps both end samples
+static bool WithinChart(const std::vector<ChartPoint>& points, const HistoryRing& ring, DecimationMode mode)
+{
+    size_t perColumn = mode == DECIMATE_LTTB ? 1 : 2;
+    if (points.empty() || points.size() > perColumn * (CHART_WIDTH + 2))
+        return false;
+    for (size_t i = 0; i < points.size(); i++) {
+        if (points[i].index < ring.Begin() || points[i].index >= ring.End() || points[i].value != ring.At(points[i].index))
+            return false;
+        if (i > 0 && points[i].index <= points[i - 1].index)
+            return false;
+    }
+    return mode != DECIMATE_LTTB || (points.front().index == ring.Begin() && points.back().index == ring.End() - 1);
+}
+
+static double Median(std::vector<double>& frames)
+{
+    std::sort(frames.begin(), frames.end());
+    return frames[frames.size() / 2];
+}
+
+static void Run(DecimationMode mode, const char* name)
+{
+    uint32_t state = 99;
+    float value = 40.0f;
+    HistoryRing ring(HISTORY_SECONDS);
+    for (int i = 0; i < HISTORY_SECONDS; i++)
+        ring.Push(NextValue(state, value));
+
+    ChartDecimator decimator(mode);
+    decimator.SetWidth(CHART_WIDTH);
+    auto begin = std::chrono::steady_clock::now();
+    decimator.Update(ring);
+    double rebuildUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+
+    double bestNewSample = 1e30;
+    double bestUnchanged = 1e30;
+    bool matchesRebuild = true;
+    bool bounded = true;
+    for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+        std::vector<double> newSample;
+        std::vector<double> unchanged;
+        for (int frame = 0; frame < BENCHMARK_FRAMES; frame++) {
+            ring.Push(NextValue(state, value));
+            begin = std::chrono::steady_clock::now();
+            const std::vector<ChartPoint>& points = decimator.Update(ring);
+            newSample.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count());
+
+            begin = std::chrono::steady_clock::now();
+            decimator.Update(ring);
+            unchanged.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count());
+
+            if (!WithinChart(points, ring, mode))
+                bounded = false;
+
+            // Spot-check the cache against starting over (exact for min/max; LTTB's knock-on
+            // effect along the chain is only settled by a rebuild, by design)
+            if (mode == DECIMATE_MINMAX && frame % 250 == 0) {
+                ChartDecimator fresh(mode);
+                fresh.SetWidth(CHART_WIDTH);
+                if (!SamePoints(points, fresh.Update(ring)))
+                    matchesRebuild = false;
+            }
+        }
+        bestNewSample = (std::min)(bestNewSample, Median(newSample));
+        bestUnchanged = (std::min)(bestUnchanged, Median(unchanged));
+    }
+
+    printf("%-6s %d samples -> %zu points: rebuild %.0f us, new sample %.2f us, unchanged %.3f us per frame\n",
+           name, HISTORY_SECONDS, decimator.GetPoints().size(), rebuildUs, bestNewSample / 1000.0, bestUnchanged / 1000.0);
+    CHECK(bounded);
+    CHECK(matchesRebuild);
+    CHECK(bestNewSample < BENCHMARK_BUDGET_NS);
+    CHECK(bestUnchanged < BENCHMARK_BUDGET_NS);
+}
+
+int main()
+{
+    Run(DECIMATE_MINMAX, "minmax");
+    Run(DECIMATE_LTTB, "lttb");
+    return TestResult("ChartDecimationBenchmark");
+}
@@ -0,0 +1,123 @@
+// Connection monitor tick cost on a synthetic 50,000-connection table with 2% churn per
+// tick, including the backend handing over the table. The 1 ms budget holds for a table in
+// stable order, which is what the backends return and what the in-step diff relies on. A
+// table that comes back reordered every tick (the worst case: every row hashed on both
+// sides) gets a looser 8 ms bound, about twice what it measures. Single ticks on a shared
+// machine are noisy, so both checks are on the best of a few rounds' medians.
+
+#include "TestSupport.h"
+#include "ConnectionMonitor.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#define BENCHMARK_CONNECTIONS 50000
+#define BENCHMARK_ROUNDS 5
+#define BENCHMARK_TICKS 100
+#define BENCHMARK_BUDGET_NS 1000000ull             // Stable table order
+#define BENCHMARK_REORDERED_BUDGET_NS 8000000ull   // Reordered every tick
+
+// Keeps a table in memory and replaces a slice of it with new connections on every snapshot.
+// With rotation on, the table also comes back shifted each time, so no row lines up with
+// the previous snapshot and every one goes through the fingerprint sets.
+class SyntheticConnectionBackend : public IConnectionBackend {
+public:
+    void SetRotating(bool rotating) { m_rotating = rotating; }
+
+    SyntheticConnectionBackend()
+    {
+        m_table.resize(BENCHMARK_CONNECTIONS);
+        for (size_t i = 0; i < m_table.size(); i++)
+            Fill(m_table[i]);
+    }
+
+    bool Snapshot(std::vector<ConnectionRecord>& records) override
+    {
+        for (size_t i = 0; i < BENCHMARK_CONNECTIONS / 50; i++)
+            Fill(m_table[(m_cursor + i) % m_table.size()]);
+        m_cursor = (m_cursor + BENCHMARK_CONNECTIONS / 50) % m_table.size();
+        if (m_rotating) {
+            m_rotation = (m_rotation + 7919) % m_table.size();
+            records.assign(m_table.begin() + m_rotation, m_table.end());
+            records.insert(records.end(), m_table.begin(), m_table.begin() + m_rotation);
+        } else {
+            records.assign(m_table.begin(), m_table.end());
+        }
+        return true;
+    }
+
+    bool GetProcessName(uint32_t pid, char* name, size_t length) override
+    {
+        snprintf(name, length, "process-%u", pid);
+        return true;
+    }
+
+private:
+    void Fill(ConnectionRecord& record)
+    {
+        uint32_t serial = m_serial++;
+        memset(&record, 0, sizeof(record));
+        bool v6 = serial % 4 == 0;
+        record.family = v6 ? 6 : 4;
+        record.protocol = serial % 10 == 0 ? CONNECTION_UDP : CONNECTION_TCP;
+        record.state = record.protocol == CONNECTION_TCP ? static_cast<uint8_t>(TCP_STATE_ESTABLISHED + serial % 7) : 0;
+        uint32_t local = 0x0A000000u | (serial & 0xFF);
+        uint32_t remote = 0xC0A80000u ^ (serial * 2654435761u);
+        memcpy(record.localAddress, &local, 4);
+        memcpy(record.remoteAddress + (v6 ? 12 : 0), &remote, 4);
+        record.localPort = static_cast<uint16_t>(1024 + serial % 60000);
+        record.remotePort = static_cast<uint16_t>(serial % 3 ? 443 : 80);
+        record.pid = 1000 + serial % 700;
+    }
+
+    std::vector<ConnectionRecord> m_table;
+    size_t m_cursor = 0;
+    size_t m_rotation = 0;
+    uint32_t m_serial = 1;
+    bool m_rotating = false;
+};
+
+// Median tick cost over BENCHMARK_TICKS ticks
+static uint64_t MeasureRound(ConnectionMonitor& monitor)
+{
+    std::vector<uint64_t> costs;
+    for (int i = 0; i < BENCHMARK_TICKS; i++) {
+        CHECK(monitor.Sample());
+        costs.push_back(monitor.GetLastSampleCostNs());
+    }
+    std::sort(costs.begin(), costs.end());
+    printf("%d connections: median %.3f ms, p90 %.3f ms, max %.3f ms per tick\n", BENCHMARK_CONNECTIONS,
+           costs[costs.size() / 2] * 1e-6, costs[costs.size() * 9 / 10] * 1e-6, costs.back() * 1e-6);
+    return costs[costs.size() / 2];
+}
+
+int main()
+{
+    auto owned = std::make_unique<SyntheticConnectionBackend>();
+    SyntheticConnectionBackend* backend = owned.get();
+    ConnectionMonitor monitor(std::move(owned));
+    monitor.SetTopCount(MAX_TOP_CONNECTION_PROCESSES);
+
+    // Warm up: the first ticks size the sets and the record buffer
+    for (int i = 0; i < 5; i++)
+        CHECK(monitor.Sample());
+
+    uint64_t best = ~0ull;
+    for (int round = 0; round < BENCHMARK_ROUNDS; round++)
+        best = std::min(best, MeasureRound(monitor));
+
+    CHECK(monitor.GetTcpCount() + monitor.GetUdpCount() == BENCHMARK_CONNECTIONS);
+    CHECK(monitor.GetOpenedPerSec() > 0.0 && monitor.GetClosedPerSec() > 0.0);
+    CHECK(monitor.GetTopProcesses().size() == MAX_TOP_CONNECTION_PROCESSES);
+    CHECK(best < BENCHMARK_BUDGET_NS);
+
+    // Worst case: nothing lines up, so every row is hashed on both sides
+    printf("reordered table:\n");
+    backend->SetRotating(true);
+    uint64_t bestReordered = ~0ull;
+    for (int round = 0; round < BENCHMARK_ROUNDS; round++)
+        bestReordered = std::min(bestReordered, MeasureRound(monitor));
+    CHECK(monitor.GetOpenedPerSec() > 0.0);
+    CHECK(bestReordered < BENCHMARK_REORDERED_BUDGET_NS);
+    return TestResult("ConnectionMonitorBenchmark");
+}
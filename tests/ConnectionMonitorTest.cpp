@@ -0,0 +1,211 @@
+// Connection monitor against the /proc/net backend: state counts, endpoint parsing,
+// opened/closed rates and per-process counts from a synthetic /proc, and a sanity pass
+// over the real /proc
+
+#include "TestSupport.h"
+#include "ConnectionMonitor.h"
+#include "ProcNetConnectionBackend.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <sys/stat.h>
+
+static const char* TABLE_HEADER =
+    "  sl  local_address rem_address   st tx_queue rx_queue tr tm->when retrnsmt   uid  timeout inode\n";
+
+static std::string Row(int slot, const char* local, const char* remote, int state, unsigned inode)
+{
+    char line[256];
+    snprintf(line, sizeof(line), "%4d: %s %s %02X 00000000:00000000 00:00000000 00000000  1000        0 %u 1 0000000000000000 20 4 30 10 -1\n",
+             slot, local, remote, state, inode);
+    return line;
+}
+
+static void WriteProcess(const std::string& root, uint32_t pid, const char* name, const unsigned* inodes, size_t count)
+{
+    std::string directory = root + "/" + std::to_string(pid);
+    mkdir(directory.c_str(), 0755);
+    mkdir((directory + "/fd").c_str(), 0755);
+    WriteTestFile(directory + "/comm", std::string(name) + "\n");
+    for (size_t i = 0; i < count; i++) {
+        std::string target = "socket:[" + std::to_string(inodes[i]) + "]";
+        std::string link = directory + "/fd/" + std::to_string(i + 3);
+        unlink(link.c_str());
+        CHECK(symlink(target.c_str(), link.c_str()) == 0);
+    }
+    std::string other = directory + "/fd/0";
+    unlink(other.c_str());
+    CHECK(symlink("/dev/null", other.c_str()) == 0);
+}
+
+static void TestSyntheticProc()
+{
+    std::string root = MakeTestDirectory("connection-monitor");
+    mkdir((root + "/net").c_str(), 0755);
+
+    // 127.0.0.1:631 listening, two established to 10.0.0.2:443, one in TIME_WAIT
+    WriteTestFile(root + "/net/tcp", std::string(TABLE_HEADER) +
+                  Row(0, "0100007F:0277", "00000000:0000", 0x0A, 1001) +
+                  Row(1, "0F00000A:C350", "0200000A:01BB", 0x01, 1002) +
+                  Row(2, "0F00000A:C351", "0200000A:01BB", 0x01, 1003) +
+                  Row(3, "0F00000A:C352", "0200000A:01BB", 0x06, 0));
+    // [::1]:8080 listening
+    WriteTestFile(root + "/net/tcp6", std::string(TABLE_HEADER) +
+                  Row(0, "00000000000000000000000001000000:1F90", "00000000000000000000000000000000:0000", 0x0A, 2001));
+    WriteTestFile(root + "/net/udp", std::string(TABLE_HEADER) +
+                  Row(0, "00000000:14E9", "00000000:0000", 0x07, 3001));
+    // udp6 is missing: the other tables still count
+
+    unsigned browser[] = { 1002, 1003, 3001 };
+    unsigned daemon[] = { 1001, 2001 };
+    WriteProcess(root, 300, "browser", browser, 3);
+    WriteProcess(root, 20, "cupsd", daemon, 2);
+
+    FakeClock clock(1000000000ull);
+    auto backend = std::make_unique<ProcNetConnectionBackend>(root);
+    std::vector<ConnectionRecord> records;
+    CHECK(backend->Snapshot(records));
+    CHECK(records.size() == 6);
+    if (records.size() == 6) {
+        const uint8_t loopback[4] = { 127, 0, 0, 1 };
+        CHECK(memcmp(records[0].localAddress, loopback, 4) == 0);
+        CHECK(records[0].localPort == 631);
+        CHECK(records[0].pid == 20);
+        CHECK(records[1].remotePort == 443 && records[1].pid == 300);
+        CHECK(records[3].pid == 0);    // TIME_WAIT sockets have no owner
+        CHECK(records[4].family == 6 && records[4].localAddress[15] == 1 && records[4].localPort == 8080);
+        CHECK(records[5].protocol == CONNECTION_UDP && records[5].state == TCP_STATE_UNKNOWN);
+    }
+
+    ConnectionMonitor monitor(std::move(backend), clock);
+    CHECK(monitor.Sample());
+    CHECK(monitor.GetTcpCount() == 5);
+    CHECK(monitor.GetUdpCount() == 1);
+    CHECK(monitor.GetStateCount(TCP_STATE_LISTEN) == 2);
+    CHECK(monitor.GetStateCount(TCP_STATE_ESTABLISHED) == 2);
+    CHECK(monitor.GetStateCount(TCP_STATE_TIME_WAIT) == 1);
+    CHECK(monitor.GetOpenedPerSec() == 0.0);    // The first sample is only a baseline
+
+    const std::vector<ConnectionMonitor::ProcessCount>& top = monitor.GetTopProcesses();
+    CHECK(top.size() == 3);
+    if (top.size() == 3) {
+        CHECK(top[0].pid == 300 && top[0].connections == 3 && strcmp(top[0].name, "browser") == 0);
+        CHECK(top[1].pid == 20 && top[1].connections == 2 && strcmp(top[1].name, "cupsd") == 0);
+        CHECK(top[2].pid == 0 && top[2].connections == 1);
+    }
+
+    // Two seconds later the TIME_WAIT entry and one connection are gone and two are new
+    WriteTestFile(root + "/net/tcp", std::string(TABLE_HEADER) +
+                  Row(0, "0100007F:0277", "00000000:0000", 0x0A, 1001) +
+                  Row(1, "0F00000A:C350", "0200000A:01BB", 0x01, 1002) +
+                  Row(2, "0F00000A:C353", "0300000A:0050", 0x02, 1004) +
+                  Row(3, "0F00000A:C354", "0300000A:0050", 0x08, 1005));
+    unsigned browserLater[] = { 1002, 1004, 1005, 3001 };
+    WriteProcess(root, 300, "browser", browserLater, 4);
+    clock.AdvanceMs(2000);
+    CHECK(monitor.Sample());
+    CHECK_NEAR(monitor.GetOpenedPerSec(), 1.0, 1e-9);
+    CHECK_NEAR(monitor.GetClosedPerSec(), 1.0, 1e-9);
+    CHECK(monitor.GetStateCount(TCP_STATE_SYN_SENT) == 1);
+    CHECK(monitor.GetStateCount(TCP_STATE_CLOSE_WAIT) == 1);
+    CHECK(monitor.GetStateCount(TCP_STATE_TIME_WAIT) == 0);
+    CHECK(!top.empty() && top[0].connections == 4);
+
+    // The same connections in a different order, one of them gone and one new: rows that
+    // only moved are neither opened nor closed
+    WriteTestFile(root + "/net/tcp", std::string(TABLE_HEADER) +
+                  Row(0, "0F00000A:C354", "0300000A:0050", 0x08, 1005) +
+                  Row(1, "0F00000A:C355", "0300000A:0050", 0x02, 1006) +
+                  Row(2, "0F00000A:C350", "0200000A:01BB", 0x01, 1002) +
+                  Row(3, "0100007F:0277", "00000000:0000", 0x0A, 1001));
+    clock.AdvanceMs(1000);
+    CHECK(monitor.Sample());
+    CHECK_NEAR(monitor.GetOpenedPerSec(), 1.0, 1e-9);
+    CHECK_NEAR(monitor.GetClosedPerSec(), 1.0, 1e-9);
+    CHECK(monitor.GetTcpCount() == 5);
+
+    // After a reset the next sample is a baseline again
+    monitor.Reset();
+    clock.AdvanceMs(1000);
+    CHECK(monitor.Sample());
+    CHECK(monitor.GetOpenedPerSec() == 0.0 && monitor.GetClosedPerSec() == 0.0);
+    RemoveTestDirectory(root);
+
+    ConnectionMonitor broken(std::make_unique<ProcNetConnectionBackend>("/nonexistent-proc"), clock);
+    CHECK(!broken.Sample());
+}
+
+// 40 established connections to 10.0.0.2:443, minus the skipped ones, plus extra local ports
+static std::string BulkTable(const std::vector<int>& skipped, const std::vector<int>& added, int insertAfter)
+{
+    std::string text = TABLE_HEADER;
+    int slot = 0;
+    for (int port = 0; port < 40; port++) {
+        if (std::find(skipped.begin(), skipped.end(), port) == skipped.end()) {
+            char local[32];
+            snprintf(local, sizeof(local), "0F00000A:%04X", 40000 + port);
+            text += Row(slot++, local, "0200000A:01BB", 0x01, 5000 + port);
+        }
+        if (port == insertAfter) {
+            for (int extra : added) {
+                char local[32];
+                snprintf(local, sizeof(local), "0F00000A:%04X", 50000 + extra);
+                text += Row(slot++, local, "0200000A:01BB", 0x01, 6000 + extra);
+            }
+        }
+    }
+    return text;
+}
+
+// Runs of insertions and removals in the middle of a table only count as what changed
+static void TestTableEdits()
+{
+    std::string root = MakeTestDirectory("connection-edits");
+    mkdir((root + "/net").c_str(), 0755);
+    WriteTestFile(root + "/net/tcp", BulkTable({}, {}, -1));
+
+    FakeClock clock(1000000000ull);
+    ConnectionMonitor monitor(std::make_unique<ProcNetConnectionBackend>(root), clock);
+    CHECK(monitor.Sample());
+
+    // Four new rows inserted after port 10, three adjacent ones removed further on
+    WriteTestFile(root + "/net/tcp", BulkTable({ 20, 21, 22 }, { 1, 2, 3, 4 }, 10));
+    clock.AdvanceMs(1000);
+    CHECK(monitor.Sample());
+    CHECK_NEAR(monitor.GetOpenedPerSec(), 4.0, 1e-9);
+    CHECK_NEAR(monitor.GetClosedPerSec(), 3.0, 1e-9);
+
+    // A burst longer than the lookahead still comes out exact, just through the fingerprint sets
+    std::vector<int> burst;
+    for (int extra = 10; extra < 10 + 3 * CONNECTION_RESYNC_WINDOW; extra++)
+        burst.push_back(extra);
+    WriteTestFile(root + "/net/tcp", BulkTable({ 20, 21, 22 }, burst, 5));
+    clock.AdvanceMs(1000);
+    CHECK(monitor.Sample());
+    CHECK_NEAR(monitor.GetOpenedPerSec(), burst.size(), 1e-9);
+    CHECK_NEAR(monitor.GetClosedPerSec(), 4.0, 1e-9);
+    CHECK(monitor.GetStateCount(TCP_STATE_ESTABLISHED) == static_cast<int>(37 + burst.size()));
+    RemoveTestDirectory(root);
+}
+
+static void TestRealProc()
+{
+    ConnectionMonitor monitor(std::make_unique<ProcNetConnectionBackend>());
+    if (!monitor.Sample()) {
+        printf("no readable /proc/net, skipping the live pass\n");
+        return;
+    }
+    CHECK(monitor.GetTcpCount() >= 0 && monitor.GetUdpCount() >= 0);
+    int states = 0;
+    for (int state = 0; state < TCP_STATE_COUNT; state++)
+        states += monitor.GetStateCount(state);
+    CHECK(states == monitor.GetTcpCount());
+}
+
+int main()
+{
+    TestSyntheticProc();
+    TestTableEdits();
+    TestRealProc();
+    return TestResult("ConnectionMonitorTest");
+}
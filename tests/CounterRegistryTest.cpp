@@ -0,0 +1,138 @@
+// Counter registry against the /proc/stat backend: exact values from a synthetic /proc,
+// the tick schedule, and a sanity pass over the real /proc
+
+#include "TestSupport.h"
+#include "CounterRegistry.h"
+#include "ProcStatCounterBackend.h"
+#include <memory>
+
+static const char* CPU_PATH = "\\Processor(_Total)\\% Processor Time";
+static const char* SWITCHES_PATH = "\\System\\Context Switches/sec";
+static const char* QUEUE_PATH = "\\System\\Processor Queue Length";
+static const char* COMMIT_PATH = "\\Memory\\% Committed Bytes In Use";
+static const char* SWAP_PATH = "\\Paging File(_Total)\\% Usage";
+static const char* DISK_PATH = "\\PhysicalDisk(_Total)\\Disk Bytes/sec";
+
+static void WriteStat(const std::string& root, uint64_t user, uint64_t idle, uint64_t iowait, uint64_t ctxt, int running)
+{
+    char text[512];
+    snprintf(text, sizeof(text),
+             "cpu  %llu 0 0 %llu %llu 0 0 0 0 0\n"
+             "cpu0 %llu 0 0 %llu %llu 0 0 0 0 0\n"
+             "intr 12345 0 0\n"
+             "ctxt %llu\n"
+             "btime 1700000000\n"
+             "procs_running %d\n"
+             "procs_blocked 0\n",
+             (unsigned long long)user, (unsigned long long)idle, (unsigned long long)iowait,
+             (unsigned long long)user, (unsigned long long)idle, (unsigned long long)iowait,
+             (unsigned long long)ctxt, running);
+    WriteTestFile(root + "/stat", text);
+}
+
+static void WriteDiskstats(const std::string& root, uint64_t sdaRead, uint64_t sdaWritten)
+{
+    char text[1024];
+    // The partition, loop device and device-mapper volume repeat I/O already counted on sda
+    snprintf(text, sizeof(text),
+             "   8       0 sda 100 0 %llu 0 50 0 %llu 0 0 0 0\n"
+             "   8       1 sda1 100 0 %llu 0 50 0 %llu 0 0 0 0\n"
+             "   7       0 loop0 5 0 4000 0 0 0 0 0 0 0 0\n"
+             " 253       0 dm-0 100 0 %llu 0 50 0 %llu 0 0 0 0\n"
+             " 259       0 nvme0n1 10 0 1000 0 10 0 1000 0 0 0 0\n"
+             " 259       1 nvme0n1p1 10 0 1000 0 10 0 1000 0 0 0 0\n",
+             (unsigned long long)sdaRead, (unsigned long long)sdaWritten,
+             (unsigned long long)sdaRead, (unsigned long long)sdaWritten,
+             (unsigned long long)sdaRead, (unsigned long long)sdaWritten);
+    WriteTestFile(root + "/diskstats", text);
+}
+
+static void TestSyntheticProc()
+{
+    std::string root = MakeTestDirectory("counter-registry");
+    WriteStat(root, 1000, 9000, 0, 50000, 1);
+    WriteTestFile(root + "/meminfo",
+                  "MemTotal:       16000000 kB\n"
+                  "CommitLimit:    10000000 kB\n"
+                  "Committed_AS:    2500000 kB\n"
+                  "SwapTotal:       2000000 kB\n"
+                  "SwapFree:        1500000 kB\n");
+    WriteDiskstats(root, 1000, 2000);
+
+    FakeClock clock(1000000000ull);
+    CounterRegistry registry(std::make_unique<ProcStatCounterBackend>(root, clock));
+    int cpu = registry.Declare(COUNTER_PROCESSOR, CPU_PATH, "CPU");
+    int switches = registry.Declare(COUNTER_SYSTEM, SWITCHES_PATH, "Context switches");
+    int queue = registry.Declare(COUNTER_SYSTEM, QUEUE_PATH, "Run queue");
+    int commit = registry.Declare(COUNTER_MEMORY, COMMIT_PATH, "Commit");
+    int swap = registry.Declare(COUNTER_PAGING, SWAP_PATH, "Page file");
+    int disk = registry.Declare(COUNTER_DISK, DISK_PATH, "Disk");
+    int missing = registry.Declare(COUNTER_SYSTEM, "\\System\\No Such Counter", "Missing");
+
+    CHECK(registry.Open());
+    CHECK(registry.IsAvailable(cpu));
+    CHECK(registry.IsAvailable(disk));
+    CHECK(!registry.IsAvailable(missing));
+
+    // One second later: 300 busy ticks out of 1000 (iowait counts as idle), 2500 switches,
+    // 4 runnable, and sda moved 2048 sectors in total
+    WriteStat(root, 1300, 9600, 100, 52500, 4);
+    WriteDiskstats(root, 2000, 3048);
+    clock.AdvanceMs(1000);
+    registry.SetInterval(1000);
+    CHECK(registry.Tick(1000));
+    CHECK_NEAR(registry.GetValue(cpu), 30.0, 1e-9);
+    CHECK_NEAR(registry.GetValue(switches), 2500.0, 1e-6);
+    CHECK_NEAR(registry.GetValue(queue), 4.0, 1e-9);
+    CHECK_NEAR(registry.GetValue(commit), 25.0, 1e-9);
+    CHECK_NEAR(registry.GetValue(swap), 25.0, 1e-9);
+    CHECK_NEAR(registry.GetValue(disk), 2048.0 * 512.0, 1e-6);
+    CHECK(registry.GetValue(missing) == 0.0);
+
+    // The schedule holds further ticks back until the interval has passed
+    CHECK(!registry.Tick(1500));
+    CHECK_NEAR(registry.GetValue(cpu), 30.0, 1e-9);
+
+    // Rates divide by the elapsed clock time, not by the nominal interval
+    WriteStat(root, 1300, 11600, 100, 53500, 1);
+    clock.AdvanceMs(2000);
+    CHECK(registry.Tick(3000));
+    CHECK_NEAR(registry.GetValue(cpu), 0.0, 1e-9);
+    CHECK_NEAR(registry.GetValue(switches), 500.0, 1e-6);
+    CHECK_NEAR(registry.GetValue(disk), 0.0, 1e-9);
+
+    // Closing marks everything unavailable; a missing /proc can't be opened
+    registry.Close();
+    CHECK(!registry.IsAvailable(cpu));
+    RemoveTestDirectory(root);
+
+    CounterRegistry broken(std::make_unique<ProcStatCounterBackend>("/nonexistent-proc", clock));
+    broken.Declare(COUNTER_PROCESSOR, CPU_PATH, "CPU");
+    CHECK(!broken.Open());
+}
+
+static void TestRealProc()
+{
+    CounterRegistry registry(std::make_unique<ProcStatCounterBackend>());
+    int cpu = registry.Declare(COUNTER_PROCESSOR, CPU_PATH, "CPU");
+    int commit = registry.Declare(COUNTER_MEMORY, COMMIT_PATH, "Commit");
+    int switches = registry.Declare(COUNTER_SYSTEM, SWITCHES_PATH, "Context switches");
+    if (!registry.Open()) {
+        printf("no readable /proc, skipping the live pass\n");
+        return;
+    }
+
+    registry.SetInterval(0);
+    usleep(200000);
+    CHECK(registry.Tick(Clock::System().NowMs()));
+    CHECK(registry.GetValue(cpu) >= 0.0 && registry.GetValue(cpu) <= 100.0);
+    CHECK(registry.GetValue(commit) > 0.0);
+    CHECK(registry.GetValue(switches) >= 0.0);
+}
+
+int main()
+{
+    TestSyntheticProc();
+    TestRealProc();
+    return TestResult("CounterRegistryTest");
+}
@@ -0,0 +1,160 @@
+// Font atlas cache round trip on Linux, using ImGui's embedded default font written out
+// as a TTF: a miss bakes and saves, a hit reproduces the same glyphs, lookup tables, metrics
+// and pixels, and a cache with a bad key, a fallback glyph below -1, a lookup entry past the
+// glyphs or a truncated tail is rejected without touching the atlas
+
+#include "TestSupport.h"
+#include "FontAtlasCache.h"
+#include <cstring>
+#include <sys/stat.h>
+#include <vector>
+
+static const float FONT_SIZE = 16.0f;
+
+static std::string ReadFile(const std::string& path)
+{
+    std::string data;
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file)
+        return data;
+    char chunk[4096];
+    size_t read;
+    while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        data.append(chunk, read);
+    fclose(file);
+    return data;
+}
+
+// Offset of the first occurrence of needle in the file image, or npos
+static size_t Find(const std::string& data, const void* needle, size_t length)
+{
+    return data.find(std::string(static_cast<const char*>(needle), length));
+}
+
+template <typename T>
+static bool SameVector(const ImVector<T>& a, const ImVector<T>& b)
+{
+    return a.Size == b.Size && (a.Size == 0 || memcmp(a.Data, b.Data, sizeof(T) * a.Size) == 0);
+}
+
+static bool SameFont(const ImFont* a, const ImFont* b)
+{
+    return a->FontSize == b->FontSize && a->Ascent == b->Ascent && a->Descent == b->Descent &&
+           a->FallbackAdvanceX == b->FallbackAdvanceX && a->EllipsisChar == b->EllipsisChar &&
+           a->FallbackChar == b->FallbackChar &&
+           (a->FallbackGlyph - a->Glyphs.Data) == (b->FallbackGlyph - b->Glyphs.Data) &&
+           SameVector(a->Glyphs, b->Glyphs) && SameVector(a->IndexLookup, b->IndexLookup) &&
+           SameVector(a->IndexAdvanceX, b->IndexAdvanceX);
+}
+
+// Load a corrupted copy of the cache into an atlas that already holds a font; it must
+// refuse and leave that font in place
+static bool RejectsCorruptCopy(const std::string& path, const std::string& image, uint64_t key)
+{
+    WriteTestFile(path, image);
+    ImFontAtlas atlas;
+    ImFont* existing = atlas.AddFontDefault();
+    atlas.Build();
+    FontAtlasCache cache(path);
+    bool rejected = !cache.Load(&atlas, key);
+    return rejected && atlas.Fonts.Size == 1 && atlas.Fonts[0] == existing && atlas.TexReady;
+}
+
+int main()
+{
+    std::string root = MakeTestDirectory("font-cache");
+    std::string fontPath = root + "/ProggyClean.ttf";
+    std::string cachePath = root + "/fonts.cache";
+
+    // The embedded font, decompressed, is a complete TTF
+    {
+        ImFontAtlas source;
+        source.AddFontDefault();
+        const ImFontConfig& config = source.Sources[0];
+        WriteTestFile(fontPath, std::string(static_cast<const char*>(config.FontData), config.FontDataSize));
+    }
+    const ImWchar* ranges = ImFontAtlas().GetGlyphRangesDefault();
+
+    // Miss: bakes from the TTF and writes the cache
+    ImFontAtlas baked;
+    FontAtlasCache first(cachePath);
+    ImFont* bakedFont = first.LoadOrBuild(&baked, fontPath.c_str(), FONT_SIZE, ranges);
+    CHECK(bakedFont != nullptr);
+    CHECK(!first.WasLoadedFromCache());
+    struct stat info;
+    CHECK(stat(cachePath.c_str(), &info) == 0 && info.st_size > 0);
+
+    // Hit: the same atlas without running the builder
+    ImFontAtlas loaded;
+    FontAtlasCache second(cachePath);
+    ImFont* loadedFont = second.LoadOrBuild(&loaded, fontPath.c_str(), FONT_SIZE, ranges);
+    CHECK(loadedFont != nullptr);
+    CHECK(second.WasLoadedFromCache());
+    printf("bake %.2f ms, cache load %.2f ms\n", first.GetLastLoadNs() / 1e6, second.GetLastLoadNs() / 1e6);
+    if (!bakedFont || !loadedFont)
+        return TestResult("FontAtlasCacheTest");
+
+    CHECK(SameFont(bakedFont, loadedFont));
+    CHECK(loaded.TexReady && loaded.TexWidth == baked.TexWidth && loaded.TexHeight == baked.TexHeight);
+    CHECK(memcmp(loaded.TexPixelsAlpha8, baked.TexPixelsAlpha8, static_cast<size_t>(baked.TexWidth) * baked.TexHeight) == 0);
+    CHECK(loaded.TexUvWhitePixel.x == baked.TexUvWhitePixel.x && loaded.TexUvWhitePixel.y == baked.TexUvWhitePixel.y);
+    CHECK(loaded.CustomRects.Size == baked.CustomRects.Size);
+    const char* sample = "The quick brown fox 0123456789 {}[]";
+    ImVec2 bakedSize = bakedFont->CalcTextSizeA(FONT_SIZE, 1000.0f, 0.0f, sample);
+    ImVec2 loadedSize = loadedFont->CalcTextSizeA(FONT_SIZE, 1000.0f, 0.0f, sample);
+    CHECK(bakedSize.x == loadedSize.x && bakedSize.y == loadedSize.y);
+
+    // A different size is a different key
+    uint64_t key = FontAtlasCache::ComputeKey(&baked, fontPath.c_str(), FONT_SIZE, ranges, nullptr);
+    CHECK(key != FontAtlasCache::ComputeKey(&baked, fontPath.c_str(), FONT_SIZE + 1.0f, ranges, nullptr));
+    CHECK(FontAtlasCache::ComputeKey(&baked, (root + "/missing.ttf").c_str(), FONT_SIZE, ranges, nullptr) == 0);
+    std::string corruptPath = root + "/corrupt.cache";
+    std::string image = ReadFile(cachePath);
+    CHECK(RejectsCorruptCopy(corruptPath, image, key + 1));
+
+    // The unmodified copy loads, so the rejections below are down to the one field changed
+    {
+        WriteTestFile(corruptPath, image);
+        ImFontAtlas atlas;
+        FontAtlasCache cache(corruptPath);
+        CHECK(cache.Load(&atlas, key));
+    }
+
+    // The font record ends with fallbackGlyph, glyphCount and indexCount
+    int32_t counts[3] = { static_cast<int32_t>(bakedFont->FallbackGlyph - bakedFont->Glyphs.Data),
+                          bakedFont->Glyphs.Size, bakedFont->IndexLookup.Size };
+    size_t countsAt = Find(image, counts, sizeof(counts));
+    CHECK(countsAt != std::string::npos);
+    if (countsAt != std::string::npos) {
+        std::string bad = image;
+        int32_t fallback = -2;
+        memcpy(&bad[countsAt], &fallback, sizeof(fallback));
+        CHECK(RejectsCorruptCopy(corruptPath, bad, key));
+    }
+
+    // A lookup entry pointing past the glyphs is rejected; the "no glyph" marker is not
+    size_t lookupAt = Find(image, bakedFont->IndexLookup.Data, sizeof(ImU16) * bakedFont->IndexLookup.Size);
+    CHECK(lookupAt != std::string::npos);
+    if (lookupAt != std::string::npos) {
+        std::string bad = image;
+        ImU16 outOfRange = static_cast<ImU16>(bakedFont->Glyphs.Size);
+        memcpy(&bad[lookupAt + sizeof(ImU16) * 'A'], &outOfRange, sizeof(outOfRange));
+        CHECK(RejectsCorruptCopy(corruptPath, bad, key));
+
+        std::string unused = image;
+        ImU16 none = (ImU16)-1;
+        memcpy(&unused[lookupAt + sizeof(ImU16) * 'A'], &none, sizeof(none));
+        WriteTestFile(corruptPath, unused);
+        ImFontAtlas atlas;
+        FontAtlasCache cache(corruptPath);
+        CHECK(cache.Load(&atlas, key));
+        CHECK(atlas.Fonts.Size == 1 && atlas.Fonts[0]->FindGlyphNoFallback('A') == nullptr);
+    }
+
+    // A cache cut short anywhere fails the size check
+    CHECK(RejectsCorruptCopy(corruptPath, image.substr(0, image.size() - 1), key));
+    CHECK(RejectsCorruptCopy(corruptPath, image.substr(0, image.size() / 2), key));
+
+    RemoveTestDirectory(root);
+    return TestResult("FontAtlasCacheTest");
+}
@@ -0,0 +1,250 @@
+// Hotkey matcher replaying recorded key streams (as the low-level hook sees them, with the
+// left/right modifier codes and auto-repeat downs): left and right modifiers fold to the
+// same chord, HOTKEY_MOD_ANY chords against exact ones, repeats not firing again until the
+// key is released, keys no chord uses, and Reset dropping held keys
+
+#include "TestSupport.h"
+#include "HotkeyMatcher.h"
+
+// Virtual-key codes as the hook reports them
+#define VK_RETURN   0x0D
+#define VK_SPACE    0x20
+#define VK_LWIN     0x5B
+#define VK_LSHIFT   0xA0
+#define VK_RSHIFT   0xA1
+#define VK_LCONTROL 0xA2
+#define VK_RCONTROL 0xA3
+#define VK_LMENU    0xA4
+#define VK_RMENU    0xA5
+
+// One recorded event and the action the matcher should return for it
+struct KeyEvent {
+    uint8_t vk;
+    bool down;
+    uint8_t expected;
+};
+
+// Feed a stream; returns how many events gave a different action than recorded
+template <size_t N>
+static int Replay(HotkeyMatcher& matcher, const KeyEvent (&events)[N])
+{
+    int mismatches = 0;
+    for (const KeyEvent& event : events) {
+        if (matcher.OnKey(event.vk, event.down) != event.expected)
+            mismatches++;
+    }
+    return mismatches;
+}
+
+static HotkeyMatcher DefaultMatcher()
+{
+    HotkeySettings settings;
+    HotkeyMatcher matcher;
+    matcher.Compile(settings.chords, MAX_HOTKEY_CHORDS);
+    return matcher;
+}
+
+static void TestModifierFolding()
+{
+    HotkeyMatcher matcher = DefaultMatcher();
+
+    // Alt+Space with the left Alt, then with the right one
+    const KeyEvent leftAlt[] = {
+        { VK_LMENU, true, HOTKEY_ACTION_NONE },
+        { VK_SPACE, true, HOTKEY_ACTION_TOGGLE },
+        { VK_SPACE, false, HOTKEY_ACTION_NONE },
+        { VK_LMENU, false, HOTKEY_ACTION_NONE },
+    };
+    CHECK(Replay(matcher, leftAlt) == 0);
+    CHECK(matcher.GetModifiers() == 0);
+
+    const KeyEvent rightAlt[] = {
+        { VK_RMENU, true, HOTKEY_ACTION_NONE },
+        { VK_SPACE, true, HOTKEY_ACTION_TOGGLE },
+        { VK_SPACE, false, HOTKEY_ACTION_NONE },
+        { VK_RMENU, false, HOTKEY_ACTION_NONE },
+    };
+    CHECK(Replay(matcher, rightAlt) == 0);
+
+    // Ctrl+Alt+T from mixed sides; releasing one of two held Ctrls keeps Ctrl held
+    const KeyEvent mixed[] = {
+        { VK_LCONTROL, true, HOTKEY_ACTION_NONE },
+        { VK_RCONTROL, true, HOTKEY_ACTION_NONE },
+        { VK_RMENU, true, HOTKEY_ACTION_NONE },
+        { VK_LCONTROL, false, HOTKEY_ACTION_NONE },
+        { 'T', true, HOTKEY_ACTION_DUMP_TRACE },
+        { 'T', false, HOTKEY_ACTION_NONE },
+        { VK_RCONTROL, false, HOTKEY_ACTION_NONE },
+        { 'T', true, HOTKEY_ACTION_NONE },         // Alt+T isn't a chord
+        { 'T', false, HOTKEY_ACTION_NONE },
+        { VK_RMENU, false, HOTKEY_ACTION_NONE },
+    };
+    CHECK(Replay(matcher, mixed) == 0);
+    CHECK(matcher.GetModifiers() == 0);
+
+    matcher.OnKey(VK_LSHIFT, true);
+    matcher.OnKey(VK_RSHIFT, true);
+    matcher.OnKey(VK_LWIN, true);
+    CHECK(matcher.GetModifiers() == (HOTKEY_MOD_SHIFT | HOTKEY_MOD_WIN));
+    matcher.OnKey(VK_LSHIFT, false);
+    CHECK(matcher.GetModifiers() == (HOTKEY_MOD_SHIFT | HOTKEY_MOD_WIN));
+    matcher.OnKey(VK_RSHIFT, false);
+    CHECK(matcher.GetModifiers() == HOTKEY_MOD_WIN);
+}
+
+static void TestWildcardAndExact()
+{
+    HotkeyMatcher matcher = DefaultMatcher();
+
+    // Enter hides with any modifiers held, Space only toggles with exactly Alt
+    const KeyEvent stream[] = {
+        { VK_RETURN, true, HOTKEY_ACTION_HIDE },
+        { VK_RETURN, false, HOTKEY_ACTION_NONE },
+        { VK_LSHIFT, true, HOTKEY_ACTION_NONE },
+        { VK_RCONTROL, true, HOTKEY_ACTION_NONE },
+        { VK_RETURN, true, HOTKEY_ACTION_HIDE },
+        { VK_RETURN, false, HOTKEY_ACTION_NONE },
+        { VK_SPACE, true, HOTKEY_ACTION_NONE },
+        { VK_SPACE, false, HOTKEY_ACTION_NONE },
+        { VK_LMENU, true, HOTKEY_ACTION_NONE },
+        { VK_SPACE, true, HOTKEY_ACTION_NONE },    // Ctrl+Shift+Alt+Space is not Alt+Space
+        { VK_SPACE, false, HOTKEY_ACTION_NONE },
+        { VK_LSHIFT, false, HOTKEY_ACTION_NONE },
+        { VK_RCONTROL, false, HOTKEY_ACTION_NONE },
+        { VK_SPACE, true, HOTKEY_ACTION_TOGGLE },
+        { VK_SPACE, false, HOTKEY_ACTION_NONE },
+        { VK_LMENU, false, HOTKEY_ACTION_NONE },
+        { VK_SPACE, true, HOTKEY_ACTION_NONE },
+        { VK_SPACE, false, HOTKEY_ACTION_NONE },
+    };
+    CHECK(Replay(matcher, stream) == 0);
+
+    // An exact chord on a wildcard key wins for its own modifiers, in either order
+    const HotkeyChord wildcardFirst[] = {
+        { HOTKEY_MOD_ANY, VK_RETURN, HOTKEY_ACTION_HIDE },
+        { HOTKEY_MOD_CTRL, VK_RETURN, HOTKEY_ACTION_TOGGLE },
+    };
+    const HotkeyChord exactFirst[] = {
+        { HOTKEY_MOD_CTRL, VK_RETURN, HOTKEY_ACTION_TOGGLE },
+        { HOTKEY_MOD_ANY, VK_RETURN, HOTKEY_ACTION_HIDE },
+    };
+    const KeyEvent overlap[] = {
+        { VK_RETURN, true, HOTKEY_ACTION_HIDE },
+        { VK_RETURN, false, HOTKEY_ACTION_NONE },
+        { VK_LCONTROL, true, HOTKEY_ACTION_NONE },
+        { VK_RETURN, true, HOTKEY_ACTION_TOGGLE },
+        { VK_RETURN, false, HOTKEY_ACTION_NONE },
+        { VK_LSHIFT, true, HOTKEY_ACTION_NONE },
+        { VK_RETURN, true, HOTKEY_ACTION_HIDE },
+        { VK_RETURN, false, HOTKEY_ACTION_NONE },
+        { VK_LSHIFT, false, HOTKEY_ACTION_NONE },
+        { VK_LCONTROL, false, HOTKEY_ACTION_NONE },
+    };
+    matcher.Compile(wildcardFirst, 2);
+    CHECK(Replay(matcher, overlap) == 0);
+    matcher.Compile(exactFirst, 2);
+    CHECK(Replay(matcher, overlap) == 0);
+}
+
+static void TestAutoRepeat()
+{
+    HotkeyMatcher matcher = DefaultMatcher();
+
+    // Holding Alt+Space sends repeated downs; only the first fires
+    const KeyEvent held[] = {
+        { VK_LMENU, true, HOTKEY_ACTION_NONE },
+        { VK_LMENU, true, HOTKEY_ACTION_NONE },
+        { VK_SPACE, true, HOTKEY_ACTION_TOGGLE },
+        { VK_SPACE, true, HOTKEY_ACTION_NONE },
+        { VK_SPACE, true, HOTKEY_ACTION_NONE },
+        { VK_LMENU, true, HOTKEY_ACTION_NONE },
+        { VK_SPACE, true, HOTKEY_ACTION_NONE },
+        { VK_SPACE, false, HOTKEY_ACTION_NONE },
+        { VK_SPACE, true, HOTKEY_ACTION_TOGGLE },
+        { VK_SPACE, false, HOTKEY_ACTION_NONE },
+        { VK_LMENU, false, HOTKEY_ACTION_NONE },
+    };
+    CHECK(Replay(matcher, held) == 0);
+
+    // Repeat suppression is per key: holding Enter doesn't block Alt+Space
+    const KeyEvent overlapping[] = {
+        { VK_RETURN, true, HOTKEY_ACTION_HIDE },
+        { VK_RETURN, true, HOTKEY_ACTION_NONE },
+        { VK_LMENU, true, HOTKEY_ACTION_NONE },
+        { VK_SPACE, true, HOTKEY_ACTION_TOGGLE },
+        { VK_RETURN, true, HOTKEY_ACTION_NONE },
+        { VK_SPACE, false, HOTKEY_ACTION_NONE },
+        { VK_RETURN, false, HOTKEY_ACTION_NONE },
+        { VK_LMENU, false, HOTKEY_ACTION_NONE },
+    };
+    CHECK(Replay(matcher, overlapping) == 0);
+}
+
+static void TestUnusedKeys()
+{
+    HotkeyMatcher matcher = DefaultMatcher();
+    int fired = 0;
+    matcher.OnKey(VK_LCONTROL, true);
+    matcher.OnKey(VK_LMENU, true);
+    for (int vk = 1; vk < 256; vk++) {
+        if (vk == VK_SPACE || vk == VK_RETURN || vk == 'T' || (vk >= 0x10 && vk <= 0x12) ||
+            (vk >= VK_LSHIFT && vk <= VK_RMENU) || vk == VK_LWIN || vk == 0x5C)
+            continue;
+        if (matcher.OnKey(static_cast<uint8_t>(vk), true) != HOTKEY_ACTION_NONE)
+            fired++;
+        if (matcher.OnKey(static_cast<uint8_t>(vk), false) != HOTKEY_ACTION_NONE)
+            fired++;
+    }
+    CHECK(fired == 0);
+    CHECK(matcher.GetModifiers() == (HOTKEY_MOD_CTRL | HOTKEY_MOD_ALT));
+
+    // Unused slots and NONE actions don't claim their keys
+    const HotkeyChord chords[] = {
+        { HOTKEY_MOD_ALT, 0, HOTKEY_ACTION_TOGGLE },
+        { HOTKEY_MOD_ANY, 'Q', HOTKEY_ACTION_NONE },
+    };
+    matcher.Compile(chords, 2);
+    CHECK(matcher.OnKey('Q', true) == HOTKEY_ACTION_NONE);
+    CHECK(matcher.OnKey(0, true) == HOTKEY_ACTION_NONE);
+}
+
+static void TestReset()
+{
+    HotkeyMatcher matcher = DefaultMatcher();
+
+    // The hook was reinstalled while Alt and Space were down; their ups were never seen
+    const KeyEvent beforeReset[] = {
+        { VK_LMENU, true, HOTKEY_ACTION_NONE },
+        { VK_SPACE, true, HOTKEY_ACTION_TOGGLE },
+    };
+    CHECK(Replay(matcher, beforeReset) == 0);
+    matcher.Reset();
+    CHECK(matcher.GetModifiers() == 0);
+
+    const KeyEvent afterReset[] = {
+        { VK_SPACE, true, HOTKEY_ACTION_NONE },    // Alt no longer counts as held
+        { VK_SPACE, false, HOTKEY_ACTION_NONE },
+        { VK_RMENU, true, HOTKEY_ACTION_NONE },
+        { VK_SPACE, true, HOTKEY_ACTION_TOGGLE },
+        { VK_SPACE, false, HOTKEY_ACTION_NONE },
+        { VK_RMENU, false, HOTKEY_ACTION_NONE },
+    };
+    CHECK(Replay(matcher, afterReset) == 0);
+
+    // A key held across Reset fires on its next down instead of being taken for a repeat
+    matcher.OnKey(VK_LMENU, true);
+    CHECK(matcher.OnKey(VK_SPACE, true) == HOTKEY_ACTION_TOGGLE);
+    matcher.Reset();
+    matcher.OnKey(VK_LMENU, true);
+    CHECK(matcher.OnKey(VK_SPACE, true) == HOTKEY_ACTION_TOGGLE);
+}
+
+int main()
+{
+    TestModifierFolding();
+    TestWildcardAndExact();
+    TestAutoRepeat();
+    TestUnusedKeys();
+    TestReset();
+    return TestResult("HotkeyMatcherTest");
+}
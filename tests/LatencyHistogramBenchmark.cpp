@@ -0,0 +1,173 @@
+// Latency histogram recording cost: Record on one thread with frame-like timings (mostly a
+// few ms, some hitches) against a budget of a few nanoseconds, with values spread over the
+// whole range, a bare atomic add (the floor) and a LatencyScope (two clock reads) timed
+// alongside for reference. Checks on
+// the way that every value lands in a bucket within the ~3% relative error, that concurrent
+// recorders lose no counts, and that merged snapshots report the percentiles of the
+// combined samples.
+
+#include "TestSupport.h"
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#define BENCHMARK_ROUNDS 5
+#define BENCHMARK_RECORDS (1 << 21)
+#define BENCHMARK_FRAME_TIMES 4096       // Replayed over and over, as a frame loop would
+#define BENCHMARK_BUDGET_NS 20.0         // A locked add alone is ~10 ns on some virtualised hosts
+#define RECORDER_THREADS 4
+#define RECORDS_PER_THREAD 250000
+
+// Log-uniform values from 1 ns to ~69 s, like a mix of cheap calls and rare hitches
+static std::vector<uint64_t> MakeValues()
+{
+    std::vector<uint64_t> values(BENCHMARK_RECORDS);
+    uint64_t state = 88172645463325252ull;
+    for (uint64_t& value : values) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        int exponent = static_cast<int>(state % (LATENCY_MAX_EXPONENT + 1));
+        value = (1ull << exponent) + ((state >> 8) & ((1ull << exponent) - 1));
+    }
+    return values;
+}
+
+// Frame and call timings: 2-8 ms with one in 64 a hitch of up to ~130 ms
+static std::vector<uint64_t> MakeFrameTimes()
+{
+    std::vector<uint64_t> times(BENCHMARK_FRAME_TIMES);
+    uint32_t state = 2463534242u;
+    for (uint64_t& time : times) {
+        state = state * 1664525u + 1013904223u;
+        time = 2000000 + (state >> 8) % 6000000;
+        if ((state & 0x3F) == 0)
+            time <<= 4;
+    }
+    return times;
+}
+
+static void TestBuckets(const std::vector<uint64_t>& values)
+{
+    int outside = 0;
+    for (uint64_t value : values) {
+        size_t index = LatencyHistogram::BucketIndex(value);
+        uint64_t lowest = LatencyHistogram::BucketLowest(index);
+        uint64_t width = LatencyHistogram::BucketWidth(index);
+        if (index >= LATENCY_BUCKET_COUNT || value < lowest || value >= lowest + width ||
+            width > (std::max)(lowest / LATENCY_SUB_BUCKETS, (uint64_t)1))
+            outside++;
+    }
+    CHECK(outside == 0);
+    CHECK(LatencyHistogram::BucketIndex(~0ull) == LATENCY_BUCKET_COUNT - 1);
+}
+
+static void TestConcurrentRecorders()
+{
+    LatencyHistogram histogram;
+    std::vector<std::thread> recorders;
+    for (int t = 0; t < RECORDER_THREADS; t++) {
+        recorders.emplace_back([&histogram, t]() {
+            for (int i = 0; i < RECORDS_PER_THREAD; i++)
+                histogram.Record(static_cast<uint64_t>(t * RECORDS_PER_THREAD + i));
+        });
+    }
+    for (auto& recorder : recorders)
+        recorder.join();
+
+    LatencySnapshot snapshot;
+    histogram.Snapshot(snapshot);
+    CHECK(snapshot.total == (uint64_t)RECORDER_THREADS * RECORDS_PER_THREAD);
+    CHECK(snapshot.max == (uint64_t)RECORDER_THREADS * RECORDS_PER_THREAD - 1);
+}
+
+static void TestMerge()
+{
+    // 1..1000 us split across two histograms by parity; merged, the percentiles are the
+    // whole series' within a bucket
+    LatencyHistogram odd;
+    LatencyHistogram even;
+    for (uint64_t us = 1; us <= 1000; us++)
+        (us % 2 ? odd : even).Record(us * 1000);
+
+    LatencySnapshot merged;
+    LatencySnapshot other;
+    odd.Snapshot(merged);
+    even.Snapshot(other);
+    merged.Merge(other);
+    CHECK(merged.total == 1000);
+    CHECK(merged.max == 1000000);
+    CHECK_NEAR(merged.ValueAtPercentile(50.0), 500000.0, 500000.0 / LATENCY_SUB_BUCKETS);
+    CHECK_NEAR(merged.ValueAtPercentile(99.0), 990000.0, 990000.0 / LATENCY_SUB_BUCKETS);
+    CHECK_NEAR(merged.ValueAtPercentile(99.9), 999000.0, 999000.0 / LATENCY_SUB_BUCKETS);
+    CHECK(merged.ValueAtPercentile(100.0) == 1000000);
+}
+
+// Best-of-rounds ns per call, recording BENCHMARK_RECORDS values cycled from 'values'
+// (a power of two long, so picking the next one is a mask rather than a division)
+static double MeasureRecord(const std::vector<uint64_t>& values)
+{
+    LatencyHistogram histogram;
+    size_t mask = values.size() - 1;
+    double best = 1e30;
+    for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+        auto begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < BENCHMARK_RECORDS; i++)
+            histogram.Record(values[i & mask]);
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+        best = (std::min)(best, ns / BENCHMARK_RECORDS);
+    }
+
+    LatencySnapshot snapshot;
+    histogram.Snapshot(snapshot);
+    CHECK(snapshot.total == (uint64_t)BENCHMARK_ROUNDS * BENCHMARK_RECORDS);
+    return best;
+}
+
+static double MeasureAtomicAdd(const std::vector<uint64_t>& values)
+{
+    static std::atomic<uint64_t> counts[LATENCY_BUCKET_COUNT];
+    size_t mask = values.size() - 1;
+    double best = 1e30;
+    for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+        auto begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < BENCHMARK_RECORDS; i++)
+            counts[values[i & mask] % LATENCY_BUCKET_COUNT].fetch_add(1, std::memory_order_relaxed);
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+        best = (std::min)(best, ns / BENCHMARK_RECORDS);
+    }
+    return best;
+}
+
+static double MeasureScope()
+{
+    double best = 1e30;
+    for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < BENCHMARK_RECORDS / 10; i++)
+            LatencyScope scope(LATENCY_FRAME_BUILD);
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+        best = (std::min)(best, ns / (BENCHMARK_RECORDS / 10));
+    }
+    return best;
+}
+
+int main()
+{
+    std::vector<uint64_t> values = MakeValues();
+    TestBuckets(values);
+    TestConcurrentRecorders();
+    TestMerge();
+
+    std::vector<uint64_t> frameTimes = MakeFrameTimes();
+    double record = MeasureRecord(frameTimes);
+    double spread = MeasureRecord(values);
+    double atomicAdd = MeasureAtomicAdd(frameTimes);
+    double scope = MeasureScope();
+    printf("Record %.2f ns per call (%.2f ns spread over every bucket, bare atomic add %.2f ns), "
+           "LatencyScope %.1f ns (clock reads included)\n", record, spread, atomicAdd, scope);
+    CHECK(record < BENCHMARK_BUDGET_NS);
+    return TestResult("LatencyHistogramBenchmark");
+}
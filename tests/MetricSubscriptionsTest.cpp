@@ -0,0 +1,138 @@
+// Metric subscriptions: reference counts and handle reuse, the resolved interval following
+// the fastest live subscriber through SetInterval and unsubscribes, a metric being due as
+// soon as it gains its first subscriber, and widget subscriptions whose repeated
+// Request/Release calls don't touch the hub again
+
+#include "TestSupport.h"
+#include "MetricSubscriptions.h"
+
+static void TestRefcounts()
+{
+    MetricSubscriptions hub;
+    CHECK(!hub.HasSubscribers(METRIC_MEMORY));
+    CHECK(hub.GetInterval(METRIC_MEMORY) == 0);
+
+    int first = hub.Subscribe(METRIC_MEMORY, 1000);
+    int second = hub.Subscribe(METRIC_MEMORY, 1000);
+    int other = hub.Subscribe(METRIC_BATTERY, 5000);
+    CHECK(first != second && second != other && first != other);
+    CHECK(hub.GetSubscriberCount(METRIC_MEMORY) == 2);
+    CHECK(hub.GetSubscriberCount(METRIC_BATTERY) == 1);
+
+    hub.Unsubscribe(first);
+    CHECK(hub.GetSubscriberCount(METRIC_MEMORY) == 1);
+
+    // A stale or unknown handle changes nothing
+    hub.Unsubscribe(first);
+    hub.Unsubscribe(-1);
+    hub.Unsubscribe(1000);
+    hub.SetInterval(first, 10);
+    CHECK(hub.GetSubscriberCount(METRIC_MEMORY) == 1);
+    CHECK(hub.GetInterval(METRIC_MEMORY) == 1000);
+
+    // The freed handle is handed out again, for whatever metric comes next
+    int reused = hub.Subscribe(METRIC_STORAGE, 2000);
+    CHECK(reused == first);
+    CHECK(hub.GetSubscriberCount(METRIC_STORAGE) == 1);
+    CHECK(hub.GetSubscriberCount(METRIC_MEMORY) == 1);
+
+    hub.Unsubscribe(second);
+    hub.Unsubscribe(other);
+    hub.Unsubscribe(reused);
+    CHECK(!hub.HasSubscribers(METRIC_MEMORY) && !hub.HasSubscribers(METRIC_BATTERY) &&
+          !hub.HasSubscribers(METRIC_STORAGE));
+    CHECK(hub.GetInterval(METRIC_MEMORY) == 0 && hub.GetInterval(METRIC_STORAGE) == 0);
+}
+
+static void TestIntervalResolution()
+{
+    MetricSubscriptions hub;
+    int slow = hub.Subscribe(METRIC_CPU_USAGE, 2000);
+    CHECK(hub.GetInterval(METRIC_CPU_USAGE) == 2000);
+    int fast = hub.Subscribe(METRIC_CPU_USAGE, 500);
+    int medium = hub.Subscribe(METRIC_CPU_USAGE, 1000);
+    CHECK(hub.GetInterval(METRIC_CPU_USAGE) == 500);
+
+    // Faster and slower changes from any subscriber
+    hub.SetInterval(slow, 250);
+    CHECK(hub.GetInterval(METRIC_CPU_USAGE) == 250);
+    hub.SetInterval(slow, 4000);
+    CHECK(hub.GetInterval(METRIC_CPU_USAGE) == 500);
+
+    // The fastest leaving hands over to the next fastest
+    hub.Unsubscribe(fast);
+    CHECK(hub.GetInterval(METRIC_CPU_USAGE) == 1000);
+    hub.Unsubscribe(medium);
+    CHECK(hub.GetInterval(METRIC_CPU_USAGE) == 4000);
+
+    // Other metrics are resolved on their own
+    hub.Subscribe(METRIC_PROCESSES, 100);
+    CHECK(hub.GetInterval(METRIC_CPU_USAGE) == 4000);
+    CHECK(hub.GetInterval(METRIC_PROCESSES) == 100);
+}
+
+static void TestIsDue()
+{
+    MetricSubscriptions hub;
+    CHECK(!hub.IsDue(METRIC_NETWORK_SPEED, 0));
+
+    int handle = hub.Subscribe(METRIC_NETWORK_SPEED, 1000);
+    CHECK(hub.IsDue(METRIC_NETWORK_SPEED, 0));
+    hub.MarkSampled(METRIC_NETWORK_SPEED, 50000);
+    CHECK(!hub.IsDue(METRIC_NETWORK_SPEED, 50999));
+    CHECK(hub.IsDue(METRIC_NETWORK_SPEED, 51000));
+
+    // A second subscriber doesn't force an early sample, a new first one after a gap does
+    int second = hub.Subscribe(METRIC_NETWORK_SPEED, 1000);
+    CHECK(!hub.IsDue(METRIC_NETWORK_SPEED, 50500));
+    hub.Unsubscribe(handle);
+    hub.Unsubscribe(second);
+    CHECK(!hub.IsDue(METRIC_NETWORK_SPEED, 60000));
+    hub.Subscribe(METRIC_NETWORK_SPEED, 1000);
+    CHECK(hub.IsDue(METRIC_NETWORK_SPEED, 50001));
+}
+
+static void TestWidgetSubscription()
+{
+    MetricSubscriptions hub;
+    {
+        MetricSubscription widget(hub, METRIC_CONNECTIONS);
+        CHECK(!widget.IsActive());
+
+        widget.Request(true, 1000);
+        widget.Request(true, 1000);
+        CHECK(widget.IsActive());
+        CHECK(hub.GetSubscriberCount(METRIC_CONNECTIONS) == 1);
+
+        widget.Request(true, 250);
+        CHECK(hub.GetSubscriberCount(METRIC_CONNECTIONS) == 1);
+        CHECK(hub.GetInterval(METRIC_CONNECTIONS) == 250);
+
+        // Going off screen releases once; further releases are no-ops
+        MetricSubscription other(hub, METRIC_CONNECTIONS);
+        other.Request(true, 2000);
+        widget.Request(false, 250);
+        widget.Request(false, 250);
+        widget.Release();
+        CHECK(!widget.IsActive());
+        CHECK(hub.GetSubscriberCount(METRIC_CONNECTIONS) == 1);
+        CHECK(hub.GetInterval(METRIC_CONNECTIONS) == 2000);
+
+        widget.Request(true, 500);
+        CHECK(hub.GetSubscriberCount(METRIC_CONNECTIONS) == 2);
+        CHECK(hub.GetInterval(METRIC_CONNECTIONS) == 500);
+    }
+
+    // Both released on destruction
+    CHECK(!hub.HasSubscribers(METRIC_CONNECTIONS));
+    CHECK(hub.GetInterval(METRIC_CONNECTIONS) == 0);
+}
+
+int main()
+{
+    TestRefcounts();
+    TestIntervalResolution();
+    TestIsDue();
+    TestWidgetSubscription();
+    return TestResult("MetricSubscriptionsTest");
+}
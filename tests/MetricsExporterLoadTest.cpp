@@ -0,0 +1,224 @@
+// Metrics exporter under load: responses and 404s, a request that trickles in, thousands
+// of scrapes from concurrent clients while snapshots keep being published and a crowd of
+// idle connections sits open, and those idle clients being dropped at their deadline
+// without having delayed anyone
+
+#include "TestSupport.h"
+#include "MetricsExporter.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <vector>
+
+static const int IDLE_CLIENTS = 32;
+static const int SCRAPE_THREADS = 4;
+static const int SCRAPES_PER_THREAD = 500;
+
+static int Connect(uint16_t port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static std::string ReadAll(int fd)
+{
+    std::string text;
+    char chunk[4096];
+    ssize_t received;
+    while ((received = recv(fd, chunk, sizeof(chunk), 0)) > 0)
+        text.append(chunk, received);
+    return text;
+}
+
+// One full request/response round trip; empty on failure
+static std::string Fetch(uint16_t port, const char* request)
+{
+    int fd = Connect(port);
+    if (fd < 0)
+        return std::string();
+    send(fd, request, strlen(request), MSG_NOSIGNAL);
+    std::string response = ReadAll(fd);
+    close(fd);
+    return response;
+}
+
+static MetricsSnapshot MakeSnapshot(double cpu)
+{
+    MetricsSnapshot snapshot;
+    snapshot.cpuUsagePercent = cpu;
+    snapshot.cpuTemperatureCelsius = 55.0;
+    snapshot.memoryUsedBytes = 4ull << 30;
+    snapshot.memoryTotalBytes = 16ull << 30;
+    snapshot.downloadBytesPerSec = 1000.0;
+    snapshot.uploadBytesPerSec = 200.0;
+    return snapshot;
+}
+
+static void TestResponses(MetricsExporter& exporter)
+{
+    exporter.Publish(MakeSnapshot(12.5));
+    uint16_t port = exporter.GetPort();
+
+    std::string response = Fetch(port, "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    CHECK(response.compare(0, 15, "HTTP/1.1 200 OK") == 0);
+    CHECK(response.find("overlay_cpu_usage_percent 12.5\n") != std::string::npos);
+    CHECK(response.find("overlay_memory_total_bytes 17179869184\n") != std::string::npos);
+    CHECK(response.find("overlay_battery_percent") == std::string::npos);
+
+    // Content-Length matches the body, which ends the OpenMetrics way
+    size_t bodyStart = response.find("\r\n\r\n");
+    int contentLength = -1;
+    const char* lengthField = strstr(response.c_str(), "Content-Length: ");
+    if (lengthField)
+        contentLength = atoi(lengthField + 16);
+    CHECK(bodyStart != std::string::npos && contentLength == (int)(response.size() - bodyStart - 4));
+    CHECK(response.size() >= 6 && response.compare(response.size() - 6, 6, "# EOF\n") == 0);
+
+    // A new snapshot shows up in the next scrape
+    exporter.Publish(MakeSnapshot(80.0));
+    CHECK(Fetch(port, "GET / HTTP/1.1\r\n\r\n").find("overlay_cpu_usage_percent 80.0\n") != std::string::npos);
+
+    CHECK(Fetch(port, "GET /other HTTP/1.1\r\n\r\n").compare(0, 22, "HTTP/1.1 404 Not Found") == 0);
+    CHECK(Fetch(port, "POST /metrics HTTP/1.1\r\n\r\n").compare(0, 22, "HTTP/1.1 404 Not Found") == 0);
+
+    // A request split across several packets is put back together
+    int fd = Connect(port);
+    CHECK(fd >= 0);
+    send(fd, "GET /met", 8, MSG_NOSIGNAL);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    send(fd, "rics HTTP/1.1\r\n", 15, MSG_NOSIGNAL);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    send(fd, "\r\n", 2, MSG_NOSIGNAL);
+    CHECK(ReadAll(fd).find("overlay_cpu_usage_percent 80.0\n") != std::string::npos);
+    close(fd);
+
+    // Connecting and leaving without a word costs nothing and counts as nothing
+    uint64_t scrapes = exporter.GetScrapeCount();
+    close(Connect(port));
+    CHECK(Fetch(port, "GET /metrics HTTP/1.1\r\n\r\n").find("200 OK") != std::string::npos);
+    CHECK(exporter.GetScrapeCount() == scrapes + 1);
+}
+
+static void TestLoad(MetricsExporter& exporter)
+{
+    uint16_t port = exporter.GetPort();
+    uint64_t timedOutBefore = exporter.GetTimedOutCount();
+
+    // Connections that never send anything; with the old one-client-at-a-time loop each of
+    // these held everyone else up for a full second
+    std::vector<int> idle;
+    for (int i = 0; i < IDLE_CLIENTS; i++) {
+        int fd = Connect(port);
+        CHECK(fd >= 0);
+        idle.push_back(fd);
+    }
+
+    std::atomic<bool> publishing{ true };
+    std::thread publisher([&]() {
+        for (int i = 0; publishing.load(); i++) {
+            exporter.Publish(MakeSnapshot(i % 100));
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+    });
+
+    std::atomic<int> failures{ 0 };
+    std::vector<std::vector<double>> latencies(SCRAPE_THREADS);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> scrapers;
+    for (int t = 0; t < SCRAPE_THREADS; t++) {
+        scrapers.emplace_back([&, t]() {
+            for (int i = 0; i < SCRAPES_PER_THREAD; i++) {
+                auto begin = std::chrono::steady_clock::now();
+                std::string response = Fetch(port, "GET /metrics HTTP/1.1\r\n\r\n");
+                auto end = std::chrono::steady_clock::now();
+                if (response.compare(0, 15, "HTTP/1.1 200 OK") != 0 || response.find("# EOF\n") == std::string::npos)
+                    failures++;
+                latencies[t].push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+            }
+        });
+    }
+    for (auto& scraper : scrapers)
+        scraper.join();
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    publishing = false;
+    publisher.join();
+
+    std::vector<double> all;
+    for (const auto& list : latencies)
+        all.insert(all.end(), list.begin(), list.end());
+    std::sort(all.begin(), all.end());
+    double p50 = all[all.size() / 2];
+    double p99 = all[all.size() * 99 / 100];
+    printf("%zu scrapes with %d idle connections open: %.0f ms total, p50 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+           all.size(), IDLE_CLIENTS, elapsedMs, p50, p99, all.back());
+
+    CHECK(failures == 0);
+    CHECK(exporter.GetScrapeCount() >= (uint64_t)(SCRAPE_THREADS * SCRAPES_PER_THREAD));
+
+    // Well under the idle clients' deadline: nobody waited for them
+    CHECK(p99 < EXPORTER_CLIENT_TIMEOUT_MS / 10.0);
+    CHECK(elapsedMs < EXPORTER_CLIENT_TIMEOUT_MS * 5.0);
+
+    // The idle ones are dropped once their deadline passes
+    std::this_thread::sleep_for(std::chrono::milliseconds(EXPORTER_CLIENT_TIMEOUT_MS + 300));
+    CHECK(exporter.GetTimedOutCount() - timedOutBefore == (uint64_t)IDLE_CLIENTS);
+    for (int fd : idle) {
+        CHECK(ReadAll(fd).empty());
+        close(fd);
+    }
+}
+
+static void TestCapacity(MetricsExporter& exporter)
+{
+    // More idle connections than slots: the surplus waits in the backlog, and a scrape
+    // queued behind them is still served once the first batch times out
+    uint16_t port = exporter.GetPort();
+    std::vector<int> idle;
+    for (int i = 0; i < EXPORTER_MAX_CLIENTS; i++)
+        idle.push_back(Connect(port));
+
+    auto begin = std::chrono::steady_clock::now();
+    std::string response = Fetch(port, "GET /metrics HTTP/1.1\r\n\r\n");
+    double waitedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    CHECK(response.find("200 OK") != std::string::npos);
+    CHECK(waitedMs >= EXPORTER_CLIENT_TIMEOUT_MS * 0.8);
+    CHECK(waitedMs < EXPORTER_CLIENT_TIMEOUT_MS * 3.0);
+    for (int fd : idle)
+        close(fd);
+}
+
+int main()
+{
+    MetricsExporter exporter;
+    CHECK(exporter.Start(0));
+    CHECK(exporter.GetPort() != 0);
+
+    // The port is taken while it runs
+    MetricsExporter second;
+    CHECK(!second.Start(exporter.GetPort()));
+
+    TestResponses(exporter);
+    TestLoad(exporter);
+    TestCapacity(exporter);
+
+    // Stop returns promptly even with nothing to wake the loop but the stop signal
+    auto begin = std::chrono::steady_clock::now();
+    exporter.Stop();
+    double stopMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    CHECK(stopMs < 100.0);
+    CHECK(!exporter.IsRunning());
+    return TestResult("MetricsExporterLoadTest");
+}
@@ -0,0 +1,241 @@
+// Plugin host with real shared objects (tests/plugins): the loader's reasons for refusing a
+// missing file, something that isn't a library, no entry point, a plugin that declines, a
+// different API version and no metrics; the sample-slot contract as seen from inside a
+// plugin (open first, the same slots every call with 'valid' cleared, one call at a time,
+// RETRY not published, close on stop, nothing called while paused); and the watchdog giving
+// up on a call that never returns, abandoning its thread, keeping the other plugin going and
+// never unloading the hung library
+
+#include "TestSupport.h"
+#include "PluginHost.h"
+#include <chrono>
+#include <cstring>
+#include <dlfcn.h>
+#include <functional>
+#include <thread>
+
+#define WATCHDOG_MS 200
+
+static const std::string ACCEPTED = TEST_PLUGIN_DIRECTORY "/accepted";
+static const std::string REJECTED = TEST_PLUGIN_DIRECTORY "/rejected";
+
+static uint64_t NowMs()
+{
+    return Clock::System().NowNs() / 1000000;
+}
+
+// Poll until the condition holds; false if it didn't within the time given
+static bool WaitFor(const std::function<bool()>& condition, uint64_t timeoutMs)
+{
+    uint64_t end = NowMs() + timeoutMs;
+    while (!condition()) {
+        if (NowMs() > end)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+// A test hook exported by a plugin the host has loaded; null if the library isn't loaded
+template <typename Fn>
+static Fn FindHook(const std::string& library, const char* name)
+{
+    void* handle = dlopen(library.c_str(), RTLD_NOW | RTLD_NOLOAD);
+    if (!handle)
+        return nullptr;
+    Fn hook = reinterpret_cast<Fn>(dlsym(handle, name));
+    dlclose(handle);
+    return hook;
+}
+
+static bool IsLoaded(const std::string& library)
+{
+    void* handle = dlopen(library.c_str(), RTLD_NOW | RTLD_NOLOAD);
+    if (handle)
+        dlclose(handle);
+    return handle != nullptr;
+}
+
+static double LatestValue(const PluginHost& host, size_t plugin, uint32_t metric)
+{
+    OverlayPluginSample samples[OVERLAY_PLUGIN_MAX_METRICS];
+    return host.ReadSamples(plugin, samples, OVERLAY_PLUGIN_MAX_METRICS) > metric ? samples[metric].value : 0.0;
+}
+
+static bool HasError(const std::vector<std::string>& errors, const std::string& path, const char* reason)
+{
+    for (const auto& error : errors) {
+        if (error.compare(0, path.size(), path) == 0 && error.find(reason) != std::string::npos)
+            return true;
+    }
+    return false;
+}
+
+static void TestLoader(const std::string& root)
+{
+    PluginHost host;
+    CHECK(!host.Load(root + "/missing.so"));
+    WriteTestFile(root + "/garbage.so", "not a shared object");
+    CHECK(!host.Load(root + "/garbage.so"));
+    CHECK(host.LoadDirectory(root + "/nowhere") == 0);
+
+    CHECK(host.LoadDirectory(REJECTED) == 0);
+    CHECK(host.GetPluginCount() == 0);
+    CHECK(!host.Start());
+    const auto& errors = host.GetLoadErrors();
+    CHECK(errors.size() == 6);
+    CHECK(HasError(errors, root + "/missing.so", "No such file"));
+    CHECK(HasError(errors, root + "/garbage.so", ""));
+    CHECK(HasError(errors, REJECTED + "/NoEntryPointPlugin.so", "no " OVERLAY_PLUGIN_ENTRY_POINT " export"));
+    CHECK(HasError(errors, REJECTED + "/DeclinesPlugin.so", "declined"));
+    CHECK(HasError(errors, REJECTED + "/WrongVersionPlugin.so", "different plugin API version"));
+    CHECK(HasError(errors, REJECTED + "/NoMetricsPlugin.so", "invalid plugin description"));
+
+    // Refused libraries aren't left loaded
+    CHECK(!IsLoaded(REJECTED + "/DeclinesPlugin.so"));
+    CHECK(!IsLoaded(REJECTED + "/NoMetricsPlugin.so"));
+
+    // Accepted ones load in name order with their descriptions copied
+    CHECK(host.LoadDirectory(ACCEPTED) == 2);
+    CHECK(host.GetPluginCount() == 2);
+    CHECK(strcmp(host.GetPluginName(0), "Contract") == 0 && strcmp(host.GetPluginName(1), "Hanging") == 0);
+    CHECK(host.GetMetricCount(0) == 3 && host.GetMetricCount(1) == 1);
+    CHECK(strcmp(host.GetMetric(0, 1).name, "Contract violations") == 0);
+    CHECK(host.GetState(0) == PLUGIN_RUNNING);
+
+    OverlayPluginSample samples[OVERLAY_PLUGIN_MAX_METRICS];
+    CHECK(host.ReadSamples(0, samples, OVERLAY_PLUGIN_MAX_METRICS) == 0);
+    host.UnloadAll();
+    CHECK(host.GetPluginCount() == 0 && host.GetLoadErrors().empty());
+    CHECK(!IsLoaded(ACCEPTED + "/ContractPlugin.so"));
+}
+
+static void TestSampleContract()
+{
+    const std::string path = ACCEPTED + "/ContractPlugin.so";
+    PluginHost host;
+    CHECK(host.Load(path));
+    host.SetWatchdogMs(WATCHDOG_MS * 5);
+    auto closes = FindHook<unsigned (*)()>(path, "ContractPluginCloses");
+    CHECK(closes != nullptr);
+    if (!closes)
+        return;
+    unsigned closesBefore = closes();
+
+    // Watch what gets published while the plugin runs for a while
+    CHECK(host.Start());
+    bool published = true;
+    bool retryPublished = false;
+    bool wentBack = false;
+    double lastCalls = 0.0;
+    uint64_t lastTimestamp = 0;
+    uint64_t end = NowMs() + 700;
+    while (NowMs() < end) {
+        OverlayPluginSample samples[OVERLAY_PLUGIN_MAX_METRICS];
+        uint64_t timestamp = 0;
+        uint32_t count = host.ReadSamples(0, samples, OVERLAY_PLUGIN_MAX_METRICS, &timestamp);
+        if (count == 0) {
+            published = published && lastCalls == 0.0;    // Once published, always something
+        }
+        else {
+            published = published && count == 3 && samples[0].valid && samples[1].valid && !samples[2].valid;
+            retryPublished = retryPublished || static_cast<uint64_t>(samples[0].value) % 4 == 0;
+            wentBack = wentBack || samples[0].value < lastCalls || timestamp < lastTimestamp;
+            lastCalls = samples[0].value;
+            lastTimestamp = timestamp;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    CHECK(published);
+    CHECK(!retryPublished);
+    CHECK(!wentBack);
+    CHECK(lastCalls >= 3.0);
+    CHECK(host.GetState(0) == PLUGIN_RUNNING);
+
+    // Paused: nothing is called
+    host.SetPaused(true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    double pausedAt = LatestValue(host, 0, 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    CHECK(LatestValue(host, 0, 0) == pausedAt);
+    host.SetPaused(false);
+    CHECK(WaitFor([&] { return LatestValue(host, 0, 0) > pausedAt; }, 1000));
+
+    // Stop closes the plugin; a restart opens it again
+    host.Stop();
+    CHECK(closes() == closesBefore + 1);
+    double stoppedAt = LatestValue(host, 0, 0);
+    CHECK(host.Start());
+    CHECK(WaitFor([&] { return LatestValue(host, 0, 0) > stoppedAt; }, 1000));
+    host.Stop();
+    CHECK(closes() == closesBefore + 2);
+
+    // Checked from inside the plugin on every call
+    CHECK(LatestValue(host, 0, 1) == 0.0);
+    printf("contract plugin: %.0f calls, %u closes, %.0f violations\n", LatestValue(host, 0, 0), closes(),
+           LatestValue(host, 0, 1));
+}
+
+static void TestWatchdog()
+{
+    const std::string hangingPath = ACCEPTED + "/HangingPlugin.so";
+    PluginHost host;
+    CHECK(host.LoadDirectory(ACCEPTED) == 2);
+    host.SetWatchdogMs(WATCHDOG_MS);
+    auto calls = FindHook<unsigned (*)()>(hangingPath, "HangingPluginCalls");
+    auto stuck = FindHook<int (*)()>(hangingPath, "HangingPluginStuck");
+    auto release = FindHook<void (*)()>(hangingPath, "HangingPluginRelease");
+    CHECK(calls && stuck && release);
+    if (!calls || !stuck || !release)
+        return;
+
+    // The second call hangs; the watchdog gives up on it after the limit, not before
+    CHECK(host.Start());
+    CHECK(WaitFor([&] { return stuck() != 0; }, 2000));
+    uint64_t stuckAtMs = NowMs();
+    CHECK(WaitFor([&] { return host.GetState(1) == PLUGIN_HUNG; }, WATCHDOG_MS * 10));
+    uint64_t detectedMs = NowMs() - stuckAtMs;
+    printf("hung call abandoned after %llu ms (watchdog %d ms)\n", (unsigned long long)detectedMs, WATCHDOG_MS);
+    CHECK(detectedMs + 20 >= WATCHDOG_MS);    // Less only by how late this thread noticed
+    CHECK(host.GetState(0) == PLUGIN_RUNNING);
+    CHECK(LatestValue(host, 1, 0) == 1.0);
+
+    // A fresh collection thread keeps the other plugin going
+    double contractCalls = LatestValue(host, 0, 0);
+    CHECK(WaitFor([&] { return LatestValue(host, 0, 0) >= contractCalls + 2; }, 1000));
+
+    // When the abandoned call finally returns, its thread leaves without publishing or
+    // calling anything else
+    release();
+    CHECK(WaitFor([&] { return stuck() == 0; }, 1000));
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    CHECK(host.GetState(1) == PLUGIN_HUNG);
+    CHECK(LatestValue(host, 1, 0) == 1.0);
+    CHECK(calls() == 2);
+
+    // Stopping doesn't wait on it, and a hung plugin gets no second chance
+    uint64_t stopStartMs = NowMs();
+    host.Stop();
+    CHECK(NowMs() - stopStartMs < WATCHDOG_MS);
+    CHECK(host.Start());
+    contractCalls = LatestValue(host, 0, 0);
+    CHECK(WaitFor([&] { return LatestValue(host, 0, 0) > contractCalls; }, 1000));
+    host.Stop();
+    CHECK(host.GetState(1) == PLUGIN_HUNG);
+    CHECK(calls() == 2);
+
+    // The hung library stays mapped, since its code may still be running
+    host.UnloadAll();
+    CHECK(IsLoaded(hangingPath));
+    CHECK(!IsLoaded(ACCEPTED + "/ContractPlugin.so"));
+}
+
+int main()
+{
+    std::string root = MakeTestDirectory("plugins");
+    TestLoader(root);
+    TestSampleContract();
+    TestWatchdog();
+    RemoveTestDirectory(root);
+    return TestResult("PluginHostTest");
+}
@@ -0,0 +1,161 @@
+// Power policy fed simulated power events: AC and desktop machines at full rate, battery
+// at Balanced, the low-battery threshold and its +3% hysteresis on the way back up, both
+// forced modes ignoring events, and a forced Saver not leaving stale hysteresis behind when
+// the user goes back to Automatic. Every step checks the frame cap and sample interval the
+// rest of the overlay would apply.
+
+#include "TestSupport.h"
+#include "PowerPolicy.h"
+
+static PowerStatus OnBattery(int percent)
+{
+    PowerStatus status;
+    status.onAC = false;
+    status.hasBattery = true;
+    status.batteryPercent = percent;
+    return status;
+}
+
+static PowerStatus OnAC(int percent)
+{
+    PowerStatus status = OnBattery(percent);
+    status.onAC = true;
+    return status;
+}
+
+// One power event and the profile that should be active after it
+struct PowerStep {
+    PowerStatus status;
+    const PowerProfile* expected;
+    bool changed;
+};
+
+// Feeds the events in order; returns how many steps ended up somewhere unexpected
+template <size_t N>
+static int Replay(PowerPolicy& policy, const PowerStep (&steps)[N])
+{
+    int mismatches = 0;
+    for (const PowerStep& step : steps) {
+        bool changed = policy.Update(step.status);
+        const PowerProfile& profile = policy.GetProfile();
+        if (&profile != step.expected || changed != step.changed ||
+            profile.frameCap != step.expected->frameCap || profile.sampleIntervalMs != step.expected->sampleIntervalMs) {
+            fprintf(stderr, "battery %d%% on %s: got %s, expected %s\n", step.status.batteryPercent,
+                    step.status.onAC ? "AC" : "DC", profile.name, step.expected->name);
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+static void TestProfiles()
+{
+    // What each profile tells the frame pacer and the samplers
+    CHECK(PowerPolicy::Performance().frameCap == 0 && PowerPolicy::Performance().sampleIntervalMs == 250);
+    CHECK(PowerPolicy::Balanced().frameCap == 30 && PowerPolicy::Balanced().sampleIntervalMs == 1000);
+    CHECK(PowerPolicy::Saver().frameCap == 15 && PowerPolicy::Saver().sampleIntervalMs == 3000);
+    CHECK(PowerPolicy::Performance().allowVisualizer && !PowerPolicy::Saver().allowVisualizer);
+
+    // A desktop reports no battery and is never throttled
+    PowerPolicy policy;
+    PowerStatus desktop;
+    desktop.onAC = false;
+    desktop.hasBattery = false;
+    desktop.batteryPercent = 0;
+    CHECK(!policy.Update(desktop));
+    CHECK(&policy.GetProfile() == &PowerPolicy::Performance());
+    CHECK(policy.GetStatus().batteryPercent == 0);
+}
+
+static void TestAutomatic()
+{
+    PowerPolicy policy;
+    const PowerProfile* performance = &PowerPolicy::Performance();
+    const PowerProfile* balanced = &PowerPolicy::Balanced();
+    const PowerProfile* saver = &PowerPolicy::Saver();
+
+    // Unplug, drain past the 20% threshold, recover only past 23%, plug in at low charge
+    const PowerStep steps[] = {
+        { OnAC(80), performance, false },
+        { OnBattery(80), balanced, true },
+        { OnBattery(21), balanced, false },
+        { OnBattery(20), saver, true },
+        { OnBattery(15), saver, false },
+        { OnBattery(21), saver, false },
+        { OnBattery(23), saver, false },
+        { OnBattery(24), balanced, true },
+        { OnBattery(23), balanced, false },
+        { OnBattery(20), saver, true },
+        { OnAC(10), performance, true },
+        { OnBattery(22), balanced, true },     // Coming off AC: no Saver to hold on to
+    };
+    CHECK(Replay(policy, steps) == 0);
+
+    // A custom threshold moves the hysteresis band with it
+    policy.SetLowBatteryPercent(50);
+    const PowerStep custom[] = {
+        { OnBattery(51), balanced, false },
+        { OnBattery(50), saver, true },
+        { OnBattery(53), saver, false },
+        { OnBattery(54), balanced, true },
+    };
+    CHECK(Replay(policy, custom) == 0);
+}
+
+static void TestForcedModes()
+{
+    PowerPolicy policy;
+    const PowerProfile* performance = &PowerPolicy::Performance();
+    const PowerProfile* balanced = &PowerPolicy::Balanced();
+    const PowerProfile* saver = &PowerPolicy::Saver();
+
+    policy.SetMode(POWER_POLICY_PERFORMANCE);
+    const PowerStep alwaysFull[] = {
+        { OnBattery(5), performance, false },
+        { OnAC(5), performance, false },
+        { OnBattery(90), performance, false },
+    };
+    CHECK(Replay(policy, alwaysFull) == 0);
+
+    policy.SetMode(POWER_POLICY_POWER_SAVER);
+    const PowerStep alwaysSaver[] = {
+        { OnBattery(90), saver, true },
+        { OnAC(100), saver, false },
+        { OnBattery(5), saver, false },
+        { OnBattery(22), saver, false },
+    };
+    CHECK(Replay(policy, alwaysSaver) == 0);
+
+    // Back to Automatic at 22%: above the threshold, and the forced Saver doesn't count as
+    // having been low, so there's no hysteresis to hold it in Saver
+    policy.SetMode(POWER_POLICY_AUTOMATIC);
+    const PowerStep backToAutomatic[] = {
+        { OnBattery(22), balanced, true },
+        { OnBattery(20), saver, true },
+        { OnBattery(22), saver, false },
+    };
+    CHECK(Replay(policy, backToAutomatic) == 0);
+
+    // Forcing Saver while Automatic was already in Saver, then leaving it at 22%, lands in
+    // Balanced too
+    policy.SetMode(POWER_POLICY_POWER_SAVER);
+    CHECK(!policy.Update(OnBattery(22)));
+    policy.SetMode(POWER_POLICY_AUTOMATIC);
+    CHECK(policy.Update(OnBattery(22)));
+    CHECK(&policy.GetProfile() == balanced);
+
+    // Leaving Performance on battery goes straight to what the battery calls for
+    policy.SetMode(POWER_POLICY_PERFORMANCE);
+    CHECK(policy.Update(OnBattery(10)));
+    policy.SetMode(POWER_POLICY_AUTOMATIC);
+    CHECK(policy.Update(OnBattery(10)));
+    CHECK(&policy.GetProfile() == saver);
+}
+
+int main()
+{
+    TestProfiles();
+    TestAutomatic();
+    TestForcedModes();
+    return TestResult("PowerPolicyTest");
+}
@@ -0,0 +1,159 @@
+// Process sampler against the /proc process backend: top-N ranking and exact CPU figures
+// from a synthetic /proc, a reused PID kept apart from the process it replaced, Reset, and
+// a sanity pass over the real /proc
+
+#include "TestSupport.h"
+#include "ProcessSampler.h"
+#include "ProcProcessBackend.h"
+#include <cstring>
+#include <memory>
+#include <sys/stat.h>
+
+static const uint64_t TICKS_PER_SECOND = static_cast<uint64_t>(sysconf(_SC_CLK_TCK));
+static const uint64_t PAGE_SIZE_BYTES = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+
+// utime and stime split the ticks; starttime is field 22 and rss (pages) field 24
+static void WriteProcess(const std::string& root, uint32_t pid, const char* name, uint64_t ticks,
+                         uint64_t startTime, uint64_t rssPages)
+{
+    char directory[256];
+    snprintf(directory, sizeof(directory), "%s/%u", root.c_str(), pid);
+    mkdir(directory, 0755);
+
+    char text[512];
+    snprintf(text, sizeof(text),
+             "%u (%s) S 1 %u %u 0 -1 4194560 100 0 0 0 %llu %llu 0 0 20 0 1 0 %llu 12345678 %llu 18446744073709551615\n",
+             pid, name, pid, pid, (unsigned long long)(ticks - ticks / 2), (unsigned long long)(ticks / 2),
+             (unsigned long long)startTime, (unsigned long long)rssPages);
+    WriteTestFile(std::string(directory) + "/stat", text);
+}
+
+static const ProcessStats* FindProcess(const std::vector<ProcessStats>& list, uint32_t pid)
+{
+    for (const ProcessStats& stats : list) {
+        if (stats.pid == pid)
+            return &stats;
+    }
+    return nullptr;
+}
+
+static void TestRanking()
+{
+    std::string root = MakeTestDirectory("process-sampler");
+    WriteTestFile(root + "/stat", "cpu  1 2 3 4\n");    // Non-process entries are skipped
+    WriteProcess(root, 1, "init", 100, 10, 1000);
+    WriteProcess(root, 42, "Web Content", 0, 500, 50000);
+    WriteProcess(root, 77, "a) b", 0, 600, 20000);       // comm may hold ") "
+    WriteProcess(root, 300, "idle", 0, 700, 10);
+
+    FakeClock clock(1000000000ull);
+    ProcessSampler sampler(std::make_unique<ProcProcessBackend>(root, 2), clock);
+    sampler.SetTopCount(3);
+    CHECK(sampler.Sample());
+    CHECK(sampler.GetProcessCount() == 4);
+
+    // Memory is ranked from the first snapshot; CPU needs two
+    const std::vector<ProcessStats>& memory = sampler.GetTopByMemory();
+    CHECK(memory.size() == 3);
+    if (memory.size() == 3) {
+        CHECK(memory[0].pid == 42 && strcmp(memory[0].name, "Web Content") == 0);
+        CHECK(memory[0].workingSet == 50000 * PAGE_SIZE_BYTES);
+        CHECK(memory[1].pid == 77 && strcmp(memory[1].name, "a) b") == 0);
+        CHECK(memory[2].pid == 1);
+    }
+    CHECK(sampler.GetTopByCpu().empty());
+
+    // One second on two processors: a full second of CPU is 50%, a quarter second 12.5%
+    WriteProcess(root, 1, "init", 100 + TICKS_PER_SECOND / 4, 10, 1000);
+    WriteProcess(root, 42, "Web Content", TICKS_PER_SECOND, 500, 50000);
+    WriteProcess(root, 77, "a) b", TICKS_PER_SECOND / 2, 600, 20000);
+    clock.AdvanceMs(1000);
+    CHECK(sampler.Sample());
+    const std::vector<ProcessStats>& cpu = sampler.GetTopByCpu();
+    CHECK(cpu.size() == 3);
+    if (cpu.size() == 3) {
+        CHECK(cpu[0].pid == 42);
+        CHECK_NEAR(cpu[0].cpuPercent, 50.0, 1e-9);
+        CHECK(cpu[1].pid == 77);
+        CHECK_NEAR(cpu[1].cpuPercent, 25.0, 1e-9);
+        CHECK(cpu[2].pid == 1);
+        CHECK_NEAR(cpu[2].cpuPercent, 12.5, 1e-9);
+    }
+    CHECK_NEAR(sampler.GetTotalCpuPercent(), 87.5, 1e-9);
+
+    // pid 42 exits and the PID is reused by a process with a new start time and a larger
+    // CPU total: that must be a fresh baseline, not a delta against the old process
+    RemoveTestDirectory(root + "/42");
+    WriteProcess(root, 42, "make", 5 * TICKS_PER_SECOND, 900, 3000);
+    sampler.SetTopCount(MAX_TOP_PROCESSES);
+    clock.AdvanceMs(1000);
+    CHECK(sampler.Sample());
+    CHECK(sampler.GetProcessCount() == 4);
+    const ProcessStats* reused = FindProcess(sampler.GetTopByCpu(), 42);
+    CHECK(reused && strcmp(reused->name, "make") == 0);
+    CHECK(reused && reused->cpuPercent == 0.0);
+    CHECK_NEAR(sampler.GetTotalCpuPercent(), 0.0, 1e-9);
+
+    // From here on it's measured against its own baseline
+    WriteProcess(root, 42, "make", 5 * TICKS_PER_SECOND + TICKS_PER_SECOND / 2, 900, 3000);
+    clock.AdvanceMs(1000);
+    CHECK(sampler.Sample());
+    reused = FindProcess(sampler.GetTopByCpu(), 42);
+    CHECK(reused != nullptr);
+    if (reused)
+        CHECK_NEAR(reused->cpuPercent, 25.0, 1e-9);
+
+    // Reset drops the snapshot along with the baselines
+    sampler.Reset();
+    CHECK(sampler.GetProcessCount() == 0);
+    CHECK(sampler.GetTopByCpu().empty());
+    CHECK(sampler.GetTopByMemory().empty());
+    CHECK(sampler.Sample());
+    CHECK(sampler.GetTopByCpu().empty());
+    CHECK(sampler.GetProcessCount() == 4);
+
+    RemoveTestDirectory(root);
+
+    ProcessSampler broken(std::make_unique<ProcProcessBackend>("/nonexistent-proc", 2), clock);
+    CHECK(!broken.Sample());
+}
+
+static void TestRealProc()
+{
+    ProcessSampler sampler(std::make_unique<ProcProcessBackend>());
+    if (!sampler.Sample()) {
+        printf("no readable /proc, skipping the live pass\n");
+        return;
+    }
+    sampler.SetTopCount(MAX_TOP_PROCESSES);
+    CHECK(sampler.GetProcessCount() > 0);
+
+    // Burn a little CPU so this process has something to report
+    usleep(50000);
+    volatile uint64_t sink = 0;
+    for (uint64_t i = 0; i < 50000000; i++)
+        sink += i;
+    CHECK(sampler.Sample());
+    CHECK(sampler.GetTotalCpuPercent() >= 0.0);
+
+    std::vector<ProcessRecord> records;
+    ProcProcessBackend backend;
+    CHECK(backend.Snapshot(records));
+    bool foundSelf = false;
+    for (const ProcessRecord& record : records) {
+        if (record.pid == static_cast<uint32_t>(getpid())) {
+            foundSelf = true;
+            CHECK(record.cpuTimeNs > 0);
+            CHECK(record.workingSet > 0);
+            CHECK(record.startTime > 0);
+        }
+    }
+    CHECK(foundSelf);
+}
+
+int main()
+{
+    TestRanking();
+    TestRealProc();
+    return TestResult("ProcessSamplerTest");
+}
@@ -0,0 +1,109 @@
+// Rate accuracy with a fake clock: rates divide by the measured interval so jittery
+// sampling doesn't skew them, counters that wrap still give the right delta, readings
+// with no elapsed time are ignored, and the system clock is monotonic and fine-grained
+
+#include "TestSupport.h"
+#include "Clock.h"
+#include "Estimators.h"
+#include <algorithm>
+#include <cmath>
+
+static void TestJitteredIntervals()
+{
+    // A link moving exactly 1.25 MB/s, sampled on a nominal 1 s tick that actually
+    // fires anywhere between 0.9 s and 1.1 s (what a GetTickCount schedule looks like)
+    const double bytesPerSec = 1250000.0;
+    const uint64_t jitterMs[] = { 900, 1100, 1000, 950, 1080, 920, 1010, 1100, 900, 1040 };
+
+    FakeClock clock(5000000000ull);
+    CounterRate<uint64_t> rate;
+    uint64_t bytes = 0;
+    CHECK(!rate.Update(bytes, clock.NowNs()));
+    CHECK(!rate.HasRate());
+
+    double worstMeasured = 0.0;
+    double worstNominal = 0.0;
+    for (uint64_t ms : jitterMs) {
+        uint64_t delta = (uint64_t)(bytesPerSec * ms / 1000.0);
+        bytes += delta;
+        clock.AdvanceMs(ms);
+        CHECK(rate.Update(bytes, clock.NowNs()));
+
+        double nominal = delta / 1.0;
+        worstMeasured = (std::max)(worstMeasured, std::fabs(rate.Get() - bytesPerSec) / bytesPerSec);
+        worstNominal = (std::max)(worstNominal, std::fabs(nominal - bytesPerSec) / bytesPerSec);
+    }
+    printf("worst relative error: measured interval %.2e, nominal interval %.2e\n", worstMeasured, worstNominal);
+    CHECK(worstMeasured < 1e-9);
+    CHECK(worstNominal > 0.09);
+}
+
+static void TestSubMillisecondIntervals()
+{
+    // Millisecond timestamps can't tell 2.4 ms from 2 ms; nanoseconds can
+    FakeClock clock;
+    CounterRate<uint64_t> rate;
+    rate.Update(0, clock.NowNs());
+    clock.Advance(2400000);
+    CHECK(rate.Update(2400, clock.NowNs()));
+    CHECK_NEAR(rate.Get(), 1000000.0, 1e-3);
+}
+
+static void TestWraparound()
+{
+    // 32-bit interface counters wrap every few seconds on a fast link
+    FakeClock clock;
+    CounterRate<uint32_t> rate;
+    rate.Update(0xFFFFF000u, clock.NowNs());
+    clock.AdvanceMs(500);
+    CHECK(rate.Update(0x00001000u, clock.NowNs()));
+    CHECK_NEAR(rate.Get(), 0x2000 * 2.0, 1e-6);
+}
+
+static void TestNoElapsedTime()
+{
+    FakeClock clock;
+    CounterRate<uint64_t> rate;
+    rate.Update(100, clock.NowNs());
+    clock.AdvanceMs(1000);
+    CHECK(rate.Update(1100, clock.NowNs()));
+    CHECK_NEAR(rate.Get(), 1000.0, 1e-9);
+
+    // A second reading with the same timestamp keeps the previous rate instead of
+    // dividing by zero; the next real interval is measured from it
+    CHECK(!rate.Update(5000, clock.NowNs()));
+    CHECK_NEAR(rate.Get(), 1000.0, 1e-9);
+    clock.AdvanceMs(1000);
+    CHECK(rate.Update(5500, clock.NowNs()));
+    CHECK_NEAR(rate.Get(), 500.0, 1e-9);
+
+    rate.Reset();
+    CHECK(!rate.HasRate());
+    CHECK(!rate.Update(6000, clock.NowNs()));
+}
+
+static void TestSystemClock()
+{
+    const Clock& clock = Clock::System();
+    uint64_t previous = clock.NowNs();
+    uint64_t smallestStep = UINT64_MAX;
+    for (int i = 0; i < 100000; i++) {
+        uint64_t now = clock.NowNs();
+        CHECK(now >= previous);
+        if (now > previous)
+            smallestStep = (std::min)(smallestStep, now - previous);
+        previous = now;
+    }
+    printf("smallest system clock step: %llu ns\n", (unsigned long long)smallestStep);
+    CHECK(smallestStep < 1000000);
+}
+
+int main()
+{
+    TestJitteredIntervals();
+    TestSubMillisecondIntervals();
+    TestWraparound();
+    TestNoElapsedTime();
+    TestSystemClock();
+    return TestResult("RateAccuracyTest");
+}
@@ -0,0 +1,105 @@
+// Rectangle set hit-testing: hits on the inclusive edges and misses one pixel outside, Set
+// updating an existing entry in place, swap-remove leaving every other entry reachable
+// (first, middle and last), and Has/Contains turning false once an entry is removed
+
+#include "TestSupport.h"
+#include "RectSet.h"
+
+static void TestInclusiveEdges()
+{
+    RectSet rects;
+    CHECK(!rects.Contains(0, 0));
+    rects.Set(1, 10, 20, 110, 70);
+
+    // Corners and edge midpoints are inside
+    CHECK(rects.Contains(10, 20) && rects.Contains(110, 20) && rects.Contains(10, 70) && rects.Contains(110, 70));
+    CHECK(rects.Contains(60, 20) && rects.Contains(60, 70) && rects.Contains(10, 45) && rects.Contains(110, 45));
+    CHECK(rects.Contains(60, 45));
+
+    // One pixel past any edge is outside
+    CHECK(!rects.Contains(9, 45) && !rects.Contains(111, 45) && !rects.Contains(60, 19) && !rects.Contains(60, 71));
+    CHECK(!rects.Contains(9, 19) && !rects.Contains(111, 71));
+
+    // A single-pixel rectangle, and one at negative (left/above the primary monitor) coordinates
+    rects.Set(2, 500, 500, 500, 500);
+    CHECK(rects.Contains(500, 500) && !rects.Contains(501, 500) && !rects.Contains(500, 499));
+    rects.Set(3, -1920, -200, -1, 879);
+    CHECK(rects.Contains(-1920, -200) && rects.Contains(-1, 879) && !rects.Contains(0, 0));
+}
+
+static void TestSetUpdatesInPlace()
+{
+    RectSet rects;
+    rects.Set(0xA, 0, 0, 10, 10);
+    rects.Set(0xB, 100, 100, 110, 110);
+    rects.Set(0xC, 200, 200, 210, 210);
+
+    // Moving a window updates its entry without adding one or reordering
+    rects.Set(0xB, 300, 300, 320, 320);
+    const auto& list = rects.GetRects();
+    CHECK(list.size() == 3);
+    CHECK(list[1].id == 0xB && list[1].left == 300 && list[1].top == 300 && list[1].right == 320 &&
+          list[1].bottom == 320);
+    CHECK(!rects.Contains(105, 105));
+    CHECK(rects.Contains(310, 310));
+    CHECK(list[0].id == 0xA && list[2].id == 0xC);
+}
+
+static void TestSwapRemove()
+{
+    const int count = 6;
+    for (int removed = 0; removed < count; removed++) {
+        RectSet rects;
+        for (int i = 0; i < count; i++)
+            rects.Set(static_cast<uintptr_t>(i + 1), i * 100, 0, i * 100 + 50, 50);
+
+        rects.Remove(static_cast<uintptr_t>(removed + 1));
+        CHECK(rects.GetRects().size() == count - 1);
+        CHECK(!rects.Has(static_cast<uintptr_t>(removed + 1)));
+        CHECK(!rects.Contains(removed * 100 + 25, 25));
+
+        // Everything else is still there, with its own rectangle
+        for (int i = 0; i < count; i++) {
+            if (i == removed)
+                continue;
+            CHECK(rects.Has(static_cast<uintptr_t>(i + 1)));
+            CHECK(rects.Contains(i * 100, 0) && rects.Contains(i * 100 + 50, 50));
+        }
+    }
+}
+
+static void TestRemove()
+{
+    RectSet rects;
+    rects.Set(7, 0, 0, 100, 100);
+    rects.Set(8, 50, 50, 150, 150);
+
+    // Overlapping rectangles: the shared area stays a hit until both are gone
+    rects.Remove(7);
+    CHECK(!rects.Has(7) && rects.Has(8));
+    CHECK(!rects.Contains(25, 25) && rects.Contains(75, 75));
+
+    // Unknown ids and repeated removes are ignored
+    rects.Remove(7);
+    rects.Remove(99);
+    CHECK(rects.GetRects().size() == 1);
+
+    rects.Remove(8);
+    CHECK(!rects.Has(8) && !rects.Contains(75, 75));
+    CHECK(rects.GetRects().empty());
+
+    // Removed ids can come back
+    rects.Set(7, 0, 0, 10, 10);
+    CHECK(rects.Has(7) && rects.Contains(5, 5));
+    rects.Clear();
+    CHECK(!rects.Has(7) && !rects.Contains(5, 5));
+}
+
+int main()
+{
+    TestInclusiveEdges();
+    TestSetUpdatesInPlace();
+    TestSwapRemove();
+    TestRemove();
+    return TestResult("RectSetTest");
+}
@@ -0,0 +1,176 @@
+// Self monitor against the /proc/self backend: exact per-thread CPU and switch rates from
+// a synthetic root, threads appearing and exiting, allocation counting, and per-thread
+// accounting of real busy and sleeping threads
+
+#include "TestSupport.h"
+#include "SelfMonitor.h"
+#include "ProcSelfBackend.h"
+#include "TraceRecorder.h"
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <sys/stat.h>
+#include <thread>
+
+static const uint64_t TICKS_PER_SECOND = static_cast<uint64_t>(sysconf(_SC_CLK_TCK));
+
+static void WriteThread(const std::string& root, uint32_t tid, const char* name, uint64_t ticks, uint64_t switches)
+{
+    std::string directory = root + "/task/" + std::to_string(tid);
+    mkdir(directory.c_str(), 0755);
+
+    char text[512];
+    snprintf(text, sizeof(text), "%u (%s) S 1 1 1 0 -1 4194560 100 0 0 0 %llu %llu 0 0 20 0 4 0 5000 1000 300\n",
+             tid, name, (unsigned long long)(ticks - ticks / 3), (unsigned long long)(ticks / 3));
+    WriteTestFile(directory + "/stat", text);
+    snprintf(text, sizeof(text), "Name:\t%s\nState:\tS (sleeping)\nvoluntary_ctxt_switches:\t%llu\nnonvoluntary_ctxt_switches:\t%llu\n",
+             name, (unsigned long long)(switches - switches / 4), (unsigned long long)(switches / 4));
+    WriteTestFile(directory + "/status", text);
+}
+
+static const SelfThreadStats* FindThread(const SelfMonitor& monitor, uint32_t tid)
+{
+    for (const SelfThreadStats& stats : monitor.GetThreads()) {
+        if (stats.threadId == tid)
+            return &stats;
+    }
+    return nullptr;
+}
+
+static void TestSyntheticRoot()
+{
+    std::string root = MakeTestDirectory("self-monitor");
+    mkdir((root + "/task").c_str(), 0755);
+    mkdir((root + "/fd").c_str(), 0755);
+    for (const char* fd : { "100", "101", "102" })
+        WriteTestFile(root + "/fd/" + fd, "");
+    WriteTestFile(root + "/status", "Name:\toverlay\nVmRSS:\t   51200 kB\nRssAnon:\t   20480 kB\nThreads:\t2\n");
+    WriteThread(root, 500, "overlay", 1000, 5000);
+    WriteThread(root, 501, "sampler (1)", 200, 800);
+
+    FakeClock clock(1000000000ull);
+    SelfMonitor monitor(std::make_unique<ProcSelfBackend>(root), clock);
+    CHECK(monitor.Sample());
+    CHECK(monitor.GetThreads().empty());    // Rates need two snapshots
+    CHECK(monitor.GetProcess().workingSet == 51200ull * 1024);
+    CHECK(monitor.GetProcess().privateBytes == 20480ull * 1024);
+    CHECK(monitor.GetProcess().handleCount == 3);
+
+    // One second: the main thread used half a processor, the sampler a tenth; 502 is new
+    WriteThread(root, 500, "overlay", 1000 + TICKS_PER_SECOND / 2, 5120);
+    WriteThread(root, 501, "sampler (1)", 200 + TICKS_PER_SECOND / 10, 840);
+    WriteThread(root, 502, "loader", 50, 10);
+    clock.AdvanceMs(1000);
+    CHECK(monitor.Sample());
+    const std::vector<SelfThreadStats>& threads = monitor.GetThreads();
+    CHECK(threads.size() == 2);
+    if (threads.size() == 2) {
+        CHECK(threads[0].threadId == 500 && strcmp(threads[0].name, "overlay") == 0);
+        CHECK_NEAR(threads[0].cpuPercent, 50.0, 1e-9);
+        CHECK_NEAR(threads[0].switchesPerSec, 120.0, 1e-9);
+        CHECK(threads[1].threadId == 501 && strcmp(threads[1].name, "sampler (1)") == 0);
+        CHECK_NEAR(threads[1].cpuPercent, 10.0, 1e-9);
+        CHECK_NEAR(threads[1].switchesPerSec, 40.0, 1e-9);
+    }
+    CHECK_NEAR(monitor.GetCpuPercent(), 60.0, 1e-9);
+    CHECK_NEAR(monitor.GetContextSwitchesPerSec(), 160.0, 1e-9);
+
+    // Half a second later the sampler has exited and the loader has its first interval
+    RemoveTestDirectory(root + "/task/501");
+    WriteThread(root, 500, "overlay", 1000 + TICKS_PER_SECOND / 2, 5120);
+    WriteThread(root, 502, "loader", 50 + TICKS_PER_SECOND / 4, 30);
+    clock.AdvanceMs(500);
+    CHECK(monitor.Sample());
+    CHECK(threads.size() == 2);
+    CHECK(FindThread(monitor, 501) == nullptr);
+    const SelfThreadStats* loader = FindThread(monitor, 502);
+    CHECK(loader && threads[0].threadId == 502);
+    if (loader) {
+        CHECK_NEAR(loader->cpuPercent, 50.0, 1e-9);
+        CHECK_NEAR(loader->switchesPerSec, 40.0, 1e-9);
+    }
+    const SelfThreadStats* idle = FindThread(monitor, 500);
+    CHECK(idle && idle->cpuPercent == 0.0);
+    CHECK_NEAR(monitor.GetCpuPercent(), 50.0, 1e-9);
+
+    // Allocations made between samples are counted through the replaced operator new
+    for (int i = 0; i < 1000; i++) {
+        int* block = new int(i);
+        CHECK(*block == i);
+        delete block;
+    }
+    clock.AdvanceMs(500);
+    CHECK(monitor.Sample());
+    CHECK(monitor.GetAllocationsPerSec() >= 2000.0);
+
+    // After a reset the next sample is a baseline again
+    monitor.Reset();
+    clock.AdvanceMs(1000);
+    CHECK(monitor.Sample());
+    CHECK(monitor.GetThreads().empty());
+    RemoveTestDirectory(root);
+
+    SelfMonitor broken(std::make_unique<ProcSelfBackend>("/nonexistent-self"), clock);
+    CHECK(!broken.Sample());
+}
+
+// A spinning thread and a sleeping one, told apart by the live backend
+static void TestRealThreads()
+{
+    std::atomic<bool> stop{ false };
+    std::atomic<int> ready{ 0 };
+    std::thread busy([&] {
+        TraceRecorder::Instance().SetThreadName("busy");
+        ready++;
+        volatile uint64_t sink = 0;
+        while (!stop.load(std::memory_order_relaxed))
+            sink += 1;
+    });
+    std::thread sleeper([&] {
+        TraceRecorder::Instance().SetThreadName("sleeper");
+        ready++;
+        while (!stop.load(std::memory_order_relaxed))
+            usleep(20000);
+    });
+    while (ready.load() < 2)
+        usleep(1000);
+
+    SelfMonitor monitor(std::make_unique<ProcSelfBackend>());
+    CHECK(monitor.Sample());
+    usleep(500000);
+    CHECK(monitor.Sample());
+    stop = true;
+    busy.join();
+    sleeper.join();
+
+    const SelfThreadStats* spinning = nullptr;
+    const SelfThreadStats* sleeping = nullptr;
+    double total = 0.0;
+    for (const SelfThreadStats& stats : monitor.GetThreads()) {
+        if (strcmp(stats.name, "busy") == 0)
+            spinning = &stats;
+        if (strcmp(stats.name, "sleeper") == 0)
+            sleeping = &stats;
+        total += stats.cpuPercent;
+    }
+    CHECK(spinning && sleeping);
+    if (spinning && sleeping) {
+        printf("busy thread %.1f%%, sleeping thread %.1f%%, process %.1f%%\n",
+               spinning->cpuPercent, sleeping->cpuPercent, monitor.GetCpuPercent());
+        // Busiest first; the spinner gets most of a processor even on a single shared CPU
+        CHECK(monitor.GetThreads()[0].threadId == spinning->threadId);
+        CHECK(spinning->cpuPercent > 50.0);
+        CHECK(sleeping->cpuPercent < 10.0);
+        CHECK(sleeping->switchesPerSec > 10.0);    // It wakes every 20 ms
+    }
+    CHECK_NEAR(monitor.GetCpuPercent(), total, 1e-6);
+    CHECK(monitor.GetProcess().workingSet > 0);
+    CHECK(monitor.GetProcess().handleCount >= 3);
+}
+
+int main()
+{
+    TestSyntheticRoot();
+    TestRealThreads();
+    return TestResult("SelfMonitorTest");
+}
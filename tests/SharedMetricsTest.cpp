@@ -0,0 +1,204 @@
+// Shared-memory metrics over POSIX shm: the reader's view of a region that isn't there,
+// isn't set up or has no sample yet, concurrent readers never getting a torn sample while
+// the publisher writes flat out, and the same while new publishers keep taking the region
+// over (the crash-and-restart case), with the sequence never going backwards
+
+#include "TestSupport.h"
+#include "SharedMetricsPublisher.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <sys/mman.h>
+#include <thread>
+#include <vector>
+
+#define READER_THREADS 4
+#define WRITE_DURATION_MS 300          // Long enough for plenty of preemptions on a single core
+#define PUBLISHES_PER_TAKEOVER 200
+
+// Every field is derived from one value, so a reader can tell a torn copy from a real one
+static MetricsSnapshot MakeSnapshot(uint64_t value)
+{
+    MetricsSnapshot snapshot;
+    snapshot.timestampNs = value * 1000;
+    snapshot.cpuUsagePercent = static_cast<double>(value);
+    snapshot.cpuTemperatureCelsius = static_cast<double>(value + 1);
+    snapshot.memoryUsedBytes = value * 3;
+    snapshot.memoryTotalBytes = value * 3 + 7;
+    snapshot.downloadBytesPerSec = static_cast<double>(value * 5);
+    snapshot.uploadBytesPerSec = static_cast<double>(value * 5 + 1);
+    snapshot.batteryPercent = static_cast<int32_t>(value % 100);
+    snapshot.batteryCharging = static_cast<int32_t>(value & 1);
+    return snapshot;
+}
+
+static bool IsConsistent(const OverlayMetricsSample& sample)
+{
+    uint64_t value = static_cast<uint64_t>(sample.cpuUsagePercent);
+    MetricsSnapshot expected = MakeSnapshot(value);
+    return sample.publishCount != 0 && sample.timestampNs == expected.timestampNs &&
+           sample.cpuTemperatureCelsius == expected.cpuTemperatureCelsius &&
+           sample.memoryUsedBytes == expected.memoryUsedBytes && sample.memoryTotalBytes == expected.memoryTotalBytes &&
+           sample.downloadBytesPerSec == expected.downloadBytesPerSec &&
+           sample.uploadBytesPerSec == expected.uploadBytesPerSec &&
+           sample.batteryPercent == expected.batteryPercent && sample.batteryCharging == expected.batteryCharging;
+}
+
+struct ReaderStats {
+    uint64_t reads = 0;
+    uint64_t noSample = 0;
+    uint64_t busy = 0;
+    uint64_t torn = 0;
+    uint64_t sequenceWentBack = 0;
+    uint64_t failedOpen = 0;
+};
+
+// Reads until told to stop, checking every sample it gets
+static void ReadLoop(const std::atomic<bool>& running, ReaderStats& stats)
+{
+    OverlayMetricsReader reader;
+    if (OverlayMetricsOpen(&reader) != OVERLAY_METRICS_OK) {
+        stats.failedOpen++;
+        return;
+    }
+
+    uint64_t lastSequence = 0;
+    while (running.load(std::memory_order_relaxed)) {
+        uint64_t sequence = reader.view->sequence;
+        if (sequence < lastSequence)
+            stats.sequenceWentBack++;
+        lastSequence = sequence;
+
+        OverlayMetricsSample sample;
+        int result = OverlayMetricsRead(&reader, &sample, 100);
+        if (result == OVERLAY_METRICS_OK) {
+            stats.reads++;
+            if (!IsConsistent(sample))
+                stats.torn++;
+        } else if (result == OVERLAY_METRICS_NO_SAMPLE) {
+            stats.noSample++;
+        } else if (result == OVERLAY_METRICS_BUSY) {
+            stats.busy++;
+        }
+    }
+    OverlayMetricsClose(&reader);
+}
+
+static ReaderStats RunReaders(const std::function<void()>& writer)
+{
+    std::atomic<bool> running{ true };
+    std::vector<ReaderStats> stats(READER_THREADS);
+    std::vector<std::thread> readers;
+    for (int i = 0; i < READER_THREADS; i++)
+        readers.emplace_back(ReadLoop, std::cref(running), std::ref(stats[i]));
+
+    // Let every reader map the region before the writer starts
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    writer();
+    running = false;
+    for (auto& reader : readers)
+        reader.join();
+
+    ReaderStats total;
+    for (const auto& s : stats) {
+        total.reads += s.reads;
+        total.noSample += s.noSample;
+        total.busy += s.busy;
+        total.torn += s.torn;
+        total.sequenceWentBack += s.sequenceWentBack;
+        total.failedOpen += s.failedOpen;
+    }
+    return total;
+}
+
+static void TestStates()
+{
+    OverlayMetricsReader reader;
+    shm_unlink(OVERLAY_SHARED_METRICS_NAME);
+    CHECK(OverlayMetricsOpen(&reader) == OVERLAY_METRICS_NOT_PUBLISHED);
+
+    SharedMetricsPublisher publisher;
+    CHECK(publisher.Open());
+    CHECK(OverlayMetricsOpen(&reader) == OVERLAY_METRICS_OK);
+    CHECK(reader.view->publisherPid == static_cast<uint32_t>(getpid()));
+
+    OverlayMetricsSample sample;
+    CHECK(OverlayMetricsRead(&reader, &sample, 10) == OVERLAY_METRICS_NO_SAMPLE);
+    publisher.Publish(MakeSnapshot(42));
+    CHECK(OverlayMetricsRead(&reader, &sample, 10) == OVERLAY_METRICS_OK);
+    CHECK(IsConsistent(sample) && sample.cpuUsagePercent == 42.0 && sample.publishCount == 1);
+
+    // A publisher taking the region over starts from an empty sample and a later sequence
+    uint64_t sequence = reader.view->sequence;
+    {
+        SharedMetricsPublisher successor;
+        CHECK(successor.Open());
+        CHECK(reader.view->sequence > sequence && (reader.view->sequence & 1) == 0);
+        CHECK(OverlayMetricsRead(&reader, &sample, 10) == OVERLAY_METRICS_NO_SAMPLE);
+        successor.Publish(MakeSnapshot(7));
+        CHECK(OverlayMetricsRead(&reader, &sample, 10) == OVERLAY_METRICS_OK && sample.cpuUsagePercent == 7.0);
+    }
+
+    // Closing leaves existing mappings reporting "nothing published"
+    CHECK(OverlayMetricsRead(&reader, &sample, 10) == OVERLAY_METRICS_NO_SAMPLE);
+    OverlayMetricsClose(&reader);
+    CHECK(OverlayMetricsOpen(&reader) == OVERLAY_METRICS_NOT_PUBLISHED);
+}
+
+static void TestConcurrentReaders()
+{
+    SharedMetricsPublisher publisher;
+    CHECK(publisher.Open());
+    uint64_t publishes = 0;
+    ReaderStats stats = RunReaders([&]() {
+        auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(WRITE_DURATION_MS);
+        while (std::chrono::steady_clock::now() < end)
+            publisher.Publish(MakeSnapshot(++publishes));
+    });
+    printf("%llu publishes, %d readers: %llu reads, %llu busy, %llu torn\n", (unsigned long long)publishes,
+           READER_THREADS, (unsigned long long)stats.reads, (unsigned long long)stats.busy, (unsigned long long)stats.torn);
+    CHECK(stats.failedOpen == 0);
+    CHECK(stats.reads > 0);
+    CHECK(stats.torn == 0);
+    CHECK(stats.sequenceWentBack == 0);
+    CHECK(publisher.GetPublishCount() == publishes);
+}
+
+static void TestTakeovers()
+{
+    // Each publisher is abandoned with the region still mapped, as if its process had died;
+    // they're only closed once the readers are done
+    std::vector<std::unique_ptr<SharedMetricsPublisher>> publishers;
+    publishers.push_back(std::make_unique<SharedMetricsPublisher>());
+    CHECK(publishers.back()->Open());
+    publishers.back()->Publish(MakeSnapshot(1));
+
+    ReaderStats stats = RunReaders([&]() {
+        uint64_t value = 2;
+        auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(WRITE_DURATION_MS);
+        while (std::chrono::steady_clock::now() < end) {
+            publishers.push_back(std::make_unique<SharedMetricsPublisher>());
+            publishers.back()->Open();
+            for (int i = 0; i < PUBLISHES_PER_TAKEOVER; i++)
+                publishers.back()->Publish(MakeSnapshot(value++));
+        }
+    });
+    printf("%zu takeovers: %llu reads, %llu empty, %llu torn\n", publishers.size() - 1,
+           (unsigned long long)stats.reads, (unsigned long long)stats.noSample, (unsigned long long)stats.torn);
+    CHECK(stats.failedOpen == 0);
+    CHECK(stats.reads > 0);
+    CHECK(stats.torn == 0);
+    CHECK(stats.sequenceWentBack == 0);
+
+    while (!publishers.empty())
+        publishers.pop_back();
+}
+
+int main()
+{
+    TestStates();
+    TestConcurrentReaders();
+    TestTakeovers();
+    return TestResult("SharedMetricsTest");
+}
@@ -0,0 +1,103 @@
+// Sliding-window min/max update cost against rescanning the window, for the overlay's
+// 10-sample CPU range and for minute- and hour-long windows, checked against the rescan
+// for exactness on the way. The budget is 100 ns per update at any window size; the check
+// is on the best of a few rounds.
+
+#include "TestSupport.h"
+#include "Estimators.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#define BENCHMARK_ROUNDS 5
+#define BENCHMARK_SAMPLES 200000
+#define BENCHMARK_RESCAN_SAMPLES 20000    // The rescan is O(N) per update; a slice is enough
+#define BENCHMARK_BUDGET_NS 100.0
+
+// Random walk with occasional spikes, like a CPU or network series
+static std::vector<float> MakeSeries()
+{
+    std::vector<float> series(BENCHMARK_SAMPLES);
+    uint32_t state = 12345;
+    float value = 50.0f;
+    for (float& sample : series) {
+        state = state * 1664525u + 1013904223u;
+        value += static_cast<float>(static_cast<int>(state >> 24) - 128) / 32.0f;
+        value = (std::min)((std::max)(value, 0.0f), 100.0f);
+        sample = (state & 0x3F) == 0 ? 100.0f : value;
+    }
+    return series;
+}
+
+template <size_t N>
+static bool MatchesRescan(const std::vector<float>& series)
+{
+    SlidingMinMax<float, N> range;
+    for (size_t i = 0; i < series.size(); i++) {
+        range.Update(series[i]);
+        size_t first = i + 1 > N ? i + 1 - N : 0;
+        auto bounds = std::minmax_element(series.begin() + first, series.begin() + i + 1);
+        if (range.GetMin() != *bounds.first || range.GetMax() != *bounds.second)
+            return false;
+    }
+    return true;
+}
+
+// Best-of-rounds ns per update; the sink keeps the queries from being optimised away
+template <size_t N>
+static double MeasureSliding(const std::vector<float>& series, float& sink)
+{
+    double best = 1e30;
+    for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+        SlidingMinMax<float, N> range;
+        auto begin = std::chrono::steady_clock::now();
+        for (float sample : series) {
+            range.Update(sample);
+            sink += range.GetMax() - range.GetMin();
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+        best = (std::min)(best, ns / series.size());
+    }
+    return best;
+}
+
+template <size_t N>
+static double MeasureRescan(const std::vector<float>& series, float& sink)
+{
+    double best = 1e30;
+    for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+        auto begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < series.size(); i++) {
+            size_t first = i + 1 > N ? i + 1 - N : 0;
+            auto bounds = std::minmax_element(series.begin() + first, series.begin() + i + 1);
+            sink += *bounds.second - *bounds.first;
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+        best = (std::min)(best, ns / series.size());
+    }
+    return best;
+}
+
+template <size_t N>
+static void Run(const std::vector<float>& series, float& sink)
+{
+    std::vector<float> slice(series.begin(), series.begin() + BENCHMARK_RESCAN_SAMPLES);
+    CHECK(MatchesRescan<N>(slice));
+    double sliding = MeasureSliding<N>(series, sink);
+    double rescan = MeasureRescan<N>(slice, sink);
+    printf("window %5zu: sliding %.1f ns per update, rescan %.1f ns per update\n", N, sliding, rescan);
+    CHECK(sliding < BENCHMARK_BUDGET_NS);
+    if (N >= 60)
+        CHECK(sliding < rescan);
+}
+
+int main()
+{
+    std::vector<float> series = MakeSeries();
+    float sink = 0.0f;
+    Run<10>(series, sink);
+    Run<60>(series, sink);
+    Run<3600>(series, sink);
+    printf("(checksum %.0f)\n", sink);
+    return TestResult("SlidingMinMaxBenchmark");
+}
@@ -0,0 +1,171 @@
+// Storage monitor rate engine against the /proc/diskstats backend: per-disk throughput,
+// IOPS and queue depth from a synthetic /proc, rates over the clock-elapsed time, a disk
+// that goes away, names too long to store, volume space, and a sanity pass over the real /proc
+
+#include "TestSupport.h"
+#include "StorageMonitor.h"
+#include "ProcStorageBackend.h"
+#include <cstring>
+#include <memory>
+#include <sys/stat.h>
+
+struct DiskLine {
+    const char* name;
+    uint64_t reads;
+    uint64_t sectorsRead;
+    uint64_t writes;
+    uint64_t sectorsWritten;
+    uint32_t inFlight;
+};
+
+static void WriteDiskstats(const std::string& root, const DiskLine* disks, size_t count)
+{
+    std::string text;
+    for (size_t i = 0; i < count; i++) {
+        char line[256];
+        snprintf(line, sizeof(line), " 8 %zu %s %llu 0 %llu 10 %llu 0 %llu 20 %u 30 40 0 0 0 0\n",
+                 i, disks[i].name, (unsigned long long)disks[i].reads, (unsigned long long)disks[i].sectorsRead,
+                 (unsigned long long)disks[i].writes, (unsigned long long)disks[i].sectorsWritten, disks[i].inFlight);
+        text += line;
+    }
+    WriteTestFile(root + "/diskstats", text);
+}
+
+static const DiskStats* FindDisk(const StorageMonitor& monitor, const char* name)
+{
+    for (const DiskStats& disk : monitor.GetDisks()) {
+        if (strcmp(disk.name, name) == 0)
+            return &disk;
+    }
+    return nullptr;
+}
+
+static void TestSyntheticProc()
+{
+    std::string root = MakeTestDirectory("storage-monitor");
+    // Partitions and loop devices repeat I/O the whole disk already counts, and a name too
+    // long to store is left out rather than cut short
+    DiskLine first[] = {
+        { "sda", 1000, 80000, 500, 40000, 0 },
+        { "sda1", 1000, 80000, 500, 40000, 0 },
+        { "nvme0n1", 10, 100, 10, 100, 0 },
+        { "nvme0n1p1", 10, 100, 10, 100, 0 },
+        { "loop0", 5, 50, 0, 0, 0 },
+        { "a-disk-name-longer-than-the-limit", 1, 1, 1, 1, 0 },
+    };
+    WriteDiskstats(root, first, 6);
+    std::string longMount = root + "/a-mount-point-too-long-to-show-whole";
+    CHECK(mkdir(longMount.c_str(), 0700) == 0);
+    WriteTestFile(root + "/mounts",
+                  "/dev/sda1 /tmp ext4 rw,relatime 0 0\n"
+                  "tmpfs /run tmpfs rw 0 0\n"
+                  "proc /proc proc rw 0 0\n"
+                  "/dev/sda2 " + longMount + " ext4 rw 0 0\n");
+
+    FakeClock clock(1000000000ull);
+    StorageMonitor monitor(std::make_unique<ProcStorageBackend>(root, clock));
+    CHECK(monitor.Open());
+    CHECK(monitor.Sample());
+    CHECK(monitor.GetDisks().size() == 2);
+    CHECK(FindDisk(monitor, "sda1") == nullptr);
+    CHECK(FindDisk(monitor, "loop0") == nullptr);
+    CHECK_NEAR(monitor.GetTotalBytesPerSec(), 0.0, 1e-9);
+
+    // One second: sda read 2048 sectors in 100 I/Os and wrote 1024 in 50, with 3 in flight
+    DiskLine second[] = {
+        { "sda", 1100, 82048, 550, 41024, 3 },
+        { "sda1", 1100, 82048, 550, 41024, 3 },
+        { "nvme0n1", 10, 100, 10, 100, 0 },
+        { "nvme0n1p1", 10, 100, 10, 100, 0 },
+        { "loop0", 5, 50, 0, 0, 0 },
+    };
+    WriteDiskstats(root, second, 5);
+    clock.AdvanceMs(1000);
+    CHECK(monitor.Sample());
+    const DiskStats* sda = FindDisk(monitor, "sda");
+    CHECK(sda != nullptr);
+    if (sda) {
+        CHECK_NEAR(sda->readBytesPerSec, 2048.0 * 512.0, 1e-6);
+        CHECK_NEAR(sda->writeBytesPerSec, 1024.0 * 512.0, 1e-6);
+        CHECK_NEAR(sda->readsPerSec, 100.0, 1e-9);
+        CHECK_NEAR(sda->writesPerSec, 50.0, 1e-9);
+        CHECK(sda->queueLength == 3);
+    }
+    CHECK_NEAR(monitor.GetTotalBytesPerSec(), 3072.0 * 512.0, 1e-6);
+
+    // Rates divide by the elapsed clock time: the same delta in 250 ms is four times the rate
+    DiskLine third[] = {
+        { "sda", 1200, 84096, 550, 41024, 0 },
+        { "nvme0n1", 10, 100, 20, 300, 1 },
+    };
+    WriteDiskstats(root, third, 2);
+    clock.AdvanceMs(250);
+    CHECK(monitor.Sample());
+    sda = FindDisk(monitor, "sda");
+    const DiskStats* nvme = FindDisk(monitor, "nvme0n1");
+    CHECK(sda && nvme);
+    if (sda && nvme) {
+        CHECK_NEAR(sda->readBytesPerSec, 4.0 * 2048.0 * 512.0, 1e-6);
+        CHECK_NEAR(sda->readsPerSec, 400.0, 1e-9);
+        CHECK_NEAR(sda->writeBytesPerSec, 0.0, 1e-9);
+        CHECK_NEAR(nvme->writeBytesPerSec, 4.0 * 200.0 * 512.0, 1e-6);
+        CHECK_NEAR(nvme->writesPerSec, 40.0, 1e-9);
+    }
+
+    // A disk that goes away drops out; when it comes back it starts from a fresh baseline
+    WriteDiskstats(root, third, 1);
+    clock.AdvanceMs(1000);
+    CHECK(monitor.Sample());
+    CHECK(monitor.GetDisks().size() == 1);
+    DiskLine returned[] = {
+        { "sda", 1200, 84096, 550, 41024, 0 },
+        { "nvme0n1", 500, 9000, 500, 9000, 0 },
+    };
+    WriteDiskstats(root, returned, 2);
+    clock.AdvanceMs(1000);
+    CHECK(monitor.Sample());
+    nvme = FindDisk(monitor, "nvme0n1");
+    CHECK(nvme && nvme->readBytesPerSec == 0.0 && nvme->writesPerSec == 0.0);
+
+    // Only block-device mounts are volumes; a long mount point keeps its end
+    const std::vector<VolumeSpace>& volumes = monitor.GetVolumes();
+    CHECK(volumes.size() == 2);
+    if (volumes.size() == 2) {
+        CHECK(strcmp(volumes[0].name, "/tmp") == 0);
+        CHECK(volumes[0].totalBytes > 0 && volumes[0].freeBytes <= volumes[0].totalBytes);
+        std::string shown = "..." + longMount.substr(longMount.size() - (STORAGE_NAME_LENGTH - 4));
+        CHECK(shown.size() == STORAGE_NAME_LENGTH - 1);
+        CHECK(strcmp(volumes[1].name, shown.c_str()) == 0);
+    }
+
+    monitor.Close();
+    CHECK(!monitor.Sample());
+    RemoveTestDirectory(root);
+
+    StorageMonitor broken(std::make_unique<ProcStorageBackend>("/nonexistent-proc", clock));
+    CHECK(!broken.Open());
+}
+
+static void TestRealProc()
+{
+    StorageMonitor monitor(std::make_unique<ProcStorageBackend>());
+    if (!monitor.Open()) {
+        printf("no readable /proc/diskstats, skipping the live pass\n");
+        return;
+    }
+    CHECK(monitor.Sample());
+    usleep(100000);
+    CHECK(monitor.Sample());
+    for (const DiskStats& disk : monitor.GetDisks()) {
+        CHECK(disk.readBytesPerSec >= 0.0);
+        CHECK(disk.writeBytesPerSec >= 0.0);
+    }
+    CHECK(monitor.GetTotalBytesPerSec() >= 0.0);
+}
+
+int main()
+{
+    TestSyntheticProc();
+    TestRealProc();
+    return TestResult("StorageMonitorTest");
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+// Minimal support for the Linux test targets. Each test is its own executable registered
+// with CTest; it runs every check, reports failures with file and line, and exits non-zero
+// if any failed.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+
+static int g_checkFailures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            g_checkFailures++; \
+        } \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+    do { \
+        double checkActual = (actual); \
+        double checkExpected = (expected); \
+        if (!(std::fabs(checkActual - checkExpected) <= (tolerance))) { \
+            std::fprintf(stderr, "%s:%d: CHECK_NEAR failed: %s = %g, expected %g +/- %g\n", \
+                         __FILE__, __LINE__, #actual, checkActual, checkExpected, static_cast<double>(tolerance)); \
+            g_checkFailures++; \
+        } \
+    } while (0)
+
+inline int TestResult(const char* name)
+{
+    if (g_checkFailures)
+        std::fprintf(stderr, "%s: %d check(s) failed\n", name, g_checkFailures);
+    else
+        std::printf("%s: all checks passed\n", name);
+    return g_checkFailures ? 1 : 0;
+}
+
+// Fresh directory under /tmp for files a test generates (e.g. a synthetic /proc)
+inline std::string MakeTestDirectory(const char* name)
+{
+    std::string pattern = std::string("/tmp/") + name + "-XXXXXX";
+    if (!mkdtemp(&pattern[0])) {
+        std::perror("mkdtemp");
+        std::exit(1);
+    }
+    return pattern;
+}
+
+inline void WriteTestFile(const std::string& path, const std::string& text)
+{
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::perror(path.c_str());
+        std::exit(1);
+    }
+    std::fwrite(text.data(), 1, text.size(), file);
+    std::fclose(file);
+}
+
+inline void RemoveTestDirectory(const std::string& path)
+{
+    std::string command = "rm -rf '" + path + "'";
+    if (std::system(command.c_str()) != 0)
+        std::fprintf(stderr, "couldn't remove %s\n", path.c_str());
+}
@@ -0,0 +1,206 @@
+// Trace recorder: the Chrome JSON it formats (thread names, escaping, nesting, orphaned
+// ends), ring wraparound, and dumps taken while another thread keeps recording, which must
+// only ever contain whole, contiguous events
+
+#include "TestSupport.h"
+#include "TraceRecorder.h"
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <sys/syscall.h>
+
+struct ParsedEvent {
+    char phase;
+    unsigned tid;
+    char name[64];
+};
+
+// Pull the B/E events out of the JSON, one per line as the recorder writes them
+static std::vector<ParsedEvent> ParseEvents(const std::string& json)
+{
+    std::vector<ParsedEvent> events;
+    size_t start = 0;
+    while (start < json.size()) {
+        size_t end = json.find('\n', start);
+        if (end == std::string::npos)
+            end = json.size();
+        std::string line = json.substr(start, end - start);
+        start = end + 1;
+
+        ParsedEvent event;
+        unsigned pid;
+        unsigned long long ts;
+        unsigned fraction;
+        if (sscanf(line.c_str(), "{\"ph\":\"%c\",\"pid\":%u,\"tid\":%u,\"ts\":%llu.%u,\"name\":\"%63[^\"]",
+                   &event.phase, &pid, &event.tid, &ts, &fraction, event.name) == 6)
+            events.push_back(event);
+    }
+    return events;
+}
+
+static size_t CountPhase(const std::vector<ParsedEvent>& events, char phase)
+{
+    size_t count = 0;
+    for (const ParsedEvent& event : events)
+        count += event.phase == phase;
+    return count;
+}
+
+static void TestFormat()
+{
+    TraceRecorder& recorder = TraceRecorder::Instance();
+    recorder.Clear();
+    recorder.SetThreadName("Main \"test\"");
+
+    {
+        TraceScope disabled("Disabled");
+    }
+    recorder.SetEnabled(true);
+    {
+        TraceScope frame("Frame");
+        TraceScope update("Update");
+    }
+    recorder.End("Stray");
+    recorder.SetEnabled(false);
+
+    std::string json = recorder.FormatChromeJson();
+    CHECK(json.compare(0, 15, "{\"traceEvents\":") == 0);
+    CHECK(json.find("\"displayTimeUnit\":\"ms\"}") != std::string::npos);
+    CHECK(json.find("\"thread_name\"") != std::string::npos);
+    CHECK(json.find("Main \\\"test\\\"") != std::string::npos);
+
+    // Disabled scopes record nothing and the stray end has nothing open to close
+    std::vector<ParsedEvent> events = ParseEvents(json);
+    CHECK(events.size() == 4);
+    if (events.size() == 4) {
+        CHECK(events[0].phase == 'B' && strcmp(events[0].name, "Frame") == 0);
+        CHECK(events[1].phase == 'B' && strcmp(events[1].name, "Update") == 0);
+        CHECK(events[2].phase == 'E' && strcmp(events[2].name, "Update") == 0);
+        CHECK(events[3].phase == 'E' && strcmp(events[3].name, "Frame") == 0);
+    }
+    CHECK(json.find("Disabled") == std::string::npos);
+    CHECK(json.find("Stray") == std::string::npos);
+
+    // The file matches the string
+    std::string directory = MakeTestDirectory("trace-recorder");
+    std::string path = directory + "/trace.json";
+    CHECK(recorder.WriteChromeJson(path));
+    FILE* file = fopen(path.c_str(), "rb");
+    CHECK(file != nullptr);
+    if (file) {
+        std::string written;
+        char chunk[4096];
+        size_t read;
+        while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0)
+            written.append(chunk, read);
+        fclose(file);
+        CHECK(written == recorder.FormatChromeJson());
+    }
+    RemoveTestDirectory(directory);
+
+    recorder.Clear();
+    CHECK(ParseEvents(recorder.FormatChromeJson()).empty());
+}
+
+static void TestWraparound()
+{
+    TraceRecorder& recorder = TraceRecorder::Instance();
+    recorder.Clear();
+
+    // 2N + 2 events into an N-slot ring: the outer begin is long gone by the time it ends
+    recorder.Begin("Outer");
+    for (int i = 0; i < TRACE_EVENTS_PER_THREAD; i++) {
+        recorder.Begin("Inner");
+        recorder.End("Inner");
+    }
+    recorder.End("Outer");
+
+    // N - 1 events come back: the outer end, then an even run of inner pairs; the unmatched
+    // outer end is dropped
+    std::vector<ParsedEvent> events = ParseEvents(recorder.FormatChromeJson());
+    CHECK(events.size() == TRACE_EVENTS_PER_THREAD - 2);
+    CHECK(CountPhase(events, 'B') == (TRACE_EVENTS_PER_THREAD - 2) / 2);
+    CHECK(CountPhase(events, 'E') == (TRACE_EVENTS_PER_THREAD - 2) / 2);
+    for (const ParsedEvent& event : events)
+        CHECK(strcmp(event.name, "Inner") == 0);
+    if (!events.empty())
+        CHECK(events.front().phase == 'B');
+
+    recorder.Clear();
+}
+
+// Names double as sequence numbers so a torn or stale slot shows up as a break in the run
+static const char* const SEQUENCE_NAMES[16] = {
+    "s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11", "s12", "s13", "s14", "s15"
+};
+
+static int SequenceIndex(const char* name)
+{
+    for (int i = 0; i < 16; i++) {
+        if (strcmp(name, SEQUENCE_NAMES[i]) == 0)
+            return i;
+    }
+    return -1;
+}
+
+static void TestConcurrentDumps()
+{
+    TraceRecorder& recorder = TraceRecorder::Instance();
+    recorder.Clear();
+
+    std::atomic<bool> stop{ false };
+    std::atomic<unsigned> writerTid{ 0 };
+    std::thread writer([&]() {
+        recorder.SetThreadName("Writer");
+        writerTid = static_cast<unsigned>(syscall(SYS_gettid));
+        for (unsigned i = 0; !stop.load(std::memory_order_relaxed); i++) {
+            recorder.Begin(SEQUENCE_NAMES[i % 16]);
+            recorder.End(SEQUENCE_NAMES[i % 16]);
+        }
+    });
+    while (writerTid.load() == 0)
+        std::this_thread::yield();
+
+    int breaks = 0;
+    size_t dumps = 0;
+    size_t fullDumps = 0;
+    while (dumps < 50) {
+        std::vector<ParsedEvent> events = ParseEvents(recorder.FormatChromeJson());
+        dumps++;
+        if (events.size() >= TRACE_EVENTS_PER_THREAD / 2)
+            fullDumps++;
+
+        // Every begin follows the previous pair's end in sequence, every end closes its begin
+        int previous = -1;
+        char previousPhase = 0;
+        for (const ParsedEvent& event : events) {
+            int index = SequenceIndex(event.name);
+            if (index < 0 || event.tid != writerTid.load())
+                breaks++;
+            else if (previous >= 0 && event.phase == 'B' && (previousPhase != 'E' || index != (previous + 1) % 16))
+                breaks++;
+            else if (previous >= 0 && event.phase == 'E' && (previousPhase != 'B' || index != previous))
+                breaks++;
+            previous = index;
+            previousPhase = event.phase;
+        }
+        CHECK(events.size() < TRACE_EVENTS_PER_THREAD);
+        std::this_thread::yield();
+    }
+
+    stop = true;
+    writer.join();
+    printf("%zu dumps (%zu of a full ring), %d sequence breaks\n", dumps, fullDumps, breaks);
+    CHECK(breaks == 0);
+    CHECK(fullDumps > 0);
+    recorder.Clear();
+}
+
+int main()
+{
+    TestFormat();
+    TestWraparound();
+    TestConcurrentDumps();
+    return TestResult("TraceRecorderTest");
+}
@@ -0,0 +1,203 @@
+// Traffic accountant crash recovery by truncation injection: the journal cut at every byte
+// offset recovers exactly the whole records before the cut, a corrupt record ends the
+// replay, a crash between writing the snapshot and truncating the journal counts nothing
+// twice, a torn snapshot falls back to the journal, and compaction keeps the journal
+// bounded without losing anything across reopen
+
+#include "TestSupport.h"
+#include "TrafficAccountant.h"
+#include <algorithm>
+#include <vector>
+
+static const uint32_t DAY = 20240115;
+
+static std::string ReadFile(const std::string& path)
+{
+    std::string data;
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file)
+        return data;
+    char chunk[4096];
+    size_t read;
+    while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        data.append(chunk, read);
+    fclose(file);
+    return data;
+}
+
+// One adapter whose counters advance by a known amount per reading
+class FakeAdapter {
+public:
+    // Record i (from 1) adds i * 1000 received and i * 10 sent
+    void Step(TrafficAccountant& accountant, uint32_t dayKey)
+    {
+        m_step++;
+        m_rx += m_step * 1000;
+        m_tx += m_step * 10;
+        accountant.Integrate({ { 7, m_rx, m_tx } }, dayKey);
+    }
+
+    void Baseline(TrafficAccountant& accountant, uint32_t dayKey) { accountant.Integrate({ { 7, m_rx, m_tx } }, dayKey); }
+
+    static uint64_t RxAfter(uint64_t records) { return records * (records + 1) / 2 * 1000; }
+    static uint64_t TxAfter(uint64_t records) { return records * (records + 1) / 2 * 10; }
+
+private:
+    uint64_t m_step = 0;
+    uint64_t m_rx = 5000000;
+    uint64_t m_tx = 60000;
+};
+
+static void TestCountsAndReopen(const std::string& root)
+{
+    std::string base = root + "/basic";
+    {
+        TrafficAccountant accountant;
+        CHECK(accountant.Open(base));
+        FakeAdapter adapter;
+        adapter.Baseline(accountant, DAY);
+        CHECK(accountant.GetJournalLength() == 0);
+        for (int i = 0; i < 5; i++)
+            adapter.Step(accountant, DAY);
+        adapter.Step(accountant, DAY + 1);
+
+        CHECK(accountant.GetDay(DAY).rxBytes == FakeAdapter::RxAfter(5));
+        CHECK(accountant.GetDay(DAY + 1).rxBytes == 6000);
+        CHECK(accountant.GetMonth(TrafficAccountant::MonthKey(DAY)).rxBytes == FakeAdapter::RxAfter(6));
+        CHECK(accountant.GetMonth(TrafficAccountant::MonthKey(DAY)).txBytes == FakeAdapter::TxAfter(6));
+        CHECK(accountant.GetJournalLength() == 6);
+
+        // An adapter reset counts from zero rather than wrapping
+        accountant.Integrate({ { 7, 300, 3 } }, DAY + 1);
+        CHECK(accountant.GetDay(DAY + 1).rxBytes == 6300);
+    }
+
+    TrafficAccountant reopened;
+    CHECK(reopened.Open(base));
+    CHECK(reopened.GetDay(DAY).rxBytes == FakeAdapter::RxAfter(5));
+    CHECK(reopened.GetDay(DAY + 1).rxBytes == 6300 && reopened.GetDay(DAY + 1).txBytes == 63);
+    CHECK(reopened.GetJournalLength() == 0);
+}
+
+static void TestJournalTruncation(const std::string& root)
+{
+    const int records = 8;
+    std::string base = root + "/live";
+
+    // Snapshot of the files as a crash would leave them: journal written, never compacted
+    TrafficAccountant live;
+    CHECK(live.Open(base));
+    FakeAdapter adapter;
+    adapter.Baseline(live, DAY);
+    for (int i = 0; i < records; i++)
+        adapter.Step(live, DAY);
+    std::string snapshot = ReadFile(base + ".snap");
+    std::string journal = ReadFile(base + ".journal");
+    CHECK(!snapshot.empty() && journal.size() % records == 0);
+    size_t recordSize = journal.size() / records;
+
+    int mismatches = 0;
+    for (size_t cut = 0; cut <= journal.size(); cut++) {
+        std::string crashed = root + "/crashed";
+        WriteTestFile(crashed + ".snap", snapshot);
+        WriteTestFile(crashed + ".journal", journal.substr(0, cut));
+
+        TrafficAccountant recovered;
+        CHECK(recovered.Open(crashed));
+        uint64_t whole = cut / recordSize;
+        TrafficBucket day = recovered.GetDay(DAY);
+        if (day.rxBytes != FakeAdapter::RxAfter(whole) || day.txBytes != FakeAdapter::TxAfter(whole))
+            mismatches++;
+
+        // Recovery starts a clean journal, so new records aren't appended after a torn tail
+        CHECK(recovered.GetJournalLength() == 0);
+        recovered.Close();
+        TrafficAccountant again;
+        CHECK(again.Open(crashed));
+        if (again.GetDay(DAY).rxBytes != FakeAdapter::RxAfter(whole))
+            mismatches++;
+    }
+    printf("journal of %d records cut at every one of %zu offsets: %d mismatches\n", records, journal.size() + 1, mismatches);
+    CHECK(mismatches == 0);
+
+    // A flipped byte in the middle ends the replay at that record
+    std::string corrupt = journal;
+    corrupt[recordSize * 3 + recordSize / 2] ^= 0x40;
+    WriteTestFile(root + "/corrupt.snap", snapshot);
+    WriteTestFile(root + "/corrupt.journal", corrupt);
+    TrafficAccountant recovered;
+    CHECK(recovered.Open(root + "/corrupt"));
+    CHECK(recovered.GetDay(DAY).rxBytes == FakeAdapter::RxAfter(3));
+}
+
+static void TestCrashDuringCompaction(const std::string& root)
+{
+    std::string base = root + "/compact";
+    TrafficAccountant live;
+    CHECK(live.Open(base));
+    FakeAdapter adapter;
+    adapter.Baseline(live, DAY);
+    for (int i = 0; i < 4; i++)
+        adapter.Step(live, DAY);
+    std::string journal = ReadFile(base + ".journal");
+
+    // The new snapshot made it to disk, the journal truncate didn't
+    CHECK(live.Compact());
+    std::string snapshot = ReadFile(base + ".snap");
+    WriteTestFile(root + "/halfway.snap", snapshot);
+    WriteTestFile(root + "/halfway.journal", journal);
+    TrafficAccountant recovered;
+    CHECK(recovered.Open(root + "/halfway"));
+    CHECK(recovered.GetDay(DAY).rxBytes == FakeAdapter::RxAfter(4));
+
+    // Records written after the compaction still count, once
+    recovered.Close();
+    adapter.Step(live, DAY);
+    std::string tail = ReadFile(base + ".journal");
+    WriteTestFile(root + "/halfway.snap", snapshot);
+    WriteTestFile(root + "/halfway.journal", journal + tail);
+    CHECK(recovered.Open(root + "/halfway"));
+    CHECK(recovered.GetDay(DAY).rxBytes == FakeAdapter::RxAfter(5));
+
+    // A torn snapshot is ignored; whatever the journal still holds is recovered
+    WriteTestFile(root + "/torn.snap", snapshot.substr(0, snapshot.size() / 2));
+    WriteTestFile(root + "/torn.journal", tail);
+    TrafficAccountant torn;
+    CHECK(torn.Open(root + "/torn"));
+    CHECK(torn.GetDay(DAY).rxBytes == 5000);
+}
+
+static void TestCompactionBound(const std::string& root)
+{
+    std::string base = root + "/bound";
+    const int records = 2500;
+    {
+        TrafficAccountant accountant;
+        CHECK(accountant.Open(base));
+        FakeAdapter adapter;
+        adapter.Baseline(accountant, DAY);
+        uint32_t longest = 0;
+        for (int i = 0; i < records; i++) {
+            adapter.Step(accountant, DAY);
+            longest = (std::max)(longest, accountant.GetJournalLength());
+        }
+        CHECK(longest < 1024);
+        CHECK(accountant.GetDay(DAY).rxBytes == FakeAdapter::RxAfter(records));
+    }
+
+    TrafficAccountant reopened;
+    CHECK(reopened.Open(base));
+    CHECK(reopened.GetDay(DAY).rxBytes == FakeAdapter::RxAfter(records));
+    CHECK(reopened.GetDay(DAY).txBytes == FakeAdapter::TxAfter(records));
+}
+
+int main()
+{
+    std::string root = MakeTestDirectory("traffic");
+    TestCountsAndReopen(root);
+    TestJournalTruncation(root);
+    TestCrashDuringCompaction(root);
+    TestCompactionBound(root);
+    RemoveTestDirectory(root);
+    return TestResult("TrafficAccountantTest");
+}
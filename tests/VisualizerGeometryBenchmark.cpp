@@ -0,0 +1,103 @@
+// Visualizer geometry on a headless Dear ImGui frame, for every style at 32, 64 and 256
+// bands: the vertices each style adds, that it adds no draw command to the window, and
+// its CPU cost per frame. The budget is 20 us per frame at 256 bands; single frames are
+// noisy, so the check is on the best of a few rounds' medians.
+
+#include "TestSupport.h"
+#include "VisualizerGeometry.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#define BENCHMARK_ROUNDS 5
+#define BENCHMARK_FRAMES 500
+#define BENCHMARK_BUDGET_NS 20000.0
+
+static const char* STYLE_NAMES[] = { "bars", "line", "circle" };
+
+// Levels and peaks that move every frame, like a live capture
+static void FillFrame(int frame, std::vector<float>& levels, std::vector<float>& peaks)
+{
+    for (size_t i = 0; i < levels.size(); i++) {
+        levels[i] = 0.5f + 0.5f * sinf(frame * 0.1f + i * 0.3f);
+        peaks[i] = (std::min)(1.0f, levels[i] + 0.1f);
+    }
+}
+
+static void NewHeadlessFrame()
+{
+    ImGui::NewFrame();
+    ImGui::SetNextWindowPos(ImVec2(0, 0));
+    ImGui::SetNextWindowSize(ImVec2(420, 160));
+    ImGui::Begin("Audio", nullptr, ImGuiWindowFlags_NoDecoration);
+    ImGui::Text("Volume: 50%%");
+}
+
+static void EndHeadlessFrame()
+{
+    ImGui::End();
+    ImGui::Render();
+}
+
+// Median ns per Draw over BENCHMARK_FRAMES frames, checking geometry and draw commands on the way
+static double MeasureStyle(const VisualizerGeometry& geometry, int style, bool& geometryOk)
+{
+    std::vector<float> levels(geometry.GetBands());
+    std::vector<float> peaks(geometry.GetBands());
+    std::vector<double> frames;
+    frames.reserve(BENCHMARK_FRAMES);
+
+    for (int frame = 0; frame < BENCHMARK_FRAMES; frame++) {
+        FillFrame(frame, levels, peaks);
+        NewHeadlessFrame();
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        ImVec2 origin = ImGui::GetCursorScreenPos();
+        int commands = drawList->CmdBuffer.Size;
+        int vertices = drawList->VtxBuffer.Size;
+
+        auto begin = std::chrono::steady_clock::now();
+        geometry.Draw(drawList, style, origin, 400.0f, 80.0f, levels.data(), peaks.data());
+        frames.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count());
+
+        if (drawList->CmdBuffer.Size != commands || drawList->VtxBuffer.Size - vertices != geometry.GetVertexCount(style))
+            geometryOk = false;
+        ImGui::Dummy(ImVec2(400.0f, 80.0f));
+        EndHeadlessFrame();
+    }
+
+    std::sort(frames.begin(), frames.end());
+    return frames[frames.size() / 2];
+}
+
+int main()
+{
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(1280, 720);
+    io.DeltaTime = 1.0f / 60.0f;
+    io.IniFilename = nullptr;
+    unsigned char* pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    VisualizerGeometry geometry;
+    const int bandCounts[] = { 32, 64, 256 };
+    for (int bands : bandCounts) {
+        geometry.SetBands(bands);
+        for (int style = VISUALIZER_BARS; style <= VISUALIZER_CIRCLE; style++) {
+            double best = 1e30;
+            bool geometryOk = true;
+            for (int round = 0; round < BENCHMARK_ROUNDS; round++)
+                best = (std::min)(best, MeasureStyle(geometry, style, geometryOk));
+            printf("%3d bands, %-6s: %5d vertices, %6.2f us per frame\n",
+                   bands, STYLE_NAMES[style], geometry.GetVertexCount(style), best / 1000.0);
+            CHECK(geometryOk);
+            if (bands == 256)
+                CHECK(best < BENCHMARK_BUDGET_NS);
+        }
+    }
+
+    ImGui::DestroyContext();
+    return TestResult("VisualizerGeometryBenchmark");
+}
@@ -0,0 +1,165 @@
+// Visualizer smoothing driven by a fake clock: the same band input rendered at 60 Hz and at
+// 240 Hz gives the same levels and peaks at every shared frame time, the peak marker holds
+// for peakHoldTime and then falls with the configured gravity, and snapshot interpolation
+// clamps its blend factor to the two snapshots it was given
+
+#include "TestSupport.h"
+#include "VisualizerSmoother.h"
+#include "Clock.h"
+#include <algorithm>
+#include <vector>
+
+#define BANDS 4
+#define SECOND_NS 1000000000ull
+
+// Band input over time: silence, a burst from 0.5 s, a quieter passage from 1.5 s and
+// silence again from 2.5 s. A change at time c applies to frames after c, so every frame
+// rate integrates the same piecewise-constant input.
+static void TargetAt(uint64_t ns, float* target)
+{
+    static const float burst[BANDS] = { 1.0f, 0.8f, 0.5f, 0.2f };
+    static const float quiet[BANDS] = { 0.3f, 0.3f, 0.1f, 0.0f };
+    for (int i = 0; i < BANDS; i++) {
+        if (ns <= SECOND_NS / 2 || ns > SECOND_NS * 5 / 2)
+            target[i] = 0.0f;
+        else if (ns <= SECOND_NS * 3 / 2)
+            target[i] = burst[i];
+        else
+            target[i] = quiet[i];
+    }
+}
+
+// Levels and peaks after every 60 Hz frame, rendering at 'rate' frames per second
+static std::vector<std::vector<float>> Render(int rate, int seconds)
+{
+    FakeClock clock;
+    VisualizerSmoother smoother(BANDS);
+    std::vector<std::vector<float>> frames;
+    float target[BANDS];
+    int perFrame = rate / 60;
+
+    for (uint64_t frame = 0; frame <= static_cast<uint64_t>(rate) * seconds; frame++) {
+        clock.Set(frame * SECOND_NS / rate);
+        TargetAt(clock.NowNs(), target);
+        smoother.Update(target, clock.NowSeconds());
+        if (frame % perFrame == 0) {
+            std::vector<float> state(smoother.GetLevels());
+            state.insert(state.end(), smoother.GetPeaks().begin(), smoother.GetPeaks().end());
+            frames.push_back(state);
+        }
+    }
+    return frames;
+}
+
+static void TestFrameRateIndependence()
+{
+    std::vector<std::vector<float>> at60 = Render(60, 4);
+    std::vector<std::vector<float>> at240 = Render(240, 4);
+    CHECK(at60.size() == at240.size());
+
+    float worst = 0.0f;
+    for (size_t frame = 0; frame < (std::min)(at60.size(), at240.size()); frame++) {
+        for (size_t i = 0; i < at60[frame].size(); i++)
+            worst = (std::max)(worst, std::fabs(at60[frame][i] - at240[frame][i]));
+    }
+    printf("60 Hz vs 240 Hz: largest level/peak difference %g over %zu frames\n", worst, at60.size());
+    CHECK(worst < 1e-4f);
+
+    // And the input actually moved things: the burst was reached and released
+    CHECK(at60[90][0] > 0.99f);       // 1.5 s, a second into the burst
+    CHECK(at60[180][0] < 0.31f);      // 3.0 s, well into silence the peak has also fallen
+    CHECK(at60[180][BANDS] < 0.31f);
+}
+
+static void TestPeakHoldAndFall()
+{
+    FakeClock clock;
+    VisualizerSmootherSettings settings;
+    VisualizerSmoother smoother(1);
+    smoother.SetSettings(settings);
+    const float loud = 1.0f;
+    const float silent = 0.0f;
+
+    // Let the level settle at full scale, then cut to silence at t = 1 s
+    for (int frame = 0; frame <= 60; frame++) {
+        clock.Set(frame * SECOND_NS / 60);
+        smoother.Update(&loud, clock.NowSeconds());
+    }
+    float top = smoother.GetPeaks()[0];
+    CHECK(top > 0.999f);
+
+    auto peakAt = [&](double seconds) {
+        clock.Set(static_cast<uint64_t>(seconds * 1e9));
+        smoother.Update(&silent, clock.NowSeconds());
+        return smoother.GetPeaks()[0];
+    };
+
+    // Held for peakHoldTime while the level drops away
+    CHECK(peakAt(1.1) == top);
+    CHECK(peakAt(1.0 + settings.peakHoldTime - 0.01) == top);
+    CHECK(smoother.GetLevels()[0] < 0.05f);
+
+    // Then falls as top - g t^2 / 2 from the end of the hold
+    double fall = 0.2;
+    CHECK_NEAR(peakAt(1.0 + settings.peakHoldTime + fall), top - 0.5 * settings.peakGravity * fall * fall, 1e-5);
+    fall = 0.5;
+    CHECK_NEAR(peakAt(1.0 + settings.peakHoldTime + fall), top - 0.5 * settings.peakGravity * fall * fall, 1e-5);
+
+    // Never below the level itself, and resting on it once it has fallen that far
+    float peak = peakAt(3.0);
+    CHECK(peak >= smoother.GetLevels()[0]);
+    CHECK(peak < 0.01f);
+
+    // A new high restarts the hold from its own time
+    const float half = 0.5f;
+    for (int frame = 1; frame <= 30; frame++) {
+        clock.Set(3 * SECOND_NS + frame * SECOND_NS / 60);
+        smoother.Update(&half, clock.NowSeconds());
+    }
+    float newTop = smoother.GetPeaks()[0];
+    CHECK(newTop > 0.49f && newTop <= 0.5f);
+    CHECK(peakAt(3.5 + settings.peakHoldTime - 0.01) == newTop);
+    CHECK(peakAt(3.5 + settings.peakHoldTime + 0.1) < newTop);
+
+    // Reset forgets levels, peaks and the previous timestamp
+    smoother.Reset();
+    CHECK(smoother.GetLevels()[0] == 0.0f && smoother.GetPeaks()[0] == 0.0f);
+}
+
+static void TestInterpolationClamp()
+{
+    const float previous[BANDS] = { 0.0f, 0.2f, 1.0f, 0.5f };
+    const float current[BANDS] = { 1.0f, 0.6f, 0.0f, 0.5f };
+    float output[BANDS];
+
+    // Halfway through the interval after the newest snapshot: halfway between the two
+    VisualizerSmoother::InterpolateSnapshots(previous, 1.00, current, 1.01, 1.015, BANDS, output);
+    CHECK_NEAR(output[0], 0.5, 1e-5);
+    CHECK_NEAR(output[1], 0.4, 1e-5);
+    CHECK_NEAR(output[2], 0.5, 1e-5);
+    CHECK_NEAR(output[3], 0.5, 1e-5);
+
+    // Before the interval: the previous snapshot, not an extrapolation past it
+    VisualizerSmoother::InterpolateSnapshots(previous, 1.00, current, 1.01, 0.90, BANDS, output);
+    CHECK(std::equal(output, output + BANDS, previous));
+
+    // Long after (capture stalled): the newest snapshot, not an overshoot
+    VisualizerSmoother::InterpolateSnapshots(previous, 1.00, current, 1.01, 5.00, BANDS, output);
+    CHECK(std::equal(output, output + BANDS, current));
+
+    // No previous snapshot or no interval between them: the newest as-is
+    VisualizerSmoother::InterpolateSnapshots(nullptr, 0.0, current, 1.01, 1.015, BANDS, output);
+    CHECK(std::equal(output, output + BANDS, current));
+    VisualizerSmoother::InterpolateSnapshots(previous, 1.01, current, 1.01, 1.015, BANDS, output);
+    CHECK(std::equal(output, output + BANDS, current));
+    VisualizerSmoother::InterpolateSnapshots(previous, 1.02, current, 1.01, 1.015, BANDS, output);
+    CHECK(std::equal(output, output + BANDS, current));
+}
+
+int main()
+{
+    TestFrameRateIndependence();
+    TestPeakHoldAndFall();
+    TestInterpolationClamp();
+    return TestResult("VisualizerSmootherTest");
+}
@@ -0,0 +1,88 @@
+/*
+ * Well-behaved test plugin that checks the host keeps its side of the collect() contract:
+ * open() before the first collect(), the same slots every call with 'valid' cleared, one
+ * call at a time, the context passed back, and close() last. Metric 0 counts calls,
+ * metric 1 reports contract violations seen so far, and metric 2 is written but never
+ * marked valid. Every fourth call returns RETRY, which the host must not publish.
+ */
+#include "OverlayPluginApi.h"
+#include <stddef.h>
+
+typedef struct ContractState {
+    int opened;
+    int inCall;
+    unsigned calls;
+    unsigned closes;
+    unsigned violations;
+    OverlayPluginSample* slots;
+} ContractState;
+
+static ContractState g_state;
+
+static const OverlayPluginMetric g_metrics[] = {
+    { "Calls", "", 0.0, 0.0 },
+    { "Contract violations", "", 0.0, 0.0 },
+    { "Never valid", "", 0.0, 0.0 },
+};
+
+static int Open(void* context)
+{
+    ContractState* state = (ContractState*)context;
+    if (state != &g_state || state->opened)
+        g_state.violations++;
+    g_state.opened = 1;
+    return OVERLAY_PLUGIN_OK;
+}
+
+static int Collect(void* context, OverlayPluginSample* samples, uint32_t count)
+{
+    ContractState* state = (ContractState*)context;
+    uint32_t i;
+    if (state != &g_state)
+        return OVERLAY_PLUGIN_FAILED;
+    if (__atomic_exchange_n(&state->inCall, 1, __ATOMIC_ACQ_REL))
+        state->violations++;
+
+    if (!state->opened || count != 3 || (state->slots && state->slots != samples))
+        state->violations++;
+    state->slots = samples;
+    for (i = 0; i < count && i < 3; i++) {
+        if (samples[i].valid)
+            state->violations++;
+    }
+
+    state->calls++;
+    samples[0].value = (double)state->calls;
+    samples[0].valid = 1;
+    samples[1].value = (double)state->violations;
+    samples[1].valid = 1;
+    samples[2].value = -1.0;
+
+    __atomic_store_n(&state->inCall, 0, __ATOMIC_RELEASE);
+    return state->calls % 4 == 0 ? OVERLAY_PLUGIN_RETRY : OVERLAY_PLUGIN_OK;
+}
+
+static void Close(void* context)
+{
+    ContractState* state = (ContractState*)context;
+    if (state != &g_state || !state->opened || state->inCall)
+        g_state.violations++;
+    g_state.opened = 0;
+    __atomic_add_fetch(&g_state.closes, 1, __ATOMIC_RELEASE);
+}
+
+static const OverlayPluginInfo g_info = {
+    OVERLAY_PLUGIN_API_VERSION, sizeof(OverlayPluginInfo), "Contract",
+    3, g_metrics, 100, &g_state, Open, Collect, Close
+};
+
+OVERLAY_PLUGIN_EXPORT const OverlayPluginInfo* OverlayPluginGetInfo(uint32_t hostApiVersion)
+{
+    return hostApiVersion >= OVERLAY_PLUGIN_API_VERSION ? &g_info : NULL;
+}
+
+/* For the test: how many times close() ran */
+OVERLAY_PLUGIN_EXPORT unsigned ContractPluginCloses(void)
+{
+    return __atomic_load_n(&g_state.closes, __ATOMIC_ACQUIRE);
+}
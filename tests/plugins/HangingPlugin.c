@@ -0,0 +1,58 @@
+/*
+ * Test plugin whose second collect() doesn't come back until the test releases it, so the
+ * host's watchdog has to give up on it. The test can see when the call is stuck.
+ */
+#include "OverlayPluginApi.h"
+#include <stddef.h>
+#include <unistd.h>
+
+static unsigned g_calls;
+static int g_stuck;
+static int g_released;
+
+static const OverlayPluginMetric g_metrics[] = {
+    { "Calls", "", 0.0, 0.0 },
+};
+
+static int Collect(void* context, OverlayPluginSample* samples, uint32_t count)
+{
+    (void)context;
+    (void)count;
+    unsigned calls = __atomic_add_fetch(&g_calls, 1, __ATOMIC_ACQ_REL);
+    if (calls >= 2) {
+        __atomic_store_n(&g_stuck, 1, __ATOMIC_RELEASE);
+        while (!__atomic_load_n(&g_released, __ATOMIC_ACQUIRE))
+            usleep(1000);
+        __atomic_store_n(&g_stuck, 0, __ATOMIC_RELEASE);
+    }
+    samples[0].value = (double)calls;
+    samples[0].valid = 1;
+    return OVERLAY_PLUGIN_OK;
+}
+
+static const OverlayPluginInfo g_info = {
+    OVERLAY_PLUGIN_API_VERSION, sizeof(OverlayPluginInfo), "Hanging",
+    1, g_metrics, 100, NULL, NULL, Collect, NULL
+};
+
+OVERLAY_PLUGIN_EXPORT const OverlayPluginInfo* OverlayPluginGetInfo(uint32_t hostApiVersion)
+{
+    (void)hostApiVersion;
+    return &g_info;
+}
+
+/* For the test */
+OVERLAY_PLUGIN_EXPORT unsigned HangingPluginCalls(void)
+{
+    return __atomic_load_n(&g_calls, __ATOMIC_ACQUIRE);
+}
+
+OVERLAY_PLUGIN_EXPORT int HangingPluginStuck(void)
+{
+    return __atomic_load_n(&g_stuck, __ATOMIC_ACQUIRE);
+}
+
+OVERLAY_PLUGIN_EXPORT void HangingPluginRelease(void)
+{
+    __atomic_store_n(&g_released, 1, __ATOMIC_RELEASE);
+}
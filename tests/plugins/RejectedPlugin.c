@@ -0,0 +1,48 @@
+/*
+ * Test plugins the host must refuse, one per build flag: no entry point, an entry point
+ * that declines, a different API version, and a description without metrics.
+ */
+#include "OverlayPluginApi.h"
+#include <stddef.h>
+
+static const OverlayPluginMetric g_metrics[] = {
+    { "Value", "", 0.0, 0.0 },
+};
+
+static int Collect(void* context, OverlayPluginSample* samples, uint32_t count)
+{
+    (void)context;
+    (void)samples;
+    (void)count;
+    return OVERLAY_PLUGIN_OK;
+}
+
+static const OverlayPluginInfo g_info = {
+#ifdef PLUGIN_WRONG_VERSION
+    OVERLAY_PLUGIN_API_VERSION + 1,
+#else
+    OVERLAY_PLUGIN_API_VERSION,
+#endif
+    sizeof(OverlayPluginInfo), "Rejected",
+#ifdef PLUGIN_NO_METRICS
+    0,
+#else
+    1,
+#endif
+    g_metrics, 1000, NULL, NULL, Collect, NULL
+};
+
+#ifdef PLUGIN_NO_ENTRY_POINT
+OVERLAY_PLUGIN_EXPORT const OverlayPluginInfo* OverlayPluginGetInformation(uint32_t hostApiVersion)
+#else
+OVERLAY_PLUGIN_EXPORT const OverlayPluginInfo* OverlayPluginGetInfo(uint32_t hostApiVersion)
+#endif
+{
+    (void)hostApiVersion;
+#ifdef PLUGIN_DECLINES
+    (void)g_info;    /* A valid description it could have returned; it declines anyway */
+    return NULL;
+#else
+    return &g_info;
+#endif
+}